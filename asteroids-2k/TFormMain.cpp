@@ -1,13 +1,18 @@
 //---------------------------------------------------------------------------
 #include <vcl.h>
 #include <windows.h>
+#include <mmsystem.h>
 #pragma hdrstop
 
 #include "TFormMain.h"
 
 #include "video.h"
+#include "render.h"
 #include "audio.h"
 #include "game.h"
+#include "loop.h"
+#include "replay.h"
+#include "profiler.h"
 #include "commdefs.h"
 
 #include "TDlgBestScores.h"
@@ -31,6 +36,13 @@ __fastcall TFormMain::TFormMain(TComponent* Owner) : TForm(Owner)
 	m_pGame = NULL;
 	m_pAudio = NULL;
     m_pVideo = NULL;
+    m_pRender = NULL;
+    m_pClock = NULL;
+    m_pLoop = NULL;
+    m_pReplay = NULL;
+    m_bReplay = false;
+    m_nReplayTick = 0;
+    m_pProfiler = NULL;
 }
 
 /*!****************************************************************************
@@ -57,7 +69,8 @@ void __fastcall TFormMain::FormPaint(TObject *Sender)
 		HDC hVMDC = m_pGame->GetVM()->GetDC();
         RECT Rect = m_pGame->GetClientArea();
 
-        ::BitBlt(hDC, 0, 0, Rect.right, Rect.bottom, hVMDC, 0, 0, SRCCOPY);
+        PROFILE(ppPaint,
+        	::BitBlt(hDC, 0, 0, Rect.right, Rect.bottom, hVMDC, 0, 0, SRCCOPY));
 	}
 }
 
@@ -67,7 +80,9 @@ void __fastcall TFormMain::FormPaint(TObject *Sender)
 ******************************************************************************/
 void __fastcall TFormMain::TimerTimer(TObject *Sender)
 {
-	MainLoop();
+	PROFILE(ppFrame, MainLoop());
+
+	if( Profiler ) Profiler->EndFrame();
 }
 
 /*!****************************************************************************
@@ -97,7 +112,6 @@ void TFormMain::Setup()
     assert(DlgBestScores);
     DlgBestScores->Visible = false;
 
-	srand(::GetCurrentTime());
 
 								// setting-up the video manager
 	try
@@ -111,10 +125,24 @@ void TFormMain::Setup()
 		exit(-1);
     }
 
-								// setting-up the sound manager
+								// the actors draw on the render buffer
+	m_pRender = new TRenderBuffer();
+	assert(m_pRender);
+								// the game loop, on the system clock;
+                                // 1 ms resolution for Sleep()
+	::timeBeginPeriod(1);
+
+	m_pClock = new TSystemClock();
+	assert(m_pClock);
+
+	m_pLoop = new TGameLoop(m_pClock, FPS, FPS);
+	assert(m_pLoop);
+								// setting-up the sound manager;
+                                // "-mixer" mixes the sounds in the
+                                // game, on a stream of OpenAL
     try
     {
-    	m_pAudio = new TSoundManager();
+    	m_pAudio = new TSoundManager(FindCmdLineSwitch("mixer"));
 		assert(m_pAudio);
 
 		m_pAudio->SetMasterVolume(0.25);
@@ -128,8 +156,11 @@ void TFormMain::Setup()
 								// create the game
 	try
     {
-        m_pGame = new TGame(m_pVideo, m_pAudio);
+        m_pGame = new TGame(m_pVideo, m_pAudio, m_pRender);
         assert(m_pGame);
+								// one thread per core for the
+                                // parallel loops of the step
+        m_pGame->SetThreadsCount(0);
 	}
     catch(...)
     {
@@ -141,11 +172,64 @@ void TFormMain::Setup()
 		exit(-1);
     }
 
-#ifdef _DEVEL
-	m_pGame->Restart();
-#else
-	m_pGame->GameOver();
+	m_pReplay = new TReplay();
+	assert(m_pReplay);
+
+	m_pProfiler = new TProfiler();
+	assert(m_pProfiler);
+
+	ParseTheCommandLine();
+								// a new game on each run, same seed
+                                // and same inputs, same game
+	if( m_bReplay )
+	{
+		m_pGame->Restart(m_pReplay->GetSeed());
+	}
+	else
+	{
+		m_pGame->Restart(::GetCurrentTime());
+#ifndef _DEVEL
+		m_pGame->GameOver();
 #endif
+	}
+}
+
+/*!****************************************************************************
+* @brief	Handles the command line options "-record file", "-replay file",
+*			"-profile file" and "-threads count"
+******************************************************************************/
+void TFormMain::ParseTheCommandLine()
+{
+	assert(m_pReplay);
+
+	for(int i=1; i<ParamCount(); i++)
+	{
+		AnsiString strFileName = ParamStr(i+1);
+
+		if( ParamStr(i) == "-record" )
+		{
+			m_strRecordFile = strFileName;
+		}
+		else if( ParamStr(i) == "-replay" )
+		{
+			if( !m_pReplay->Load(strFileName.c_str()) )
+			{
+				::MessageBox(0, L"Cannot load the replay file", L"Error", MB_OK | MB_ICONERROR);
+				exit(-1);
+			}
+
+			m_bReplay = true;
+		}
+		else if( ParamStr(i) == "-profile" )
+		{
+			m_strProfileFile = strFileName;
+			m_pProfiler->SetEnabled(true);
+		}
+		else if( ParamStr(i) == "-threads" )
+		{
+			m_pGame->SetThreadsCount(StrToIntDef(strFileName, 0));
+		}
+	}
 }
 
 /*!****************************************************************************
@@ -156,18 +240,42 @@ void TFormMain::Cleanup()
 	assert(m_pGame);
 	assert(m_pAudio);
     assert(m_pVideo);
+    assert(m_pRender);
+    assert(m_pLoop);
+    assert(m_pReplay);
+    assert(m_pProfiler);
+
+	if( !m_strRecordFile.IsEmpty() && m_pReplay->IsRecording() )
+	{
+		m_pReplay->Save(m_strRecordFile.c_str());
+	}
+
+	if( !m_strProfileFile.IsEmpty() && m_pProfiler->IsEnabled() )
+	{
+		m_pProfiler->ExportTheTrace(m_strProfileFile.c_str());
+	}
+
+	m_pProfiler->SetEnabled(false);
 
 	delete m_pGame;
     delete m_pAudio;
     delete m_pVideo;
+    delete m_pRender;
+    delete m_pLoop;
+    delete m_pClock;
+    delete m_pReplay;
+    delete m_pProfiler;
+
+	::timeEndPeriod(1);
 }
 
 /*!****************************************************************************
 * @brief	Keyboard handler
+* @return	The commands for the human ship, a combination of enInput
 * @note		Uses GetAsynkKeyState() function instead of WM_KEYDOWN event
 *			handler so that can handle multiple keys pressed simultaneously
 ******************************************************************************/
-void TFormMain::KeyboardHandler()
+unsigned TFormMain::KeyboardHandler()
 {
 	static SHORT nKeys[256];
 	int VK_N = 0X4E, VK_P = 0X50, VK_Q = 0X51, VK_S = 0X53;
@@ -186,61 +294,126 @@ void TFormMain::KeyboardHandler()
 	nKeys[VK_ADD] = GetAsyncKeyState(VK_ADD);
 	nKeys[VK_SUBTRACT] = GetAsyncKeyState(VK_SUBTRACT);
 
-	if( nKeys[VK_N] && !m_pGame->IsPausing() ) m_pGame->Restart();
+	bool bF2 = nKeys[VK_F2];
+	nKeys[VK_F2] = GetAsyncKeyState(VK_F2);
+
+	if( nKeys[VK_N] && !m_pGame->IsPausing() && !m_bReplay )
+	{
+		m_pGame->Restart();
+		m_pReplay->Begin(m_pGame->GetSeed());
+	}
 
 	if( nKeys[VK_P] ) m_pGame->PauseTheGame();
+											// toggles on the key press only
+	if( nKeys[VK_F2] && !bF2 ) m_pProfiler->SetEnabled(!m_pProfiler->IsEnabled());
 	if( nKeys[VK_ADD] ) m_pGame->GetSM()->IncreaseMasterVolume();
 	if( nKeys[VK_SUBTRACT] ) m_pGame->GetSM()->DecreaseMasterVolume();
 	if( nKeys[VK_ESCAPE] | nKeys[VK_Q] ) { m_pGame->EndTheGame(); PostQuitMessage(0); }
 
-	if( m_pGame->GetShip(scHuman)->IsAlive() )
-	{
-		if( nKeys[VK_S] ) m_pGame->GetShip(scHuman)->ActivateTheShield();;
-		if( nKeys[VK_SPACE] ) m_pGame->ShotTheMissile(m_pGame->GetShip(scHuman));
-		if( nKeys[VK_LEFT] ) m_pGame->GetShip(scHuman)->RotateLeft(SHIP_ROTSTEP);
-		if( nKeys[VK_RIGHT] ) m_pGame->GetShip(scHuman)->RotateRight(SHIP_ROTSTEP);
-		if( nKeys[VK_UP] ) m_pGame->GetShip(scHuman)->Impulse(SHIP_IMPULSE);
-	}
+	unsigned nInput = 0;
+
+	if( nKeys[VK_S] ) nInput |= inShield;
+	if( nKeys[VK_SPACE] ) nInput |= inFire;
+	if( nKeys[VK_LEFT] ) nInput |= inLeft;
+	if( nKeys[VK_RIGHT] ) nInput |= inRight;
+	if( nKeys[VK_UP] ) nInput |= inThrust;
+
+	return nInput;
 }
 
 /*!****************************************************************************
-* @brief	Force the execution speed to a specified framerate
-* @param	nFPS The value of Frames per Second to be forced to
+* @brief	Records the tick just run, or checks it against the replay
+* @param	nInput The commands applied before the tick
 ******************************************************************************/
-void TFormMain::ForceToFPS(unsigned nFPS)
+void TFormMain::ReplayHandler(unsigned nInput)
 {
-	assert(nFPS > 0);
+	assert(m_pReplay);
+
+	if( !m_bReplay )
+	{
+		if( m_pReplay->IsRecording() ) m_pReplay->Record(nInput, m_pGame->GetHash());
+
+		return;
+	}
 
-	static unsigned nCurTime = ::GetTickCount();
+	bool bMatch = m_pReplay->Check(m_nReplayTick, m_pGame->GetHash());
 
-	while( (::GetTickCount() - nCurTime) < 1.0/FPS * 1000.0) {;}
-	nCurTime = ::GetTickCount();
+	m_nReplayTick++;
+
+	if( !bMatch || m_nReplayTick >= m_pReplay->GetTicksCount() )
+	{
+		m_pGame->PauseTheGame(true);
+
+		::MessageBox(0, bMatch ? L"Replay completed" : L"The replay diverged!",
+			L"Replay", MB_OK | (bMatch ? MB_ICONINFORMATION : MB_ICONERROR));
+
+		m_bReplay = false;
+	}
 }
 
 /*!****************************************************************************
 * @brief	Main application loop
+* @note		The game advances in fixed steps of DT, FPS steps per second of
+*			real time: after a slow frame more steps are run to catch up
 ******************************************************************************/
 void TFormMain::MainLoop()
 {
 	assert(m_pGame);
+	assert(m_pAudio);
+	assert(m_pLoop);
+	assert(m_pProfiler);
+											// the next blocks of the mixer,
+                                            // during the pause too
+	m_pAudio->Update();
 
-	KeyboardHandler();
+	if( !m_pGame->IsRunning() || m_pGame->IsPausing() )
+	{
+		KeyboardHandler();
+											// the pause does not count as
+                                            // elapsed time
+		m_pLoop->Reset();
+		PROFILE(ppWait, m_pLoop->Wait());
+
+		return;
+	}
+
+	unsigned nSteps = m_pLoop->Update();
 
-	if( m_pGame->IsRunning() && !m_pGame->IsPausing() )
+	for(unsigned i=0; i<nSteps && m_pGame->IsRunning() && !m_pGame->IsPausing(); i++)
 	{
-											// clear the screen to black
-		m_pGame->GetVM()->ClearScreen(RGB(0,0,0));
+		unsigned nInput = KeyboardHandler();
+
+		if( m_bReplay ) nInput = m_pReplay->GetInput(m_nReplayTick);
+
+		m_pGame->Input(nInput);
+											// only the last step is drawn
+		m_pRender->Clear();
 
 		m_pGame->Run();
+
+		ReplayHandler(nInput);
+	}
+
+	if( m_pLoop->IsRenderTime() )
+	{
+											// clear the screen to black
+		PROFILE(ppClear, m_pGame->GetVM()->ClearScreen(RGB(0,0,0)));
+											// draw the frame recorded by Run()
+		PROFILE(ppRender, m_pGame->Render());
+
+		if( m_pProfiler->IsEnabled() )
+		{
+			m_pProfiler->DrawOverlay(m_pGame->GetVM(), 16, 48);
+											// the entities, below the phases
+			m_pGame->DrawTheStats(m_pGame->GetVM(), 16, 48 + (ppCount + 2) * FONTSIZE);
+		}
 											// Force to repaint. The last paramater
 											// [BOOL bErase] must be set to FALSE
 											// to avoid annoying flickering effects
 		InvalidateRect((HWND) this->Handle, &m_pGame->GetClientArea(), FALSE);
-
-											// Force to a specific FPS so that
-											// the frame-rate is CPU independent
-		ForceToFPS(FPS);
 	}
+											// sleep until the next step
+	PROFILE(ppWait, m_pLoop->Wait());
 }
 
 //---------------------------------------------------------------------------
@@ -13,6 +13,11 @@
 class TGame;
 class TSoundManager;
 class TVideoManager;
+class TRenderBuffer;
+class TGameLoop;
+class TClock;
+class TReplay;
+class TProfiler;
 
 //---------------------------------------------------------------------------
 class TFormMain : public TForm
@@ -33,12 +38,29 @@ protected:
 	TGame* m_pGame;
 	TSoundManager *m_pAudio;
     TVideoManager *m_pVideo;
+    TRenderBuffer *m_pRender;
+    TClock *m_pClock;
+    TGameLoop *m_pLoop;
+											// "-record file": the games are
+                                            // recorded, the last one is saved;
+                                            // "-replay file": a recorded game
+                                            // is played back and checked
+    TReplay *m_pReplay;
+    AnsiString m_strRecordFile;
+    bool m_bReplay;
+    unsigned m_nReplayTick;
+											// F2 shows the time of the phases,
+                                            // "-profile file" saves the trace
+                                            // of the last frames at the exit
+    TProfiler *m_pProfiler;
+    AnsiString m_strProfileFile;
 
 	void Setup();
     void Cleanup();
     void MainLoop();
-    void KeyboardHandler();
-    void ForceToFPS(unsigned nFPS);
+    unsigned KeyboardHandler();
+    void ParseTheCommandLine();
+    void ReplayHandler(unsigned nInput);
 };
 
 //---------------------------------------------------------------------------
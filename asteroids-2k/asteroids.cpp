@@ -12,261 +12,409 @@
 ******************************************************************************/
 
 #include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
 
 #include "maths.h"
 #include "utils.h"
 #include "asteroids.h"
+#include "sounds.h"
 #include "commdefs.h"
 
 
-#define ASTEROID_MAXVERTS	16
-
-
 /*!****************************************************************************
 * @brief	Constructor
 * @param	pVM Pointer to the video manager object
 * @param	pSM Pointer to the sound manager object
-* @param	nClass Class of the asteroid (e.g.: big, medium, small)
-* @param	Pos The initial position for the asteroid
-* @param	Vel The initial velocity for the asteroid
-* @param	Radius The size (e.g. radius) of the asteroid
+* @param	pRandom Pointer to the random generator of the game
+* @param	pShapes Pointer to the cache of the rotated outlines
+* @param	pJobs Pointer to the job system
+* @param	pEntities Pointer to the entity store, the asteroids are its
+*			archetype ekAsteroid
 ******************************************************************************/
-TAsteroid::TAsteroid(TVideoManager* pVM, TSoundManager* pSM,
-	enAsteroidClass nClass, TVector2 Pos, TVector2 Vel, double Radius)
+TAsteroidField::TAsteroidField(TVideoDevice* pVM, TSoundDevice* pSM,
+	maths::TRandom* pRandom, TShapeCache* pShapes, TJobSystem* pJobs,
+	TEntityStore* pEntities)
 {
 	assert(pVM);
 	assert(pSM);
+	assert(pRandom);
+	assert(pShapes);
+	assert(pJobs);
+	assert(pEntities);
 
 	m_pVideo = pVM;
 	m_pAudio = pSM;
-	m_nClass = nClass;
-	m_Pos = Pos;
-	m_Vel = Vel;
-	m_bAlive = true;
-	m_Radius = Radius;
-	m_nClass = nClass;
-    m_bVisible = true;
-	m_Radius = Radius;
-	m_nExplosionTicks = 0;
+	m_pRandom = pRandom;
+	m_pShapes = pShapes;
+	m_pJobs = pJobs;
+	m_pEntities = pEntities;
+	m_pRocks = &pEntities->GetArchetype(ekAsteroid);
 	m_Color = RGB(255,255,255);
+	m_Dt = m_Width = m_Height = 0;
+	m_nAlive = m_nExploding = 0;
+	m_bCompact = false;
 
-	m_Shape = RandShape(Radius);
-
-	m_Rot = 0;
-	m_DRot = rand()/double(RAND_MAX) * Vel.Length() * 0.25 * maths::RandSign();
+	BuildTheTemplates();
 }
 
 /*!****************************************************************************
 * @brief	Destructor
 ******************************************************************************/
-TAsteroid::~TAsteroid()
+TAsteroidField::~TAsteroidField()
 {
-	;
-}
+	m_pEntities->Clear(ekAsteroid);
 
-/*!****************************************************************************
-* @brief	Checks for the asteroid "aliveness"
-* @return	True if the asteroid is "alive", false otherwise
-******************************************************************************/
-bool TAsteroid::IsAlive()
-{
-	return m_bAlive;
+	for(int i=0; i<=acSmall; i++)
+	{
+		for(int j=0; j<ASTEROID_NTEMPLATES; j++) m_pShapes->Remove(m_Templates[i][j]);
+	}
 }
 
 /*!****************************************************************************
-* @brief	Checks if the asteroid is colliding in a specified position
-* @return	True if the asteroid is colliding in Pos, false otherwise
+* @brief	Builds the outlines shared by the asteroids, ASTEROID_NTEMPLATES
+*			per class, and adds them to the shape cache
+* @note		The templates have their own generator, so they are the same in
+*			every game and they do not take numbers from the game sequence
 ******************************************************************************/
-bool TAsteroid::Collide(TVector2 Pos)
+void TAsteroidField::BuildTheTemplates()
 {
-	return bool ( Distance(Pos, this->m_Pos) <= this->m_Radius );
+	maths::TRandom Random(ASTEROID_TEMPLATESEED);
+
+	for(int i=0; i<=acSmall; i++)
+	{
+		for(int j=0; j<ASTEROID_NTEMPLATES; j++)
+		{
+			RandShape(enAsteroidClass(i), Random, m_Outline);
+
+			m_Templates[i][j] = m_pShapes->Add(m_Outline);
+		}
+	}
 }
 
 /*!****************************************************************************
-* @brief	Sets the position of the asteroid
-* @param	Pos The position to be set for the asteroid
+* @brief	Adds an asteroid to the field
+* @param	nClass Class of the asteroid (e.g.: big, medium, small)
+* @param	Pos The initial position for the asteroid
+* @param	Vel The initial velocity for the asteroid
+* @param	Radius The size (e.g. radius) of the asteroid
+* @return	The handle of the new asteroid
 ******************************************************************************/
-void TAsteroid::SetPos(TVector2 Pos)
+TEntity TAsteroidField::Add(enAsteroidClass nClass, TVector2 Pos, TVector2 Vel,
+	double Radius)
 {
-	m_Pos = Pos;
+	static const TSoundId Sounds[acSmall + 1] = { snBangLarge, snBangMedium, snBangSmall };
+
+	TEntity nEntity = m_pEntities->Create(ekAsteroid);
+	unsigned nIndex = GetCount() - 1;
+
+	TTransform& Transform = m_pRocks->Transforms[nIndex];
+	TMotion& Motion = m_pRocks->Motions[nIndex];
+	TLifetime& Lifetime = m_pRocks->Lifetimes[nIndex];
+	TRenderable& Renderable = m_pRocks->Renderables[nIndex];
+
+	Transform.X = Pos.X;
+	Transform.Y = Pos.Y;
+	Transform.Rot = 0;
+	Motion.VX = Vel.X;
+	Motion.VY = Vel.Y;
+	m_pRocks->Colliders[nIndex].Radius = Radius;
+	Lifetime.bAlive = Lifetime.bVisible = true;
+	m_nAlive++;
+	m_pRocks->Emitters[nIndex].nSound = Sounds[nClass];
+
+	Renderable.nClass = nClass;
+	Renderable.nVariant = m_pRandom->Next() % ASTEROID_NTEMPLATES;
+	Renderable.nShape = m_Templates[nClass][Renderable.nVariant];
+	Renderable.Color = m_Color;
+											// a spare outline is not its own
+	if( nIndex < m_Outlines.size() ) m_Outlines[nIndex].clear();
+											// one draw per statement, the order
+                                            // of the operands is unspecified
+	double DRot = m_pRandom->AbsRand(Vel.Length() * 0.25);
+	Motion.Spin = DRot * m_pRandom->RandSign();
+
+	return nEntity;
 }
 
 /*!****************************************************************************
-* @brief	Gets the position of the asteroid
-* @return	The position of the asteroid
+* @brief	Removes all the asteroids and the explosions
 ******************************************************************************/
-TVector2 TAsteroid::GetPos()
+void TAsteroidField::Clear()
 {
-	return m_Pos;
+											// invalidates the handles in use
+	m_pEntities->Clear(ekAsteroid);
+
+	m_Explosions.clear();
+	m_nAlive = m_nExploding = 0;
+	m_bCompact = false;
 }
 
 /*!****************************************************************************
-* @brief	Gets the veclocity of the asteroid
-* @return	The velocity of the asteroid
+* @brief	Removes the dead asteroids whose explosion has ended
+* @note		Single pass that keeps the order of the others, the outlines
+*			follow their asteroids
 ******************************************************************************/
-TVector2 TAsteroid::GetVel()
+void TAsteroidField::Compact()
 {
-	return this->m_Vel;
+	unsigned nCount = 0;
+
+	for(unsigned i=0; i<GetCount(); i++)
+	{
+		TLifetime& Lifetime = m_pRocks->Lifetimes[i];
+
+		if( Lifetime.bAlive || Lifetime.nTicks > 0 )
+		{
+			if( i != nCount ) m_Outlines[nCount].swap(m_Outlines[i]);
+			nCount++;
+		}
+	}
+
+	m_pEntities->RemoveTheDead(ekAsteroid);
+	m_bCompact = false;
+
+	assert(GetCount() == nCount);
 }
 
 /*!****************************************************************************
-* @brief	Gets the class of the asteroid
-* @return	The class of the asteroid (e.g. small, medium or big)
+* @brief	Gets the memory of the asteroids
+* @return	The bytes taken by the components and the arrays of the field,
+*			as allocated
+* @note		The templates are in the shape cache
 ******************************************************************************/
-enAsteroidClass TAsteroid::GetClass()
+unsigned TAsteroidField::GetMemory()
 {
-	return this->m_nClass;
+	unsigned nBytes = sizeof(*this) + m_pRocks->GetMemory();
+
+	nBytes += m_Explosions.capacity() * sizeof(TAsteroidExplosion);
+	nBytes += m_Outline.capacity() * sizeof(TVector2);
+
+	for(unsigned i=0; i<m_Outlines.size(); i++)
+	{
+		nBytes += sizeof(TVecPoints) + m_Outlines[i].capacity() * sizeof(TVector2);
+	}
+
+	return nBytes;
 }
 
 /*!****************************************************************************
-* @brief	Generates randomly an asteroid shape
-* @param	Size The size of the asteroid to be generated
+* @brief		Generates randomly an asteroid shape, of unit radius
+* @param		nClass The class of the asteroid
+* @param		Random The random generator
+* @param[out]	Pts The vertices of the shape, its memory is reused
 ******************************************************************************/
-TVecPoints TAsteroid::RandShape(double Size)
+void TAsteroidField::RandShape(enAsteroidClass nClass, maths::TRandom& Random,
+	TVecPoints& Pts)
 {
-	TVecPoints Pts;
 	double Angle = 0;
 	double DAngle = 360.0/ASTEROID_MAXVERTS;
+	double Roughness = GetRoughness(nClass);
+
+	Pts.resize(ASTEROID_MAXVERTS);
 
 	for(int i=0; i<ASTEROID_MAXVERTS; ++i)
 	{
-		Pts.push_back( TVector2(
-        	Size * cos( DEG2RAD(Angle)) + maths::Rand(GetRoughness()),
-			Size * sin( DEG2RAD(Angle)) + maths::Rand(GetRoughness()) ));
+		double X = cos( DEG2RAD(Angle)) + Random.Rand(Roughness);
+		double Y = sin( DEG2RAD(Angle)) + Random.Rand(Roughness);
+
+		Pts[i] = TVector2(X, Y);
 
 		Angle += DAngle;
 	}
-
-	return Pts;
 }
 
 /*!****************************************************************************
 * @brief	Gets the "roughness" of asteroid
-* @return	Return the roughness by mean of the "class" (size) of asteroid
+* @param	nClass The class of the asteroid
+* @return	Return the roughness by mean of the "class" (size) of asteroid,
+*			relative to its size
 ******************************************************************************/
-double TAsteroid::GetRoughness()
+double TAsteroidField::GetRoughness(enAsteroidClass nClass)
 {
-    double Roughness = 5.0;
+											// 5, 3 and 2 pixels on asteroids
+                                            // of 30, 20 and 10 pixels
+    double Roughness = 5.0/30.0;
 
-    if( m_nClass == acBig ) Roughness = 5.0;
-    else if( m_nClass == acMedium ) Roughness = 3.0;
-    else Roughness = 2.0;
+    if( nClass == acBig ) Roughness = 5.0/30.0;
+    else if( nClass == acMedium ) Roughness = 3.0/20.0;
+    else Roughness = 2.0/10.0;
 
     return Roughness;
 }
 
 /*!****************************************************************************
-* @brief	Gets the size of the asteroid
-* @return	The Size (radius) of the asteroid
+* @brief	Checks if an asteroid is colliding in a specified position
+* @param	nIndex Index of the asteroid
+* @param	Pt The position to be checked
+* @return	True if the asteroid is colliding in Pt, false otherwise
 ******************************************************************************/
-double TAsteroid::GetSize()
+bool TAsteroidField::Collide(unsigned nIndex, TVector2 Pt)
 {
- 	return m_Radius;
+	TTransform& Transform = m_pRocks->Transforms[nIndex];
+	double Radius = m_pRocks->Colliders[nIndex].Radius;
+	double DX = Pt.X - Transform.X, DY = Pt.Y - Transform.Y;
+
+	if( DX*DX + DY*DY > Radius * Radius ) return false;
+											// inside the circle: the outline,
+                                            // if drawn since it was added
+	return !HasOutline(nIndex) || PointInPolygon(Pt, m_Outlines[nIndex]);
 }
 
 /*!****************************************************************************
-* @brief	Sets the asteroid "aliveness"
-* @return	True for alive, false otherwise
+* @brief	Checks if a point moving along a segment has hit an asteroid
+* @param	nIndex Index of the asteroid
+* @param	From The position of the point at the start of the step
+* @param	To The position of the point at the end of the step
+* @param	Dt The value for the delta time of the step
+* @return	True if the asteroid is colliding with the segment, false otherwise
+* @note		The test is made relative to the asteroid, that has moved by its
+*			velocity in the same step
+* @note		The bounding circle only: the outline is the one at the end of
+*			the step, and the asteroid has turned during it, so a segment
+*			may cross the rock and miss that outline
 ******************************************************************************/
-void TAsteroid::SetAlive(bool bAlive)
+bool TAsteroidField::Collide(unsigned nIndex, TVector2 From, TVector2 To, double Dt)
 {
- 	m_bAlive = bAlive;
+	From.X += m_pRocks->Motions[nIndex].VX * Dt;
+	From.Y += m_pRocks->Motions[nIndex].VY * Dt;
+
+	return SegmentCircle(From, To, GetPos(nIndex), GetSize(nIndex));
 }
 
 /*!****************************************************************************
-* @brief	Sets the asteroid visibility
+* @brief	Checks if an asteroid has been drawn since it was added
+* @param	nIndex Index of the asteroid
+* @return	True if GetOutline() is its outline, where it is now
 ******************************************************************************/
-void TAsteroid::SetVisible(bool bVisible)
+bool TAsteroidField::HasOutline(unsigned nIndex)
 {
- 	m_bVisible = bVisible;
+	return nIndex < m_Outlines.size() && m_Outlines[nIndex].size();
 }
 
 /*!****************************************************************************
-* @brief	Handles the asteroid crashing
+* @brief	Gets the outline of an asteroid, as drawn in the last update
+* @param	nIndex Index of the asteroid
+* @return	The outline, polygon of the collisions
 ******************************************************************************/
-void TAsteroid::Crash()
+TVecPoints& TAsteroidField::GetOutline(unsigned nIndex)
 {
-    SetAlive(false);
+	assert(HasOutline(nIndex));
+
+	return m_Outlines[nIndex];
 }
 
 /*!****************************************************************************
-* @brief	Check if the asteroid is exploding
-* @return	True if the asteroid is exploding, false otherwise
+* @brief	Sets the position of an asteroid, its outline follows
+* @param	nIndex Index of the asteroid
+* @param	Pos The new position
 ******************************************************************************/
-bool TAsteroid::IsExploding()
+void TAsteroidField::SetPos(unsigned nIndex, TVector2 Pos)
 {
-	return bool(m_nExplosionTicks > 0);
+	TVector2 OldPos = GetPos(nIndex);
+
+	m_pRocks->Transforms[nIndex].X = Pos.X;
+	m_pRocks->Transforms[nIndex].Y = Pos.Y;
+
+	MoveTheOutline(nIndex, OldPos);
 }
 
 /*!****************************************************************************
-* @brief	Starts the asteroid explosion
+* @brief	Translates the outline of an asteroid that has been moved
+* @param	nIndex Index of the asteroid
+* @param	OldPos The position the outline has been built at
 ******************************************************************************/
-void TAsteroid::Explode()
+void TAsteroidField::MoveTheOutline(unsigned nIndex, TVector2 OldPos)
+{
+	if( HasOutline(nIndex) )
+	{
+		TTransform& Transform = m_pRocks->Transforms[nIndex];
+
+		Translate(m_Outlines[nIndex], TVector2(Transform.X - OldPos.X,
+			Transform.Y - OldPos.Y));
+	}
+}
+
+/*!****************************************************************************
+* @brief	Starts the explosion of an asteroid
+* @param	nIndex Index of the asteroid
+******************************************************************************/
+void TAsteroidField::Explode(unsigned nIndex)
 {
 	assert(m_pAudio);
+	assert(nIndex < GetCount());
 
-	SetAlive(false);
-	SetVisible(false);
+	TLifetime& Lifetime = m_pRocks->Lifetimes[nIndex];
 
-    if( GetClass() == acBig ) { m_pAudio->PlayTheSound("bang_large"); }
-    else if( GetClass() == acMedium ) { m_pAudio->PlayTheSound("bang_medium"); }
-    else { m_pAudio->PlayTheSound("bang_small"); }
+	assert(Lifetime.bAlive);
+											// removed from the field once
+                                            // the debris have faded
+	Lifetime.bAlive = false;
+	Lifetime.nTicks = ASTEROID_EXPLOSIONTICKS;
+	m_nAlive--;
+	m_nExploding++;
 
-	m_nExplosionTicks = ASTEROID_EXPLOSIONTICKS;
+	m_pAudio->PlayTheSound(m_pRocks->Emitters[nIndex].nSound, false,
+		GetThePan(m_pRocks->Transforms[nIndex].X));
 
-	m_DebrisStartPos = m_Pos;
+	m_Explosions.push_back(TAsteroidExplosion());
+	TAsteroidExplosion& Explosion = m_Explosions.back();
 
+	Explosion.nTicks = ASTEROID_EXPLOSIONTICKS;
+	Explosion.Origin = Explosion.StartPos = GetPos(nIndex);
+	Explosion.Vel = GetVel(nIndex);
 												// builds the debris
 	{
-        m_nDebris = ASTEROID_NDEBRIS/2.0 + maths::AbsRand(ASTEROID_NDEBRIS)/2.0;
+        Explosion.nDebris = ASTEROID_NDEBRIS/2.0 + m_pRandom->AbsRand(ASTEROID_NDEBRIS)/2.0;
 
         double Scale = 8.0;
-        int nSize = GetSize();
-        double DAngle = (2.0 * M_PI) / m_nDebris;
+        int nSize = GetSize(nIndex);
+        double DAngle = (2.0 * M_PI) / Explosion.nDebris;
 
-        for(int i=0; i < m_nDebris; ++i)
+        for(int i=0; i < Explosion.nDebris; ++i)
         {
-            double Radius = nSize / 4.0 + abs(maths::Rand(nSize));
+            double Radius = nSize / 4.0 + fabs(m_pRandom->Rand(nSize));
 
-            m_Debris[i].X = m_Pos.X + cos(i*DAngle) * Radius;
-            m_Debris[i].Y = m_Pos.Y + sin(i*DAngle) * Radius;
+            Explosion.Debris[i].X = Explosion.Origin.X + cos(i*DAngle) * Radius;
+            Explosion.Debris[i].Y = Explosion.Origin.Y + sin(i*DAngle) * Radius;
 
-            m_DebrisScales[i] = maths::AbsRand(Scale);
-            m_DebrisScales[i] = maths::AbsRand(Scale);
+            Explosion.DebrisScales[i] = m_pRandom->AbsRand(Scale);
+            Explosion.DebrisScales[i] = m_pRandom->AbsRand(Scale);
         }
 	}
 }
 
 /*!****************************************************************************
-* @brief 	Handles the asteroid explosion
+* @brief 	Handles an asteroid explosion
+* @param	Explosion The explosion data
 ******************************************************************************/
-void TAsteroid::DoExplosion()
+void TAsteroidField::DoExplosion(TAsteroidExplosion& Explosion)
 {
 	assert(m_pVideo);
 
 	double Scale = 16;
-	m_nExplosionTicks--;
+	Explosion.nTicks--;
 
-	int nCurTick = ASTEROID_EXPLOSIONTICKS - m_nExplosionTicks;
+	int nCurTick = ASTEROID_EXPLOSIONTICKS - Explosion.nTicks;
 
 											// Tien conto della quantita'
                                             // di moto che ha l'asteroide
                                             // al momento dell'esplosione.
-    m_DebrisStartPos.X += m_Vel.X * DT;
-    m_DebrisStartPos.Y += m_Vel.Y * DT;
+    Explosion.StartPos.X += Explosion.Vel.X * DT;
+    Explosion.StartPos.Y += Explosion.Vel.Y * DT;
 
-	if( m_nExplosionTicks > 0 )
+	if( Explosion.nTicks > 0 )
 	{
-		BYTE Brightness = 255.0/ double(ASTEROID_EXPLOSIONTICKS) * m_nExplosionTicks;
+		BYTE Brightness = 255.0/ double(ASTEROID_EXPLOSIONTICKS) * Explosion.nTicks;
 
-		for(int i=0; i<m_nDebris; i++)
+		for(int i=0; i<Explosion.nDebris; i++)
 		{
-			double X = m_DebrisStartPos.X
-            	+ (m_Debris[i].X - m_Pos.X)
-                * (Scale + m_DebrisScales[i]) / 100.0 * nCurTick ;
-			double Y = m_DebrisStartPos.Y
-            	+ (m_Debris[i].Y - m_Pos.Y)
-            	* (Scale + m_DebrisScales[i]) / 100.0 * nCurTick ;
+			double X = Explosion.StartPos.X
+            	+ (Explosion.Debris[i].X - Explosion.Origin.X)
+                * (Scale + Explosion.DebrisScales[i]) / 100.0 * nCurTick ;
+			double Y = Explosion.StartPos.Y
+            	+ (Explosion.Debris[i].Y - Explosion.Origin.Y)
+            	* (Scale + Explosion.DebrisScales[i]) / 100.0 * nCurTick ;
 
 			TVector2 Pos( X, Y );
 			m_pVideo->DrawPoint(Pos, RGB(Brightness, Brightness, Brightness) );
@@ -275,31 +423,127 @@ void TAsteroid::DoExplosion()
 }
 
 /*!****************************************************************************
-* @brief	Updates the asteroid status
+* @brief	Updates the status of all the asteroids and explosions
 * @param	Dt The value for the delta time
 ******************************************************************************/
-void TAsteroid::Update(double Dt)
+void TAsteroidField::Update(double Dt)
 {
 	assert(m_pVideo);
 
-	if( IsAlive() )
-    {
-        m_Pos.X += m_Vel.X * Dt;
-        m_Pos.Y += m_Vel.Y * Dt;
+	unsigned nCount = GetCount();
+											// the outlines past the count
+                                            // are kept to reuse their memory
+	if( m_Outlines.size() < nCount ) m_Outlines.resize(nCount);
+
+	m_Dt = Dt;
+											// integration, then the outlines
+	TMethodJob<TAsteroidField> IntegrateJob(this, &TAsteroidField::Integrate);
+	m_pJobs->ParallelFor(nCount, ASTEROID_GRAIN, IntegrateJob);
+
+	TMethodJob<TAsteroidField> OutlinesJob(this, &TAsteroidField::BuildTheOutlines);
+	m_pJobs->ParallelFor(nCount, ASTEROID_GRAIN, OutlinesJob);
+											// drawing, in order; the count
+                                            // down of the dead ones
+	for(unsigned i=0; i<nCount; i++)
+	{
+		TLifetime& Lifetime = m_pRocks->Lifetimes[i];
 
-        TVecPoints Shape = this->m_Shape;
+		if( Lifetime.bAlive )
+		{
+			m_pVideo->DrawLines(m_Outlines[i], 0, m_pRocks->Renderables[i].Color, true);
+		}
+		else if( Lifetime.nTicks > 0 && --Lifetime.nTicks == 0 )
+		{
+			m_nExploding--;
+			m_bCompact = true;
+		}
+	}
+											// no index is held between the
+                                            // steps: the dead ones can go
+	if( m_bCompact ) Compact();
+											// explosions, the ended ones
+                                            // are removed
+	for(unsigned i=0; i<m_Explosions.size(); )
+	{
+		DoExplosion(m_Explosions[i]);
 
-        m_Rot += m_DRot;
+		if( m_Explosions[i].nTicks <= 0 )
+		{
+			m_Explosions[i] = m_Explosions.back();
+			m_Explosions.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
 
-        Rotate(Shape, m_Rot);
-        Translate(Shape, m_Pos);
+/*!****************************************************************************
+* @brief	Forces the asteroids inside of the scenery limits
+* @param	Width Width of the scenery
+* @param	Height Height of the scenery
+******************************************************************************/
+void TAsteroidField::Wrap(double Width, double Height)
+{
+	m_Width = Width;
+	m_Height = Height;
 
-        m_pVideo->DrawLines(Shape, 0, m_Color, true);
+	TMethodJob<TAsteroidField> Job(this, &TAsteroidField::WrapAround);
+	m_pJobs->ParallelFor(GetCount(), ASTEROID_GRAIN, Job);
+}
+
+/*!****************************************************************************
+* @brief	Moves the asteroids of a range
+* @param	nBegin First asteroid
+* @param	nEnd One past the last asteroid
+******************************************************************************/
+void TAsteroidField::Integrate(unsigned nBegin, unsigned nEnd)
+{
+	IntegrateTheMotion(*m_pRocks, m_Dt, nBegin, nEnd);
+}
+
+/*!****************************************************************************
+* @brief	Wraps the asteroids of a range around the edges of the area
+* @param	nBegin First asteroid
+* @param	nEnd One past the last asteroid
+******************************************************************************/
+void TAsteroidField::WrapAround(unsigned nBegin, unsigned nEnd)
+{
+	double Width = m_Width, Height = m_Height;
+
+	for(unsigned i=nBegin; i<nEnd; i++)
+	{
+		if( IsAlive(i) )
+		{
+			TTransform& Transform = m_pRocks->Transforms[i];
+			TVector2 Pos = GetPos(i);
+
+			if( Transform.X < 0 ) Transform.X = Width;
+			if( Transform.X > Width ) Transform.X = 0;
+			if( Transform.Y < 0 ) Transform.Y = Height;
+			if( Transform.Y > Height ) Transform.Y = 0;
+											// the outline follows, for the
+                                            // collisions
+			if( Transform.X != Pos.X || Transform.Y != Pos.Y ) MoveTheOutline(i, Pos);
+		}
 	}
-    else if( IsExploding() )
-    {
-		DoExplosion();
-    }
 }
 
+/*!****************************************************************************
+* @brief	Transforms the outlines of the asteroids of a range
+* @param	nBegin First asteroid
+* @param	nEnd One past the last asteroid
+******************************************************************************/
+void TAsteroidField::BuildTheOutlines(unsigned nBegin, unsigned nEnd)
+{
+	for(unsigned i=nBegin; i<nEnd; i++)
+	{
+		if( IsAlive(i) )
+		{
+			m_pShapes->Transform(m_pRocks->Renderables[i].nShape,
+				m_pRocks->Transforms[i].Rot, GetSize(i), GetPos(i), m_Outlines[i]);
+		}
+	}
+}
 
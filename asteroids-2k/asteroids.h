@@ -7,77 +7,130 @@
 #ifndef _ASTEROIDS_H_
 #define _ASTEROIDS_H_
 
-#include <windows.h>
 #include <map>
 #include <string>
 #include <vector>
 #include <stdio.h>
 
-#include "audio.h"
-#include "video.h"
+#include "commdefs.h"
+#include "devices.h"
 #include "vectors.h"
+#include "maths.h"
+#include "shapes.h"
+#include "jobs.h"
+#include "entities.h"
 
 #define ASTEROID_EXPLOSIONTICKS		64
 #define ASTEROID_NDEBRIS			16
+#define ASTEROID_MAXVERTS			16
+#define ASTEROID_NTEMPLATES			8			// shapes per class
+#define ASTEROID_TEMPLATESEED		2021		// same shapes in every game
+#define ASTEROID_GRAIN				256			// asteroids per chunk of a
+												// parallel loop
 
 
 enum enAsteroidClass { acBig, acMedium, acSmall };
 
-class TAsteroid;
-typedef std::vector<TAsteroid> TVecAsteroids;
-typedef std::vector<TAsteroid*> TVecPtrAsteroids;
+										// debris of an exploding asteroid
+struct TAsteroidExplosion
+{
+	TVector2 Origin, StartPos, Vel;
+	int nDebris, nTicks;
+	TVector2 Debris[ASTEROID_NDEBRIS];
+	double DebrisScales[ASTEROID_NDEBRIS];
+};
 
-class TAsteroid
+typedef std::vector<TAsteroidExplosion> TVecExplosions;
+
+										// all the asteroids of the scenery, the
+										// archetype ekAsteroid of the entity
+										// store: the index i (0 <= i <
+										// GetCount()) selects the i-th element
+										// of every component
+class TAsteroidField
 {
 	public:
-        TAsteroid( TVideoManager* pVM,
-        	TSoundManager* pSM,
-        	enAsteroidClass nClass, TVector2 Pos,
-            TVector2 Vel, double Radius );
-		~TAsteroid();
+		TAsteroidField(TVideoDevice* pVM, TSoundDevice* pSM, maths::TRandom* pRandom,
+			TShapeCache* pShapes, TJobSystem* pJobs, TEntityStore* pEntities);
+		~TAsteroidField();
 
 	public:
-        void Update(double DT);
-        enAsteroidClass GetClass();
+		TEntity Add(enAsteroidClass nClass, TVector2 Pos, TVector2 Vel, double Radius);
+		void Clear();
 
-        double GetSize();
-        TVector2 GetPos();
-        TVector2 GetVel();
+		unsigned GetCount() { return m_pRocks->GetCount(); }
+		unsigned GetExplosionsCount() { return m_Explosions.size(); }
+											// kept up to date by Add(),
+                                            // Explode() and the compaction
+		unsigned GetAliveCount() { return m_nAlive; }
+		unsigned GetExplodingCount() { return m_nExploding; }
 
-        void Explode();
-        void DoExplosion();
-        bool IsExploding();
+		void Update(double Dt);
+		void Wrap(double Width, double Height);
 
-        bool Collide(TVector2 Pt);
-        void SetPos(TVector2 Pos);
+		void Explode(unsigned nIndex);
+		bool Collide(unsigned nIndex, TVector2 Pt);
+		bool Collide(unsigned nIndex, TVector2 From, TVector2 To, double Dt);
+		bool HasOutline(unsigned nIndex);
+		TVecPoints& GetOutline(unsigned nIndex);
 
-        bool IsAlive();
-        void SetAlive(bool bAlive);
-	    void SetVisible(bool bVisible);
+	public:
+		TVector2 GetPos(unsigned nIndex)
+			{ return TVector2(m_pRocks->Transforms[nIndex].X, m_pRocks->Transforms[nIndex].Y); }
+		TVector2 GetVel(unsigned nIndex)
+			{ return TVector2(m_pRocks->Motions[nIndex].VX, m_pRocks->Motions[nIndex].VY); }
+		double GetSize(unsigned nIndex) { return m_pRocks->Colliders[nIndex].Radius; }
+		enAsteroidClass GetClass(unsigned nIndex)
+			{ return enAsteroidClass(m_pRocks->Renderables[nIndex].nClass); }
+		bool IsAlive(unsigned nIndex) { return m_pRocks->Lifetimes[nIndex].bAlive != 0; }
+		unsigned GetTemplate(unsigned nIndex) { return m_pRocks->Renderables[nIndex].nVariant; }
+
+		void SetPos(unsigned nIndex, TVector2 Pos);
+
+		unsigned GetMemory();
 
 	protected:
-        bool m_bAlive, m_bVisible;
-        COLORREF m_Color;
-        double m_Radius, m_Rot, m_DRot;
-        TVecPoints m_Shape;
-        TVector2 m_Pos, m_Vel, m_Acc;
-		TSoundManager* m_pAudio;
-        TVideoManager* m_pVideo;
-        enAsteroidClass m_nClass;
+		TSoundDevice* m_pAudio;
+		TVideoDevice* m_pVideo;
+		maths::TRandom* m_pRandom;
+		TShapeCache* m_pShapes;
+		TJobSystem* m_pJobs;
+		TEntityStore* m_pEntities;
+		TArchetype* m_pRocks;				// the components of the asteroids
+		COLORREF m_Color;
+
+		TVecExplosions m_Explosions;
+											// the alive asteroids, the dead
+                                            // ones still exploding, and if
+                                            // some dead ones can be removed
+		unsigned m_nAlive, m_nExploding;
+		bool m_bCompact;
+											// outlines of unit radius, shared
+                                            // by all the asteroids: their ids
+                                            // in the cache, by class
+		int m_Templates[acSmall + 1][ASTEROID_NTEMPLATES];
+											// the outlines being drawn, one
+                                            // per asteroid, the ones past
+                                            // GetCount() are spare
+		std::vector<TVecPoints> m_Outlines;
+		TVecPoints m_Outline;
+											// arguments of the parallel loops
+		double m_Dt, m_Width, m_Height;
 
 	protected:
-        void Crash();
-        double GetRoughness();
-		TVecPoints RandShape(double Size);
-
-    protected:
-										// debris
-		TVector2 m_DebrisStartPos;
-        int m_nDebris, m_nExplosionTicks;
-        TVector2 m_Debris[ASTEROID_NDEBRIS];
-        double m_DebrisScales[ASTEROID_NDEBRIS];
+		void DoExplosion(TAsteroidExplosion& Explosion);
+		void Compact();
+											// the bodies of the parallel
+                                            // loops, on [nBegin, nEnd)
+		void Integrate(unsigned nBegin, unsigned nEnd);
+		void WrapAround(unsigned nBegin, unsigned nEnd);
+		void BuildTheOutlines(unsigned nBegin, unsigned nEnd);
+		void MoveTheOutline(unsigned nIndex, TVector2 OldPos);
+
+		double GetRoughness(enAsteroidClass nClass);
+		void BuildTheTemplates();
+		void RandShape(enAsteroidClass nClass, maths::TRandom& Random, TVecPoints& Pts);
 };
 
 #endif
 
-
@@ -5,6 +5,15 @@
 
 	@brief	Audio manager
 
+	@par	A sound is a buffer, played on the voices of a pool of sources
+			(see voices.cpp): a sound played again while playing is heard
+			twice, instead of starting again.
+
+	@par	The sources are those of OpenAL or, with the software mixer, the
+			voices of TSoftMixer (see mixer.cpp): the mixer renders blocks
+			of frames on a streaming source of OpenAL, refilled by Update()
+			at each frame of the game.
+
 	@noop	author:	Francesco Settembrini
 	@noop	last update: 23/6/2021
 	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
@@ -13,15 +22,17 @@
 
 #include <windows.h>
 #include <assert.h>
+#include <math.h>
 
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 
 #include <al/al.h>
 #include <al/alc.h>
 
 #include "audio.h"
+#include "wav.h"
+#include "mapfile.h"
 #include "utils.h"
 
 
@@ -29,10 +40,151 @@
 #define DELTAVOLUME	0.05
 
 
+/*!****************************************************************************
+* @brief	Creates an OpenAL source
+* @return	The id of the source
+******************************************************************************/
+unsigned TALBackend::CreateTheSource()
+{
+	ALuint nSourceId = 0;
+	alGenSources(1, &nSourceId);
+
+	return nSourceId;
+}
+
+/*!****************************************************************************
+* @brief	Deletes an OpenAL source
+* @param	nSource The id of the source
+******************************************************************************/
+void TALBackend::DeleteTheSource(unsigned nSource)
+{
+	ALuint nSourceId = nSource;
+	alDeleteSources(1, &nSourceId);
+}
+
+/*!****************************************************************************
+* @brief	Plays a buffer on a source, from its start
+* @param	nSource The id of the source
+* @param	nBuffer The id of the buffer
+* @param	bLoop True for playing the buffer repeatedly
+* @param	Gain The gain, between 0..1
+* @param	Pan The position, -1 left .. 1 right
+* @note		OpenAL positions the mono buffers only: a stereo buffer is
+*			heard at the center
+******************************************************************************/
+void TALBackend::Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+	double Gain, double Pan)
+{
+	Pan = std::min(std::max(Pan, -1.0), 1.0);
+											// the buffer of a source can
+                                            // be changed once it is stopped
+	alSourceStop(nSource);
+	alSourcei(nSource, AL_BUFFER, nBuffer);
+	alSourcei(nSource, AL_LOOPING, bLoop);
+	alSourcef(nSource, AL_GAIN, Gain);
+											// on a circle around the listener
+	alSourcei(nSource, AL_SOURCE_RELATIVE, AL_TRUE);
+	alSource3f(nSource, AL_POSITION, Pan, 0, -sqrt(1.0 - Pan * Pan));
+	alSourcePlay(nSource);
+}
+
+/*!****************************************************************************
+* @brief	Stops a source, and releases its buffer
+* @param	nSource The id of the source
+******************************************************************************/
+void TALBackend::Stop(unsigned nSource)
+{
+	alSourceStop(nSource);
+	alSourcei(nSource, AL_BUFFER, 0);
+}
+
+/*!****************************************************************************
+* @brief	Checks if a source is playing
+* @param	nSource The id of the source
+* @return	True if playing, false if stopped or ended
+******************************************************************************/
+bool TALBackend::IsPlaying(unsigned nSource)
+{
+	ALint nState = AL_STOPPED;
+	alGetSourcei(nSource, AL_SOURCE_STATE, &nState);
+
+	return nState == AL_PLAYING;
+}
+
+/*!****************************************************************************
+* @brief	Constructor: queues the first blocks of the mixer, and plays them
+* @param	pMixer Pointer to the software mixer
+******************************************************************************/
+TALStream::TALStream(TSoftMixer* pMixer)
+{
+	assert(pMixer);
+
+	m_pMixer = pMixer;
+	m_Frames.resize(2 * MIXER_BLOCK);
+
+	alGenSources(1, &m_nSource);
+	alGenBuffers(STREAM_BUFFERS, m_nBuffers);
+
+	for(int i=0; i<STREAM_BUFFERS; i++) Fill(m_nBuffers[i]);
+
+	alSourceQueueBuffers(m_nSource, STREAM_BUFFERS, m_nBuffers);
+	alSourcePlay(m_nSource);
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TALStream::~TALStream()
+{
+	alSourceStop(m_nSource);
+	alSourcei(m_nSource, AL_BUFFER, 0);
+
+	alDeleteSources(1, &m_nSource);
+	alDeleteBuffers(STREAM_BUFFERS, m_nBuffers);
+}
+
+/*!****************************************************************************
+* @brief	Refills the blocks played, and queues them again
+******************************************************************************/
+void TALStream::Update()
+{
+	ALint nProcessed = 0;
+	alGetSourcei(m_nSource, AL_BUFFERS_PROCESSED, &nProcessed);
+
+	while( nProcessed-- > 0 )
+	{
+		ALuint nBuffer = 0;
+
+		alSourceUnqueueBuffers(m_nSource, 1, &nBuffer);
+		Fill(nBuffer);
+		alSourceQueueBuffers(m_nSource, 1, &nBuffer);
+	}
+											// all the blocks played before the
+                                            // update (a hitch): start again
+	ALint nState = AL_STOPPED;
+	alGetSourcei(m_nSource, AL_SOURCE_STATE, &nState);
+
+	if( nState != AL_PLAYING ) alSourcePlay(m_nSource);
+}
+
+/*!****************************************************************************
+* @brief	Renders the next block of the mixer on a buffer
+* @param	nBuffer The id of the buffer
+******************************************************************************/
+void TALStream::Fill(ALuint nBuffer)
+{
+	m_pMixer->Render(&m_Frames[0], MIXER_BLOCK);
+
+	alBufferData(nBuffer, AL_FORMAT_STEREO16, &m_Frames[0],
+		m_Frames.size() * sizeof(short), m_pMixer->GetSampleRate());
+}
+
 /*!****************************************************************************
 * @brief	Constructor
+* @param	bSoftMixer True for mixing the sounds with the software mixer,
+*			false for the sources of OpenAL
 ******************************************************************************/
-TSoundManager::TSoundManager()
+TSoundManager::TSoundManager(bool bSoftMixer)
 {
 	TALSystem *pALSystem = new TALSystem();
 	assert(pALSystem);
@@ -54,6 +206,27 @@ TSoundManager::TSoundManager()
 	{
 		throw;
 	}
+	m_pMixer = NULL;
+	m_pStream = NULL;
+											// all the sources, once
+	if( bSoftMixer )
+	{
+		m_pMixer = new TSoftMixer(MIXER_RATE);
+		assert(m_pMixer);
+
+		m_pStream = new TALStream(m_pMixer);
+		assert(m_pStream);
+
+		m_pBackend = m_pMixer;
+	}
+	else
+	{
+		m_pBackend = new TALBackend();
+		assert(m_pBackend);
+	}
+
+	m_pVoices = new TVoicePool(m_pBackend, bSoftMixer ? MIXER_VOICES : VOICES_COUNT);
+	assert(m_pVoices);
 }
 
 /*!****************************************************************************
@@ -63,6 +236,10 @@ TSoundManager::~TSoundManager()
 {
 	assert(m_pALSystem);
 	assert(m_pALSystem->pAlcContext);
+											// the sources, before the context
+	delete m_pVoices;
+	delete m_pStream;
+	delete m_pBackend;
 
 	alcDestroyContext(m_pALSystem->pAlcContext);
 	alcCloseDevice(m_pALSystem->pAlcDevice);
@@ -76,8 +253,10 @@ void TSoundManager::SetMasterVolume(double Volume)
 {
 	if( Volume > 1.0 ) Volume = 1.0;
 	if( Volume < 0 ) Volume = 0;
-
-	alListenerf(AL_GAIN, Volume);
+											// the mixer scales the bus, the
+                                            // stream plays at full gain
+	if( m_pMixer ) m_pMixer->SetMasterVolume(Volume);
+	else alListenerf(AL_GAIN, Volume);
 }
 
 /*!****************************************************************************
@@ -86,6 +265,8 @@ void TSoundManager::SetMasterVolume(double Volume)
 ******************************************************************************/
 double TSoundManager::GetMasterVolume()
 {
+	if( m_pMixer ) return m_pMixer->GetMasterVolume();
+
 	ALfloat Volume = 0;
 
 	alGetListenerf(AL_GAIN, &Volume);
@@ -128,27 +309,47 @@ void TSoundManager::DecreaseMasterVolume()
 ******************************************************************************/
 bool TSoundManager::LoadTheSound(std::string strFileName)
 {
-	bool bResult = false;
+	TMappedFile File;
+											// the samples are read in place,
+                                            // in the mapping of the file
+	if( !File.Open(strFileName.c_str()) ) return false;
+
+	return LoadTheSound(utils::GetFileName(strFileName, true),
+		File.GetData(), File.GetSize());
+}
+
+/*!****************************************************************************
+* @brief	Load a sound from the bytes of a WAV file
+* @param	strName The name of the sound
+* @param	pBytes Pointer to the bytes of the file, in a mapping or in memory
+* @param	nSize The size of the file
+* @return	Returns true for success, false otherwise
+******************************************************************************/
+bool TSoundManager::LoadTheSound(std::string strName, const char* pBytes, unsigned nSize)
+{
+	TWavInfo Info;
 
-	int nChannels=0, nSampleRate=0, nBps=0, nSize = 0;
-	char *pData = LoadWAV(strFileName.c_str(), nChannels, nSampleRate, nBps, nSize);
+	if( !ParseTheWav(pBytes, nSize, Info) ) return false;
 
-/*
-printf("\n\nFile Name: %s", strFileName.c_str());
-printf("\nchannels: %d", nChannels);
-printf("\nSampleRate: %d", nSampleRate);
-printf("\nBps: %d", nBps);
-printf("\nSamples per channel: %d", nSize);
-*/
+	unsigned nBufferId = 0;
 
-	if( pData )
+	if( m_pMixer )
 	{
-		ALuint nBufferId, nFormat;
-		alGenBuffers(1, &nBufferId);
+											// converted by the mixer, in its
+                                            // own buffers
+		nBufferId = m_pMixer->AddTheBuffer(Info.pData, Info.nChannels,
+			Info.nSampleRate, Info.nBps, Info.nSize);
+	}
+	else
+	{
+		ALuint nAlBufferId;
+		ALenum nFormat;
+
+		alGenBuffers(1, &nAlBufferId);
 
-		if( nChannels == 1 )
+		if( Info.nChannels == 1 )
 		{
-			if( nBps == 8 )
+			if( Info.nBps == 8 )
 			{
 				nFormat = AL_FORMAT_MONO8;
 			}
@@ -159,7 +360,7 @@ printf("\nSamples per channel: %d", nSize);
 		}
 		else
 		{
-			if( nBps == 8 )
+			if( Info.nBps == 8 )
 			{
 				nFormat = AL_FORMAT_STEREO8;
 			}
@@ -168,32 +369,31 @@ printf("\nSamples per channel: %d", nSize);
 				nFormat = AL_FORMAT_STEREO16;
 			}
 		}
+											// copied by OpenAL, the mapping
+                                            // can go
+		alBufferData(nAlBufferId, nFormat, Info.pData, Info.nSize, Info.nSampleRate);
 
-		alBufferData(nBufferId, nFormat, pData, nSize, nSampleRate);
-
-		ALuint nSourceId;
-		alGenSources(1, &nSourceId);
-
-		alSourcei(nSourceId, AL_BUFFER, nBufferId);
-
-		std::string strName = utils::GetFileName(strFileName, true);
-
-        TSoundTrack SoundTrack(strName, nBufferId, nSourceId);
+		nBufferId = nAlBufferId;
+	}
 
-		m_SoundTracks.insert(make_pair(strName, SoundTrack));
+											// no limits, until set by the
+                                            // game
+	TSoundTrack SoundTrack(strName, nBufferId, m_pVoices->AddTheSound(nBufferId));
 
-		bResult = true;
-	}
+	m_SoundTracks.insert(make_pair(strName, SoundTrack));
 
-	return bResult;
+	return true;
 }
 
 /*!****************************************************************************
 * @brief	Load sounds from a list of specified files
 * @param	strSounds A list of sound filenames to be open
+* @param	pPack Pointer to the asset pack, or NULL
 * @return	Returns true for success, false otherwise
+* @note		A sound is read from the pack if there, from its file in the data
+*			folder otherwise
 ******************************************************************************/
-bool TSoundManager::LoadTheSounds(std::vector<std::string> strSounds)
+bool TSoundManager::LoadTheSounds(std::vector<std::string> strSounds, TAssetPack* pPack)
 {
 	assert(strSounds.size());
 
@@ -203,13 +403,21 @@ bool TSoundManager::LoadTheSounds(std::vector<std::string> strSounds)
 
 	for(int i=0; i<strSounds.size(); ++i)
 	{
-		std::string strWavFile = strDataPath + strSounds[i] + ".wav";
+		std::string strWavFile = strSounds[i] + ".wav";
+
+		const char* pData;
+		unsigned nSize;
 
-		if( !LoadTheSound(strWavFile) )
+		if( pPack && pPack->IsOpen() && pPack->Read(strWavFile.c_str(), pData, nSize) )
+		{
+			bResult = LoadTheSound(strSounds[i], pData, nSize);
+		}
+		else
 		{
-			bResult = false;
-			break;
+			bResult = LoadTheSound(strDataPath + strWavFile);
 		}
+
+		if( !bResult ) break;
 	}
 
 	return bResult;
@@ -220,10 +428,79 @@ bool TSoundManager::LoadTheSounds(std::vector<std::string> strSounds)
 ******************************************************************************/
 void TSoundManager::FreeTheSounds()
 {
-	for( TMapSoundTracks::iterator Iter = m_SoundTracks.begin(); Iter != m_SoundTracks.end(); ++Iter)
+											// the voices release the buffers
+	m_pVoices->Clear();
+
+	if( m_pMixer )
 	{
-		alDeleteSources(1, &Iter->second.nSourceId);
+		m_pMixer->FreeTheBuffers();
 	}
+	else
+	{
+		for( TMapSoundTracks::iterator Iter = m_SoundTracks.begin(); Iter != m_SoundTracks.end(); ++Iter)
+		{
+			alDeleteBuffers(1, &Iter->second.nBufferId);
+		}
+	}
+
+	m_SoundTracks.clear();
+}
+
+/*!****************************************************************************
+* @brief	Finds a sound by name
+* @param	strSound The name of the sound, its file name without extension
+* @return	The id of the sound, SOUND_NONE if not loaded
+* @note		To be called once, the id is then used to play the sound
+******************************************************************************/
+TSoundId TSoundManager::FindTheSound(std::string strSound)
+{
+	TMapSoundTracks::iterator it = m_SoundTracks.find(strSound);
+
+	if( it == m_SoundTracks.end() ) return SOUND_NONE;
+
+	return it->second.nSoundId;
+}
+
+/*!****************************************************************************
+* @brief	Sets how a sound shares the voices
+* @param	nSound The id of the sound
+* @param	nPriority The priority of the sound, the higher the less stolen
+* @param	nMaxVoices The voices of the sound at once, VOICES_NOLIMIT for
+*			any number
+******************************************************************************/
+void TSoundManager::SetTheLimits(TSoundId nSound, int nPriority, unsigned nMaxVoices)
+{
+	m_pVoices->SetTheLimits(nSound, nPriority, nMaxVoices);
+}
+
+/*!****************************************************************************
+* @brief	Sets the gain of a sound
+* @param	nSound The id of the sound
+* @param	Gain The gain, between 0..1
+******************************************************************************/
+void TSoundManager::SetTheGain(TSoundId nSound, double Gain)
+{
+	m_pVoices->SetTheGain(nSound, Gain);
+}
+
+/*!****************************************************************************
+* @brief	Plays a sound on a voice of the pool
+* @param	nSound The id of the sound
+* @param	bLoop Flag for looping: true for playing the sound repeatedly
+* @param	Pan The position of the sound, -1 left .. 1 right
+******************************************************************************/
+void TSoundManager::PlayTheSound(TSoundId nSound, bool bLoop, double Pan)
+{
+	m_pVoices->Play(nSound, bLoop, Pan);
+}
+
+/*!****************************************************************************
+* @brief	Stops all the voices playing a sound
+* @param	nSound The id of the sound
+******************************************************************************/
+void TSoundManager::StopTheSound(TSoundId nSound)
+{
+	m_pVoices->Stop(nSound);
 }
 
 /*!****************************************************************************
@@ -233,18 +510,7 @@ void TSoundManager::FreeTheSounds()
 ******************************************************************************/
 void TSoundManager::PlayTheSound(std::string strSound, bool bLoop)
 {
-	if( m_SoundTracks.size() )
-	{
-        TMapSoundTracks::iterator it = m_SoundTracks.find(strSound);
-
-		if( it != m_SoundTracks.end() )
-		{
-			TSoundTrack ST = it->second;
-
-			alSourcei(ST.nSourceId, AL_LOOPING, bLoop);
-			alSourcePlay(ST.nSourceId);
-		}
-	}
+	PlayTheSound(FindTheSound(strSound), bLoop);
 }
 
 /*!****************************************************************************
@@ -253,15 +519,7 @@ void TSoundManager::PlayTheSound(std::string strSound, bool bLoop)
 ******************************************************************************/
 void TSoundManager::StopTheSound(std::string strSound)
 {
-	if( m_SoundTracks.size() )
-	{
-        TMapSoundTracks::iterator it = m_SoundTracks.find(strSound);
-
-        if( it != m_SoundTracks.end() )
-		{
-			alSourceStop(it->second.nSourceId);
-		}
-	}
+	StopTheSound(FindTheSound(strSound));
 }
 
 /*!****************************************************************************
@@ -269,63 +527,14 @@ void TSoundManager::StopTheSound(std::string strSound)
 ******************************************************************************/
 void TSoundManager::StopAllSounds()
 {
-    for( TMapSoundTracks::iterator it = m_SoundTracks.begin(); it != m_SoundTracks.end(); ++it)
-	{
-		alSourceStop(it->second.nSourceId);
-	}
+	m_pVoices->StopAll();
 }
 
 /*!****************************************************************************
-* @brief	Load raw data from an audio file in WAV PCM format
-* @param	strFileName The path to the file name to be open
-* @param[in,out] nChannels The number of channels: 1 for mono, 2 for stereo
-* @param[in,out] nSampleRate The Sample rate for audio data
-* @param[in,out] nBps The bits per sample
-* @param[in,out] nSize The size of raw audio buffer
-* @return	The pointer to the raw audio buffer data
+* @brief	Refills the stream of the software mixer, once per frame
 ******************************************************************************/
-char* TSoundManager::LoadWAV(std::string strFileName,
-	int& nChannels, int& nSampleRate, int& nBps, int& nSize)
+void TSoundManager::Update()
 {
-    char buffer[4];
-
-    std::ifstream in(strFileName.c_str(), std::ios::binary);
-
-    in.read(buffer, 4);
-
-    if (strncmp(buffer, "RIFF", 4) != 0)
-    {
-        std::cout << "this is not a valid WAV file" << std::endl;
-        return NULL;
-    }
-
-    in.read(buffer, 4);
-    in.read(buffer, 4);      // WAVE
-    in.read(buffer, 4);      // fmt
-    in.read(buffer, 4);      // 16
-    in.read(buffer, 2);      // 1
-
-    in.read(buffer, 2);
-    nChannels = utils::ConvertToInt(buffer, 2);
-
-    in.read(buffer, 4);
-    nSampleRate = utils::ConvertToInt(buffer, 4);
-
-    in.read(buffer, 4);
-    in.read(buffer, 2);
-
-    in.read(buffer, 2);
-    nBps = utils::ConvertToInt(buffer, 2);
-
-    in.read(buffer, 4);      // data
-    in.read(buffer, 4);
-    nSize = utils::ConvertToInt(buffer, 4);
-
-    char* pData = new char[nSize];
-	assert(pData);
-    in.read(pData, nSize);
-
-    return pData;
+	if( m_pStream ) m_pStream->Update();
 }
 
-
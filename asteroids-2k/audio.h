@@ -14,6 +14,11 @@
 #include <vector>
 #include <map>
 
+#include "devices.h"
+#include "voices.h"
+#include "mixer.h"
+#include "pack.h"
+
 
 struct TALSystem
 {
@@ -21,6 +26,42 @@ struct TALSystem
 	ALCdevice *pAlcDevice;
 };
 
+										// the sources of OpenAL, for the pool
+class TALBackend : public TAudioBackend
+{
+	public:
+		unsigned CreateTheSource();
+		void DeleteTheSource(unsigned nSource);
+
+		void Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+			double Gain, double Pan);
+		void Stop(unsigned nSource);
+		bool IsPlaying(unsigned nSource);
+};
+
+#define STREAM_BUFFERS		4			// of MIXER_BLOCK frames, queued
+
+										// the output of the software mixer,
+                                        // on a streaming source of OpenAL
+class TALStream
+{
+	public:
+		TALStream(TSoftMixer* pMixer);
+		~TALStream();
+
+	public:
+		void Update();
+
+	protected:
+		TSoftMixer* m_pMixer;
+		ALuint m_nSource;
+		ALuint m_nBuffers[STREAM_BUFFERS];
+		std::vector<short> m_Frames;
+
+	protected:
+		void Fill(ALuint nBuffer);
+};
+
 class TSoundTrack
 {
     public:
@@ -28,28 +69,32 @@ class TSoundTrack
         {
             this->strName = Other.strName;
             this->nBufferId = Other.nBufferId;
-            this->nSourceId = Other.nSourceId;
+            this->nSoundId = Other.nSoundId;
         }
 
-        TSoundTrack(std::string strName, ALuint nBufferId, ALuint nSourceId)
+        TSoundTrack(std::string strName, ALuint nBufferId, TSoundId nSoundId)
         {
             this->strName = strName;
             this->nBufferId = nBufferId;
-            this->nSourceId = nSourceId;
+            this->nSoundId = nSoundId;
         }
 
     public:
         std::string strName;
-        ALuint nBufferId, nSourceId;
+        ALuint nBufferId;
+        TSoundId nSoundId;					// in the voice pool
 };
 
 typedef std::vector<TSoundTrack> TSoundTracks;
 typedef std::map< std::string, TSoundTrack > TMapSoundTracks;
 
-class TSoundManager
+										// the sounds of the game, played on
+                                        // a pool of OpenAL sources, or of the
+                                        // voices of the software mixer
+class TSoundManager : public TSoundDevice
 {
 	public:
-        TSoundManager();
+        TSoundManager(bool bSoftMixer = false);
         ~TSoundManager();
 
         double GetMasterVolume();
@@ -58,20 +103,33 @@ class TSoundManager
         void IncreaseMasterVolume();
         void DecreaseMasterVolume();
 
-        bool LoadTheSounds(std::vector<std::string> strSounds);
+        bool LoadTheSounds(std::vector<std::string> strSounds, TAssetPack* pPack = NULL);
         void FreeTheSounds();
         bool LoadTheSound(std::string strFileName);
+        bool LoadTheSound(std::string strName, const char* pBytes, unsigned nSize);
+
+        TSoundId FindTheSound(std::string strSound);
+        void SetTheLimits(TSoundId nSound, int nPriority, unsigned nMaxVoices);
+        void SetTheGain(TSoundId nSound, double Gain);
+
+        void PlayTheSound(TSoundId nSound, bool bLoop = false, double Pan = 0);
+        void StopTheSound(TSoundId nSound);
         void PlayTheSound(std::string strSound, bool bLoop = false);
         void StopTheSound(std::string strSound);
         void StopAllSounds();
 
+        void Update();
+
+        TVoicePool* GetVoices() { return m_pVoices; }
+        TSoftMixer* GetMixer() { return m_pMixer; }
+
     protected:
         TALSystem *m_pALSystem;
+        TAudioBackend *m_pBackend;
+        TSoftMixer *m_pMixer;				// NULL on the OpenAL sources
+        TALStream *m_pStream;
+        TVoicePool *m_pVoices;
         TMapSoundTracks m_SoundTracks;
-
-        char* LoadWAV(std::string strFileName, int& nChannels, int& nSampleRate, int& nBps, int& nSize);
 };
 
 #endif
-
-
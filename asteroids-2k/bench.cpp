@@ -0,0 +1,3295 @@
+/*!****************************************************************************
+
+	@file	bench.cpp
+
+	@brief	Headless benchmark of the game simulation
+
+	@par	Runs a scripted session for a given number of ticks, without
+			window, video and audio, then reports the ticks per second
+			and the time spent in each phase of the simulation step.
+
+	@par	Build (Linux):
+			g++ -O2 -o bench bench.cpp sim.cpp ships.cpp asteroids.cpp
+			weapons.cpp maths.cpp vectors.cpp timer.cpp spatial.cpp render.cpp
+			pens.cpp raster.cpp loop.cpp replay.cpp profiler.cpp shapes.cpp
+			jobs.cpp entities.cpp voices.cpp sounds.cpp mixer.cpp wav.cpp
+			mapfile.cpp lz4.cpp pack.cpp -lpthread
+
+	@par	Usage:
+			bench [ticks] [level] [seed]
+			bench collide [reps] [seed]
+			bench soak [missiles] [seed]
+			bench raster [frames] [level] [file.ppm]
+			bench loop [seconds] [render ms] [hitch ms]
+			bench replay [ticks] [seed] [file]
+			bench profile [frames] [file.json]
+			bench alloc [ticks] [level]
+			bench transform
+			bench shapes [budget KB]
+			bench footprint [asteroids]
+			bench jobs [max threads]
+			bench swept [shots]
+			bench outline [probes]
+			bench entities [reuses]
+			bench voices [ticks]
+			bench sounds [triggers]
+			bench mixer [seconds] [file.wav]
+			bench wav [file.wav ...]
+			bench pack [data folder]
+
+	@par	The "collide" mode measures the cost of the asteroids collision
+			queries, brute force vs. broadphase grid, for 10 to 100k
+			asteroids on the game area.
+
+	@par	The "soak" mode fires a million missiles (by default) at a level
+			that never ends, and checks that the cost of a tick does not
+			grow with the number of missiles fired so far.
+
+	@par	The "raster" mode draws the game with the software rasterizer,
+			reports the time per frame and the checksum of the last frame,
+			and optionally saves the last frame as a PPM image.
+
+	@par	The "loop" mode drives the game loop with a virtual clock: each
+			frame costs a fixed render time, plus a long hitch every
+			LOOPHITCHEVERY frames, and the game must keep running at FPS
+			steps per second of (virtual) real time.
+
+	@par	The "replay" mode records a scripted game, saves it, then plays
+			it back on a new simulation checking the hash of the world at
+			each tick, and on a simulation with another seed, that must
+			diverge.
+
+	@par	The "profile" mode runs the same frames, drawn with the software
+			rasterizer, with the profiler off and on, reports the overhead,
+			the rolling p50/p99 of each phase, and writes the trace events
+			in the Chrome trace event format.
+
+	@par	The "alloc" mode counts the heap allocations (operator new is
+			replaced) of each tick and of each flush of the render buffer on
+			the software rasterizer, in a game played twice from the same
+			seed: the second time nothing must be allocated.
+
+	@par	The "transform" mode compares, for 16, 1k and 1M points, the
+			Rotate() and Translate() loops with the batched Transform()
+			kernels, AoS and SoA, double and float, and reports the
+			difference of the results from the loops.
+
+	@par	The "shapes" mode draws SHAPESCOUNT asteroid outlines rotated by
+			the shape cache, for some angular resolutions, with the given
+			memory budget and with no budget (sin/cos table), vs. the exact
+			Transform(); it reports the time per outline, the memory of the
+			cache, the error bound and the largest error measured.
+
+	@par	The "footprint" mode fills an asteroid field (10k asteroids by
+			default) and compares its memory with the previous layout, an
+			outline of ASTEROID_MAXVERTS vertices on the heap per asteroid,
+			then times the drawing of the field.
+
+	@par	The "jobs" mode times the update and the wrap of fields of 1k to
+			1M asteroids run by 1 to 32 threads (by default), and checks
+			that the outlines drawn and the positions do not depend on the
+			number of threads; then it plays the same game with one thread
+			and with the most threads, that must have the same hash.
+
+	@par	The "swept" mode fires missiles (10k by default) at the speeds of
+			the game, from the missile speed to that plus the top speed of
+			the ship, across small moving asteroids, at some time steps: it
+			counts the hits caught by the point tests at the end of each
+			step and by the swept tests of the segments run in the steps,
+			vs. the swept tests on much shorter steps, then reports the cost
+			of the two tests.
+
+	@par	The "outline" mode throws random points (1M by default) inside
+			the bounding circles of asteroids and ships, and reports the
+			share of them outside the outlines, the false positives of the
+			circle alone; then the cost of a query with the circle alone,
+			and with the outline after the circle, for points inside the
+			circles and all over the game area, and the cost of the test
+			of a ship outline vs. an asteroid outline.
+
+	@par	The "entities" mode removes and creates a missile 100k times (by
+			default), reusing one slot of the entity store, and checks that
+			the handle of the live one is always found, the previous one
+			never, and an asteroid created first still is.
+
+	@par	The "voices" mode plays the sounds of games at a high level on
+			voice pools of 4 to 32 voices, over the stub audio backend, and
+			counts the restarts, the steals and the drops, vs. the sounds
+			cut off by one source per sound; then a burst of explosions,
+			and the cost of a play.
+
+	@par	The "sounds" mode times the triggers of the sounds (10M by
+			default) on a device that only counts them: by name, with the
+			copy of the track of the previous sound manager, by name, and
+			by id; and counts the heap allocations of each trigger.
+
+	@par	The "mixer" mode checks the pan of the software mixer, times the
+			mix of MIXER_VOICES looping voices (10 seconds of audio by
+			default) and reports the share of a core it takes; then mixes
+			a minute of a game, optionally to a WAV file.
+
+	@par	The "wav" mode runs the WAV parser on a corpus of files, good and
+			bad, then on every truncation of them and on 100k copies with
+			random bytes changed, each in a heap block of its exact size;
+			then maps and parses the files given, counting the allocations.
+
+	@par	The "pack" mode checks the LZ4 codec on some kinds of data, and
+			times it, then decompresses every truncation of a block and
+			100k copies with random bytes changed; it builds a pack, reads
+			it back and rejects its truncations. Given the data folder of
+			the game, it times the loads of the data files at startup, one
+			by one and from a pack, cold (evicted from the cache of the
+			system) and warm, and counts the allocations.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <new>
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "sim.h"
+#include "timer.h"
+#include "pens.h"
+#include "render.h"
+#include "raster.h"
+#include "loop.h"
+#include "replay.h"
+#include "profiler.h"
+#include "shapes.h"
+#include "voices.h"
+#include "sounds.h"
+#include "mixer.h"
+#include "wav.h"
+#include "mapfile.h"
+#include "lz4.h"
+#include "pack.h"
+#include "devices.h"
+#include "commdefs.h"
+
+//-----------------------------------------------------------------------------
+
+#define DEFTICKS		10000
+#define DEFLEVEL		1
+#define DEFSEED			1
+
+#define DEFREPS			20
+#define NPROBES			64
+
+#define DEFMISSILES		1000000
+#define SOAKVOLLEY		4
+#define SOAKASTEROIDS	5
+#define SOAKWINDOWS		10
+#define SOAKMAXRATIO	2.0
+
+#define DEFFRAMES		1000
+
+#define DEFREPLAYTICKS	20000
+#define DEFREPLAYFILE	"bench.a2kr"
+
+#define DEFPROFILEFILE	"bench.json"
+
+#define DEFALLOCTICKS	10000
+
+#define XFORMPOINTS		(32 * 1024 * 1024)	// points transformed per size
+
+#define SHAPESCOUNT		256				// outlines of the "shapes" mode
+#define SHAPESVERTS		12
+#define SHAPESREPS		2000
+
+#define DEFFOOTPRINT	10000
+#define HEAPHEADER		(2 * sizeof(void*))	// bookkeeping of a heap block
+
+#define DEFMAXTHREADS	32
+#define JOBSUPDATES		(2 * 1024 * 1024)	// asteroids updated per size
+#define JOBSTICKS		2000
+#define JOBSLEVEL		20
+
+#define DEFSHOTS		10000
+#define SWEPTSPEED		100.0			// MISSILESPEED of the simulation
+#define SWEPTRADIUS		10.0			// a small asteroid
+#define SWEPTDIST		50.0			// from the start to the asteroid
+#define SWEPTTIME		2.0				// seconds, all the missiles past
+#define SWEPTREPS		200
+#define SWEPTSUBSTEPS	16				// of the reference
+
+#define DEFPROBES		1000000
+#define OUTLINEROCKS	1000
+#define OUTLINEPAIRS	100000
+
+#define DEFREUSES		100000
+
+#define DEFVOICETICKS	20000
+#define VOICESPLAYS		1000000
+
+#define DEFTRIGGERS		10000000
+
+#define DEFMIXSECONDS	10.0
+#define MIXERTICKS		3600			// of the game mixed, a minute
+
+#define WAVMUTATIONS	100000
+
+#define LZ4BYTES		(64 * 1024 * 1024)	// compressed per case
+#define LZ4MUTATIONS	100000
+#define LZ4FUZZBYTES	4096			// of text, compressed and broken
+#define DEFPACKFILE		"bench.a2kp"
+#define LZ4PACKFILE		"bench_lz4.a2kp"
+#define PACKCOLDLOADS	5
+#define PACKWARMLOADS	200
+
+#define DEFLOOPTIME		60.0
+#define DEFRENDERMS		4.0
+#define DEFHITCHMS		70.0
+#define LOOPHITCHEVERY	97
+
+										// the exception specifications are
+                                        // gone in C++17
+#if __cplusplus < 201103L
+	#define THROWS_BADALLOC		throw(std::bad_alloc)
+	#define THROWS_NOTHING		throw()
+#else
+	#define THROWS_BADALLOC
+	#define THROWS_NOTHING		noexcept
+#endif
+
+										// heap allocations so far, the
+                                        // workers of the jobs included
+static volatile long nHeapAllocs = 0;
+
+static void CountTheAlloc()
+{
+#ifdef _WIN32
+	InterlockedIncrement(&nHeapAllocs);
+#else
+	__sync_add_and_fetch(&nHeapAllocs, 1);
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Counting allocator, for the "alloc" mode
+******************************************************************************/
+#if defined(__GNUC__)
+__attribute__((noinline))		// see operator delete
+#endif
+void* operator new(size_t nSize) THROWS_BADALLOC
+{
+	CountTheAlloc();
+
+	void* pBlock = malloc(nSize ? nSize : 1);
+	if( !pBlock ) throw std::bad_alloc();
+
+	return pBlock;
+}
+
+/*!****************************************************************************
+* @brief	Counting allocator, the version that returns NULL on failure
+*			(std::stable_sort uses it for its buffer)
+******************************************************************************/
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void* operator new(size_t nSize, const std::nothrow_t&) THROWS_NOTHING
+{
+	CountTheAlloc();
+
+	return malloc(nSize ? nSize : 1);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))		// else gcc sees malloc() and free() as a
+#endif							// mismatch of new and delete
+void operator delete(void* pBlock) THROWS_NOTHING
+{
+	free(pBlock);
+}
+
+#if __cplusplus >= 201402L
+										// sized delete, called instead of the
+                                        // one above since C++14
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* pBlock, size_t) THROWS_NOTHING
+{
+	free(pBlock);
+}
+#endif
+
+/*!****************************************************************************
+* @brief	Fake pens and brushes, only counted
+******************************************************************************/
+class TFakeGdiFactory : public TGdiFactory
+{
+	public:
+		TFakeGdiFactory() { m_nCreated = m_nDeleted = 0; }
+
+		TGdiHandle CreatePen(int nWidth, COLORREF Color)
+		{
+			return (TGdiHandle) (size_t) ++m_nCreated;
+		}
+
+		TGdiHandle CreateBrush(COLORREF Color)
+		{
+			return (TGdiHandle) (size_t) ++m_nCreated;
+		}
+
+		void DeleteObject(TGdiHandle hObject) { m_nDeleted++; }
+
+		unsigned GetCreated() { return m_nCreated; }
+		unsigned GetDeleted() { return m_nDeleted; }
+
+	protected:
+		unsigned m_nCreated, m_nDeleted;
+};
+
+/*!****************************************************************************
+* @brief	Null video device that looks up the pens as TVideoManager does
+******************************************************************************/
+class TPenCacheDevice : public TNullVideoDevice
+{
+	public:
+		TPenCacheDevice(TGdiFactory* pFactory) : m_PenCache(pFactory) {}
+
+        void DrawLines(TVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false)
+		{
+			m_PenCache.GetPen(nLineWidth, Color);
+		}
+
+        void DrawLines(TVecVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false)
+		{
+			m_PenCache.GetPen(nLineWidth, Color);
+		}
+
+		void ClearScreen(COLORREF Color)
+		{
+			m_PenCache.GetBrush(Color);
+		}
+
+		TPenCache* GetPenCache() { return &m_PenCache; }
+
+	protected:
+		TPenCache m_PenCache;
+};
+
+/*!****************************************************************************
+* @brief	Video device that hashes the lines drawn, in order
+******************************************************************************/
+class THashVideoDevice : public TNullVideoDevice
+{
+	public:
+		THashVideoDevice() { m_nHash = 2166136261u; m_bEnabled = true; }
+
+		void DrawLines(TVecPoints& Pts, int nLineWidth,
+			COLORREF Color, bool bClosed=false)
+		{
+			if( m_bEnabled && Pts.size() ) Hash(&Pts[0], Pts.size() * sizeof(TVector2));
+		}
+
+		unsigned GetHash() { return m_nHash; }
+		void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+
+	protected:
+		unsigned m_nHash;
+		bool m_bEnabled;
+
+		void Hash(const void* pData, unsigned nSize)
+		{
+			const unsigned char* pBytes = (const unsigned char*) pData;
+
+			for(unsigned i=0; i<nSize; i++) m_nHash = (m_nHash ^ pBytes[i]) * 16777619u;
+		}
+};
+
+/*!****************************************************************************
+* @brief	Simulation driven by a scripted player
+******************************************************************************/
+class TBenchSimulation : public TSimulation
+{
+	public:
+		TBenchSimulation(TVideoDevice* pVD, TSoundDevice* pSD, int nLevel,
+			unsigned nSeed = DEFSEED) : TSimulation(pVD, pSD)
+		{
+			m_nStartLevel = nLevel;
+			m_bSoak = false;
+			m_Angle = 0;
+
+			Restart(nSeed);
+			StartLevel();
+		}
+
+		void StartLevel()
+		{
+											// NextLevel() increments the level
+			m_nLevel = m_nStartLevel - 1;
+			NextLevel();
+		}
+										// the inputs of the scripted player
+		unsigned Script()
+		{
+			unsigned nTick = GetTick(), nInput = inFire;
+
+			if( nTick % 200 == 0 ) nInput |= inShield;
+			if( nTick % 3 == 0 ) nInput |= inLeft;
+			if( nTick % 20 == 0 ) nInput |= inThrust;
+
+			return nInput;
+		}
+
+		void Play()
+		{
+			if( IsGameOver() )
+			{
+				Restart();
+				StartLevel();
+			}
+			else
+			{
+				Input(Script());
+			}
+
+			Step(DT);
+		}
+
+										// replaces the asteroids of the level
+		void Populate(unsigned nCount)
+		{
+			m_Asteroids.Clear();
+			BuildTheAsteroids(nCount);
+		}
+										// counts the (probe, asteroid) overlaps
+										// scanning all the asteroids
+		unsigned BruteContacts(TVecPoints& Probes)
+		{
+			unsigned nContacts = 0;
+
+			for(int i=0; i<Probes.size(); i++)
+			{
+				for(int j=0; j<m_Asteroids.GetCount(); j++)
+				{
+					if( m_Asteroids.IsAlive(j)
+						&& m_Asteroids.Collide(j, Probes[i]) )
+					{
+						nContacts++;
+					}
+				}
+			}
+
+			return nContacts;
+		}
+										// same as above, using the grid (the
+										// time includes the grid building)
+		unsigned GridContacts(TVecPoints& Probes)
+		{
+			unsigned nContacts = 0;
+
+			BuildTheGrid();
+
+			for(int i=0; i<Probes.size(); i++)
+			{
+				m_AsteroidsGrid.Query(Probes[i], 0, m_Candidates);
+
+				for(int k=0; k<m_Candidates.size(); k++)
+				{
+					unsigned nRoid = m_Candidates[k];
+
+					if( m_Asteroids.IsAlive(nRoid)
+						&& m_Asteroids.Collide(nRoid, Probes[i]) )
+					{
+						nContacts++;
+					}
+				}
+			}
+
+			return nContacts;
+		}
+
+										// fires missiles from the center of the
+										// screen, all around
+		unsigned Volley(unsigned nCount)
+		{
+			unsigned nFired = 0;
+
+			m_bSoak = true;
+			m_nLives = 3;
+
+			for(unsigned i=0; i<nCount; i++)
+			{
+				int nMissile = m_Missiles.Spawn();
+				if( nMissile < 0 ) break;
+
+				m_Angle += 2.399963;	// golden angle
+
+				m_Missiles.SetOwner(nMissile, GetShip(scHuman)->GetEntity());
+				m_Missiles.Arm(nMissile, GetScreenCenter(),
+					TVector2(100.0 * cos(m_Angle), 100.0 * sin(m_Angle)) );
+
+				nFired++;
+			}
+
+			return nFired;
+		}
+
+	protected:
+		int m_nStartLevel;
+		bool m_bSoak;
+		double m_Angle;
+
+	protected:
+										// in soak mode the level never ends and
+										// the missiles are not cleared
+		void NextLevel()
+		{
+			if( m_bSoak ) Populate(SOAKASTEROIDS);
+			else TSimulation::NextLevel();
+		}
+};
+
+/*!****************************************************************************
+* @brief	A scripted game on the null devices, or drawing on a render
+*			buffer: the fixture of the modes that play the game
+******************************************************************************/
+struct TBenchGame
+{
+	TNullVideoDevice VideoDevice;
+	TNullSoundDevice SoundDevice;
+	TRenderBuffer RenderBuffer;
+	TBenchSimulation Sim;
+
+	TBenchGame(int nLevel = DEFLEVEL, unsigned nSeed = DEFSEED, bool bRender = false)
+		: Sim(bRender ? (TVideoDevice*) &RenderBuffer : &VideoDevice, &SoundDevice,
+			nLevel, nSeed) {}
+};
+
+/*!****************************************************************************
+* @brief	An asteroid field and its systems, without a simulation: the
+*			fixture of the modes that time the asteroids
+******************************************************************************/
+template <class TVideo>
+struct TBenchField
+{
+	TVideo VideoDevice;
+	TNullSoundDevice SoundDevice;
+	TShapeCache Cache;
+	TJobSystem Jobs;
+	maths::TRandom Random;
+	TEntityStore Entities;
+	TAsteroidField Field;
+
+	TBenchField(unsigned nThreads = 1) : Jobs(nThreads), Random(DEFSEED),
+		Field(&VideoDevice, &SoundDevice, &Random, &Cache, &Jobs, &Entities) {}
+
+										// asteroids of every class, all over
+                                        // the game area
+	void Fill(unsigned nCount, double Speed)
+	{
+		for(unsigned i=0; i<nCount; i++)
+		{
+			TVector2 Pos(Random.AbsRand(FRAMEW), Random.AbsRand(FRAMEH));
+			TVector2 Vel(Random.Rand(Speed), Random.Rand(Speed));
+			enAsteroidClass nClass = enAsteroidClass(Random.Next() % (acSmall + 1));
+
+			Field.Add(nClass, Pos, Vel, 10.0 * (3 - nClass) + Random.AbsRand(10.0));
+		}
+	}
+};
+
+/*!****************************************************************************
+* @brief	Collision queries cost vs. asteroids count
+* @param	nReps Number of repetitions for each asteroids count
+* @param	nSeed Seed of the simulation
+******************************************************************************/
+void CollideBench(unsigned nReps, unsigned nSeed)
+{
+	TBenchGame Game(1, nSeed);
+	TBenchSimulation& Sim = Game.Sim;
+
+	unsigned nWidth, nHeight;
+	Sim.GetClientArea(nWidth, nHeight);
+
+	TVecPoints Probes;
+
+	for(int i=0; i<NPROBES; i++)
+	{
+		Probes.push_back( TVector2(maths::AbsRand(nWidth), maths::AbsRand(nHeight)) );
+	}
+
+	printf("%-10s %14s %14s %10s\n", "asteroids", "brute [us]", "grid [us]", "contacts");
+
+	for(unsigned nCount = 10; nCount <= 100000; nCount *= 10)
+	{
+		Sim.Populate(nCount);
+
+		unsigned nBrute = 0, nGrid = 0;
+
+		double Time = utils::GetTime();
+
+		for(unsigned i=0; i<nReps; i++) nBrute = Sim.BruteContacts(Probes);
+
+		double BruteTime = utils::GetTime() - Time;
+
+		Time = utils::GetTime();
+
+		for(unsigned i=0; i<nReps; i++) nGrid = Sim.GridContacts(Probes);
+
+		double GridTime = utils::GetTime() - Time;
+											// the broadphase must not miss any hit
+		assert(nBrute == nGrid);
+
+		printf("%-10u %14.3f %14.3f %10u\n", nCount,
+			BruteTime * 1.0e6 / nReps, GridTime * 1.0e6 / nReps,
+			nGrid);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Fires a lot of missiles and checks that the cost per tick is flat
+* @param	nMissiles Number of missiles to be fired
+* @param	nSeed Seed of the simulation
+* @return	0 if the cost is flat, 1 otherwise
+******************************************************************************/
+int SoakBench(unsigned nMissiles, unsigned nSeed)
+{
+	TBenchGame Game(1, nSeed);
+	TBenchSimulation& Sim = Game.Sim;
+	Sim.Populate(SOAKASTEROIDS);
+
+	unsigned nFired = 0, nDropped = 0;
+	unsigned nWindowSize = nMissiles / SOAKWINDOWS ? nMissiles / SOAKWINDOWS : 1;
+	double First = 0, Max = 0;
+
+	printf("%-8s %10s %10s %10s\n", "window", "ticks", "tick [us]", "missiles");
+
+	for(unsigned nWindow = 0; nFired < nMissiles; nWindow++)
+	{
+		unsigned nTicks = 0, nTarget = nFired + nWindowSize;
+
+		double Time = utils::GetTime();
+
+		while( nFired < nTarget && nFired < nMissiles )
+		{
+			unsigned nCount = Sim.Volley(SOAKVOLLEY);
+
+			nFired += nCount;
+			nDropped += SOAKVOLLEY - nCount;
+
+			Sim.Step(DT);
+			nTicks++;
+		}
+
+		double TickTime = (utils::GetTime() - Time) * 1.0e6 / nTicks;
+
+		if( nWindow == 0 ) First = TickTime;
+		if( TickTime > Max ) Max = TickTime;
+
+		printf("%-8u %10u %10.3f %10u\n", nWindow, nTicks, TickTime,
+			Sim.GetMissilesCount());
+	}
+
+	bool bFlat = Max <= First * SOAKMAXRATIO;
+
+	printf("\nfired:    %u (dropped %u, pool exhausted)\n", nFired, nDropped);
+	printf("missiles: live %u, peak %u, capacity %u\n", Sim.GetMissilesCount(),
+		Sim.GetMissilesPeak(), Sim.GetMissilesCapacity());
+	printf("flat:     %s (max/first = %.2f)\n", bFlat ? "yes" : "NO", Max / First);
+
+	return bFlat ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Draws the game with the software rasterizer
+* @param	nFrames Number of frames to be drawn
+* @param	nLevel Starting level
+* @param	pFileName If not NULL, the last frame is saved in this file
+******************************************************************************/
+void RasterBench(unsigned nFrames, int nLevel, char* pFileName)
+{
+	TBenchGame Game(nLevel, DEFSEED, true);
+	TBenchSimulation& Sim = Game.Sim;
+	TRenderBuffer& RenderBuffer = Game.RenderBuffer;
+	TRasterDevice Raster(FRAMEW, FRAMEH);
+
+	double RenderTime = 0, MaxTime = 0;
+	unsigned nCommands = 0;
+
+	for(unsigned i=0; i<nFrames; i++)
+	{
+		Sim.Play();
+		Sim.Step(DT);
+
+		char strText[64];
+		sprintf(strText, "SCORE %06d  LEVEL %d", Sim.GetScore(), Sim.GetLevel());
+		RenderBuffer.DrawText(strText, 10, 10, RGB(255,255,255), TA_LEFT);
+
+		nCommands += RenderBuffer.GetCommandsCount();
+
+		double Time = utils::GetTime();
+
+		Raster.ClearScreen(RGB(0,0,0));
+		RenderBuffer.Flush(&Raster);
+
+		Time = utils::GetTime() - Time;
+
+		RenderTime += Time;
+		if( Time > MaxTime ) MaxTime = Time;
+	}
+
+	printf("frames:     %u, %ux%u, %s kernels\n", nFrames,
+		Raster.GetWidth(), Raster.GetHeight(), TRasterDevice::GetKernelsName());
+	printf("commands:   %.1f per frame\n", double(nCommands) / nFrames);
+	printf("frame:      %.3f us average, %.3f us max\n",
+		RenderTime * 1.0e6 / nFrames, MaxTime * 1.0e6);
+	printf("checksum:   %08x\n", Raster.GetChecksum());
+
+	if( pFileName )
+	{
+		printf("saved:      %s (%s)\n", pFileName,
+			Raster.SaveTheFrame(pFileName) ? "ok" : "failed");
+	}
+}
+
+/*!****************************************************************************
+* @brief	Runs the game loop on a virtual clock
+* @param	Seconds Virtual time to be run
+* @param	RenderTime Cost of a frame, in seconds
+* @param	HitchTime Cost of a slow frame, in seconds
+* @return	0 if the game kept its speed, 1 otherwise
+******************************************************************************/
+int LoopBench(double Seconds, double RenderTime, double HitchTime)
+{
+	TBenchGame Game(1);
+	TBenchSimulation& Sim = Game.Sim;
+
+	TVirtualClock Clock;
+	TGameLoop Loop(&Clock, FPS, FPS);
+
+	unsigned nRendered = 0;
+
+	while( Clock.GetTime() < Seconds )
+	{
+		unsigned nSteps = Loop.Update();
+
+		for(unsigned i=0; i<nSteps; i++)
+		{
+			Sim.Play();
+			Sim.Step(DT);
+		}
+
+		if( Loop.IsRenderTime() )
+		{
+			nRendered++;
+			Clock.Advance(nRendered % LOOPHITCHEVERY ? RenderTime : HitchTime);
+		}
+
+		Loop.Wait();
+	}
+
+	TFrameStats Stats = Loop.GetStats();
+
+	double Elapsed = Clock.GetTime();
+	double Speed = Stats.nSteps / (Elapsed * FPS);
+										// every step is either run or dropped
+	unsigned nExpected = unsigned(Elapsed * FPS);
+	bool bOk = Stats.nSteps + Stats.nDroppedSteps + 1 >= nExpected
+		&& Stats.nSteps + Stats.nDroppedSteps <= nExpected + 1;
+
+	printf("elapsed:    %.3f s (virtual)\n", Elapsed);
+	printf("steps:      %u run, %u dropped, %u expected\n",
+		Stats.nSteps, Stats.nDroppedSteps, nExpected);
+	printf("frames:     %u updates, %u rendered\n", Stats.nFrames, Stats.nRendered);
+	printf("frame:      %.3f ms average, %.3f ms min, %.3f ms max\n",
+		Stats.GetAverageFrame() * 1000.0, Stats.MinFrame * 1000.0,
+		Stats.MaxFrame * 1000.0);
+	printf("sleep:      %.1f%% of the time\n", Stats.TotalSleep * 100.0 / Elapsed);
+	printf("speed:      %.3f x real time (%s)\n", Speed, bOk ? "ok" : "WRONG");
+
+	return bOk ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Plays back a replay on a simulation
+* @return	The number of ticks that matched the recording
+******************************************************************************/
+unsigned PlayBack(TReplay& Replay, unsigned nSeed)
+{
+	TBenchGame Game(1, nSeed);
+	TBenchSimulation& Sim = Game.Sim;
+
+	for(unsigned i=0; i<Replay.GetTicksCount(); i++)
+	{
+		Sim.Input(Replay.GetInput(i));
+		Sim.Step(DT);
+
+		if( !Replay.Check(i, Sim.GetHash()) ) return i;
+	}
+
+	return Replay.GetTicksCount();
+}
+
+/*!****************************************************************************
+* @brief	Records a game, then plays it back
+* @param	nTicks Number of ticks to be recorded
+* @param	nSeed Seed of the game
+* @param	pFileName Name of the replay file
+* @return	0 if the playback reproduced the game, 1 otherwise
+******************************************************************************/
+int ReplayBench(unsigned nTicks, unsigned nSeed, const char* pFileName)
+{
+	TBenchGame Game(1, nSeed);
+	TBenchSimulation& Sim = Game.Sim;
+	TReplay Recorder;
+
+	Recorder.Begin(nSeed);
+
+	double Time = utils::GetTime();
+										// the game goes on after the game-over,
+                                        // there is no restart in a replay
+	for(unsigned i=0; i<nTicks; i++)
+	{
+		unsigned nInput = Sim.IsGameOver() ? 0 : Sim.Script();
+
+		Sim.Input(nInput);
+		Sim.Step(DT);
+
+		Recorder.Record(nInput, Sim.GetHash());
+	}
+
+	double RecordTime = utils::GetTime() - Time;
+
+	if( !Recorder.Save(pFileName) )
+	{
+		printf("cannot save %s\n", pFileName);
+		return 1;
+	}
+
+	FILE* fp = fopen(pFileName, "rb");
+	fseek(fp, 0, SEEK_END);
+	long nFileSize = ftell(fp);
+	fclose(fp);
+
+	TReplay Replay;
+
+	if( !Replay.Load(pFileName) )
+	{
+		printf("cannot load %s\n", pFileName);
+		return 1;
+	}
+
+	Time = utils::GetTime();
+
+	unsigned nMatched = PlayBack(Replay, Replay.GetSeed());
+
+	double PlayTime = utils::GetTime() - Time;
+										// another seed must be detected
+	unsigned nDiverged = PlayBack(Replay, Replay.GetSeed() + 1);
+
+	bool bOk = nMatched == nTicks && nDiverged < nTicks;
+
+	printf("recorded:   %u ticks, seed %u, score %d, %.3f us/tick\n", nTicks,
+		nSeed, Sim.GetScore(), RecordTime * 1.0e6 / nTicks);
+	printf("file:       %s, %ld bytes\n", pFileName, nFileSize);
+	printf("playback:   %u/%u ticks matched, %.3f us/tick\n", nMatched,
+		Replay.GetTicksCount(), PlayTime * 1.0e6 / nTicks);
+	printf("seed + 1:   diverged within tick %u\n", nDiverged + 1);
+	printf("replay:     %s\n", bOk ? "ok" : "WRONG");
+
+	return bOk ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Runs frames of the game, drawn with the software rasterizer,
+*			with the profiler markers in place
+* @param	nFrames Number of frames
+* @param	nScore The score at the end
+* @return	The elapsed time, in seconds
+******************************************************************************/
+double ProfiledFrames(unsigned nFrames, int& nScore)
+{
+	TBenchGame Game(DEFLEVEL, DEFSEED, true);
+	TBenchSimulation& Sim = Game.Sim;
+	TRenderBuffer& RenderBuffer = Game.RenderBuffer;
+	TRasterDevice Raster(FRAMEW, FRAMEH);
+
+	double Time = utils::GetTime();
+
+	for(unsigned i=0; i<nFrames; i++)
+	{
+		double FrameTime = utils::GetTime();
+
+		RenderBuffer.Clear();
+		Sim.Play();
+
+		PROFILE(ppClear, Raster.ClearScreen(RGB(0,0,0)));
+		PROFILE(ppRender, RenderBuffer.Flush(&Raster));
+
+		if( Profiler )
+		{
+			Profiler->Record(ppFrame, FrameTime, utils::GetTime());
+			Profiler->EndFrame();
+		}
+	}
+
+	nScore = Sim.GetScore();
+
+	return utils::GetTime() - Time;
+}
+
+/*!****************************************************************************
+* @brief	Measures the cost of the profiler, off and on
+* @param	nFrames Number of frames
+* @param	pFileName The trace is written on this file
+* @return	0 if the game is the same with the profiler on, 1 otherwise
+******************************************************************************/
+int ProfileBench(unsigned nFrames, const char* pFileName)
+{
+	static TProfiler BenchProfiler;
+	TProfiler* pProfiler = &BenchProfiler;
+										// the cost of a marker, alone
+	const unsigned nMarkers = 10000000;
+	volatile unsigned nCount = 0;
+
+	double Time = utils::GetTime();
+	for(unsigned i=0; i<nMarkers; i++) PROFILE(ppWait, nCount++);
+	double MarkerOff = utils::GetTime() - Time;
+
+	pProfiler->SetEnabled(true);
+
+	Time = utils::GetTime();
+	for(unsigned i=0; i<nMarkers; i++) PROFILE(ppWait, nCount++);
+	double MarkerOn = utils::GetTime() - Time;
+
+	pProfiler->SetEnabled(false);
+										// warm-up
+	int nScoreOff, nScoreOn;
+	ProfiledFrames(nFrames / 10 + 1, nScoreOff);
+
+	double OffTime = ProfiledFrames(nFrames, nScoreOff);
+										// enabling discards the events
+                                        // of the markers
+	pProfiler->SetEnabled(true);
+
+	double OnTime = ProfiledFrames(nFrames, nScoreOn);
+
+	pProfiler->SetEnabled(false);
+
+	bool bOk = nScoreOff == nScoreOn;
+
+	printf("frames:     %u, score %d off, %d on\n", nFrames, nScoreOff, nScoreOn);
+	printf("profiler:   %.3f us/frame off, %.3f us/frame on (%+.2f%%)\n",
+		OffTime * 1.0e6 / nFrames, OnTime * 1.0e6 / nFrames,
+		(OnTime / OffTime - 1.0) * 100.0);
+	printf("marker:     %.2f ns off, %.2f ns on\n",
+		MarkerOff * 1.0e9 / nMarkers, MarkerOn * 1.0e9 / nMarkers);
+	printf("\n%-12s %12s %12s\n", "phase", "p50 [us]", "p99 [us]");
+
+	for(int i=0; i<ppCount; i++)
+	{
+		if( i == ppShowInfo || i == ppPaint || i == ppWait ) continue;
+
+		printf("%-12s %12.3f %12.3f\n", TProfiler::GetPhaseName(i),
+			pProfiler->GetPercentile(i, 0.5) * 1.0e6,
+			pProfiler->GetPercentile(i, 0.99) * 1.0e6);
+	}
+										// the last frames only
+	printf("\ntrace:      %s (%s)\n", pFileName,
+		pProfiler->ExportTheTrace(pFileName) ? "ok" : "failed");
+
+	return bOk ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Plays ticks and frames, counting the heap allocations
+* @param	Sim The simulation
+* @param	RenderBuffer The buffer the simulation draws on
+* @param	Raster The device the buffer is flushed on
+* @param	nTicks Number of ticks
+* @param	nStepAllocs The allocations of the ticks
+* @param	nFrameAllocs The allocations of the flushes
+* @return	The number of ticks that have allocated
+******************************************************************************/
+unsigned CountTheAllocs(TBenchSimulation& Sim, TRenderBuffer& RenderBuffer,
+	TRasterDevice& Raster, unsigned nTicks, unsigned long& nStepAllocs,
+	unsigned long& nFrameAllocs)
+{
+	unsigned nAllocTicks = 0;
+
+	nStepAllocs = nFrameAllocs = 0;
+
+	for(unsigned i=0; i<nTicks; i++)
+	{
+		unsigned long nStart = nHeapAllocs;
+
+		Sim.Play();
+
+		unsigned long nStep = nHeapAllocs - nStart;
+
+		Raster.ClearScreen(RGB(0,0,0));
+		RenderBuffer.Flush(&Raster);
+
+		unsigned long nFrame = nHeapAllocs - nStart - nStep;
+
+		nStepAllocs += nStep;
+		nFrameAllocs += nFrame;
+
+		if( nStep + nFrame ) nAllocTicks++;
+	}
+
+	return nAllocTicks;
+}
+
+/*!****************************************************************************
+* @brief	Counts the heap allocations of the ticks and of the frames
+* @param	nTicks Number of ticks of a game
+* @param	nLevel Starting level
+* @return	0 if the replayed game does not allocate, 1 otherwise
+* @note		The game is played twice from the same seed: the first time
+*			the buffers grow to their peak size, the second time nothing
+*			must be allocated, level changes and restarts included
+******************************************************************************/
+int AllocBench(unsigned nTicks, int nLevel)
+{
+	TBenchGame Game(nLevel, DEFSEED, true);
+	TBenchSimulation& Sim = Game.Sim;
+	TRenderBuffer& RenderBuffer = Game.RenderBuffer;
+	TRasterDevice Raster(FRAMEW, FRAMEH);
+
+	unsigned long nStepAllocs, nFrameAllocs;
+
+	unsigned nAllocTicks = CountTheAllocs(Sim, RenderBuffer, Raster, nTicks,
+		nStepAllocs, nFrameAllocs);
+	int nScore = Sim.GetScore();
+
+	printf("first:      %u ticks, score %d, %lu allocations in the ticks, "
+		"%lu in the frames, %u ticks allocating\n", nTicks, nScore,
+		nStepAllocs, nFrameAllocs, nAllocTicks);
+
+	unsigned long nStart = nHeapAllocs;
+
+	Sim.Restart(DEFSEED);
+	Sim.StartLevel();
+
+	unsigned long nRestartAllocs = nHeapAllocs - nStart;
+
+	nAllocTicks = CountTheAllocs(Sim, RenderBuffer, Raster, nTicks,
+		nStepAllocs, nFrameAllocs);
+
+	bool bOk = nStepAllocs + nFrameAllocs == 0 && Sim.GetScore() == nScore;
+
+	printf("second:     %u ticks, score %d, %lu allocations in the ticks, "
+		"%lu in the frames, %u ticks allocating\n", nTicks, Sim.GetScore(),
+		nStepAllocs, nFrameAllocs, nAllocTicks);
+	printf("restart:    %lu allocations\n", nRestartAllocs);
+	printf("alloc:      %s\n", bOk ? "ok" : "WRONG");
+
+	return bOk ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Times the transform of a set of points
+* @param	nPoints Number of points
+******************************************************************************/
+void TransformBench(unsigned nPoints)
+{
+	unsigned nReps = XFORMPOINTS / nPoints;
+	double Theta = 33.0;
+	TVector2 Shift(400.0, 300.0);
+	TAffine2 M(Theta, Shift);
+
+	TVecPoints Src(nPoints), Loop(nPoints), AoS(nPoints);
+	std::vector<double> SrcX(nPoints), SrcY(nPoints), DstX(nPoints), DstY(nPoints);
+	std::vector<TVector2f> SrcF(nPoints), AoSF(nPoints);
+	std::vector<float> SrcFX(nPoints), SrcFY(nPoints), DstFX(nPoints), DstFY(nPoints);
+
+	for(unsigned i=0; i<nPoints; i++)
+	{
+		Src[i] = TVector2(maths::Rand(64.0), maths::Rand(64.0));
+
+		SrcX[i] = Src[i].X;
+		SrcY[i] = Src[i].Y;
+		SrcF[i].X = SrcFX[i] = Src[i].X;
+		SrcF[i].Y = SrcFY[i] = Src[i].Y;
+	}
+
+	double Times[5];
+	double Time = utils::GetTime();
+										// the loops used so far: a copy,
+                                        // then Rotate() and Translate()
+	for(unsigned n=0; n<nReps; n++)
+	{
+		Loop = Src;
+		Rotate(Loop, Theta);
+		Translate(Loop, Shift);
+	}
+
+	Times[0] = utils::GetTime() - Time;
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<nReps; n++) Transform(M, &Src[0], &AoS[0], nPoints);
+
+	Times[1] = utils::GetTime() - Time;
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<nReps; n++)
+	{
+		Transform(M, &SrcX[0], &SrcY[0], &DstX[0], &DstY[0], nPoints);
+	}
+
+	Times[2] = utils::GetTime() - Time;
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<nReps; n++) Transform(M, &SrcF[0], &AoSF[0], nPoints);
+
+	Times[3] = utils::GetTime() - Time;
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<nReps; n++)
+	{
+		Transform(M, &SrcFX[0], &SrcFY[0], &DstFX[0], &DstFY[0], nPoints);
+	}
+
+	Times[4] = utils::GetTime() - Time;
+										// differences from the loops
+	double Errors[5] = { 0, 0, 0, 0, 0 };
+
+	for(unsigned i=0; i<nPoints; i++)
+	{
+		double E[5] = { 0,
+			std::max(fabs(AoS[i].X - Loop[i].X), fabs(AoS[i].Y - Loop[i].Y)),
+			std::max(fabs(DstX[i] - Loop[i].X), fabs(DstY[i] - Loop[i].Y)),
+			std::max(fabs(AoSF[i].X - Loop[i].X), fabs(AoSF[i].Y - Loop[i].Y)),
+			std::max(fabs(DstFX[i] - Loop[i].X), fabs(DstFY[i] - Loop[i].Y)) };
+
+		for(int j=0; j<5; j++) Errors[j] = std::max(Errors[j], E[j]);
+	}
+
+	const char* strNames[5] = {
+		"loops", "aos double", "soa double", "aos float", "soa float" };
+
+	for(int j=0; j<5; j++)
+	{
+		printf("%-8u %-12s %10.3f %10.2fx %12.3g\n", nPoints, strNames[j],
+			Times[j] * 1.0e9 / (double(nReps) * nPoints), Times[0] / Times[j],
+			Errors[j]);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Times the outlines rotated by the shape cache
+* @param	nSteps Rotations per turn of the cache
+* @param	nBudget Bytes for the pre-rotated copies
+******************************************************************************/
+void ShapesBench(unsigned nSteps, unsigned nBudget)
+{
+	TShapeCache Cache(nSteps, nBudget);
+	std::vector<TVecPoints> Shapes(SHAPESCOUNT);
+	std::vector<int> Ids(SHAPESCOUNT);
+	std::vector<double> Angles(SHAPESCOUNT);
+	TVecPoints Exact, Cached;
+	double Bound = 0;
+										// rough polygons, as the asteroids
+	for(unsigned i=0; i<SHAPESCOUNT; i++)
+	{
+		for(unsigned j=0; j<SHAPESVERTS; j++)
+		{
+			double Angle = 2.0 * M_PI * j / SHAPESVERTS;
+			double Radius = 40.0 * (0.75 + maths::AbsRand(0.25));
+
+			Shapes[i].push_back(TVector2(cos(Angle) * Radius, sin(Angle) * Radius));
+		}
+
+		Shapes[i].push_back(Shapes[i][0]);
+
+		Ids[i] = Cache.Add(Shapes[i]);
+		Angles[i] = maths::AbsRand(360.0);
+		Bound = std::max(Bound, Cache.GetMaxError(Ids[i]));
+	}
+
+	TVector2 Pos(FRAMEW / 2, FRAMEH / 2);
+	double Times[2], Error = 0;
+	double Time = utils::GetTime();
+
+	for(unsigned n=0; n<SHAPESREPS; n++)
+	{
+		for(unsigned i=0; i<SHAPESCOUNT; i++)
+		{
+			Transform(Shapes[i], Angles[i] + n, Pos, Exact);
+		}
+	}
+
+	Times[0] = utils::GetTime() - Time;
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<SHAPESREPS; n++)
+	{
+		for(unsigned i=0; i<SHAPESCOUNT; i++)
+		{
+			Cache.Transform(Ids[i], Angles[i] + n, Pos, Cached);
+		}
+	}
+
+	Times[1] = utils::GetTime() - Time;
+										// errors over random angles
+	for(unsigned n=0; n<SHAPESREPS; n++)
+	{
+		unsigned i = n % SHAPESCOUNT;
+		double Angle = maths::Rand(720.0);
+
+		Transform(Shapes[i], Angle, Pos, Exact);
+		Cache.Transform(Ids[i], Angle, Pos, Cached);
+
+		for(unsigned j=0; j<Exact.size(); j++)
+		{
+			Error = std::max(Error, (Exact[j] - Cached[j]).Length());
+		}
+	}
+
+	printf("%-6u %-8u %4u/%-4u %10.3f %10.3f %9.2fx %10.4f %10.4f\n",
+		nSteps, Cache.GetMemory() / 1024, Cache.GetCachedCount(),
+		Cache.GetShapesCount(), Times[0] * 1.0e9 / (SHAPESREPS * SHAPESCOUNT),
+		Times[1] * 1.0e9 / (SHAPESREPS * SHAPESCOUNT), Times[0] / Times[1],
+		Bound, Error);
+}
+
+/*!****************************************************************************
+* @brief	Reports the memory of the asteroids, templates vs. outlines
+* @param	nCount Number of asteroids
+******************************************************************************/
+void FootprintBench(unsigned nCount)
+{
+	TBenchField<TRenderBuffer> Bench;
+	TAsteroidField& Field = Bench.Field;
+	TShapeCache& Cache = Bench.Cache;
+
+	Bench.Fill(nCount, 10.0);
+										// the field now: the index of the
+                                        // template, the templates in the cache
+	unsigned nField = Field.GetMemory();
+	unsigned nTemplates = (acSmall + 1) * ASTEROID_NTEMPLATES * ASTEROID_MAXVERTS
+		* sizeof(TVector2);
+	unsigned nNew = nField + nTemplates + Cache.GetMemory();
+										// before: an outline per asteroid,
+                                        // as a vector on the heap
+	unsigned nOutline = sizeof(TVecPoints) + ASTEROID_MAXVERTS * sizeof(TVector2)
+		+ HEAPHEADER;
+	unsigned nOld = nField - nCount * sizeof(BYTE) + nCount * nOutline;
+
+	double Time = utils::GetTime();
+
+	for(unsigned n=0; n<DEFREPS; n++)
+	{
+		Bench.VideoDevice.Clear();
+		Field.Update(DT);
+	}
+
+	Time = utils::GetTime() - Time;
+
+	printf("asteroids:  %u\n", nCount);
+	printf("outlines:   %u bytes, %u per asteroid (%u vertices on the heap)\n",
+		nCount * nOutline, nOutline, ASTEROID_MAXVERTS);
+	printf("templates:  %u bytes, %u per class, %u bytes of rotated copies, "
+		"%u per asteroid (index)\n", nTemplates, ASTEROID_NTEMPLATES,
+		Cache.GetMemory(), (unsigned) sizeof(BYTE));
+	printf("old:        %u bytes, %.1f per asteroid\n", nOld, double(nOld) / nCount);
+	printf("new:        %u bytes, %.1f per asteroid, %.1f without the copies\n",
+		nNew, double(nNew) / nCount, double(nNew - Cache.GetMemory()) / nCount);
+	printf("draw:       %.1f ns per asteroid\n", Time * 1.0e9 / (DEFREPS * nCount));
+}
+
+/*!****************************************************************************
+* @brief	Times the parallel loops of an asteroid field
+* @param	nCount Number of asteroids
+* @param	nThreads Number of threads
+* @param	nHash The hash of the outlines and of the positions
+* @return	The time of an update, in seconds
+******************************************************************************/
+double FieldUpdates(unsigned nCount, unsigned nThreads, unsigned& nHash)
+{
+	TBenchField<THashVideoDevice> Bench(nThreads);
+	TAsteroidField& Field = Bench.Field;
+	THashVideoDevice& VideoDevice = Bench.VideoDevice;
+
+	Bench.Fill(nCount, 50.0);
+
+	unsigned nReps = std::max(JOBSUPDATES / nCount, 4u);
+											// the first one allocates, the
+                                            // last one is hashed
+	VideoDevice.SetEnabled(false);
+
+	Field.Update(DT);
+	Field.Wrap(FRAMEW, FRAMEH);
+
+	double Time = utils::GetTime();
+
+	for(unsigned n=1; n<nReps; n++)
+	{
+		Field.Update(DT);
+		Field.Wrap(FRAMEW, FRAMEH);
+	}
+
+	Time = utils::GetTime() - Time;
+
+	VideoDevice.SetEnabled(true);
+	Field.Update(DT);
+
+	nHash = VideoDevice.GetHash();
+
+	for(unsigned i=0; i<nCount; i++)
+	{
+		TVector2 Pos = Field.GetPos(i);
+		nHash = (nHash ^ unsigned(Pos.X * 1024.0)) * 16777619u;
+		nHash = (nHash ^ unsigned(Pos.Y * 1024.0)) * 16777619u;
+	}
+
+	return Time / (nReps - 1);
+}
+
+/*!****************************************************************************
+* @brief	Plays a game with a number of threads
+* @param	nThreads Number of threads
+* @param	nScore The score at the end
+* @return	The hash of the world at the end
+******************************************************************************/
+unsigned JobsGame(unsigned nThreads, int& nScore)
+{
+	TBenchGame Game(JOBSLEVEL);
+	TBenchSimulation& Sim = Game.Sim;
+
+	Sim.SetThreadsCount(nThreads);
+
+	for(unsigned i=0; i<JOBSTICKS; i++)
+	{
+		Sim.Play();
+		Sim.Step(DT);
+	}
+
+	nScore = Sim.GetScore();
+
+	return Sim.GetHash();
+}
+
+/*!****************************************************************************
+* @brief	Times the parallel loops of the asteroids, for 1 to nMaxThreads
+*			threads
+* @param	nMaxThreads The most threads
+* @return	0 if the results do not depend on the number of threads
+******************************************************************************/
+int JobsBench(unsigned nMaxThreads)
+{
+	unsigned Counts[4] = { 1000, 10000, 100000, 1000000 };
+	bool bOk = true;
+
+	printf("cores:      %u\n\n", TJobSystem::GetCoresCount());
+	printf("%-10s %-8s %12s %10s %10s %10s\n", "asteroids", "threads",
+		"us/update", "ns/rock", "speed-up", "hash");
+
+	for(int i=0; i<4; i++)
+	{
+		unsigned nHash1 = 0;
+		double Time1 = 0;
+
+		for(unsigned nThreads=1; nThreads<=nMaxThreads; nThreads*=2)
+		{
+			unsigned nHash;
+			double Time = FieldUpdates(Counts[i], nThreads, nHash);
+
+			if( nThreads == 1 ) { Time1 = Time; nHash1 = nHash; }
+
+			bool bSame = nHash == nHash1;
+			bOk = bOk && bSame;
+
+			printf("%-10u %-8u %12.1f %10.2f %9.2fx %10s\n", Counts[i], nThreads,
+				Time * 1.0e6, Time * 1.0e9 / Counts[i], Time1 / Time,
+				bSame ? "same" : "DIFFERENT");
+		}
+	}
+
+	int nScore1, nScoreN;
+	unsigned nHash1 = JobsGame(1, nScore1);
+	unsigned nHashN = JobsGame(nMaxThreads, nScoreN);
+
+	bOk = bOk && nHash1 == nHashN;
+
+	printf("\ngame:       1 thread score %d hash %08x, %u threads score %d hash %08x\n",
+		nScore1, nHash1, nMaxThreads, nScoreN, nHashN);
+	printf("jobs:       %s\n", bOk ? "ok" : "WRONG");
+
+	return bOk ? 0 : 1;
+}
+
+/*!****************************************************************************
+* @brief		Fires missiles across small moving asteroids, one per asteroid,
+*				with the point and with the swept tests
+* @param		nShots Number of missiles
+* @param		Dt The value for the delta time of a step
+* @param[out]	Point The missiles that have hit, by the point tests
+* @param[out]	Swept The missiles that have hit, by the swept tests
+* @param[out]	PointTime Seconds per point test
+* @param[out]	SweptTime Seconds per swept test
+******************************************************************************/
+void FireTheShots(unsigned nShots, double Dt, std::vector<bool>& Point,
+	std::vector<bool>& Swept, double& PointTime, double& SweptTime)
+{
+	TBenchField<TNullVideoDevice> Bench;
+	TAsteroidField& Field = Bench.Field;
+	maths::TRandom& Random = Bench.Random;
+
+	TMissilePool Missiles(&Bench.VideoDevice, &Bench.Jobs, &Bench.Entities, nShots);
+
+	Point.assign(nShots, false);
+	Swept.assign(nShots, false);
+											// each missile crosses the line of
+                                            // its asteroid at a random offset
+	for(unsigned i=0; i<nShots; i++)
+	{
+		TVector2 Pos(Random.AbsRand(FRAMEW), Random.AbsRand(FRAMEH));
+		TVector2 Vel(Random.Rand(30.0), Random.Rand(30.0));
+
+		Field.Add(acSmall, Pos, Vel, SWEPTRADIUS);
+
+		double Speed = SWEPTSPEED + Random.AbsRand(SHIP_MAXVEL);
+		double Theta = DEG2RAD(Random.AbsRand(360.0));
+		TVector2 MissileVel(Speed * cos(Theta), Speed * sin(Theta));
+											// the path, relative to the asteroid
+		TVector2 Rel(MissileVel.X - Vel.X, MissileVel.Y - Vel.Y);
+		double RelSpeed = Rel.Length();
+		Rel.X /= RelSpeed;
+		Rel.Y /= RelSpeed;
+
+		double Offset = Random.Rand(2.0 * SWEPTRADIUS);
+
+		Missiles.Arm(Missiles.Spawn(), TVector2(Pos.X - Rel.X * SWEPTDIST - Rel.Y * Offset,
+			Pos.Y - Rel.Y * SWEPTDIST + Rel.X * Offset), MissileVel);
+	}
+											// the missiles move, then the
+                                            // asteroids, as in a step
+	unsigned nSteps = unsigned(ceil(SWEPTTIME / Dt));
+
+	for(unsigned n=0; n<nSteps; n++)
+	{
+		IntegrateTheMotion(Bench.Entities.GetArchetype(ekMissile), Dt, 0, nShots);
+
+		Field.Update(Dt);
+
+		for(unsigned i=0; i<nShots; i++)
+		{
+			if( Field.Collide(i, Missiles.GetPos(i)) ) Point[i] = true;
+
+			if( Field.Collide(i, Missiles.GetPrevPos(i), Missiles.GetPos(i), Dt) )
+			{
+				Swept[i] = true;
+			}
+		}
+	}
+											// the cost, on the last segments
+	volatile unsigned nCount = 0;
+	double Time = utils::GetTime();
+
+	for(unsigned n=0; n<SWEPTREPS; n++)
+	{
+		for(unsigned i=0; i<nShots; i++) nCount += Field.Collide(i, Missiles.GetPos(i));
+	}
+
+	PointTime = (utils::GetTime() - Time) / (SWEPTREPS * nShots);
+	Time = utils::GetTime();
+
+	for(unsigned n=0; n<SWEPTREPS; n++)
+	{
+		for(unsigned i=0; i<nShots; i++)
+		{
+			nCount += Field.Collide(i, Missiles.GetPrevPos(i), Missiles.GetPos(i), Dt);
+		}
+	}
+
+	SweptTime = (utils::GetTime() - Time) / (SWEPTREPS * nShots);
+}
+
+/*!****************************************************************************
+* @brief	Counts the hits caught by the point and by the swept tests, vs.
+*			the swept tests on steps SWEPTSUBSTEPS times shorter
+* @param	nShots Number of missiles, one per asteroid
+* @param	Dt The value for the delta time of a step
+******************************************************************************/
+void SweptBench(unsigned nShots, double Dt)
+{
+	std::vector<bool> Point, Swept, Truth, Unused;
+	double PointTime, SweptTime, Time;
+
+	FireTheShots(nShots, Dt / SWEPTSUBSTEPS, Unused, Truth, Time, Time);
+	FireTheShots(nShots, Dt, Point, Swept, PointTime, SweptTime);
+
+	unsigned nHits = 0, nPoint = 0, nSwept = 0, nWrong = 0;
+
+	for(unsigned i=0; i<nShots; i++)
+	{
+		nHits += Truth[i];
+		nPoint += Truth[i] && Point[i];
+		nSwept += Truth[i] && Swept[i];
+		nWrong += !Truth[i] && (Point[i] || Swept[i]);
+	}
+
+	printf("%-6.2f %6.1f %8u %8u %7.1f%% %8u %7.1f%% %6u %9.2f %9.2f\n", Dt,
+		(SWEPTSPEED + SHIP_MAXVEL) * Dt, nHits, nPoint, 100.0 * nPoint / std::max(nHits, 1u),
+		nSwept, 100.0 * nSwept / std::max(nHits, 1u), nWrong,
+		PointTime * 1.0e9, SweptTime * 1.0e9);
+}
+
+/*!****************************************************************************
+* @brief	Gets a random point inside a circle
+* @param	Random The generator
+* @param	Center The center of the circle
+* @param	Radius The radius of the circle
+******************************************************************************/
+TVector2 RandInCircle(maths::TRandom& Random, TVector2 Center, double Radius)
+{
+	double R = Radius * sqrt(Random.AbsRand(1.0));
+	double Theta = DEG2RAD(Random.AbsRand(360.0));
+
+	return TVector2(Center.X + R * cos(Theta), Center.Y + R * sin(Theta));
+}
+
+/*!****************************************************************************
+* @brief	False positives of the bounding circles, and the cost of the
+*			outline tests
+* @param	nProbes Number of points, for the asteroids and for each ship
+******************************************************************************/
+void OutlineBench(unsigned nProbes)
+{
+	TBenchField<TNullVideoDevice> Bench;
+	TAsteroidField& Field = Bench.Field;
+	maths::TRandom& Random = Bench.Random;
+
+	for(unsigned i=0; i<OUTLINEROCKS; i++)
+	{
+		enAsteroidClass nClass = enAsteroidClass(i % (acSmall + 1));
+		TVector2 Pos(Random.AbsRand(FRAMEW), Random.AbsRand(FRAMEH));
+
+		Field.Add(nClass, Pos, TVector2(Random.Rand(50.0), Random.Rand(50.0)),
+			10.0 * (3 - nClass));
+	}
+											// the outlines of this tick
+	Field.Update(DT);
+
+	TShip* pShips[3];
+	const char* pNames[3] = { "human", "alien small", "alien big" };
+
+	for(int i=0; i<3; i++)
+	{
+		double Size = i == scAlienBig ? 1.5 * SHIP_SIZE : SHIP_SIZE;
+
+		pShips[i] = new TShip(&Bench.VideoDevice, &Bench.SoundDevice, &Random, &Bench.Cache,
+			&Bench.Entities, enShipClass(i), TVector2(Size, Size),
+			TVector2(FRAMEW / 2, FRAMEH / 2), TVector2(0, 0));
+
+		pShips[i]->SetRot(Random.AbsRand(360.0));
+		pShips[i]->Update(DT);
+	}
+
+	TVecPoints Probes(nProbes), AreaProbes(nProbes);
+	std::vector<unsigned> Rocks(nProbes);
+
+	for(unsigned j=0; j<nProbes; j++)
+	{
+		Rocks[j] = Random.Next() % OUTLINEROCKS;
+		Probes[j] = RandInCircle(Random, Field.GetPos(Rocks[j]), Field.GetSize(Rocks[j]));
+		AreaProbes[j] = TVector2(Random.AbsRand(FRAMEW), Random.AbsRand(FRAMEH));
+	}
+											// false positives, by class
+	const char* pClasses[3] = { "asteroid big", "asteroid mid", "asteroid small" };
+	unsigned nIn[3] = { 0, 0, 0 }, nHits[3] = { 0, 0, 0 };
+
+	for(unsigned j=0; j<nProbes; j++)
+	{
+		unsigned nClass = Field.GetClass(Rocks[j]);
+
+		nIn[nClass]++;
+		nHits[nClass] += Field.Collide(Rocks[j], Probes[j]);
+	}
+
+	printf("%-16s %10s %10s %10s\n", "object", "in circle", "in outline", "false pos");
+
+	for(int i=0; i<3; i++)
+	{
+		printf("%-16s %10u %10u %9.1f%%\n", pClasses[i], nIn[i], nHits[i],
+			100.0 * (nIn[i] - nHits[i]) / std::max(nIn[i], 1u));
+	}
+
+	for(int i=0; i<3; i++)
+	{
+		unsigned nShipHits = 0;
+
+		for(unsigned j=0; j<nProbes; j++)
+		{
+			nShipHits += pShips[i]->IsColliding(RandInCircle(Random,
+				pShips[i]->GetPos(), pShips[i]->GetRadius()));
+		}
+
+		printf("%-16s %10u %10u %9.1f%%\n", pNames[i], nProbes, nShipHits,
+			100.0 * (nProbes - nShipHits) / nProbes);
+	}
+											// the cost of a query, the circle
+                                            // alone as before, then both
+	volatile unsigned nCount = 0;
+	double Times[4];
+
+	for(int n=0; n<4; n++)
+	{
+		TVecPoints& Pts = n < 2 ? Probes : AreaProbes;
+		double Time = utils::GetTime();
+
+		for(unsigned j=0; j<nProbes; j++)
+		{
+			unsigned i = Rocks[j];
+
+			if( n % 2 == 0 )
+			{
+				double DX = Pts[j].X - Field.GetPos(i).X, DY = Pts[j].Y - Field.GetPos(i).Y;
+				nCount += DX*DX + DY*DY <= Field.GetSize(i) * Field.GetSize(i);
+			}
+			else
+			{
+				nCount += Field.Collide(i, Pts[j]);
+			}
+		}
+
+		Times[n] = (utils::GetTime() - Time) * 1.0e9 / nProbes;
+	}
+
+	printf("\n%-16s %10s %10s\n", "points", "circle ns", "outline ns");
+	printf("%-16s %10.2f %10.2f\n", "in the circles", Times[0], Times[1]);
+	printf("%-16s %10.2f %10.2f\n", "on the area", Times[2], Times[3]);
+											// ship vs. asteroid, the circles
+                                            // overlapping
+	unsigned nPairs = 0, nOverlaps = 0;
+	double Time = utils::GetTime();
+
+	for(unsigned j=0; j<OUTLINEPAIRS; j++)
+	{
+		unsigned i = Rocks[j % nProbes];
+		TShip* pShip = pShips[j % 3];
+
+		pShip->SetPos(RandInCircle(Random, Field.GetPos(i),
+			Field.GetSize(i) + pShip->GetRadius()));
+
+		nPairs++;
+		nOverlaps += pShip->IsColliding(Field.GetOutline(i));
+	}
+
+	Time = utils::GetTime() - Time;
+
+	printf("%-16s %10u %10u %9.1f%% %8.2f ns\n", "ship / asteroid", nPairs, nOverlaps,
+		100.0 * (nPairs - nOverlaps) / nPairs, Time * 1.0e9 / nPairs);
+
+	for(int i=0; i<3; i++) delete pShips[i];
+}
+
+/*!****************************************************************************
+* @brief	Reuses a slot of the entity store many times, as the missiles do
+*			through the free list, and checks the handles
+* @param	nReuses Number of reuses of the slot
+* @return	0 if every live handle is found and every stale one is not
+******************************************************************************/
+int EntitiesBench(unsigned nReuses)
+{
+	TEntityStore Entities;
+											// a live entity, never removed
+	TEntity nRock = Entities.Create(ekAsteroid);
+	TEntity nPrev = ENTITY_NONE;
+
+	unsigned nLost = 0, nStale = 0;
+
+	for(unsigned i=0; i<nReuses; i++)
+	{
+		TEntity nMissile = Entities.Create(ekMissile);
+		int nIndex = Entities.Find(nMissile);
+
+		if( nIndex < 0 ) nLost++;
+		if( nPrev != ENTITY_NONE && Entities.IsValid(nPrev) ) nStale++;
+
+		if( nIndex >= 0 ) Entities.Remove(ekMissile, nIndex);
+
+		nPrev = nMissile;
+	}
+
+	if( !Entities.IsValid(nRock) ) nLost++;
+
+	printf("slot:       %u reuses, generations of %u, %u live handles lost, "
+		"%u stale handles found\n", nReuses, ENTITY_GENMASK + 1, nLost, nStale);
+
+	return nLost || nStale ? -1 : 0;
+}
+
+										// the length of the sounds, in ticks
+static const unsigned SoundTicks[snCount] =
+{
+	86, 51, 16, 52, 59, 52, 10, 7, 17, 152, 300
+};
+
+/*!****************************************************************************
+* @brief	Sound device on the stub backend: plays the sounds on the voice
+*			pool, and counts the sounds that one source per sound, the
+*			previous model, would have cut off
+******************************************************************************/
+class TStubSoundDevice : public TSoundDevice
+{
+	public:
+		TStubSoundDevice(unsigned nVoices) : m_Voices(&m_Backend, nVoices)
+		{
+			m_nCutOffs = 0;
+
+											// in order: the ids are enSound
+			for(unsigned i=0; i<snCount; i++)
+			{
+				const TSoundSetup& Sound = SoundSetups[i];
+
+				m_Sounds[Sound.pName] = m_Voices.AddTheSound(
+					m_Backend.AddTheBuffer(SoundTicks[i]),
+					Sound.nPriority, Sound.nMaxVoices);
+
+				m_Ends.push_back(0);
+			}
+		}
+
+		TSoundId FindTheSound(std::string strSound)
+		{
+			std::map<std::string, TSoundId>::iterator it = m_Sounds.find(strSound);
+
+			return it != m_Sounds.end() ? it->second : SOUND_NONE;
+		}
+
+		void PlayTheSound(TSoundId nSound, bool bLoop = false, double Pan = 0)
+		{
+			if( nSound == SOUND_NONE ) return;
+											// the single source, restarted
+			if( !bLoop )
+			{
+				unsigned nTime = m_Backend.GetTime();
+
+				if( nTime < m_Ends[nSound] ) m_nCutOffs++;
+				m_Ends[nSound] = nTime + SoundTicks[nSound];
+			}
+
+			m_Voices.Play(nSound, bLoop, Pan);
+		}
+
+		void StopTheSound(TSoundId nSound)
+		{
+			if( nSound == SOUND_NONE ) return;
+
+			m_Ends[nSound] = 0;
+			m_Voices.Stop(nSound);
+		}
+
+		void PlayTheSound(std::string strSound, bool bLoop = false)
+		{
+			PlayTheSound(FindTheSound(strSound), bLoop);
+		}
+
+		void StopTheSound(std::string strSound)
+		{
+			StopTheSound(FindTheSound(strSound));
+		}
+
+		void StopAllSounds()
+		{
+			std::fill(m_Ends.begin(), m_Ends.end(), 0);
+			m_Voices.StopAll();
+		}
+
+		void Advance() { m_Backend.Advance(); }
+
+		TVoicePool& GetVoices() { return m_Voices; }
+		unsigned GetCutOffs() { return m_nCutOffs; }
+
+	protected:
+		TStubAudioBackend m_Backend;		// before the pool, built on it
+		TVoicePool m_Voices;
+		std::map<std::string, TSoundId> m_Sounds;
+		std::vector<unsigned> m_Ends;		// of the single source per sound
+		unsigned m_nCutOffs;
+};
+
+/*!****************************************************************************
+* @brief	Plays the sounds of a game on a voice pool
+* @param	nTicks Number of ticks
+* @param	nVoices Number of voices of the pool
+******************************************************************************/
+void VoicesGame(unsigned nTicks, unsigned nVoices)
+{
+	TStubSoundDevice SoundDevice(nVoices);
+	TNullVideoDevice VideoDevice;
+	TBenchSimulation Sim(&VideoDevice, &SoundDevice, JOBSLEVEL);
+
+	unsigned nMaxBusy = 0;
+
+	for(unsigned i=0; i<nTicks; i++)
+	{
+		Sim.Play();
+		SoundDevice.Advance();
+
+		nMaxBusy = std::max(nMaxBusy, SoundDevice.GetVoices().GetBusyCount());
+	}
+
+	TVoicePoolStats Stats = SoundDevice.GetVoices().GetStats();
+
+	printf("%6u %9u %9u %9u %9u %9u %9u\n", nVoices, Stats.nPlays,
+		SoundDevice.GetCutOffs(), Stats.nRestarts, Stats.nSteals,
+		Stats.nDrops, nMaxBusy);
+}
+
+/*!****************************************************************************
+* @brief	Voice allocation and stealing of the pool, on the stub backend
+* @param	nTicks Number of ticks of the games
+******************************************************************************/
+void VoicesBench(unsigned nTicks)
+{
+	printf("game: %u ticks at level %d; cut offs: of one source per sound\n",
+		nTicks, JOBSLEVEL);
+	printf("%6s %9s %9s %9s %9s %9s %9s\n", "voices", "plays", "cut offs",
+		"restarts", "steals", "drops", "max busy");
+
+	unsigned Voices[4] = { 4, 8, VOICES_COUNT, 32 };
+
+	for(int i=0; i<4; i++) VoicesGame(nTicks, Voices[i]);
+
+											// a burst: ten asteroids exploding
+                                            // in a tick, while firing
+	TStubSoundDevice SoundDevice(VOICES_COUNT);
+
+	for(int i=0; i<4; i++) SoundDevice.PlayTheSound(snShipFire);
+	for(int i=0; i<10; i++) SoundDevice.PlayTheSound(snBangSmall);
+
+	printf("\nburst of 10 bangs: %u heard (limit %u), %u fire heard, "
+		"%u cut offs with one source per sound\n",
+		SoundDevice.GetVoices().GetPlayingCount(snBangSmall),
+		SoundSetups[snBangSmall].nMaxVoices,
+		SoundDevice.GetVoices().GetPlayingCount(snShipFire),
+		SoundDevice.GetCutOffs());
+
+											// the cost of a play, with all the
+                                            // voices busy
+	TStubAudioBackend Backend;
+	TVoicePool Pool(&Backend, VOICES_COUNT);
+
+	for(unsigned i=0; i<snCount; i++)
+	{
+		Pool.AddTheSound(Backend.AddTheBuffer(SoundTicks[i]),
+			SoundSetups[i].nPriority, SoundSetups[i].nMaxVoices);
+	}
+
+	unsigned nPlays = VOICESPLAYS;
+
+	double Time = utils::GetTime();
+	for(unsigned i=0; i<nPlays; i++)
+	{
+		Pool.Play(i % snCount);
+		if( i % 8 == 7 ) Backend.Advance();
+	}
+	Time = utils::GetTime() - Time;
+
+	printf("\nplay: %.1f ns\n", 1e9 * Time / nPlays);
+}
+
+										// a sound track of the previous sound
+                                        // manager, found by name
+struct TBenchTrack
+{
+	std::string strName;
+	TSoundId nSound;
+};
+
+/*!****************************************************************************
+* @brief	Sound device that only counts the triggers: the cost of a
+*			trigger without the voices
+******************************************************************************/
+class TTriggerSoundDevice : public TSoundDevice
+{
+	public:
+		TTriggerSoundDevice()
+		{
+			for(unsigned i=0; i<snCount; i++)
+			{
+				TBenchTrack Track;
+
+				Track.strName = SoundSetups[i].pName;
+				Track.nSound = i;
+
+				m_Sounds[Track.strName] = i;
+				m_Tracks.insert(std::make_pair(Track.strName, Track));
+			}
+
+			m_Plays.assign(snCount, 0);
+		}
+
+		TSoundId FindTheSound(std::string strSound)
+		{
+			std::map<std::string, TSoundId>::iterator it = m_Sounds.find(strSound);
+
+			return it != m_Sounds.end() ? it->second : SOUND_NONE;
+		}
+
+		void PlayTheSound(TSoundId nSound, bool bLoop = false, double Pan = 0)
+		{
+			if( nSound != SOUND_NONE ) m_Plays[nSound]++;
+		}
+
+		void StopTheSound(TSoundId nSound) {}
+
+		void PlayTheSound(std::string strSound, bool bLoop = false)
+		{
+			PlayTheSound(FindTheSound(strSound), bLoop);
+		}
+
+		void StopTheSound(std::string strSound) {}
+		void StopAllSounds() {}
+											// the trigger before the ids: the
+                                            // track copied out of the map
+		virtual void PlayTheTrack(std::string strSound, bool bLoop = false)
+		{
+			std::map<std::string, TBenchTrack>::iterator it = m_Tracks.find(strSound);
+
+			if( it == m_Tracks.end() ) return;
+
+			TBenchTrack Track = it->second;
+
+			PlayTheSound(Track.nSound, bLoop);
+		}
+
+		unsigned GetPlays()
+		{
+			unsigned nPlays = 0;
+
+			for(unsigned i=0; i<m_Plays.size(); i++) nPlays += m_Plays[i];
+
+			return nPlays;
+		}
+
+	protected:
+		std::map<std::string, TSoundId> m_Sounds;
+		std::map<std::string, TBenchTrack> m_Tracks;
+		std::vector<unsigned> m_Plays;
+};
+
+/*!****************************************************************************
+* @brief	The cost of a sound trigger: by name with a copy of the track,
+*			as before the ids, by name, and by id
+* @param	nTriggers Number of triggers of each kind
+******************************************************************************/
+void SoundsBench(unsigned nTriggers)
+{
+	TTriggerSoundDevice Device;
+	TSoundDevice* pDevice = &Device;
+	const char* pNames[snCount];
+
+	for(unsigned i=0; i<snCount; i++) pNames[i] = SoundSetups[i].pName;
+
+	const char* pModes[3] = { "name + copy", "name", "id" };
+
+	printf("%12s %10s %12s\n", "trigger", "ns", "allocations");
+
+	for(int nMode=0; nMode<3; nMode++)
+	{
+		unsigned long nAllocs = nHeapAllocs;
+		double Time = utils::GetTime();
+											// a string from the literal, as at
+                                            // the call sites before the ids
+		for(unsigned i=0; i<nTriggers; i++)
+		{
+			unsigned nSound = i % snCount;
+
+			if( nMode == 0 ) Device.PlayTheTrack(pNames[nSound]);
+			else if( nMode == 1 ) pDevice->PlayTheSound(pNames[nSound]);
+			else pDevice->PlayTheSound(TSoundId(nSound));
+		}
+
+		Time = utils::GetTime() - Time;
+		nAllocs = nHeapAllocs - nAllocs;
+
+		printf("%12s %10.1f %12.2f\n", pModes[nMode], 1e9 * Time / nTriggers,
+			double(nAllocs) / nTriggers);
+	}
+
+	printf("\nplays: %u\n", Device.GetPlays());
+}
+
+/*!****************************************************************************
+* @brief	Makes the PCM data of a sound, as read from a WAV file: a noise
+*			burst fading out
+* @param	nFrames Number of frames
+* @param	nChannels 1 for mono, 2 for stereo
+* @param	nBps The bits per sample, 8 or 16
+* @param	Random The generator of the noise
+* @return	The samples: 8 bit unsigned or 16 bit signed little endian
+******************************************************************************/
+std::vector<char> MakeTheSound(unsigned nFrames, int nChannels, int nBps,
+	maths::TRandom& Random)
+{
+	std::vector<char> Data(nFrames * nChannels * nBps / 8);
+
+	for(unsigned i=0; i<nFrames * nChannels; i++)
+	{
+		double Value = Random.Rand(1.0) * (1.0 - double(i) / (nFrames * nChannels));
+
+		if( nBps == 8 )
+		{
+			Data[i] = char(128 + int(127 * Value));
+		}
+		else
+		{
+			short nValue = short(32767 * Value);
+
+			Data[2*i] = char(nValue & 0xFF);
+			Data[2*i + 1] = char((nValue >> 8) & 0xFF);
+		}
+	}
+
+	return Data;
+}
+
+/*!****************************************************************************
+* @brief	Adds the sounds of the game to a mixer and to its voice pool, in
+*			all the formats of the WAV files, some at half rate
+* @param	Mixer The mixer
+* @param	Voices The voice pool on the mixer
+******************************************************************************/
+void AddTheSounds(TSoftMixer& Mixer, TVoicePool& Voices)
+{
+	maths::TRandom Random(DEFSEED);
+
+	for(unsigned i=0; i<snCount; i++)
+	{
+		int nChannels = 1 + i % 2, nBps = i % 4 < 2 ? 16 : 8;
+		unsigned nRate = i % 5 == 4 ? MIXER_RATE / 2 : MIXER_RATE;
+		unsigned nFrames = SoundTicks[i] * nRate / FPS;
+
+		std::vector<char> Data = MakeTheSound(nFrames, nChannels, nBps, Random);
+
+		unsigned nBuffer = Mixer.AddTheBuffer(&Data[0], nChannels, nRate, nBps,
+			Data.size());
+
+		Voices.AddTheSound(nBuffer, SoundSetups[i].nPriority,
+			SoundSetups[i].nMaxVoices);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Sound device on the software mixer
+******************************************************************************/
+class TMixerSoundDevice : public TSoundDevice
+{
+	public:
+		TMixerSoundDevice() : m_Voices(&m_Mixer, MIXER_VOICES)
+		{
+			AddTheSounds(m_Mixer, m_Voices);
+		}
+
+		TSoundId FindTheSound(std::string strSound)
+		{
+			for(unsigned i=0; i<snCount; i++)
+			{
+				if( strSound == SoundSetups[i].pName ) return i;
+			}
+
+			return SOUND_NONE;
+		}
+
+		void PlayTheSound(TSoundId nSound, bool bLoop = false, double Pan = 0)
+		{
+			m_Voices.Play(nSound, bLoop, Pan);
+		}
+
+		void StopTheSound(TSoundId nSound) { m_Voices.Stop(nSound); }
+
+		void PlayTheSound(std::string strSound, bool bLoop = false)
+		{
+			PlayTheSound(FindTheSound(strSound), bLoop);
+		}
+
+		void StopTheSound(std::string strSound)
+		{
+			StopTheSound(FindTheSound(strSound));
+		}
+
+		void StopAllSounds() { m_Voices.StopAll(); }
+
+		TSoftMixer& GetMixer() { return m_Mixer; }
+
+	protected:
+		TSoftMixer m_Mixer;				// before the pool, built on it
+		TVoicePool m_Voices;
+};
+
+/*!****************************************************************************
+* @brief	The cost of the software mixer, and a game mixed to a WAV file
+* @param	Seconds The seconds of audio mixed, for the timing
+* @param	pFileName The WAV file of the game, NULL for none
+* @return	0 if the pan is right and the file is written
+******************************************************************************/
+int MixerBench(double Seconds, const char* pFileName)
+{
+	int nResult = 0;
+										// the pan: a constant on the left,
+                                        // the center and the right
+	TSoftMixer Mixer;
+	std::vector<char> Data(4 * MIXER_BLOCK);
+	std::vector<short> Frames(2 * MIXER_BLOCK);
+
+	for(unsigned i=0; i<Data.size(); i += 2) { Data[i] = 0; Data[i + 1] = 0x40; }
+
+	unsigned nBuffer = Mixer.AddTheBuffer(&Data[0], 1, MIXER_RATE, 16, Data.size());
+	unsigned nSource = Mixer.CreateTheSource();
+	double Pans[3] = { -1.0, 0.0, 1.0 };
+	short nLeft[3], nRight[3];
+
+	for(int i=0; i<3; i++)
+	{
+		Mixer.Play(nSource, nBuffer, false, 1.0, Pans[i]);
+		Mixer.Render(&Frames[0], 16);
+
+		nLeft[i] = Frames[0];
+		nRight[i] = Frames[1];
+	}
+
+	bool bPan = nLeft[0] > 0 && nRight[0] == 0 && nLeft[1] == nRight[1]
+		&& nLeft[1] > 0 && nLeft[2] == 0 && nRight[2] > 0;
+
+	printf("kernels:    %s\n", TSoftMixer::GetKernelsName());
+	printf("pan:        left %d/%d, center %d/%d, right %d/%d: %s\n",
+		nLeft[0], nRight[0], nLeft[1], nRight[1], nLeft[2], nRight[2],
+		bPan ? "ok" : "FAILED");
+
+	if( !bPan ) nResult = -1;
+										// all the voices busy, looping
+	TSoftMixer LoadMixer;
+	TVoicePool Voices(&LoadMixer, MIXER_VOICES);
+
+	AddTheSounds(LoadMixer, Voices);
+
+	for(unsigned i=0; i<MIXER_VOICES; i++)
+	{
+		Voices.SetTheLimits(i % snCount, 0, VOICES_NOLIMIT);
+		Voices.SetTheGain(i % snCount, 0.25);
+		Voices.Play(i % snCount, true, -1.0 + 2.0 * i / (MIXER_VOICES - 1));
+	}
+
+	LoadMixer.SetMasterVolume(0.5);
+
+	unsigned nBlocks = unsigned(Seconds * MIXER_RATE / MIXER_BLOCK);
+	nBlocks = std::max(nBlocks, 1u);
+
+	double Time = utils::GetTime();
+
+	for(unsigned i=0; i<nBlocks; i++) LoadMixer.Render(&Frames[0], MIXER_BLOCK);
+
+	Time = utils::GetTime() - Time;
+
+	double Audio = double(nBlocks) * MIXER_BLOCK / MIXER_RATE;
+
+	printf("load:       %u voices at %d Hz, %.1f KB of samples\n",
+		LoadMixer.GetPlayingCount(), MIXER_RATE, LoadMixer.GetMemory() / 1024.0);
+	printf("mix:        %.1f us per block of %d frames, %.2f%% of a core\n",
+		1e6 * Time / nBlocks, MIXER_BLOCK, 100.0 * Time / Audio);
+
+										// a game, a tick of frames at a time
+	TMixerSoundDevice SoundDevice;
+	TNullVideoDevice VideoDevice;
+	TBenchSimulation Sim(&VideoDevice, &SoundDevice, JOBSLEVEL);
+	TWavSink Sink;
+
+	if( pFileName && !Sink.Open(pFileName, MIXER_RATE) )
+	{
+		printf("cannot write %s\n", pFileName);
+		return -1;
+	}
+
+	SoundDevice.GetMixer().SetMasterVolume(0.25);
+
+	std::vector<short> Tick(2 * MIXER_RATE / FPS);
+	unsigned nPeak = 0, nClipped = 0;
+
+	for(unsigned i=0; i<MIXERTICKS; i++)
+	{
+		Sim.Play();
+
+		SoundDevice.GetMixer().Render(&Tick[0], MIXER_RATE / FPS);
+		Sink.Write(&Tick[0], MIXER_RATE / FPS);
+
+		nPeak = std::max(nPeak, SoundDevice.GetMixer().GetPlayingCount());
+
+		for(unsigned j=0; j<Tick.size(); j++)
+		{
+			nClipped += Tick[j] == 32767 || Tick[j] == -32768;
+		}
+	}
+
+	printf("game:       %u ticks, %u voices at most, %u samples clipped\n",
+		MIXERTICKS, nPeak, nClipped);
+
+	if( pFileName )
+	{
+		printf("wav:        %s, %u frames\n", pFileName, Sink.GetFramesCount());
+		Sink.Close();
+	}
+
+	return nResult;
+}
+
+/*!****************************************************************************
+* @brief	Appends a little endian integer
+* @param	Bytes The bytes
+* @param	nValue The value
+* @param	nBytes The size of the integer, 2 or 4 bytes
+******************************************************************************/
+void PutTheInt(std::vector<char>& Bytes, unsigned nValue, int nBytes)
+{
+	for(int i=0; i<nBytes; i++) Bytes.push_back(char((nValue >> (8*i)) & 0xFF));
+}
+
+/*!****************************************************************************
+* @brief	Appends a chunk, padded to an even size
+* @param	Bytes The bytes
+* @param	pId The id of the chunk
+* @param	Body The bytes of the chunk
+* @param	bPad False for leaving out the padding of an odd size
+******************************************************************************/
+void PutTheChunk(std::vector<char>& Bytes, const char* pId,
+	const std::vector<char>& Body, bool bPad = true)
+{
+	Bytes.insert(Bytes.end(), pId, pId + 4);
+	PutTheInt(Bytes, Body.size(), 4);
+	Bytes.insert(Bytes.end(), Body.begin(), Body.end());
+
+	if( bPad && Body.size() % 2 ) Bytes.push_back(0);
+}
+
+/*!****************************************************************************
+* @brief	Makes the body of a "fmt " chunk
+* @param	nFormat The format tag, WAV_FORMATEXT for the extensible format
+*			of PCM
+* @param	nChannels Number of channels
+* @param	nRate The frames per second
+* @param	nBps The bits per sample
+* @param	nSize The size of the chunk: 16, 18, or 40 for the extensible
+* @return	The bytes of the chunk
+******************************************************************************/
+std::vector<char> MakeTheFormat(unsigned nFormat, unsigned nChannels,
+	unsigned nRate, unsigned nBps, unsigned nSize = 16)
+{
+	std::vector<char> Body;
+
+	PutTheInt(Body, nFormat, 2);
+	PutTheInt(Body, nChannels, 2);
+	PutTheInt(Body, nRate, 4);
+	PutTheInt(Body, nRate * nChannels * nBps / 8, 4);
+	PutTheInt(Body, nChannels * nBps / 8, 2);
+	PutTheInt(Body, nBps, 2);
+
+	if( nSize > 16 ) PutTheInt(Body, nSize - 18, 2);
+											// valid bits, mask, subformat
+	if( nSize == 40 )
+	{
+		PutTheInt(Body, nBps, 2);
+		PutTheInt(Body, 3, 4);
+		PutTheInt(Body, WAV_FORMATPCM, 2);
+		Body.resize(40, 0x10);
+	}
+
+	return Body;
+}
+
+/*!****************************************************************************
+* @brief	Wraps the chunks in a RIFF WAVE chunk
+* @param	Chunks The bytes of the chunks
+* @param	nExtra Bytes added to the size of the RIFF chunk
+* @return	The bytes of the file
+******************************************************************************/
+std::vector<char> MakeTheWav(const std::vector<char>& Chunks, unsigned nExtra = 0)
+{
+	std::vector<char> Bytes;
+
+	Bytes.insert(Bytes.end(), "RIFF", "RIFF" + 4);
+	PutTheInt(Bytes, 4 + Chunks.size() + nExtra, 4);
+	Bytes.insert(Bytes.end(), "WAVE", "WAVE" + 4);
+	Bytes.insert(Bytes.end(), Chunks.begin(), Chunks.end());
+
+	return Bytes;
+}
+
+										// a file of the corpus, and what the
+                                        // parser must find in it
+struct TWavCase
+{
+	const char* pName;
+	std::vector<char> Bytes;
+	bool bValid;
+	unsigned nData;						// size of the samples, if valid
+};
+
+/*!****************************************************************************
+* @brief	Parses a file, from a heap block of its exact size: a read past
+*			its end is caught by the checkers of the heap
+* @param	Bytes The bytes of the file
+* @param	Info The result of the parser
+* @return	True if parsed, false if rejected
+******************************************************************************/
+bool ParseTheCase(const std::vector<char>& Bytes, TWavInfo& Info)
+{
+	unsigned nSize = Bytes.size();
+	char* pBytes = new char[nSize ? nSize : 1];
+
+	if( nSize ) memcpy(pBytes, &Bytes[0], nSize);
+
+	bool bResult = ParseTheWav(pBytes, nSize, Info);
+											// the samples within the file
+	if( bResult && (Info.pData < pBytes || Info.pData + Info.nSize > pBytes + nSize) )
+	{
+		printf("data out of the file\n");
+		bResult = false;
+	}
+
+	delete [] pBytes;
+
+	return bResult;
+}
+
+/*!****************************************************************************
+* @brief	Builds the corpus: files that must be parsed, files that must be
+*			rejected
+* @param	Cases The corpus
+******************************************************************************/
+void BuildTheCorpus(std::vector<TWavCase>& Cases)
+{
+	std::vector<char> Data(1000, 0x40), Odd(999, 0x40), List(11, 'x'), Fact(4, 0);
+	std::vector<char> Fmt16 = MakeTheFormat(WAV_FORMATPCM, 2, 44100, 16);
+	std::vector<char> C;
+
+	TWavCase Case;
+
+#define WAVCASE(Name, Valid, Size) \
+	Case.pName = Name; Case.Bytes = MakeTheWav(C); Case.bValid = Valid; \
+	Case.nData = Size; Cases.push_back(Case); C.clear();
+
+	PutTheChunk(C, "fmt ", Fmt16); PutTheChunk(C, "data", Data);
+	WAVCASE("pcm16 stereo", true, 1000);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATPCM, 1, 22050, 8)); PutTheChunk(C, "data", Odd);
+	WAVCASE("pcm8 mono, odd data", true, 999);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATPCM, 2, 44100, 16, 18)); PutTheChunk(C, "data", Data);
+	WAVCASE("fmt 18 bytes", true, 1000);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATEXT, 2, 48000, 16, 40)); PutTheChunk(C, "data", Data);
+	WAVCASE("extensible", true, 1000);
+
+	PutTheChunk(C, "LIST", List); PutTheChunk(C, "fmt ", Fmt16); PutTheChunk(C, "fact", Fact);
+	PutTheChunk(C, "data", Data); PutTheChunk(C, "LIST", List);
+	WAVCASE("LIST and fact", true, 1000);
+
+	PutTheChunk(C, "data", Data); PutTheChunk(C, "fmt ", Fmt16);
+	WAVCASE("data before fmt", true, 1000);
+
+	PutTheChunk(C, "fmt ", Fmt16); PutTheChunk(C, "data", Odd);
+	WAVCASE("partial frame", true, 996);
+
+	PutTheChunk(C, "fmt ", Fmt16); PutTheChunk(C, "LIST", List, false);
+	WAVCASE("no data", false, 0);
+
+	PutTheChunk(C, "data", Data);
+	WAVCASE("no fmt", false, 0);
+
+	PutTheChunk(C, "fmt ", std::vector<char>(Fmt16.begin(), Fmt16.begin() + 14)); PutTheChunk(C, "data", Data);
+	WAVCASE("fmt too short", false, 0);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(3, 2, 44100, 32)); PutTheChunk(C, "data", Data);
+	WAVCASE("float", false, 0);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATPCM, 6, 44100, 16)); PutTheChunk(C, "data", Data);
+	WAVCASE("6 channels", false, 0);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATPCM, 2, 44100, 24)); PutTheChunk(C, "data", Data);
+	WAVCASE("24 bits", false, 0);
+
+	PutTheChunk(C, "fmt ", MakeTheFormat(WAV_FORMATPCM, 2, 0, 16)); PutTheChunk(C, "data", Data);
+	WAVCASE("rate 0", false, 0);
+
+#undef WAVCASE
+											// the ones that cannot be built
+                                            // from good chunks
+	std::vector<char> Bytes = Cases[0].Bytes;
+	unsigned nFmt = 12 + 8;
+
+	Case.bValid = false;
+	Case.nData = 0;
+
+	Case.pName = "not RIFF";
+	Case.Bytes = Bytes; Case.Bytes[0] = 'X'; Cases.push_back(Case);
+
+	Case.pName = "not WAVE";
+	Case.Bytes = Bytes; Case.Bytes[8] = 'X'; Cases.push_back(Case);
+
+	Case.pName = "bad block align";
+	Case.Bytes = Bytes; Case.Bytes[nFmt + 12] = 3; Cases.push_back(Case);
+
+	Case.pName = "data past the end";
+	Case.Bytes = Bytes; Case.Bytes.resize(Bytes.size() - 1); Cases.push_back(Case);
+
+	Case.pName = "huge chunk";
+	Case.Bytes = Bytes; Case.Bytes[nFmt - 1] = char(0xFF); Cases.push_back(Case);
+
+	Case.pName = "empty";
+	Case.Bytes.clear(); Cases.push_back(Case);
+
+	Case.pName = "RIFF size past the end";
+	Case.Bytes = MakeTheWav(std::vector<char>(Bytes.begin() + 12, Bytes.end()), 100000);
+	Case.bValid = true;
+	Case.nData = 1000;
+	Cases.push_back(Case);
+}
+
+/*!****************************************************************************
+* @brief	The WAV parser on a corpus of files, truncated and mutated, then
+*			the loads of the files given
+* @param	nFiles Number of files
+* @param	pFiles The names of the files
+* @return	0 if the corpus is parsed as expected and the files are loaded
+******************************************************************************/
+int WavBench(int nFiles, char* pFiles[])
+{
+	int nResult = 0;
+
+	std::vector<TWavCase> Cases;
+	BuildTheCorpus(Cases);
+
+	TWavInfo Info;
+	unsigned nWrong = 0;
+
+	for(unsigned i=0; i<Cases.size(); i++)
+	{
+		bool bParsed = ParseTheCase(Cases[i].Bytes, Info);
+		bool bRight = bParsed == Cases[i].bValid && (!bParsed || Info.nSize == Cases[i].nData);
+
+		printf("%-24s %-8s %s\n", Cases[i].pName, bParsed ? "parsed" : "rejected",
+			bRight ? "" : "WRONG");
+
+		nWrong += !bRight;
+	}
+										// every truncation of every file,
+                                        // then random bytes changed
+	unsigned nParsed = 0, nRejected = 0, nTries = 0;
+
+	for(unsigned i=0; i<Cases.size(); i++)
+	{
+		for(unsigned n=0; n<Cases[i].Bytes.size(); n++, nTries++)
+		{
+			std::vector<char> Bytes(Cases[i].Bytes.begin(), Cases[i].Bytes.begin() + n);
+
+			if( ParseTheCase(Bytes, Info) ) nParsed++;
+			else nRejected++;
+		}
+	}
+
+	maths::TRandom Random(DEFSEED);
+
+	for(unsigned i=0; i<WAVMUTATIONS; i++, nTries++)
+	{
+		std::vector<char> Bytes = Cases[Random.Next() % Cases.size()].Bytes;
+
+		if( Bytes.empty() ) continue;
+
+		unsigned nChanges = 1 + Random.Next() % 4;
+
+		for(unsigned j=0; j<nChanges; j++)
+		{
+											// the headers, mostly
+			unsigned nPos = Random.Next() % std::min(unsigned(Bytes.size()), 64u);
+
+			Bytes[nPos] = char(Random.Next());
+		}
+
+		if( ParseTheCase(Bytes, Info) ) nParsed++;
+		else nRejected++;
+	}
+
+	printf("\ncorpus:     %u files, %u wrong\n", unsigned(Cases.size()), nWrong);
+	printf("fuzz:       %u files, %u parsed, %u rejected, none read out of bounds\n",
+		nTries, nParsed, nRejected);
+
+	if( nWrong ) nResult = -1;
+										// the files, mapped
+	if( nFiles > 0 )
+	{
+		printf("\n");
+
+		unsigned long nAllocs = nHeapAllocs;
+		double Time = utils::GetTime();
+
+		for(int i=0; i<nFiles; i++)
+		{
+			TMappedFile File;
+
+			if( !File.Open(pFiles[i]) || !ParseTheWav(File.GetData(), File.GetSize(), Info) )
+			{
+				printf("%s: %s\n", pFiles[i], File.IsOpen() ? Info.pError : "cannot map");
+				nResult = -1;
+				continue;
+			}
+
+			printf("%s: %d ch, %d Hz, %d bits, %u bytes\n", pFiles[i],
+				Info.nChannels, Info.nSampleRate, Info.nBps, Info.nSize);
+		}
+
+		Time = utils::GetTime() - Time;
+		nAllocs = nHeapAllocs - nAllocs;
+
+		printf("\nload:       %d files in %.3f ms, %lu allocations\n", nFiles,
+			1e3 * Time, nAllocs);
+	}
+
+	return nResult;
+}
+
+/*!****************************************************************************
+* @brief	Compresses a block, and checks that it comes back
+* @param	Data The data
+* @param[out]	Block The compressed block
+* @return	True if decompressed to the same data
+******************************************************************************/
+bool RoundTheTrip(const std::vector<char>& Data, std::vector<char>& Block)
+{
+	unsigned nSize = Data.size();
+
+	Block.resize(LZ4GetBound(nSize));
+	Block.resize(LZ4Compress(nSize ? &Data[0] : "", nSize, &Block[0]));
+
+	std::vector<char> Copy(nSize + 1);
+
+	return LZ4Decompress(&Block[0], Block.size(), &Copy[0], nSize) &&
+		std::equal(Data.begin(), Data.end(), Copy.begin());
+}
+
+/*!****************************************************************************
+* @brief	Decompresses a block from a heap block of its exact size, into one
+*			of the exact size of the data: a read or a write out of bounds is
+*			caught by the checkers of the heap
+* @param	Block The compressed block
+* @param	nSize The size of the data
+* @return	True if decompressed
+******************************************************************************/
+bool DecompressTheCase(const std::vector<char>& Block, unsigned nSize)
+{
+	char* pBlock = new char[Block.size() ? Block.size() : 1];
+	char* pData = new char[nSize ? nSize : 1];
+
+	if( Block.size() ) memcpy(pBlock, &Block[0], Block.size());
+
+	bool bResult = LZ4Decompress(pBlock, Block.size(), pData, nSize);
+
+	delete [] pData;
+	delete [] pBlock;
+
+	return bResult;
+}
+
+/*!****************************************************************************
+* @brief	Evicts a file from the cache of the system, for a cold load
+* @param	pFileName The name of the file
+******************************************************************************/
+void EvictTheFile(const char* pFileName)
+{
+#ifndef _WIN32
+	int nFile = open(pFileName, O_RDONLY);
+
+	if( nFile >= 0 )
+	{
+		posix_fadvise(nFile, 0, 0, POSIX_FADV_DONTNEED);
+		close(nFile);
+	}
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Adds up the bytes of an asset, so that every page is read
+* @param	pData Pointer to the data
+* @param	nSize The size of the data
+* @return	The sum
+******************************************************************************/
+unsigned SumTheBytes(const char* pData, unsigned nSize)
+{
+	unsigned nSum = 0;
+
+	for(unsigned i=0; i<nSize; i++) nSum += (unsigned char) pData[i];
+
+	return nSum;
+}
+
+/*!****************************************************************************
+* @brief	Gets the data files of the game read at startup, that are in the
+*			data folder
+* @param	strPath The data folder
+* @param[out]	strAssets The names of the files
+******************************************************************************/
+void GetTheAssets(const std::string& strPath, std::vector<std::string>& strAssets)
+{
+	std::vector<std::string> strNames;
+
+	for(unsigned i=0; i<snCount; i++)
+	{
+		strNames.push_back(std::string(SoundSetups[i].pName) + ".wav");
+	}
+
+	strNames.push_back(FONTFILE);
+	strNames.push_back(HELPFILE);
+	strNames.push_back(SCORESFILE);
+
+	for(unsigned i=0; i<strNames.size(); i++)
+	{
+		TMappedFile File;
+
+		if( File.Open((strPath + strNames[i]).c_str()) ) strAssets.push_back(strNames[i]);
+		else printf("%s: missing\n", strNames[i].c_str());
+	}
+}
+
+/*!****************************************************************************
+* @brief	Checks for the name of a sound
+* @param	strName The name of the asset
+* @return	True if a WAV file
+******************************************************************************/
+bool IsTheSound(const std::string& strName)
+{
+	return strName.size() > 4 && strName.compare(strName.size() - 4, 4, ".wav") == 0;
+}
+
+/*!****************************************************************************
+* @brief	Loads the assets of the game from their files, as before the pack:
+*			a sound is mapped and parsed, the others are read
+* @param	strPath The data folder
+* @param	strAssets The names of the assets
+* @return	The sum of the bytes used, 0 if an asset cannot be read
+******************************************************************************/
+unsigned LoadTheFiles(const std::string& strPath, const std::vector<std::string>& strAssets)
+{
+	unsigned nSum = 0;
+
+	for(unsigned i=0; i<strAssets.size(); i++)
+	{
+		TMappedFile File;
+		TWavInfo Info;
+
+		if( !File.Open((strPath + strAssets[i]).c_str()) ) return 0;
+
+		if( IsTheSound(strAssets[i]) )
+		{
+			if( !ParseTheWav(File.GetData(), File.GetSize(), Info) ) return 0;
+
+			nSum += SumTheBytes(Info.pData, Info.nSize);
+		}
+		else
+		{
+			nSum += SumTheBytes(File.GetData(), File.GetSize());
+		}
+	}
+
+	return nSum;
+}
+
+/*!****************************************************************************
+* @brief	Loads the assets of the game from a pack
+* @param	strPackFile The name of the pack
+* @param	strAssets The names of the assets
+* @return	The sum of the bytes used, 0 if an asset cannot be read
+******************************************************************************/
+unsigned LoadThePack(const std::string& strPackFile, const std::vector<std::string>& strAssets)
+{
+	unsigned nSum = 0;
+
+	TAssetPack Pack;
+
+	if( !Pack.Open(strPackFile.c_str()) ) return 0;
+
+	for(unsigned i=0; i<strAssets.size(); i++)
+	{
+		const char* pData;
+		unsigned nSize;
+		TWavInfo Info;
+
+		if( !Pack.Read(strAssets[i].c_str(), pData, nSize) ) return 0;
+
+		if( IsTheSound(strAssets[i]) )
+		{
+			if( !ParseTheWav(pData, nSize, Info) ) return 0;
+
+			nSum += SumTheBytes(Info.pData, Info.nSize);
+		}
+		else
+		{
+			nSum += SumTheBytes(pData, nSize);
+		}
+	}
+
+	return nSum;
+}
+
+/*!****************************************************************************
+* @brief	Times the loads of the assets of the game, cold (the files out of
+*			the cache of the system) and warm
+* @param	pName The name of the way of loading
+* @param	strPath The data folder
+* @param	strPackFile The name of the pack, or empty for the files
+* @param	strAssets The names of the assets
+* @param	nSum The sum of the bytes, the same for every way
+* @return	True if the bytes loaded are the right ones
+******************************************************************************/
+bool TimeTheLoads(const char* pName, const std::string& strPath,
+	const std::string& strPackFile, const std::vector<std::string>& strAssets,
+	unsigned nSum)
+{
+	double Cold = 0, Warm = 0;
+	unsigned nLoaded = 0;
+
+	for(unsigned i=0; i<PACKCOLDLOADS; i++)
+	{
+		if( strPackFile.empty() )
+		{
+			for(unsigned j=0; j<strAssets.size(); j++) EvictTheFile((strPath + strAssets[j]).c_str());
+		}
+		else
+		{
+			EvictTheFile(strPackFile.c_str());
+		}
+
+		double Time = utils::GetTime();
+
+		nLoaded = strPackFile.empty() ? LoadTheFiles(strPath, strAssets) :
+			LoadThePack(strPackFile, strAssets);
+
+		Cold += utils::GetTime() - Time;
+	}
+
+	unsigned long nAllocs = nHeapAllocs;
+	double Time = utils::GetTime();
+
+	for(unsigned i=0; i<PACKWARMLOADS; i++)
+	{
+		nLoaded = strPackFile.empty() ? LoadTheFiles(strPath, strAssets) :
+			LoadThePack(strPackFile, strAssets);
+	}
+
+	Warm = utils::GetTime() - Time;
+	nAllocs = nHeapAllocs - nAllocs;
+
+	unsigned nOpens = strPackFile.empty() ? strAssets.size() : 1;
+
+	printf("%-20s %10.3f %10.3f %8u %10.1f %s\n", pName,
+		1e3 * Cold / PACKCOLDLOADS, 1e3 * Warm / PACKWARMLOADS, nOpens,
+		double(nAllocs) / PACKWARMLOADS, nLoaded == nSum ? "" : "WRONG");
+
+	return nLoaded == nSum;
+}
+
+/*!****************************************************************************
+* @brief	The LZ4 codec and the asset pack on synthetic data, then the
+*			startup loads of the data files of the game, one by one vs.
+*			from a pack, if a data folder is given
+* @param	pDataPath The data folder of the game, or NULL
+* @return	0 if every check passes
+******************************************************************************/
+int PackBench(const char* pDataPath)
+{
+	int nResult = 0;
+
+	maths::TRandom Random(DEFSEED);
+										// data of every kind: short, runs,
+                                        // noise, text, and samples
+	std::vector< std::vector<char> > Cases;
+	const char* pNames[] = {
+		"empty", "1 byte", "12 bytes", "13 bytes", "zeros", "noise",
+		"text", "sine"
+	};
+
+	Cases.push_back(std::vector<char>());
+	Cases.push_back(std::vector<char>(1, 'a'));
+	Cases.push_back(std::vector<char>(12, 'a'));
+	Cases.push_back(std::vector<char>(13, 'a'));
+	Cases.push_back(std::vector<char>(1024 * 1024, 0));
+	Cases.push_back(std::vector<char>(64 * 1024));
+
+	for(unsigned i=0; i<Cases.back().size(); i++) Cases.back()[i] = char(Random.Next());
+
+	Cases.push_back(std::vector<char>());
+
+	for(unsigned i=0; i<2000; i++)
+	{
+		char Line[64];
+		sprintf(Line, "Level %u: %u asteroids, %u points\n", i, Random.Next() % 40,
+			Random.Next() % 100 * 10);
+
+		Cases.back().insert(Cases.back().end(), Line, Line + strlen(Line));
+	}
+
+	Cases.push_back(std::vector<char>(200000));
+
+	for(unsigned i=0; i<Cases.back().size(); i++) Cases.back()[i] = char(100 * sin(i * 0.05));
+
+	unsigned nWrong = 0;
+	std::vector<char> Block;
+
+	printf("%-12s %10s %10s %8s %10s %10s %s\n", "data", "size", "block", "ratio",
+		"comp MB/s", "dec MB/s", "");
+
+	for(unsigned i=0; i<Cases.size(); i++)
+	{
+		bool bRight = RoundTheTrip(Cases[i], Block);
+		unsigned nSize = Cases[i].size();
+
+		double CompTime = 0, DecompTime = 0;
+		unsigned nReps = 1 + LZ4BYTES / (nSize + 1);
+
+		if( nSize )
+		{
+			std::vector<char> Temp(LZ4GetBound(nSize)), Copy(nSize);
+
+			double Time = utils::GetTime();
+
+			for(unsigned j=0; j<nReps; j++) LZ4Compress(&Cases[i][0], nSize, &Temp[0]);
+
+			CompTime = utils::GetTime() - Time;
+			Time = utils::GetTime();
+
+			for(unsigned j=0; j<nReps; j++) LZ4Decompress(&Block[0], Block.size(), &Copy[0], nSize);
+
+			DecompTime = utils::GetTime() - Time;
+		}
+
+		double MBytes = double(nSize) * nReps / (1024.0 * 1024.0);
+
+		printf("%-12s %10u %10u %7.1f%% %10.0f %10.0f %s\n", pNames[i], nSize,
+			unsigned(Block.size()), nSize ? 100.0 * Block.size() / nSize : 0.0,
+			CompTime > 0 ? MBytes / CompTime : 0.0,
+			DecompTime > 0 ? MBytes / DecompTime : 0.0, bRight ? "" : "WRONG");
+
+		nWrong += !bRight;
+	}
+										// every truncation of a block, then
+                                        // random bytes changed
+	unsigned nDecompressed = 0, nRejected = 0, nTries = 0;
+	unsigned nSmall = LZ4FUZZBYTES;
+
+	RoundTheTrip(std::vector<char>(Cases[6].begin(), Cases[6].begin() + nSmall), Block);
+
+	for(unsigned n=0; n<Block.size(); n++, nTries++)
+	{
+		std::vector<char> Bytes(Block.begin(), Block.begin() + n);
+
+		if( DecompressTheCase(Bytes, nSmall) ) nDecompressed++;
+		else nRejected++;
+	}
+
+	for(unsigned i=0; i<LZ4MUTATIONS; i++, nTries++)
+	{
+		std::vector<char> Bytes = Block;
+		unsigned nChanges = 1 + Random.Next() % 4;
+
+		for(unsigned j=0; j<nChanges; j++) Bytes[Random.Next() % Bytes.size()] = char(Random.Next());
+
+		if( DecompressTheCase(Bytes, nSmall) ) nDecompressed++;
+		else nRejected++;
+	}
+
+	printf("\ncodec:      %u blocks, %u wrong\n", unsigned(Cases.size()), nWrong);
+	printf("fuzz:       %u blocks, %u decompressed, %u rejected, none out of bounds\n",
+		nTries, nDecompressed, nRejected);
+										// a pack of the cases, stored and
+                                        // compressed, read back
+	TAssetPackBuilder Builder;
+
+	for(unsigned i=0; i<Cases.size(); i++)
+	{
+		std::string strName = std::string(pNames[i]) + (i % 2 ? ".bin" : ".lz4");
+
+		Builder.Add(strName.c_str(), Cases[i].empty() ? "" : &Cases[i][0],
+			Cases[i].size(), i % 2 == 0);
+	}
+
+	unsigned nPackWrong = !Builder.Save(DEFPACKFILE);
+
+	TAssetPack Pack;
+
+	if( !Pack.Open(DEFPACKFILE) ) nPackWrong++;
+
+	for(unsigned i=0; i<Cases.size() && Pack.IsOpen(); i++)
+	{
+		std::string strName = std::string(pNames[i]) + (i % 2 ? ".bin" : ".lz4");
+		int nEntry = Pack.Find(strName.c_str());
+
+		const char* pData;
+		unsigned nSize;
+
+		if( nEntry == PACK_NONE || !Pack.Read(nEntry, pData, nSize) || nSize != Cases[i].size() ||
+			!std::equal(Cases[i].begin(), Cases[i].end(), pData) ||
+			(Pack.GetEntry(nEntry).nOffset % PACK_ALIGN) )
+		{
+			printf("%s: WRONG\n", strName.c_str());
+			nPackWrong++;
+		}
+	}
+
+	if( Pack.Find("missing.bin") != PACK_NONE ) nPackWrong++;
+										// each truncation of the file is not
+                                        // a pack, but for the last bytes of
+                                        // the data of the last entry
+	std::vector<char> Bytes;
+	Builder.Build(Bytes);
+
+	unsigned nTruncations = 0;
+
+	for(unsigned n=0; n<Bytes.size(); n += 1 + n / 64)
+	{
+		FILE* fp = fopen(DEFPACKFILE, "wb");
+		fwrite(&Bytes[0], 1, n, fp);
+		fclose(fp);
+
+		if( Pack.Open(DEFPACKFILE) ) nPackWrong++;
+
+		nTruncations++;
+	}
+
+	Pack.Close();
+	remove(DEFPACKFILE);
+
+	printf("pack:       %u entries, %u truncations rejected, %u wrong\n",
+		Builder.GetAssetsCount(), nTruncations, nPackWrong);
+
+	if( nWrong || nPackWrong ) nResult = -1;
+
+	if( !pDataPath ) return nResult;
+										// the startup loads of the game
+	std::string strPath = std::string(pDataPath) + "/";
+	std::vector<std::string> strAssets;
+
+	printf("\n");
+	GetTheAssets(strPath, strAssets);
+
+	unsigned nSum = LoadTheFiles(strPath, strAssets);
+
+	if( strAssets.empty() || !nSum )
+	{
+		printf("%s: the data files cannot be read\n", pDataPath);
+		return -1;
+	}
+										// sounds stored, the rest compressed
+                                        // as by the packer; then everything
+                                        // compressed, where it pays
+	TAssetPackBuilder Stored, Compressed;
+
+	for(unsigned i=0; i<strAssets.size(); i++)
+	{
+		std::string strFile = strPath + strAssets[i];
+
+		Stored.AddTheFile(strFile.c_str(), !IsTheSound(strAssets[i]));
+		Compressed.AddTheFile(strFile.c_str(), true);
+	}
+
+	Stored.Save(DEFPACKFILE);
+	Compressed.Save(LZ4PACKFILE);
+
+	TMappedFile StoredFile, CompressedFile;
+	StoredFile.Open(DEFPACKFILE);
+	CompressedFile.Open(LZ4PACKFILE);
+
+	printf("\nassets:     %u files, pack %u bytes, compressed pack %u bytes\n",
+		unsigned(strAssets.size()), StoredFile.GetSize(), CompressedFile.GetSize());
+
+	StoredFile.Close();
+	CompressedFile.Close();
+
+	printf("\n%-20s %10s %10s %8s %10s\n", "load", "cold [ms]", "warm [ms]", "opens", "allocs");
+
+	if( !TimeTheLoads("files", strPath, "", strAssets, nSum) ) nResult = -1;
+	if( !TimeTheLoads("pack", strPath, DEFPACKFILE, strAssets, nSum) ) nResult = -1;
+	if( !TimeTheLoads("pack, all lz4", strPath, LZ4PACKFILE, strAssets, nSum) ) nResult = -1;
+
+	remove(DEFPACKFILE);
+	remove(LZ4PACKFILE);
+
+	return nResult;
+}
+
+/*!****************************************************************************
+* @brief	Program entry point
+******************************************************************************/
+int main(int argc, char* argv[])
+{
+	if( argc > 1 && strcmp(argv[1], "collide") == 0 )
+	{
+		unsigned nReps = argc > 2 ? atoi(argv[2]) : DEFREPS;
+		unsigned nSeed = argc > 3 ? atoi(argv[3]) : DEFSEED;
+											// for the probes
+		srand(nSeed);
+
+		CollideBench(nReps ? nReps : 1, nSeed);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "soak") == 0 )
+	{
+		unsigned nMissiles = argc > 2 ? atoi(argv[2]) : DEFMISSILES;
+		unsigned nSeed = argc > 3 ? atoi(argv[3]) : DEFSEED;
+
+		return SoakBench(nMissiles ? nMissiles : 1, nSeed);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "raster") == 0 )
+	{
+		unsigned nFrames = argc > 2 ? atoi(argv[2]) : DEFFRAMES;
+		int nLevel = argc > 3 ? atoi(argv[3]) : DEFLEVEL;
+
+		RasterBench(nFrames ? nFrames : 1, nLevel > 0 ? nLevel : 1,
+			argc > 4 ? argv[4] : NULL);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "replay") == 0 )
+	{
+		unsigned nTicks = argc > 2 ? atoi(argv[2]) : DEFREPLAYTICKS;
+		unsigned nSeed = argc > 3 ? atoi(argv[3]) : DEFSEED;
+
+		return ReplayBench(nTicks ? nTicks : 1, nSeed,
+			argc > 4 ? argv[4] : DEFREPLAYFILE);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "profile") == 0 )
+	{
+		unsigned nFrames = argc > 2 ? atoi(argv[2]) : DEFFRAMES;
+
+		return ProfileBench(nFrames ? nFrames : 1,
+			argc > 3 ? argv[3] : DEFPROFILEFILE);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "alloc") == 0 )
+	{
+		unsigned nTicks = argc > 2 ? atoi(argv[2]) : DEFALLOCTICKS;
+		int nLevel = argc > 3 ? atoi(argv[3]) : DEFLEVEL;
+
+		return AllocBench(nTicks ? nTicks : 1, nLevel > 0 ? nLevel : 1);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "transform") == 0 )
+	{
+		printf("kernels:    %s\n\n", GetTransformKernels());
+		printf("%-8s %-12s %10s %11s %12s\n", "points", "kernel",
+			"ns/point", "speed-up", "max diff");
+
+		TransformBench(16);
+		TransformBench(1024);
+		TransformBench(1024 * 1024);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "shapes") == 0 )
+	{
+		unsigned nBudgetKB = argc > 2 ? atoi(argv[2]) : SHAPES_BUDGET / 1024;
+		unsigned Steps[4] = { 36, 360, 1024, 3600 };
+
+		printf("%-6s %-8s %9s %10s %10s %10s %10s %10s\n", "steps", "memory",
+			"cached", "exact ns", "cache ns", "speed-up", "bound", "max error");
+
+		for(int i=0; i<4; i++) ShapesBench(Steps[i], nBudgetKB * 1024);
+		for(int i=0; i<4; i++) ShapesBench(Steps[i], 0);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "footprint") == 0 )
+	{
+		unsigned nCount = argc > 2 ? atoi(argv[2]) : DEFFOOTPRINT;
+
+		FootprintBench(nCount ? nCount : 1);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "jobs") == 0 )
+	{
+		unsigned nMaxThreads = argc > 2 ? atoi(argv[2]) : DEFMAXTHREADS;
+
+		return JobsBench(std::max(1u, std::min(nMaxThreads, (unsigned) JOBS_MAXTHREADS)));
+	}
+
+	if( argc > 1 && strcmp(argv[1], "swept") == 0 )
+	{
+		unsigned nShots = argc > 2 ? atoi(argv[2]) : DEFSHOTS;
+		double Steps[4] = { DT / 2.0, DT, DT * 2.0, DT * 4.0 };
+
+		printf("%-6s %6s %8s %8s %8s %8s %8s %6s %9s %9s\n", "dt", "px/step",
+			"hits", "point", "", "swept", "", "wrong", "point ns", "swept ns");
+
+		for(int i=0; i<4; i++) SweptBench(nShots ? nShots : 1, Steps[i]);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "outline") == 0 )
+	{
+		unsigned nProbes = argc > 2 ? atoi(argv[2]) : DEFPROBES;
+
+		OutlineBench(nProbes ? nProbes : 1);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "entities") == 0 )
+	{
+		unsigned nReuses = argc > 2 ? atoi(argv[2]) : DEFREUSES;
+
+		return EntitiesBench(nReuses);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "voices") == 0 )
+	{
+		unsigned nTicks = argc > 2 ? atoi(argv[2]) : DEFVOICETICKS;
+
+		VoicesBench(nTicks ? nTicks : 1);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "sounds") == 0 )
+	{
+		unsigned nTriggers = argc > 2 ? atoi(argv[2]) : DEFTRIGGERS;
+
+		SoundsBench(nTriggers ? nTriggers : 1);
+
+		return 0;
+	}
+
+	if( argc > 1 && strcmp(argv[1], "mixer") == 0 )
+	{
+		double Seconds = argc > 2 ? atof(argv[2]) : DEFMIXSECONDS;
+		const char* pFileName = argc > 3 ? argv[3] : NULL;
+
+		return MixerBench(Seconds > 0 ? Seconds : DEFMIXSECONDS, pFileName);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "wav") == 0 )
+	{
+		return WavBench(argc - 2, argv + 2);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "pack") == 0 )
+	{
+		return PackBench(argc > 2 ? argv[2] : NULL);
+	}
+
+	if( argc > 1 && strcmp(argv[1], "loop") == 0 )
+	{
+		double Seconds = argc > 2 ? atof(argv[2]) : DEFLOOPTIME;
+		double RenderMs = argc > 3 ? atof(argv[3]) : DEFRENDERMS;
+		double HitchMs = argc > 4 ? atof(argv[4]) : DEFHITCHMS;
+
+		return LoopBench(Seconds, RenderMs / 1000.0, HitchMs / 1000.0);
+	}
+
+	unsigned nTicks = argc > 1 ? atoi(argv[1]) : DEFTICKS;
+	int nLevel = argc > 2 ? atoi(argv[2]) : DEFLEVEL;
+	unsigned nSeed = argc > 3 ? atoi(argv[3]) : DEFSEED;
+
+	if( nTicks == 0 || nLevel < 1 )
+	{
+		printf("usage: %s [ticks] [level] [seed]\n", argv[0]);
+		return -1;
+	}
+
+	TFakeGdiFactory GdiFactory;
+	TPenCacheDevice VideoDevice(&GdiFactory);
+											// the actors draw on the buffer, the
+                                            // buffer is flushed on a null device
+                                            // that uses the pens cache
+	TBenchGame Game(nLevel, nSeed, true);
+	TBenchSimulation& Sim = Game.Sim;
+	TRenderBuffer& RenderBuffer = Game.RenderBuffer;
+	Sim.ResetPhaseTimes();
+
+	double RenderTime = 0;
+	unsigned nCommands = 0, nBatches = 0;
+
+	double StartTime = utils::GetTime();
+
+	for(unsigned i=0; i<nTicks; i++)
+	{
+		Sim.Play();
+
+		double Time = utils::GetTime();
+
+		VideoDevice.ClearScreen(RGB(0,0,0));
+
+		nCommands += RenderBuffer.GetCommandsCount();
+		RenderBuffer.Flush(&VideoDevice);
+		nBatches += RenderBuffer.GetBatchesCount();
+
+		RenderTime += utils::GetTime() - Time;
+	}
+
+	double Elapsed = utils::GetTime() - StartTime;
+
+	const char* strPhases[spCount] = {
+		"ships", "missiles", "asteroids", "limits", "broadphase",
+		"handlers", "collisions"
+	};
+
+	printf("ticks:      %u\n", nTicks);
+	printf("level:      %d (start %d)\n", Sim.GetLevel(), nLevel);
+	printf("score:      %d\n", Sim.GetScore());
+	TSimStats Stats = Sim.GetStats();
+
+	printf("asteroids:  %u (alive %u, exploding %u)\n", Stats.nAsteroids,
+		Stats.nAsteroidsAlive, Stats.nAsteroidsExploding);
+	printf("missiles:   %u (armed %u, peak %u, capacity %u)\n", Stats.nMissiles,
+		Stats.nMissilesArmed, Sim.GetMissilesPeak(), Sim.GetMissilesCapacity());
+	printf("entities:   %u\n", Stats.nEntities);
+	printf("commands:   %.1f per frame, %.1f batches\n",
+		double(nCommands) / nTicks, double(nBatches) / nTicks);
+	TPenCacheStats PenStats = VideoDevice.GetPenCache()->GetStats();
+
+	printf("pens:       hit rate %.2f%% (%u hits, %u misses, %u evictions)\n",
+		VideoDevice.GetPenCache()->GetHitRate() * 100.0,
+		PenStats.nHits, PenStats.nMisses, PenStats.nEvictions);
+	printf("gdi:        %u objects created, %u deleted\n",
+		GdiFactory.GetCreated(), GdiFactory.GetDeleted());
+	printf("elapsed:    %.3f s\n", Elapsed);
+	printf("ticks/s:    %.1f\n", nTicks / Elapsed);
+	printf("\n%-12s %12s %12s\n", "phase", "total [ms]", "tick [us]");
+
+	for(int i=0; i<spCount; i++)
+	{
+		double Time = Sim.GetPhaseTime(enSimPhase(i));
+
+		printf("%-12s %12.3f %12.3f\n", strPhases[i],
+			Time * 1000.0, Time * 1.0e6 / nTicks);
+	}
+
+	printf("%-12s %12.3f %12.3f\n", "render",
+		RenderTime * 1000.0, RenderTime * 1.0e6 / nTicks);
+
+	return 0;
+}
+
@@ -7,7 +7,26 @@
 #ifndef _COMMDEFS_H_
 #define _COMMDEFS_H_
 
-#include <windows.h>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+										// minimal GDI types for the
+										// headless (non Windows) builds
+	typedef unsigned char BYTE;
+	typedef unsigned int UINT;
+	typedef unsigned int COLORREF;
+
+	#define RGB(R,G,B)	((COLORREF)(((BYTE)(R)) | ((UINT)((BYTE)(G)) << 8)\
+						| ((UINT)((BYTE)(B)) << 16)))
+
+	#define GetRValue(C)	((BYTE)(C))
+	#define GetGValue(C)	((BYTE)(((C) >> 8) & 0xFF))
+	#define GetBValue(C)	((BYTE)(((C) >> 16) & 0xFF))
+
+	#define TA_LEFT			0
+	#define TA_RIGHT		2
+	#define TA_CENTER		6
+#endif
 
 
 #define APPNAME			" Asteroids-2k rel 1.0.0"\
@@ -17,6 +36,7 @@
 #define DATAFOLDER		"\\data\\"
 #define SCORESFILE		"hiscores.txt"
 #define HELPFILE		"help.txt"
+#define FONTFILE		"technolcd.ttf"
 
 #define FRAMEW			800
 #define FRAMEH			600
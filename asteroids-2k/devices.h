@@ -0,0 +1,95 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _DEVICES_H_
+#define _DEVICES_H_
+
+#include <string>
+
+#include "commdefs.h"
+#include "vectors.h"
+
+using namespace maths;
+
+										// the drawing primitives used by
+										// the actors of the game
+class TVideoDevice
+{
+	public:
+		virtual ~TVideoDevice() {}
+
+        virtual void DrawPoint(TVector2& Pt, COLORREF Color) = 0;
+        virtual void DrawPoints(TVecPoints& Pts, COLORREF Color)
+        {
+        	for(int i=0; i<Pts.size(); i++) DrawPoint(Pts[i], Color);
+        }
+
+        virtual void DrawLines(TVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false) = 0;
+        virtual void DrawLines(TVecVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false) = 0;
+
+        virtual void DrawText(char* pText, int nX, int nY,
+        	COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER) = 0;
+
+        virtual void ClearScreen(COLORREF Color) {}
+};
+
+										// a loaded sound, by id: the name is
+                                        // looked up once, by FindTheSound()
+typedef int TSoundId;
+
+#define SOUND_NONE		-1
+
+										// the sound primitives used by
+										// the actors of the game
+class TSoundDevice
+{
+	public:
+		virtual ~TSoundDevice() {}
+
+        virtual TSoundId FindTheSound(std::string strSound) = 0;
+
+										// Pan: -1 left, 0 center, 1 right
+        virtual void PlayTheSound(TSoundId nSound, bool bLoop = false,
+        	double Pan = 0) = 0;
+        virtual void StopTheSound(TSoundId nSound) = 0;
+        virtual void PlayTheSound(std::string strSound, bool bLoop = false) = 0;
+        virtual void StopTheSound(std::string strSound) = 0;
+        virtual void StopAllSounds() = 0;
+};
+
+										// do-nothing devices, used to run
+										// the simulation without a window
+class TNullVideoDevice : public TVideoDevice
+{
+	public:
+        void DrawPoint(TVector2& Pt, COLORREF Color) {}
+        void DrawPoints(TVecPoints& Pts, COLORREF Color) {}
+
+        void DrawLines(TVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false) {}
+        void DrawLines(TVecVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false) {}
+
+        void DrawText(char* pText, int nX, int nY,
+        	COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER) {}
+};
+
+class TNullSoundDevice : public TSoundDevice
+{
+	public:
+        TSoundId FindTheSound(std::string strSound) { return SOUND_NONE; }
+
+        void PlayTheSound(TSoundId nSound, bool bLoop = false, double Pan = 0) {}
+        void StopTheSound(TSoundId nSound) {}
+        void PlayTheSound(std::string strSound, bool bLoop = false) {}
+        void StopTheSound(std::string strSound) {}
+        void StopAllSounds() {}
+};
+
+#endif
+
@@ -0,0 +1,445 @@
+/*!****************************************************************************
+
+	@file	entities.h
+	@file	entities.cpp
+
+	@brief	Entity store: ships, missiles and asteroids as packed arrays of
+			components
+
+	@par	Each kind of entity has an archetype, a fixed set of components
+			(the mask) stored as one packed array per component. The loops
+			of the game (the systems) run on the arrays of an archetype, in
+			order of memory, with no virtual call per entity.
+
+	@par	An entity is known by a handle, that stays valid until it is
+			removed; its index in the archetype changes when an entity
+			before it is removed. Remove() moves the last entity in the
+			place of the removed one, RemoveTheDead() keeps the order.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+
+#include "entities.h"
+
+										// the components of each kind
+static const unsigned EntityMasks[ekCount] =
+{
+										// ships
+	ecTransform | ecMotion | ecCollider | ecLifetime | ecRenderable | ecAudioEmitter,
+										// missiles
+	ecTransform | ecMotion | ecPrevious | ecLifetime | ecRenderable | ecOwner,
+										// asteroids
+	ecTransform | ecMotion | ecCollider | ecLifetime | ecRenderable | ecAudioEmitter
+};
+
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nMask The components of the archetype, enComponent bits
+******************************************************************************/
+TArchetype::TArchetype(unsigned nMask)
+{
+	m_nMask = nMask;
+}
+
+/*!****************************************************************************
+* @brief	Reserves the memory of the components
+* @param	nCount Number of entities
+******************************************************************************/
+void TArchetype::Reserve(unsigned nCount)
+{
+	Entities.reserve(nCount);
+
+	if( Has(ecTransform) ) Transforms.reserve(nCount);
+	if( Has(ecMotion) ) Motions.reserve(nCount);
+	if( Has(ecPrevious) ) Previous.reserve(nCount);
+	if( Has(ecCollider) ) Colliders.reserve(nCount);
+	if( Has(ecLifetime) ) Lifetimes.reserve(nCount);
+	if( Has(ecRenderable) ) Renderables.reserve(nCount);
+	if( Has(ecAudioEmitter) ) Emitters.reserve(nCount);
+	if( Has(ecOwner) ) Owners.reserve(nCount);
+}
+
+/*!****************************************************************************
+* @brief	Gets the memory of the components
+* @return	The bytes of the arrays, as allocated
+******************************************************************************/
+unsigned TArchetype::GetMemory()
+{
+	return Entities.capacity() * sizeof(TEntity)
+		+ Transforms.capacity() * sizeof(TTransform)
+		+ Motions.capacity() * sizeof(TMotion)
+		+ Previous.capacity() * sizeof(TPrevious)
+		+ Colliders.capacity() * sizeof(TCollider)
+		+ Lifetimes.capacity() * sizeof(TLifetime)
+		+ Renderables.capacity() * sizeof(TRenderable)
+		+ Emitters.capacity() * sizeof(TAudioEmitter)
+		+ Owners.capacity() * sizeof(TOwner);
+}
+
+/*!****************************************************************************
+* @brief	Appends an entity, its components set to zero
+* @param	nEntity The handle of the entity
+******************************************************************************/
+void TArchetype::Append(TEntity nEntity)
+{
+	Entities.push_back(nEntity);
+
+	if( Has(ecTransform) ) { TTransform C = { 0, 0, 0 }; Transforms.push_back(C); }
+	if( Has(ecMotion) ) { TMotion C = { 0, 0, 0 }; Motions.push_back(C); }
+	if( Has(ecPrevious) ) { TPrevious C = { 0, 0 }; Previous.push_back(C); }
+	if( Has(ecCollider) ) { TCollider C = { 0 }; Colliders.push_back(C); }
+	if( Has(ecLifetime) ) { TLifetime C = { 0, 0, 0 }; Lifetimes.push_back(C); }
+	if( Has(ecRenderable) ) { TRenderable C = { -1, 0, 0, 0 }; Renderables.push_back(C); }
+	if( Has(ecAudioEmitter) ) { TAudioEmitter C = { SOUND_NONE }; Emitters.push_back(C); }
+	if( Has(ecOwner) ) { TOwner C = { ENTITY_NONE }; Owners.push_back(C); }
+}
+
+/*!****************************************************************************
+* @brief	Copies the components of an entity over another one
+* @param	nFrom Index of the entity to be copied
+* @param	nTo Index of the entity to be overwritten
+******************************************************************************/
+void TArchetype::Move(unsigned nFrom, unsigned nTo)
+{
+	Entities[nTo] = Entities[nFrom];
+
+	if( Has(ecTransform) ) Transforms[nTo] = Transforms[nFrom];
+	if( Has(ecMotion) ) Motions[nTo] = Motions[nFrom];
+	if( Has(ecPrevious) ) Previous[nTo] = Previous[nFrom];
+	if( Has(ecCollider) ) Colliders[nTo] = Colliders[nFrom];
+	if( Has(ecLifetime) ) Lifetimes[nTo] = Lifetimes[nFrom];
+	if( Has(ecRenderable) ) Renderables[nTo] = Renderables[nFrom];
+	if( Has(ecAudioEmitter) ) Emitters[nTo] = Emitters[nFrom];
+	if( Has(ecOwner) ) Owners[nTo] = Owners[nFrom];
+}
+
+/*!****************************************************************************
+* @brief	Drops the entities past a count, the memory is kept
+* @param	nCount The new number of entities
+******************************************************************************/
+void TArchetype::Resize(unsigned nCount)
+{
+	assert(nCount <= GetCount());
+
+	Entities.resize(nCount);
+
+	if( Has(ecTransform) ) Transforms.resize(nCount);
+	if( Has(ecMotion) ) Motions.resize(nCount);
+	if( Has(ecPrevious) ) Previous.resize(nCount);
+	if( Has(ecCollider) ) Colliders.resize(nCount);
+	if( Has(ecLifetime) ) Lifetimes.resize(nCount);
+	if( Has(ecRenderable) ) Renderables.resize(nCount);
+	if( Has(ecAudioEmitter) ) Emitters.resize(nCount);
+	if( Has(ecOwner) ) Owners.resize(nCount);
+}
+
+/*!****************************************************************************
+* @brief	Constructor, builds the archetype of each kind
+******************************************************************************/
+TEntityStore::TEntityStore()
+{
+	for(int i=0; i<ekCount; i++) m_Archetypes[i] = TArchetype(EntityMasks[i]);
+}
+
+/*!****************************************************************************
+* @brief	Creates an entity, the last one of its archetype
+* @param	nKind The kind of the entity
+* @return	The handle of the entity
+******************************************************************************/
+TEntity TEntityStore::Create(enEntityKind nKind)
+{
+	unsigned nSlot;
+
+	if( m_FreeSlots.size() )
+	{
+		nSlot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		nSlot = m_SlotKinds.size();
+											// the last slot, with the last
+                                            // generation, is ENTITY_NONE
+		assert(nSlot < ENTITY_SLOTMASK);
+
+		m_SlotKinds.push_back(0);
+		m_SlotIndices.push_back(0);
+		m_SlotGens.push_back(0);
+	}
+
+	TArchetype& Archetype = m_Archetypes[nKind];
+	TEntity nEntity = (m_SlotGens[nSlot] << ENTITY_SLOTBITS) | nSlot;
+
+	m_SlotKinds[nSlot] = nKind;
+	m_SlotIndices[nSlot] = Archetype.GetCount();
+
+	Archetype.Append(nEntity);
+
+	return nEntity;
+}
+
+/*!****************************************************************************
+* @brief	Invalidates the handle of a removed entity
+* @param	nEntity The handle
+******************************************************************************/
+void TEntityStore::FreeTheSlot(TEntity nEntity)
+{
+	unsigned nSlot = nEntity & ENTITY_SLOTMASK;
+
+											// wraps to the bits of the handle
+	m_SlotGens[nSlot] = (m_SlotGens[nSlot] + 1) & ENTITY_GENMASK;
+	m_FreeSlots.push_back(nSlot);
+}
+
+/*!****************************************************************************
+* @brief	Removes an entity, the last one of the archetype takes its place
+* @param	nKind The kind of the entity
+* @param	nIndex The index of the entity in its archetype
+******************************************************************************/
+void TEntityStore::Remove(enEntityKind nKind, unsigned nIndex)
+{
+	TArchetype& Archetype = m_Archetypes[nKind];
+	unsigned nLast = Archetype.GetCount() - 1;
+
+	assert(nIndex <= nLast);
+
+	FreeTheSlot(Archetype.Entities[nIndex]);
+
+	if( nIndex != nLast )
+	{
+		Archetype.Move(nLast, nIndex);
+		m_SlotIndices[ Archetype.Entities[nIndex] & ENTITY_SLOTMASK ] = nIndex;
+	}
+
+	Archetype.Resize(nLast);
+}
+
+/*!****************************************************************************
+* @brief	Removes the entities that are not alive, once their ticks (of
+*			the explosion) are over
+* @param	nKind The kind of the entities, with a lifetime
+* @note		Single pass that keeps the order of the others
+******************************************************************************/
+void TEntityStore::RemoveTheDead(enEntityKind nKind)
+{
+	TArchetype& Archetype = m_Archetypes[nKind];
+	unsigned nCount = 0;
+
+	assert(Archetype.Has(ecLifetime));
+
+	for(unsigned i=0; i<Archetype.GetCount(); i++)
+	{
+		if( Archetype.Lifetimes[i].bAlive || Archetype.Lifetimes[i].nTicks > 0 )
+		{
+			if( i != nCount )
+			{
+				Archetype.Move(i, nCount);
+				m_SlotIndices[ Archetype.Entities[nCount] & ENTITY_SLOTMASK ] = nCount;
+			}
+
+			nCount++;
+		}
+		else
+		{
+			FreeTheSlot(Archetype.Entities[i]);
+		}
+	}
+
+	Archetype.Resize(nCount);
+}
+
+/*!****************************************************************************
+* @brief	Removes all the entities of a kind
+* @param	nKind The kind of the entities
+******************************************************************************/
+void TEntityStore::Clear(enEntityKind nKind)
+{
+	TArchetype& Archetype = m_Archetypes[nKind];
+
+	for(unsigned i=0; i<Archetype.GetCount(); i++) FreeTheSlot(Archetype.Entities[i]);
+
+	Archetype.Resize(0);
+}
+
+/*!****************************************************************************
+* @brief	Finds an entity by handle
+* @param	nEntity The handle of the entity
+* @return	The index of the entity in its archetype, -1 if it has been
+*			removed
+******************************************************************************/
+int TEntityStore::Find(TEntity nEntity)
+{
+	unsigned nSlot = nEntity & ENTITY_SLOTMASK;
+
+	if( nSlot < m_SlotKinds.size() && m_SlotGens[nSlot] == nEntity >> ENTITY_SLOTBITS )
+	{
+		return m_SlotIndices[nSlot];
+	}
+
+	return -1;
+}
+
+/*!****************************************************************************
+* @brief		Gets the archetype and the index of a live entity
+* @param		nEntity The handle of the entity
+* @param[out]	nKind The kind of the entity
+* @return		The index of the entity in its archetype
+******************************************************************************/
+unsigned TEntityStore::Locate(TEntity nEntity, enEntityKind& nKind)
+{
+	int nIndex = Find(nEntity);
+
+	assert(nIndex >= 0);
+
+	nKind = enEntityKind(m_SlotKinds[nEntity & ENTITY_SLOTMASK]);
+
+	return nIndex;
+}
+
+/*!****************************************************************************
+* @brief	Gets the transform of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TTransform& TEntityStore::GetTransform(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Transforms[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the motion of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TMotion& TEntityStore::GetMotion(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Motions[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the collider of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TCollider& TEntityStore::GetCollider(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Colliders[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the lifetime of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TLifetime& TEntityStore::GetLifetime(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Lifetimes[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the renderable of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TRenderable& TEntityStore::GetRenderable(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Renderables[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the audio emitter of an entity
+* @param	nEntity The handle of the entity
+******************************************************************************/
+TAudioEmitter& TEntityStore::GetEmitter(TEntity nEntity)
+{
+	enEntityKind nKind;
+	unsigned nIndex = Locate(nEntity, nKind);
+
+	return m_Archetypes[nKind].Emitters[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of entities of all the kinds
+******************************************************************************/
+unsigned TEntityStore::GetCount()
+{
+	unsigned nCount = 0;
+
+	for(int i=0; i<ekCount; i++) nCount += m_Archetypes[i].GetCount();
+
+	return nCount;
+}
+
+/*!****************************************************************************
+* @brief	Gets the memory of the store
+* @return	The bytes of the components and of the handles, as allocated
+******************************************************************************/
+unsigned TEntityStore::GetMemory()
+{
+	unsigned nBytes = sizeof(*this);
+
+	for(int i=0; i<ekCount; i++) nBytes += m_Archetypes[i].GetMemory();
+
+	nBytes += (m_SlotKinds.capacity() + m_SlotIndices.capacity()
+		+ m_SlotGens.capacity() + m_FreeSlots.capacity()) * sizeof(unsigned);
+
+	return nBytes;
+}
+
+/*!****************************************************************************
+* @brief	Moves the live entities of a range by their velocity and spin
+* @param	Archetype The entities, with a transform, a motion and a lifetime
+* @param	Dt The value for the delta time
+* @param	nBegin First entity
+* @param	nEnd One past the last entity
+* @note		The previous position is saved first, if in the archetype
+******************************************************************************/
+void IntegrateTheMotion(TArchetype& Archetype, double Dt, unsigned nBegin, unsigned nEnd)
+{
+	assert(Archetype.Has(ecTransform | ecMotion | ecLifetime));
+
+	TTransform* pTransforms = Archetype.GetCount() ? &Archetype.Transforms[0] : NULL;
+	TMotion* pMotions = Archetype.GetCount() ? &Archetype.Motions[0] : NULL;
+	TLifetime* pLifetimes = Archetype.GetCount() ? &Archetype.Lifetimes[0] : NULL;
+
+	if( Archetype.Has(ecPrevious) )
+	{
+		for(unsigned i=nBegin; i<nEnd; i++)
+		{
+			if( pLifetimes[i].bAlive )
+			{
+				Archetype.Previous[i].X = pTransforms[i].X;
+				Archetype.Previous[i].Y = pTransforms[i].Y;
+			}
+		}
+	}
+
+	for(unsigned i=nBegin; i<nEnd; i++)
+	{
+		if( pLifetimes[i].bAlive )
+		{
+			pTransforms[i].X += pMotions[i].VX * Dt;
+			pTransforms[i].Y += pMotions[i].VY * Dt;
+
+			pTransforms[i].Rot += pMotions[i].Spin;
+		}
+	}
+}
+
@@ -0,0 +1,181 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _ENTITIES_H_
+#define _ENTITIES_H_
+
+#include <vector>
+
+#include "commdefs.h"
+#include "vectors.h"
+#include "devices.h"
+
+										// handles: slot in the low bits,
+										// generation of the slot in the high
+#define ENTITY_SLOTBITS			24
+#define ENTITY_SLOTMASK			((1u << ENTITY_SLOTBITS) - 1)
+#define ENTITY_GENMASK			(0xFFFFFFFFu >> ENTITY_SLOTBITS)
+#define ENTITY_NONE				0xFFFFFFFFu
+
+
+typedef unsigned TEntity;
+
+										// the components, one bit each in the
+                                        // mask of an archetype
+enum enComponent
+{
+	ecTransform = 1 << 0,
+	ecMotion = 1 << 1,
+	ecPrevious = 1 << 2,
+	ecCollider = 1 << 3,
+	ecLifetime = 1 << 4,
+	ecRenderable = 1 << 5,
+	ecAudioEmitter = 1 << 6,
+	ecOwner = 1 << 7
+};
+
+										// the kinds of entity, an archetype
+                                        // each: a new kind is a new entry
+                                        // here and in the table of the masks
+enum enEntityKind { ekShip, ekMissile, ekAsteroid, ekCount };
+
+struct TTransform
+{
+	double X, Y;
+	double Rot;							// degrees
+};
+
+struct TMotion
+{
+	double VX, VY;
+	double Spin;						// degrees per tick
+};
+										// the position before the last move,
+                                        // for the swept collisions
+struct TPrevious
+{
+	double X, Y;
+};
+
+struct TCollider
+{
+	double Radius;
+};
+
+struct TLifetime
+{
+	BYTE bAlive, bVisible;
+	int nTicks;							// of the explosion: a dead entity
+										// is removed once they are over
+};
+
+struct TRenderable
+{
+	int nShape;							// in the shape cache
+	COLORREF Color;
+	BYTE nClass, nVariant;				// of the kinds with more shapes
+};
+
+struct TAudioEmitter
+{
+	TSoundId nSound;
+};
+
+struct TOwner
+{
+	TEntity nOwner;
+};
+
+										// the entities of a kind, as packed
+                                        // arrays of components: the index i
+                                        // (0 <= i < GetCount()) selects the
+                                        // i-th element of every array; the
+                                        // components not in the mask are
+                                        // left empty
+class TArchetype
+{
+	public:
+		TArchetype(unsigned nMask = 0);
+
+	public:
+		unsigned GetMask() { return m_nMask; }
+		bool Has(unsigned nMask) { return (m_nMask & nMask) == nMask; }
+		unsigned GetCount() { return Entities.size(); }
+
+		void Reserve(unsigned nCount);
+		unsigned GetMemory();
+
+	public:
+		std::vector<TEntity> Entities;
+
+		std::vector<TTransform> Transforms;
+		std::vector<TMotion> Motions;
+		std::vector<TPrevious> Previous;
+		std::vector<TCollider> Colliders;
+		std::vector<TLifetime> Lifetimes;
+		std::vector<TRenderable> Renderables;
+		std::vector<TAudioEmitter> Emitters;
+		std::vector<TOwner> Owners;
+
+	protected:
+		unsigned m_nMask;
+
+	protected:
+		friend class TEntityStore;
+
+		void Append(TEntity nEntity);
+		void Move(unsigned nFrom, unsigned nTo);
+		void Resize(unsigned nCount);
+};
+
+										// all the entities of the game, an
+                                        // archetype per kind; the handles stay
+                                        // valid until the entity is removed
+class TEntityStore
+{
+	public:
+		TEntityStore();
+
+	public:
+		TArchetype& GetArchetype(enEntityKind nKind) { return m_Archetypes[nKind]; }
+
+		TEntity Create(enEntityKind nKind);
+		void Remove(enEntityKind nKind, unsigned nIndex);
+		void RemoveTheDead(enEntityKind nKind);
+		void Clear(enEntityKind nKind);
+
+		int Find(TEntity nEntity);
+		bool IsValid(TEntity nEntity) { return Find(nEntity) >= 0; }
+
+		TTransform& GetTransform(TEntity nEntity);
+		TMotion& GetMotion(TEntity nEntity);
+		TCollider& GetCollider(TEntity nEntity);
+		TLifetime& GetLifetime(TEntity nEntity);
+		TRenderable& GetRenderable(TEntity nEntity);
+		TAudioEmitter& GetEmitter(TEntity nEntity);
+
+		unsigned GetCount();
+		unsigned GetCount(enEntityKind nKind) { return m_Archetypes[nKind].GetCount(); }
+		unsigned GetMemory();
+
+	protected:
+		TArchetype m_Archetypes[ekCount];
+											// by slot: the kind and the index
+                                            // of the entity, the generation
+		std::vector<unsigned> m_SlotKinds, m_SlotIndices, m_SlotGens;
+		std::vector<unsigned> m_FreeSlots;
+
+	protected:
+		void FreeTheSlot(TEntity nEntity);
+		unsigned Locate(TEntity nEntity, enEntityKind& nKind);
+};
+
+										// the systems, loops on the components
+                                        // of an archetype in [nBegin, nEnd)
+void IntegrateTheMotion(TArchetype& Archetype, double Dt, unsigned nBegin, unsigned nEnd);
+
+#endif
+
@@ -18,10 +18,10 @@
 
 #include "audio.h"
 #include "video.h"
+#include "render.h"
+#include "pack.h"
 
-#include "ships.h"
-#include "weapons.h"
-#include "asteroids.h"
+#include "sim.h"
 
 
 struct TRecordScore
@@ -33,20 +33,19 @@ struct TRecordScore
 typedef std::vector<std::string> TVecStrings;
 typedef std::vector<TRecordScore> TVecRecordScores;
 
-class TGame
+class TGame : public TSimulation
 {
 	public:
-    	TGame(TVideoManager* pVM, TSoundManager* pSM);
+    	TGame(TVideoManager* pVM, TSoundManager* pSM, TRenderBuffer* pRB);
         ~TGame();
 
 	public:
         void Run();
+        void Render();
 
         bool IsPausing();
         bool IsRunning();
-        bool IsGameOver();
 
-        void Restart();
         void GameOver();
         void RunTheGame();
         void StopTheGame();
@@ -57,82 +56,49 @@ class TGame
 
         HWND GetMainWnd();
         RECT GetClientArea();
-        void GetClientArea(unsigned& nW, unsigned& nH);
+        using TSimulation::GetClientArea;
 
-        void ShotTheMissile(TShip* pShip);
-
-        TVideoManager* GetVM() { return m_pVideo; }
-        TSoundManager* GetSM() { return m_pAudio; }
-
-		TShip* GetShip(enShipClass nShipClass) { return m_pShips[nShipClass]; }
+        TVideoManager* GetVM() { return m_pVM; }
+        TSoundManager* GetSM() { return m_pSM; }
 
     protected:
-        TSoundManager* m_pAudio;
-        TVideoManager* m_pVideo;
+        TSoundManager* m_pSM;
+        TVideoManager* m_pVM;
+        TRenderBuffer* m_pRB;
 
-        TVecPtrShips m_pShips;
-        TVecPtrWeapons m_pMissiles;
-        TVecPtrAsteroids m_pAsteroids;
-        bool m_bRun, m_bPause, m_bGameOver;
-        int m_nScore, m_nLevel,
-        	m_nDifficulty, m_nLives, m_nBonusCount;
+        bool m_bRun, m_bPause;
+											// "game-over" splash pages
+        int m_nSplashPage;
+        unsigned m_nSplashTime;
 
         AnsiString m_strBestScoresName;
         TVecRecordScores m_BestScores;
         unsigned m_nDlgRetVal;
 
         TVecStrings m_strHelp;
+        TAssetPack m_Pack;					// open while loading the data
 
 	protected:
 
 		void Setup();
 
         void ShowInfo();
-        void NextLevel();
-
-		void Split(TAsteroid* pAsteroid, TVecPtrAsteroids& Splits);
-
-        bool IsSafetyPos(TVector2 Pos);
 
         bool LoadTheHelp();
         bool LoadTheSounds();
 
-        void AddScore(int nScore);
-        void AddScore(TAsteroid* pAsteroid);
-
         bool IsBestScore();
         void RegisterBestScore();
         void SaveBestScores();
         bool LoadTheBestScores(char* pFileName);
 
         bool BuildTheFonts();
-        void BuildTheAsteroids(unsigned nCount);
-
-        bool BuildTheShips();
-
-        void ForceInsideLimits();
-        bool IsInsideGameArea(TVector2 Pos);
-
-        void LevelHandler();
-        void BonusHandler();
-        void CollisionHandler();
-
-		bool Collide(TShip* pShip1, TShip* pShip2);
-        bool Collide(TMissile* pMissile, TShip* pShip);
-        bool Collide(TAsteroid* pAsteroid, TShip* pShip);
 
         void GameOverHandler();
-		void HumanShipsHandler();
-        void AlienShipsHandler();
+        void BestScoreHandler();
 
         void Sort(TVecRecordScores& Scores, bool bAscending=true);
-
-		void Clear(TVecPtrShips& Ships);
-        void Clear(TVecPtrWeapons& Missiles);
-        void Clear(TVecPtrAsteroids& Asteroids);
-
 };
 
 #endif
 
-
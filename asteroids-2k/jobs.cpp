@@ -0,0 +1,491 @@
+/*!****************************************************************************
+
+	@file	jobs.h
+	@file	jobs.cpp
+
+	@brief	Job system for the parallel loops of the simulation
+
+	@par	ParallelFor() splits the indices of a loop in chunks of at least
+			nGrain indices, and deals them in order to the threads: each
+			thread has a queue of consecutive chunks. A thread takes the
+			chunks of its queue from the back and, once it is empty, steals
+			the chunks of the others from the front. The caller is the
+			thread 0 and returns when all the chunks have been run.
+
+	@par	The chunks must be independent of each other (each index writes
+			only its own data): so the results do not depend on the number
+			of threads, nor on which thread runs which chunk.
+
+	@par	An idle worker polls for a new loop JOBS_SPINS times, then sleeps
+			on a semaphore. A loop posts the semaphore once per sleeping
+			worker, not once per worker: the posts of the workers that were
+			still polling would pile up. With one thread, or less than
+			nGrain indices, the loop is run by the caller, without any
+			synchronization.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <semaphore.h>
+	#include <sched.h>
+	#include <unistd.h>
+#endif
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "jobs.h"
+
+//-----------------------------------------------------------------------------
+
+static long AtomicIncrement(volatile long* pVal)
+{
+#ifdef _WIN32
+	return InterlockedIncrement(pVal);
+#else
+	return __sync_add_and_fetch(pVal, 1);
+#endif
+}
+
+static long AtomicDecrement(volatile long* pVal)
+{
+#ifdef _WIN32
+	return InterlockedDecrement(pVal);
+#else
+	return __sync_sub_and_fetch(pVal, 1);
+#endif
+}
+
+static long AtomicExchange(volatile long* pVal, long nVal)
+{
+#ifdef _WIN32
+	return InterlockedExchange(pVal, nVal);
+#else
+	return __sync_lock_test_and_set(pVal, nVal);
+#endif
+}
+
+static long AtomicCompareExchange(volatile long* pVal, long nVal, long nCompare)
+{
+#ifdef _WIN32
+	return InterlockedCompareExchange(pVal, nVal, nCompare);
+#else
+	return __sync_val_compare_and_swap(pVal, nCompare, nVal);
+#endif
+}
+
+static long AtomicLoad(volatile long* pVal)
+{
+#ifdef _WIN32
+	return InterlockedCompareExchange(pVal, 0, 0);
+#else
+	return __sync_fetch_and_add(pVal, 0);
+#endif
+}
+
+static void MemoryFence()
+{
+#ifdef _WIN32
+	static volatile long nFence = 0;
+	InterlockedExchange(&nFence, 0);		// full barrier on x86/x64
+#else
+	__sync_synchronize();
+#endif
+}
+
+static void YieldTheThread()
+{
+#ifdef _WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+static void Lock(volatile long* pLock)
+{
+	while( AtomicExchange(pLock, 1) ) { while( AtomicLoad(pLock) ) ; }
+}
+
+static void Unlock(volatile long* pLock)
+{
+#ifdef _WIN32
+	InterlockedExchange(pLock, 0);
+#else
+	__sync_lock_release(pLock);			// a release barrier: the writes
+                                        // under the lock are seen first
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerThread(LPVOID pArgs)
+{
+	TWorkerArgs* pWorker = (TWorkerArgs*) pArgs;
+	pWorker->pJobs->WorkerLoop(pWorker->nThread);
+
+	return 0;
+}
+#else
+static void* WorkerThread(void* pArgs)
+{
+	TWorkerArgs* pWorker = (TWorkerArgs*) pArgs;
+	pWorker->pJobs->WorkerLoop(pWorker->nThread);
+
+	return NULL;
+}
+#endif
+
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nThreads Number of threads, the caller included; 0 for one
+*			thread per core
+******************************************************************************/
+TJobSystem::TJobSystem(unsigned nThreads)
+{
+	m_nThreads = 1;
+	m_nQuit = 0;
+	m_pJob = NULL;
+	m_nCount = m_nChunk = 0;
+	m_nPending = m_nGeneration = m_nSteals = m_nSleeping = 0;
+
+	for(int i=0; i<JOBS_MAXTHREADS; i++)
+	{
+		m_Queues[i].nLock = 0;
+		m_Queues[i].nFront = m_Queues[i].nBack = 0;
+	}
+
+#ifdef _WIN32
+	m_pWakeUp = CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+#else
+	m_pWakeUp = new sem_t;
+	sem_init((sem_t*) m_pWakeUp, 0, 0);
+#endif
+
+	assert(m_pWakeUp);
+
+	SetThreadsCount(nThreads);
+}
+
+/*!****************************************************************************
+* @brief	Destructor, stops the threads
+******************************************************************************/
+TJobSystem::~TJobSystem()
+{
+	StopTheThreads();
+
+#ifdef _WIN32
+	CloseHandle(m_pWakeUp);
+#else
+	sem_destroy((sem_t*) m_pWakeUp);
+	delete (sem_t*) m_pWakeUp;
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of cores of the system
+******************************************************************************/
+unsigned TJobSystem::GetCoresCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO Info;
+	GetSystemInfo(&Info);
+
+	return std::max(1, (int) Info.dwNumberOfProcessors);
+#else
+	return std::max(1, (int) sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Sets the number of threads, restarting the workers
+* @param	nThreads Number of threads, the caller included; 0 for one
+*			thread per core
+******************************************************************************/
+void TJobSystem::SetThreadsCount(unsigned nThreads)
+{
+	if( nThreads == 0 ) nThreads = GetCoresCount();
+
+	nThreads = std::min(nThreads, (unsigned) JOBS_MAXTHREADS);
+
+	if( nThreads == m_nThreads && m_Threads.size() == nThreads - 1 ) return;
+
+	StopTheThreads();
+
+	m_nThreads = nThreads;
+
+	StartTheThreads();
+}
+
+/*!****************************************************************************
+* @brief	Starts the workers, the threads other than the caller
+******************************************************************************/
+void TJobSystem::StartTheThreads()
+{
+	m_nQuit = 0;
+	m_Args.resize(m_nThreads);
+
+	for(unsigned i=1; i<m_nThreads; i++)
+	{
+		m_Args[i].pJobs = this;
+		m_Args[i].nThread = i;
+
+#ifdef _WIN32
+		HANDLE hThread = CreateThread(NULL, 0, WorkerThread, &m_Args[i], 0, NULL);
+		assert(hThread);
+
+		m_Threads.push_back(hThread);
+#else
+		pthread_t* pThread = new pthread_t;
+		int nResult = pthread_create(pThread, NULL, WorkerThread, &m_Args[i]);
+		assert(nResult == 0);
+
+		m_Threads.push_back(pThread);
+#endif
+	}
+}
+
+/*!****************************************************************************
+* @brief	Stops the workers and waits for them
+******************************************************************************/
+void TJobSystem::StopTheThreads()
+{
+	AtomicExchange(&m_nQuit, 1);
+	MemoryFence();
+
+	WakeTheWorkers();
+
+	for(unsigned i=0; i<m_Threads.size(); i++)
+	{
+#ifdef _WIN32
+		WaitForSingleObject(m_Threads[i], INFINITE);
+		CloseHandle(m_Threads[i]);
+#else
+		pthread_join(*(pthread_t*) m_Threads[i], NULL);
+		delete (pthread_t*) m_Threads[i];
+#endif
+	}
+
+	m_Threads.clear();
+}
+
+/*!****************************************************************************
+* @brief	Runs a loop on all the threads
+* @param	nCount Number of indices, the loop runs on [0, nCount)
+* @param	nGrain Minimum number of indices of a chunk
+* @param	Job The body of the loop
+* @note		The chunks of the loop must be independent of each other
+******************************************************************************/
+void TJobSystem::ParallelFor(unsigned nCount, unsigned nGrain, TParallelJob& Job)
+{
+	if( nCount == 0 ) return;
+
+	nGrain = std::max(nGrain, 1u);
+
+	if( m_nThreads == 1 || nCount <= nGrain )
+	{
+		Job.Run(0, nCount, 0);
+		return;
+	}
+											// not too small, not too few
+	unsigned nChunk = (nCount + m_nThreads * JOBS_CHUNKSPERTHREAD - 1)
+		/ (m_nThreads * JOBS_CHUNKSPERTHREAD);
+	nChunk = std::max(nChunk, nGrain);
+
+	unsigned nChunks = (nCount + nChunk - 1) / nChunk;
+
+	m_pJob = &Job;
+	m_nCount = nCount;
+	m_nChunk = nChunk;
+	m_nPending = nChunks;
+											// consecutive chunks per thread
+	for(unsigned i=0; i<m_nThreads; i++)
+	{
+		TJobQueue& Queue = m_Queues[i];
+
+		Lock(&Queue.nLock);
+		Queue.nFront = unsigned(double(nChunks) * i / m_nThreads);
+		Queue.nBack = unsigned(double(nChunks) * (i + 1) / m_nThreads);
+		Unlock(&Queue.nLock);
+	}
+
+	MemoryFence();
+	AtomicIncrement(&m_nGeneration);
+	WakeTheWorkers();
+
+	RunTheChunks(0);
+											// the chunks being run by the
+                                            // others
+	while( AtomicLoad(&m_nPending) > 0 ) YieldTheThread();
+
+	MemoryFence();
+	m_pJob = NULL;
+}
+
+/*!****************************************************************************
+* @brief	Posts the semaphore once for each sleeping worker
+******************************************************************************/
+void TJobSystem::WakeTheWorkers()
+{
+	long nSleeping = AtomicExchange(&m_nSleeping, 0);
+
+#ifdef _WIN32
+	if( nSleeping > 0 ) ReleaseSemaphore(m_pWakeUp, nSleeping, NULL);
+#else
+	for(long i=0; i<nSleeping; i++) sem_post((sem_t*) m_pWakeUp);
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Takes back the sleep of a worker that has seen a new loop, or the
+*			quit, after counting itself among the sleeping ones
+* @return	false if the worker has already been counted by a wake-up: its
+*			post is on the semaphore and must be taken
+* @note		The sleeping workers are a count, not a list: taking back the
+*			sleep of another one is the same
+******************************************************************************/
+bool TJobSystem::CancelTheSleep()
+{
+	for(;;)
+	{
+		long nSleeping = AtomicLoad(&m_nSleeping);
+
+		if( nSleeping == 0 ) return false;
+
+		if( AtomicCompareExchange(&m_nSleeping, nSleeping - 1, nSleeping) == nSleeping )
+		{
+			return true;
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Checks that no loop has started since a generation, and that the
+*			system is still running
+* @param	nGeneration The generation of the last loop run by the worker
+******************************************************************************/
+bool TJobSystem::IsIdle(long nGeneration)
+{
+	return AtomicLoad(&m_nGeneration) == nGeneration && !AtomicLoad(&m_nQuit);
+}
+
+/*!****************************************************************************
+* @brief	Takes a chunk from the back of the queue of a thread
+* @param	nThread The thread
+* @param	nChunk The chunk
+* @return	false if the queue is empty
+******************************************************************************/
+bool TJobSystem::TakeTheChunk(unsigned nThread, unsigned& nChunk)
+{
+	TJobQueue& Queue = m_Queues[nThread];
+	bool bResult = false;
+
+	Lock(&Queue.nLock);
+
+	if( Queue.nFront < Queue.nBack )
+	{
+		nChunk = --Queue.nBack;
+		bResult = true;
+	}
+
+	Unlock(&Queue.nLock);
+
+	return bResult;
+}
+
+/*!****************************************************************************
+* @brief	Steals a chunk from the front of the queue of another thread
+* @param	nThread The thief
+* @param	nChunk The chunk
+* @return	false if all the queues are empty
+******************************************************************************/
+bool TJobSystem::StealTheChunk(unsigned nThread, unsigned& nChunk)
+{
+	for(unsigned i=1; i<m_nThreads; i++)
+	{
+		TJobQueue& Queue = m_Queues[(nThread + i) % m_nThreads];
+		bool bResult = false;
+
+		Lock(&Queue.nLock);
+
+		if( Queue.nFront < Queue.nBack )
+		{
+			nChunk = Queue.nFront++;
+			bResult = true;
+		}
+
+		Unlock(&Queue.nLock);
+
+		if( bResult )
+		{
+			AtomicIncrement(&m_nSteals);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*!****************************************************************************
+* @brief	Runs the chunks of a thread, then the stolen ones
+* @param	nThread The thread
+******************************************************************************/
+void TJobSystem::RunTheChunks(unsigned nThread)
+{
+	unsigned nChunk;
+
+	while( TakeTheChunk(nThread, nChunk) || StealTheChunk(nThread, nChunk) )
+	{
+											// the loop is alive until its
+                                            // last chunk is done
+		unsigned nBegin = nChunk * m_nChunk;
+		unsigned nEnd = std::min(nBegin + m_nChunk, m_nCount);
+
+		m_pJob->Run(nBegin, nEnd, nThread);
+
+		MemoryFence();
+		AtomicDecrement(&m_nPending);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Waits for the loops and runs their chunks, until the system stops
+* @param	nThread The worker
+******************************************************************************/
+void TJobSystem::WorkerLoop(unsigned nThread)
+{
+	long nGeneration = AtomicLoad(&m_nGeneration);
+
+	while( !AtomicLoad(&m_nQuit) )
+	{
+		for(int i=0; i<JOBS_SPINS && IsIdle(nGeneration); i++) YieldTheThread();
+
+		if( IsIdle(nGeneration) )
+		{
+			AtomicIncrement(&m_nSleeping);
+											// a loop may have started before
+                                            // the count was seen
+			if( !IsIdle(nGeneration) && CancelTheSleep() ) continue;
+
+#ifdef _WIN32
+			WaitForSingleObject(m_pWakeUp, INFINITE);
+#else
+			while( sem_wait((sem_t*) m_pWakeUp) != 0 ) ;
+#endif
+			continue;
+		}
+
+		nGeneration = AtomicLoad(&m_nGeneration);
+
+		RunTheChunks(nThread);
+	}
+}
+
@@ -0,0 +1,141 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _JOBS_H_
+#define _JOBS_H_
+
+#include <stddef.h>
+#include <vector>
+
+#define JOBS_MAXTHREADS		64
+#define JOBS_CHUNKSPERTHREAD	4			// chunks of a loop per thread, at
+											// least, for the balance
+#define JOBS_SPINS			4000			// polls of an idle worker before
+											// it sleeps
+
+
+										// the body of a parallel loop: runs
+                                        // the indices [nBegin, nEnd), on the
+                                        // thread nThread (0 is the caller)
+class TParallelJob
+{
+	public:
+		virtual ~TParallelJob() {}
+
+		virtual void Run(unsigned nBegin, unsigned nEnd, unsigned nThread) = 0;
+};
+
+										// a parallel loop on a method of an
+                                        // object, void T::Method(nBegin, nEnd)
+                                        // or, to know the thread running the
+                                        // chunk, T::Method(nBegin, nEnd, nThread)
+template <class T>
+class TMethodJob : public TParallelJob
+{
+	public:
+		typedef void (T::*TMethod)(unsigned nBegin, unsigned nEnd);
+		typedef void (T::*TThreadMethod)(unsigned nBegin, unsigned nEnd,
+			unsigned nThread);
+
+		TMethodJob(T* pObject, TMethod pMethod)
+		{
+			m_pObject = pObject;
+			m_pMethod = pMethod;
+			m_pThreadMethod = NULL;
+		}
+
+		TMethodJob(T* pObject, TThreadMethod pThreadMethod)
+		{
+			m_pObject = pObject;
+			m_pMethod = NULL;
+			m_pThreadMethod = pThreadMethod;
+		}
+
+		void Run(unsigned nBegin, unsigned nEnd, unsigned nThread)
+		{
+			if( m_pMethod ) (m_pObject->*m_pMethod)(nBegin, nEnd);
+			else (m_pObject->*m_pThreadMethod)(nBegin, nEnd, nThread);
+		}
+
+	protected:
+		T* m_pObject;
+		TMethod m_pMethod;
+		TThreadMethod m_pThreadMethod;
+};
+
+										// the chunks of a loop still to run
+                                        // by a thread: the owner takes them
+                                        // from the back, the thieves from
+                                        // the front
+struct TJobQueue
+{
+	volatile long nLock;
+	unsigned nFront, nBack;
+	char Padding[64];					// no false sharing of the locks
+};
+
+class TJobSystem;
+
+struct TWorkerArgs
+{
+	TJobSystem* pJobs;
+	unsigned nThread;
+};
+
+										// a pool of worker threads running
+                                        // parallel loops: the chunks of a
+                                        // loop are dealt in order to the
+                                        // threads, an idle thread steals
+                                        // from the others
+class TJobSystem
+{
+	public:
+		TJobSystem(unsigned nThreads = 1);
+		~TJobSystem();
+
+	public:
+		void SetThreadsCount(unsigned nThreads);
+		unsigned GetThreadsCount() { return m_nThreads; }
+
+		void ParallelFor(unsigned nCount, unsigned nGrain, TParallelJob& Job);
+
+		unsigned GetSteals() { return m_nSteals; }
+		void ResetSteals() { m_nSteals = 0; }
+
+		static unsigned GetCoresCount();
+											// body of the worker threads
+		void WorkerLoop(unsigned nThread);
+
+	protected:
+		unsigned m_nThreads;
+		std::vector<void*> m_Threads;
+		std::vector<TWorkerArgs> m_Args;
+		void* m_pWakeUp;
+		volatile long m_nQuit;
+											// the loop being run
+		TParallelJob* volatile m_pJob;
+		unsigned m_nCount, m_nChunk;
+		volatile long m_nPending, m_nGeneration;
+		volatile long m_nSteals;
+		volatile long m_nSleeping;		// workers on the semaphore
+
+		TJobQueue m_Queues[JOBS_MAXTHREADS];
+
+	protected:
+		void StartTheThreads();
+		void StopTheThreads();
+
+		void WakeTheWorkers();
+		bool CancelTheSleep();
+
+		bool IsIdle(long nGeneration);
+		bool TakeTheChunk(unsigned nThread, unsigned& nChunk);
+		bool StealTheChunk(unsigned nThread, unsigned& nChunk);
+		void RunTheChunks(unsigned nThread);
+};
+
+#endif
+
@@ -0,0 +1,208 @@
+/*!****************************************************************************
+
+	@file	loop.h
+	@file	loop.cpp
+
+	@brief	Game loop scheduler
+
+	@par	The simulation advances in fixed steps of 1/SimRate seconds:
+			the real time elapsed between two calls of Update() is added to
+			an accumulator, and Update() tells how many steps are due, so
+			a slow frame is recovered with more steps instead of slowing
+			down the game. The remainder of the accumulator, GetAlpha(),
+			is the interpolation factor between the last two steps.
+
+	@par	Wait() sleeps until the next step is due, and only yields the
+			time slice for the last LOOP_SPINTIME seconds, instead of
+			spinning on the clock.
+
+	@par	The time comes from a TClock, so the loop can be driven by a
+			TVirtualClock without a window.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "loop.h"
+#include "timer.h"
+
+
+/*!****************************************************************************
+* @brief	Gets the value of the high resolution clock, in seconds
+******************************************************************************/
+double TSystemClock::GetTime()
+{
+	return utils::GetTime();
+}
+
+/*!****************************************************************************
+* @brief	Suspends the calling thread
+* @param	Seconds The time to sleep, 0 yields the time slice
+******************************************************************************/
+void TSystemClock::Sleep(double Seconds)
+{
+	utils::Sleep(Seconds > 0 ? Seconds : 0);
+}
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	pClock The source of time
+* @param	SimRate Simulation steps per second
+* @param	RenderRate Frames rendered per second, 0 to render after each
+*			update that ran at least a step
+******************************************************************************/
+TGameLoop::TGameLoop(TClock* pClock, double SimRate, double RenderRate)
+{
+	assert(pClock);
+
+	m_pClock = pClock;
+	m_nMaxSteps = LOOP_MAXSTEPS;
+
+	SetSimRate(SimRate);
+	SetRenderRate(RenderRate);
+
+	ResetStats();
+	Reset();
+}
+
+/*!****************************************************************************
+* @brief	Sets the simulation rate
+* @param	SimRate Simulation steps per second
+******************************************************************************/
+void TGameLoop::SetSimRate(double SimRate)
+{
+	assert(SimRate > 0);
+
+	m_StepTime = 1.0 / SimRate;
+}
+
+/*!****************************************************************************
+* @brief	Sets the render rate
+* @param	RenderRate Frames rendered per second, 0 to render at each step
+******************************************************************************/
+void TGameLoop::SetRenderRate(double RenderRate)
+{
+	m_FrameTime = RenderRate > 0 ? 1.0 / RenderRate : 0;
+}
+
+/*!****************************************************************************
+* @brief	Restarts the timing, e.g. after a pause, discarding the time
+*			accumulated so far
+******************************************************************************/
+void TGameLoop::Reset()
+{
+	m_LastTime = m_pClock->GetTime();
+	m_NextFrame = m_LastTime;
+	m_Accumulator = 0;
+	m_bStepped = false;
+}
+
+/*!****************************************************************************
+* @brief	Accumulates the time elapsed since the last call
+* @return	The number of simulation steps to be run now
+******************************************************************************/
+unsigned TGameLoop::Update()
+{
+	double Now = m_pClock->GetTime();
+	double Elapsed = Now - m_LastTime;
+
+	m_LastTime = Now;
+	m_Accumulator += Elapsed;
+
+	m_Stats.nFrames++;
+	m_Stats.LastFrame = Elapsed;
+	m_Stats.TotalFrame += Elapsed;
+	if( Elapsed < m_Stats.MinFrame ) m_Stats.MinFrame = Elapsed;
+	if( Elapsed > m_Stats.MaxFrame ) m_Stats.MaxFrame = Elapsed;
+
+	unsigned nSteps = unsigned( floor(m_Accumulator / m_StepTime) );
+										// too far behind (e.g. the window has
+                                        // been dragged): drop the oldest steps
+	if( nSteps > m_nMaxSteps )
+	{
+		m_Stats.nDroppedSteps += nSteps - m_nMaxSteps;
+		nSteps = m_nMaxSteps;
+	}
+
+	m_Accumulator -= nSteps * m_StepTime;
+
+	if( m_Accumulator >= m_StepTime ) m_Accumulator = fmod(m_Accumulator, m_StepTime);
+
+	m_Stats.nSteps += nSteps;
+	m_bStepped = nSteps > 0;
+
+	return nSteps;
+}
+
+/*!****************************************************************************
+* @brief	Checks if a frame should be rendered after the last update
+* @return	true if a frame is due
+******************************************************************************/
+bool TGameLoop::IsRenderTime()
+{
+	if( !m_bStepped ) return false;
+
+	if( m_FrameTime > 0 )
+	{
+		if( m_LastTime < m_NextFrame ) return false;
+
+		m_NextFrame += m_FrameTime;
+										// more than a frame late, resync
+		if( m_NextFrame < m_LastTime ) m_NextFrame = m_LastTime + m_FrameTime;
+	}
+
+	m_Stats.nRendered++;
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Waits until the next simulation step is due
+******************************************************************************/
+void TGameLoop::Wait()
+{
+	double Deadline = m_LastTime + m_StepTime - m_Accumulator;
+	double Start = m_pClock->GetTime();
+	double Remaining = Deadline - Start;
+
+	if( Remaining > LOOP_SPINTIME )
+	{
+		m_pClock->Sleep(Remaining - LOOP_SPINTIME);
+	}
+
+	while( m_pClock->GetTime() < Deadline )
+	{
+		m_pClock->Sleep(0);
+	}
+
+	m_Stats.TotalSleep += m_pClock->GetTime() - Start;
+}
+
+/*!****************************************************************************
+* @brief	Gets the interpolation factor between the last two steps
+* @return	The fraction of a step elapsed after the last one, in [0,1)
+******************************************************************************/
+double TGameLoop::GetAlpha()
+{
+	return m_Accumulator / m_StepTime;
+}
+
+/*!****************************************************************************
+* @brief	Resets the statistics
+******************************************************************************/
+void TGameLoop::ResetStats()
+{
+	m_Stats.nFrames = m_Stats.nSteps = 0;
+	m_Stats.nDroppedSteps = m_Stats.nRendered = 0;
+
+	m_Stats.LastFrame = m_Stats.MaxFrame = m_Stats.TotalFrame = 0;
+	m_Stats.MinFrame = DBL_MAX;
+	m_Stats.TotalSleep = 0;
+}
+
@@ -0,0 +1,110 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _LOOP_H_
+#define _LOOP_H_
+
+#include "commdefs.h"
+
+#define LOOP_MAXSTEPS		5		// max steps run to catch up in a frame
+#define LOOP_SPINTIME		0.002	// the last part of a wait only yields,
+                                    // Sleep() is not accurate enough
+#define VCLOCK_QUANTUM		1.0e-4	// a yield on the virtual clock
+
+
+										// the source of time of the game loop
+class TClock
+{
+	public:
+		virtual ~TClock() {}
+
+		virtual double GetTime() = 0;
+										// Seconds == 0 yields the time slice
+		virtual void Sleep(double Seconds) = 0;
+};
+
+										// the high resolution system clock
+class TSystemClock : public TClock
+{
+	public:
+		double GetTime();
+		void Sleep(double Seconds);
+};
+
+										// a clock that only moves when told to,
+                                        // to drive the loop without a window
+class TVirtualClock : public TClock
+{
+	public:
+		TVirtualClock(double Time = 0) { m_Time = Time; }
+
+		double GetTime() { return m_Time; }
+		void Sleep(double Seconds) { m_Time += Seconds > 0 ? Seconds : VCLOCK_QUANTUM; }
+
+		void Advance(double Seconds) { m_Time += Seconds; }
+
+	protected:
+		double m_Time;
+};
+
+struct TFrameStats
+{
+	unsigned nFrames;				// calls to Update()
+    unsigned nSteps;				// simulation steps run
+	unsigned nDroppedSteps;			// steps skipped, too far behind
+    unsigned nRendered;				// frames rendered
+
+	double LastFrame, MinFrame, MaxFrame, TotalFrame;
+	double TotalSleep;
+
+	double GetAverageFrame() { return nFrames ? TotalFrame / nFrames : 0; }
+};
+
+										// fixed timestep scheduler: the time
+                                        // elapsed is accumulated and consumed
+                                        // in steps of 1/SimRate seconds, the
+                                        // frames are rendered at RenderRate
+class TGameLoop
+{
+	public:
+		TGameLoop(TClock* pClock, double SimRate = FPS, double RenderRate = FPS);
+
+	public:
+		void Reset();
+
+		unsigned Update();
+		bool IsRenderTime();
+		void Wait();
+
+		double GetAlpha();
+		double GetStepTime() { return m_StepTime; }
+
+		void SetSimRate(double SimRate);
+		void SetRenderRate(double RenderRate);
+		void SetMaxSteps(unsigned nMaxSteps) { m_nMaxSteps = nMaxSteps; }
+
+		TClock* GetClock() { return m_pClock; }
+
+		TFrameStats GetStats() { return m_Stats; }
+		void ResetStats();
+
+	protected:
+		TClock* m_pClock;
+
+		double m_StepTime;				// 1 / SimRate
+		double m_FrameTime;				// 1 / RenderRate, 0 = every step
+		unsigned m_nMaxSteps;
+
+		double m_LastTime;
+		double m_Accumulator;
+		double m_NextFrame;
+		bool m_bStepped;
+
+		TFrameStats m_Stats;
+};
+
+#endif
+
@@ -0,0 +1,254 @@
+/*!****************************************************************************
+
+	@file	lz4.h
+	@file	lz4.cpp
+
+	@brief	LZ4 block compression
+
+	@par	A compressor and a decompressor of the LZ4 block format, for the
+			entries of the asset pack. The compressor is the greedy one of
+			the reference, with a table of the last position of each hash
+			of 4 bytes; the decompressor checks every length and offset
+			against the sizes of the source and of the destination, so a
+			broken block is rejected, and never read or written out of
+			bounds.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+
+#include <vector>
+
+#include "lz4.h"
+
+
+/*!****************************************************************************
+* @brief	Reads 4 bytes, at any address
+* @param	pBytes Pointer to the bytes
+* @return	The bytes, as an integer of the machine
+******************************************************************************/
+static inline unsigned ReadTheInt(const unsigned char* pBytes)
+{
+	unsigned nValue;
+
+	memcpy(&nValue, pBytes, sizeof(nValue));
+
+	return nValue;
+}
+
+/*!****************************************************************************
+* @brief	Hashes 4 bytes to LZ4_HASHLOG bits
+* @param	nValue The bytes
+* @return	The index in the table
+******************************************************************************/
+static inline unsigned HashTheInt(unsigned nValue)
+{
+	return (nValue * 2654435761u) >> (32 - LZ4_HASHLOG);
+}
+
+/*!****************************************************************************
+* @brief	Writes a length that does not fit in its 4 bits of the token
+* @param	pDst Pointer to the destination
+* @param	nLength The length, less 15
+* @return	Pointer past the bytes written
+******************************************************************************/
+static unsigned char* PutTheLength(unsigned char* pDst, unsigned nLength)
+{
+	for( ; nLength >= 255; nLength -= 255) *pDst++ = 255;
+
+	*pDst++ = (unsigned char) nLength;
+
+	return pDst;
+}
+
+/*!****************************************************************************
+* @brief	Reads a length that does not fit in its 4 bits of the token
+* @param	pSrc Pointer to the source, moved past the bytes read
+* @param	pEnd Pointer to the end of the source
+* @param	nLength The length, 15 on input
+* @param	nLimit The largest length that can be right
+* @return	False if the source ends, or the length is too long
+******************************************************************************/
+static bool GetTheLength(const unsigned char*& pSrc, const unsigned char* pEnd,
+	unsigned& nLength, unsigned nLimit)
+{
+	unsigned nByte;
+
+	do
+	{
+		if( pSrc >= pEnd ) return false;
+
+		nByte = *pSrc++;
+		nLength += nByte;
+											// also keeps the sum from wrapping
+		if( nLength > nLimit ) return false;
+	}
+	while( nByte == 255 );
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Gets the largest size of a compressed block
+* @param	nSize The size of the data
+* @return	The size of the buffer for LZ4Compress()
+******************************************************************************/
+unsigned LZ4GetBound(unsigned nSize)
+{
+	return nSize + nSize / 255 + 16;
+}
+
+/*!****************************************************************************
+* @brief	Compresses a block
+* @param	pSrc Pointer to the data
+* @param	nSize The size of the data
+* @param	pDst Pointer to a buffer of LZ4GetBound(nSize) bytes
+* @return	The size of the compressed block
+******************************************************************************/
+unsigned LZ4Compress(const char* pSrc, unsigned nSize, char* pDst)
+{
+	assert(pSrc || !nSize);
+	assert(pDst);
+
+	const unsigned char* pIn = (const unsigned char*) pSrc;
+	unsigned char* pOut = (unsigned char*) pDst;
+
+	unsigned nAnchor = 0;					// start of the literals
+
+	if( nSize > LZ4_MFLIMIT )
+	{
+											// last position of each hash; a
+                                            // stale one is caught by the compare
+		std::vector<unsigned> Table(1 << LZ4_HASHLOG, 0);
+
+		unsigned nLimit = nSize - LZ4_MFLIMIT;
+		unsigned nMatchEnd = nSize - LZ4_LASTLITERALS;
+
+		for(unsigned i=0; i<nLimit; )
+		{
+			unsigned nValue = ReadTheInt(pIn + i);
+			unsigned nHash = HashTheInt(nValue);
+			unsigned nCandidate = Table[nHash];
+
+			Table[nHash] = i;
+
+			if( nCandidate >= i || i - nCandidate > LZ4_MAXOFFSET ||
+				ReadTheInt(pIn + nCandidate) != nValue )
+			{
+				i++;
+				continue;
+			}
+
+			unsigned nLength = LZ4_MINMATCH;
+
+			while( i + nLength < nMatchEnd && pIn[nCandidate + nLength] == pIn[i + nLength] )
+			{
+				nLength++;
+			}
+											// the sequence: token, literals,
+                                            // offset, then the match length
+			unsigned nLiterals = i - nAnchor;
+			unsigned nMatch = nLength - LZ4_MINMATCH;
+			unsigned char* pToken = pOut++;
+
+			*pToken = (unsigned char) ((nLiterals < 15 ? nLiterals : 15) << 4);
+
+			if( nLiterals >= 15 ) pOut = PutTheLength(pOut, nLiterals - 15);
+
+			memcpy(pOut, pIn + nAnchor, nLiterals);
+			pOut += nLiterals;
+
+			unsigned nOffset = i - nCandidate;
+
+			*pOut++ = (unsigned char) (nOffset & 0xFF);
+			*pOut++ = (unsigned char) (nOffset >> 8);
+
+			*pToken |= (unsigned char) (nMatch < 15 ? nMatch : 15);
+
+			if( nMatch >= 15 ) pOut = PutTheLength(pOut, nMatch - 15);
+
+			i += nLength;
+			nAnchor = i;
+		}
+	}
+											// the last sequence: literals only
+	unsigned nLiterals = nSize - nAnchor;
+
+	*pOut++ = (unsigned char) ((nLiterals < 15 ? nLiterals : 15) << 4);
+
+	if( nLiterals >= 15 ) pOut = PutTheLength(pOut, nLiterals - 15);
+
+	if( nLiterals ) memcpy(pOut, pIn + nAnchor, nLiterals);
+	pOut += nLiterals;
+
+	return unsigned(pOut - (unsigned char*) pDst);
+}
+
+/*!****************************************************************************
+* @brief	Decompresses a block
+* @param	pSrc Pointer to the compressed block
+* @param	nSize The size of the compressed block
+* @param	pDst Pointer to the destination
+* @param	nDstSize The size of the data, as stored with the block
+* @return	True for success, false if the block is broken or its data is
+*			not nDstSize bytes
+******************************************************************************/
+bool LZ4Decompress(const char* pSrc, unsigned nSize, char* pDst, unsigned nDstSize)
+{
+	assert(pSrc || !nSize);
+	assert(pDst || !nDstSize);
+
+	const unsigned char* pIn = (const unsigned char*) pSrc;
+	const unsigned char* pInEnd = pIn + nSize;
+	unsigned char* pOut = (unsigned char*) pDst;
+	unsigned char* pOutEnd = pOut + nDstSize;
+
+	while( pIn < pInEnd )
+	{
+		unsigned nToken = *pIn++;
+		unsigned nLiterals = nToken >> 4;
+
+		if( nLiterals == 15 && !GetTheLength(pIn, pInEnd, nLiterals, nSize) ) return false;
+
+		if( nLiterals > unsigned(pInEnd - pIn) || nLiterals > unsigned(pOutEnd - pOut) )
+		{
+			return false;
+		}
+
+		memcpy(pOut, pIn, nLiterals);
+		pIn += nLiterals;
+		pOut += nLiterals;
+											// the last sequence has no match
+		if( pIn == pInEnd ) break;
+
+		if( pInEnd - pIn < 2 ) return false;
+
+		unsigned nOffset = pIn[0] | (pIn[1] << 8);
+		pIn += 2;
+
+		if( nOffset == 0 || nOffset > unsigned(pOut - (unsigned char*) pDst) ) return false;
+
+		unsigned nLength = nToken & 15;
+
+		if( nLength == 15 && !GetTheLength(pIn, pInEnd, nLength, nDstSize) ) return false;
+
+		nLength += LZ4_MINMATCH;
+
+		if( nLength > unsigned(pOutEnd - pOut) ) return false;
+		const unsigned char* pMatch = pOut - nOffset;
+											// byte by byte if the match
+                                            // overlaps the bytes it writes
+		if( nOffset >= nLength ) memcpy(pOut, pMatch, nLength);
+		else for(unsigned i=0; i<nLength; i++) pOut[i] = pMatch[i];
+
+		pOut += nLength;
+	}
+
+	return pOut == pOutEnd;
+}
+
@@ -0,0 +1,27 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _LZ4_H_
+#define _LZ4_H_
+
+#define LZ4_MINMATCH		4
+#define LZ4_LASTLITERALS	5			// the block ends with literals
+#define LZ4_MFLIMIT			12			// no match starts in the last bytes
+#define LZ4_MAXOFFSET		65535
+#define LZ4_HASHLOG			12
+
+
+										// the block format of LZ4: sequences
+                                        // of literals and of a match in the
+                                        // previous 64k; the size of the
+                                        // block is known by the caller
+unsigned LZ4GetBound(unsigned nSize);
+
+unsigned LZ4Compress(const char* pSrc, unsigned nSize, char* pDst);
+bool LZ4Decompress(const char* pSrc, unsigned nSize, char* pDst, unsigned nDstSize);
+
+#endif
+
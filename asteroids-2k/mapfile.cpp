@@ -0,0 +1,139 @@
+/*!****************************************************************************
+
+	@file	mapfile.h
+	@file	mapfile.cpp
+
+	@brief	Files mapped in memory
+
+	@par	The data files are read through a mapping of the file: a load is
+			an open and a map, the pages are read by the system on demand
+			and shared with its cache, and nothing is copied or allocated.
+			The mapping lives until Close(), or the destructor.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <stddef.h>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#include "mapfile.h"
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TMappedFile::TMappedFile()
+{
+	m_pData = NULL;
+	m_nSize = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#else
+	m_nFile = -1;
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TMappedFile::~TMappedFile()
+{
+	Close();
+}
+
+/*!****************************************************************************
+* @brief	Maps a file
+* @param	pFileName The name of the file
+* @return	True for success, false if the file cannot be mapped or is empty
+******************************************************************************/
+bool TMappedFile::Open(const char* pFileName)
+{
+	assert(pFileName);
+
+	Close();
+
+#ifdef _WIN32
+	m_hFile = ::CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if( m_hFile == INVALID_HANDLE_VALUE ) return false;
+
+	DWORD nSize = ::GetFileSize(m_hFile, NULL);
+
+	if( nSize == INVALID_FILE_SIZE || nSize == 0 )
+	{
+		Close();
+		return false;
+	}
+
+	m_hMapping = ::CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if( m_hMapping )
+	{
+		m_pData = (const char*) ::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	m_nFile = ::open(pFileName, O_RDONLY);
+
+	if( m_nFile < 0 ) return false;
+
+	struct stat Stat;
+
+	if( ::fstat(m_nFile, &Stat) != 0 || Stat.st_size <= 0 )
+	{
+		Close();
+		return false;
+	}
+
+	unsigned nSize = unsigned(Stat.st_size);
+
+	void* pData = ::mmap(NULL, nSize, PROT_READ, MAP_PRIVATE, m_nFile, 0);
+
+	if( pData != MAP_FAILED ) m_pData = (const char*) pData;
+#endif
+
+	if( !m_pData )
+	{
+		Close();
+		return false;
+	}
+
+	m_nSize = nSize;
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Unmaps the file, and closes it
+******************************************************************************/
+void TMappedFile::Close()
+{
+#ifdef _WIN32
+	if( m_pData ) ::UnmapViewOfFile(m_pData);
+	if( m_hMapping ) ::CloseHandle(m_hMapping);
+	if( m_hFile != INVALID_HANDLE_VALUE ) ::CloseHandle(m_hFile);
+
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+#else
+	if( m_pData ) ::munmap((void*) m_pData, m_nSize);
+	if( m_nFile >= 0 ) ::close(m_nFile);
+
+	m_nFile = -1;
+#endif
+
+	m_pData = NULL;
+	m_nSize = 0;
+}
+
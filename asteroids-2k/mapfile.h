@@ -0,0 +1,48 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _MAPFILE_H_
+#define _MAPFILE_H_
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+										// a file mapped in memory, read only:
+                                        // its bytes are read in place, with
+                                        // no copy on the heap
+class TMappedFile
+{
+	public:
+		TMappedFile();
+		~TMappedFile();
+
+	public:
+		bool Open(const char* pFileName);
+		void Close();
+
+		bool IsOpen() { return m_pData != NULL; }
+
+		const char* GetData() { return m_pData; }
+		unsigned GetSize() { return m_nSize; }
+
+	protected:
+		const char* m_pData;
+		unsigned m_nSize;
+#ifdef _WIN32
+		HANDLE m_hFile, m_hMapping;
+#else
+		int m_nFile;
+#endif
+
+	private:
+										// not copied: one mapping, one owner
+		TMappedFile(const TMappedFile&);
+		TMappedFile& operator=(const TMappedFile&);
+};
+
+#endif
+
@@ -80,4 +80,98 @@ void Sort(TVecIntegers& VecInts)
 	}
 }
 
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nSeed The seed of the sequence
+******************************************************************************/
+TRandom::TRandom(unsigned nSeed)
+{
+	Seed(nSeed);
+}
+
+/*!****************************************************************************
+* @brief	Restarts the sequence
+* @param	nSeed The seed of the sequence
+* @note		The state is filled by SplitMix32, so that close seeds give
+*			unrelated sequences and the state is never all zero
+******************************************************************************/
+void TRandom::Seed(unsigned nSeed)
+{
+	m_nSeed = nSeed;
+
+	unsigned nZ = nSeed;
+
+	for(int i=0; i<4; i++)
+	{
+		nZ += 0x9E3779B9u;
+
+		unsigned nX = nZ;
+		nX = (nX ^ (nX >> 16)) * 0x85EBCA6Bu;
+		nX = (nX ^ (nX >> 13)) * 0xC2B2AE35u;
+
+		m_State[i] = nX ^ (nX >> 16);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Generates the next value of the sequence
+* @return	A value in [0, 2^32-1]
+******************************************************************************/
+unsigned TRandom::Next()
+{
+	unsigned nX = m_State[1] * 5;
+	unsigned nResult = ((nX << 7) | (nX >> 25)) * 9;
+	unsigned nT = m_State[1] << 9;
+
+	m_State[2] ^= m_State[0];
+	m_State[3] ^= m_State[1];
+	m_State[1] ^= m_State[2];
+	m_State[0] ^= m_State[3];
+
+	m_State[2] ^= nT;
+	m_State[3] = (m_State[3] << 11) | (m_State[3] >> 21);
+
+	return nResult;
+}
+
+/*!****************************************************************************
+* @brief	Generates a value in [0,1]
+******************************************************************************/
+double TRandom::NextDouble()
+{
+	return Next() / 4294967295.0;
+}
+
+/*!****************************************************************************
+* @brief	Generates a random value in [-Val, Val], as maths::Rand()
+******************************************************************************/
+double TRandom::Rand(double Val)
+{
+	return Val - 2.0 * NextDouble() * Val;
+}
+
+/*!****************************************************************************
+* @brief	Generates a random value in [0, Val], as maths::AbsRand()
+******************************************************************************/
+double TRandom::AbsRand(double Val)
+{
+	return NextDouble() * Val;
+}
+
+/*!****************************************************************************
+* @brief	Randomly generates a unitary value with sign, as maths::RandSign()
+******************************************************************************/
+int TRandom::RandSign()
+{
+	return maths::Sign(-1.0 + 2.0 * NextDouble());
+}
+
+/*!****************************************************************************
+* @brief	Gets a digest of the state, to compare two generators
+******************************************************************************/
+unsigned TRandom::GetHash()
+{
+	return m_State[0] ^ (m_State[1] * 3) ^ (m_State[2] * 5) ^ (m_State[3] * 7);
+}
+
 }	// namespace maths
\ No newline at end of file
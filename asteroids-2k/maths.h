@@ -30,6 +30,32 @@ namespace maths
     double AbsRand(double Val);
 
     void Sort(TVecIntegers& VecInts);
+
+										// xoshiro128** pseudo-random generator:
+                                        // same seed, same sequence, on every
+                                        // platform (rand() is not)
+	class TRandom
+    {
+    	public:
+        	TRandom(unsigned nSeed = 1);
+
+		public:
+        	void Seed(unsigned nSeed);
+            unsigned GetSeed() { return m_nSeed; }
+
+            unsigned Next();
+            double NextDouble();
+
+            double Rand(double Val);
+            double AbsRand(double Val);
+            int RandSign();
+
+            unsigned GetHash();
+
+		protected:
+        	unsigned m_nSeed;
+			unsigned m_State[4];
+    };
 }
 
 #endif
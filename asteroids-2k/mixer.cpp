@@ -0,0 +1,586 @@
+/*!****************************************************************************
+
+	@file	mixer.h
+	@file	mixer.cpp
+
+	@brief	Software mixer and WAV sink
+
+	@par	A backend of the voice pool (see voices.cpp) that mixes the
+			sounds itself: the PCM buffers, 8 or 16 bit, mono or stereo,
+			are converted to float and resampled to the rate of the bus
+			when they are loaded; each voice adds its buffer to a stereo
+			float bus, with its gain and its pan; the bus is scaled by the
+			master volume and saturated to 16 bit.
+
+	@par	The pan is a balance: at the center both the channels have the
+			gain of the voice, a voice on the left keeps its left channel
+			and fades the right one. The stereo buffers are panned the same
+			way, channel by channel.
+
+	@par	The kernels use SSE2 when the compiler provides it, with a
+			scalar tail; the samples are mixed in the same order on all the
+			paths, the conversion to 16 bit rounds to the nearest (half to
+			even on SSE2, away from zero on the scalar path).
+
+	@par	The output goes to a stream of OpenAL (see audio.cpp), or to a
+			WAV file through TWavSink, on a machine without audio.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MIXER_SSE2
+#endif
+
+
+/*!****************************************************************************
+* @brief	Adds a mono buffer to the bus
+* @param	pBus The stereo bus, 2 * nFrames samples
+* @param	pSrc The samples, nFrames
+* @param	nFrames Number of frames
+* @param	GainL Gain of the left channel
+* @param	GainR Gain of the right channel
+******************************************************************************/
+static void MixTheMono(float* pBus, const float* pSrc, unsigned nFrames,
+	float GainL, float GainR)
+{
+	unsigned i = 0;
+
+#if defined(MIXER_SSE2)
+	__m128 G = _mm_setr_ps(GainL, GainR, GainL, GainR);
+
+	for(; i + 4 <= nFrames; i += 4)
+	{
+		__m128 S = _mm_loadu_ps(pSrc + i);
+											// s0 s0 s1 s1, s2 s2 s3 s3
+		__m128 Lo = _mm_unpacklo_ps(S, S);
+		__m128 Hi = _mm_unpackhi_ps(S, S);
+
+		float* pOut = pBus + 2*i;
+
+		_mm_storeu_ps(pOut, _mm_add_ps(_mm_loadu_ps(pOut), _mm_mul_ps(Lo, G)));
+		_mm_storeu_ps(pOut + 4, _mm_add_ps(_mm_loadu_ps(pOut + 4), _mm_mul_ps(Hi, G)));
+	}
+#endif
+
+	for(; i<nFrames; i++)
+	{
+		pBus[2*i] += pSrc[i] * GainL;
+		pBus[2*i + 1] += pSrc[i] * GainR;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Adds a stereo buffer to the bus
+* @param	pBus The stereo bus, 2 * nFrames samples
+* @param	pSrc The samples, 2 * nFrames interleaved
+* @param	nFrames Number of frames
+* @param	GainL Gain of the left channel
+* @param	GainR Gain of the right channel
+******************************************************************************/
+static void MixTheStereo(float* pBus, const float* pSrc, unsigned nFrames,
+	float GainL, float GainR)
+{
+	unsigned i = 0, nSamples = 2 * nFrames;
+
+#if defined(MIXER_SSE2)
+	__m128 G = _mm_setr_ps(GainL, GainR, GainL, GainR);
+
+	for(; i + 4 <= nSamples; i += 4)
+	{
+		__m128 S = _mm_mul_ps(_mm_loadu_ps(pSrc + i), G);
+
+		_mm_storeu_ps(pBus + i, _mm_add_ps(_mm_loadu_ps(pBus + i), S));
+	}
+#endif
+
+	for(; i<nSamples; i += 2)
+	{
+		pBus[i] += pSrc[i] * GainL;
+		pBus[i + 1] += pSrc[i + 1] * GainR;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Converts the bus to 16 bit samples
+* @param	pOut The 16 bit samples
+* @param	pBus The samples of the bus
+* @param	nSamples Number of samples
+* @param	Volume The master volume
+******************************************************************************/
+static void ConvertTheBus(short* pOut, const float* pBus, unsigned nSamples,
+	float Volume)
+{
+	const float Scale = 32767.0f * Volume;
+	unsigned i = 0;
+
+#if defined(MIXER_SSE2)
+	__m128 S = _mm_set1_ps(Scale);
+	__m128 Max = _mm_set1_ps(32767.0f);
+	__m128 Min = _mm_set1_ps(-32768.0f);
+
+	for(; i + 8 <= nSamples; i += 8)
+	{
+											// clamped before the conversion,
+                                            // out of range it gives INT_MIN
+		__m128 A = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pBus + i), S), Min), Max);
+		__m128 B = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pBus + i + 4), S), Min), Max);
+
+		__m128i P = _mm_packs_epi32(_mm_cvtps_epi32(A), _mm_cvtps_epi32(B));
+
+		_mm_storeu_si128((__m128i*) (pOut + i), P);
+	}
+#endif
+
+	for(; i<nSamples; i++)
+	{
+		float X = std::min(std::max(pBus[i] * Scale, -32768.0f), 32767.0f);
+
+		pOut[i] = short(X < 0 ? X - 0.5f : X + 0.5f);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nSampleRate The frames per second of the bus
+******************************************************************************/
+TSoftMixer::TSoftMixer(unsigned nSampleRate)
+{
+	assert(nSampleRate > 0);
+
+	m_nSampleRate = nSampleRate;
+	m_Volume = 1.0;
+
+	m_Bus.resize(2 * MIXER_BLOCK);
+}
+
+/*!****************************************************************************
+* @brief	Adds a PCM buffer, as read from a WAV file
+* @param	pData The samples: 8 bit unsigned or 16 bit signed little endian,
+*			interleaved
+* @param	nChannels 1 for mono, 2 for stereo
+* @param	nSampleRate The frames per second of the buffer
+* @param	nBps The bits per sample, 8 or 16
+* @param	nSize The size of the samples, in bytes
+* @return	The id of the buffer
+* @note		A buffer at another rate is resampled to the rate of the bus,
+*			by linear interpolation
+******************************************************************************/
+unsigned TSoftMixer::AddTheBuffer(const char* pData, int nChannels,
+	int nSampleRate, int nBps, int nSize)
+{
+	assert(pData || nSize == 0);
+	assert(nChannels == 1 || nChannels == 2);
+	assert(nBps == 8 || nBps == 16);
+	assert(nSampleRate > 0);
+
+	const unsigned char* pBytes = (const unsigned char*) pData;
+	unsigned nFrames = nSize / (nChannels * nBps / 8);
+
+	std::vector<float> Samples(nFrames * nChannels);
+
+	for(unsigned i=0; i<Samples.size(); i++)
+	{
+		if( nBps == 8 )
+		{
+			Samples[i] = (int(pBytes[i]) - 128) / 128.0f;
+		}
+		else
+		{
+			short nSample = short(pBytes[2*i] | (pBytes[2*i + 1] << 8));
+			Samples[i] = nSample / 32768.0f;
+		}
+	}
+
+	m_Buffers.push_back(TMixerBuffer());
+	TMixerBuffer& Buffer = m_Buffers.back();
+
+	Buffer.nChannels = nChannels;
+
+	if( unsigned(nSampleRate) == m_nSampleRate || nFrames < 2 )
+	{
+		Buffer.Samples.swap(Samples);
+		Buffer.nFrames = nFrames;
+	}
+	else
+	{
+		Buffer.nFrames = unsigned(double(nFrames) * m_nSampleRate / nSampleRate);
+		Buffer.Samples.resize(Buffer.nFrames * nChannels);
+
+		double Step = double(nSampleRate) / m_nSampleRate;
+
+		for(unsigned i=0; i<Buffer.nFrames; i++)
+		{
+			double Pos = i * Step;
+			unsigned n = std::min(unsigned(Pos), nFrames - 2);
+			float T = float(Pos - n);
+
+			for(int c=0; c<nChannels; c++)
+			{
+				float A = Samples[n * nChannels + c];
+				float B = Samples[(n + 1) * nChannels + c];
+
+				Buffer.Samples[i * nChannels + c] = A + (B - A) * T;
+			}
+		}
+	}
+
+	return m_Buffers.size() - 1;
+}
+
+/*!****************************************************************************
+* @brief	Removes all the buffers
+* @note		The sources must be stopped
+******************************************************************************/
+void TSoftMixer::FreeTheBuffers()
+{
+	for(unsigned i=0; i<m_Sources.size(); i++)
+	{
+		assert(!m_Sources[i].bPlaying);
+	}
+
+	m_Buffers.clear();
+}
+
+/*!****************************************************************************
+* @brief	Sets the master volume
+* @param	Volume Value for volume, between 0..1
+******************************************************************************/
+void TSoftMixer::SetMasterVolume(double Volume)
+{
+	m_Volume = std::min(std::max(Volume, 0.0), 1.0);
+}
+
+/*!****************************************************************************
+* @brief	Counts the sources playing
+* @return	The number of sources playing
+******************************************************************************/
+unsigned TSoftMixer::GetPlayingCount()
+{
+	unsigned nCount = 0;
+
+	for(unsigned i=0; i<m_Sources.size(); i++) nCount += m_Sources[i].bPlaying;
+
+	return nCount;
+}
+
+/*!****************************************************************************
+* @brief	Memory of the buffers
+* @return	The size of the samples, in bytes
+******************************************************************************/
+unsigned TSoftMixer::GetMemory()
+{
+	unsigned nSize = 0;
+
+	for(unsigned i=0; i<m_Buffers.size(); i++)
+	{
+		nSize += m_Buffers[i].Samples.capacity() * sizeof(float);
+	}
+
+	return nSize;
+}
+
+/*!****************************************************************************
+* @brief	Mixes the sources playing
+* @param	pBus The stereo bus, 2 * nFrames samples, overwritten
+* @param	nFrames Number of frames
+******************************************************************************/
+void TSoftMixer::Mix(float* pBus, unsigned nFrames)
+{
+	assert(pBus);
+
+	memset(pBus, 0, 2 * nFrames * sizeof(float));
+
+	for(unsigned i=0; i<m_Sources.size(); i++)
+	{
+		if( m_Sources[i].bPlaying ) MixTheSource(m_Sources[i], pBus, nFrames);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Mixes the sources playing, at the master volume, to 16 bit
+* @param	pFrames The stereo frames, 2 * nFrames samples
+* @param	nFrames Number of frames
+******************************************************************************/
+void TSoftMixer::Render(short* pFrames, unsigned nFrames)
+{
+	assert(pFrames);
+
+	while( nFrames > 0 )
+	{
+		unsigned nCount = std::min(nFrames, unsigned(MIXER_BLOCK));
+
+		Mix(&m_Bus[0], nCount);
+		ConvertTheBus(pFrames, &m_Bus[0], 2 * nCount, float(m_Volume));
+
+		pFrames += 2 * nCount;
+		nFrames -= nCount;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the kernels selected at compile time
+* @return	"sse2" or "scalar"
+******************************************************************************/
+const char* TSoftMixer::GetKernelsName()
+{
+#if defined(MIXER_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Creates a source, stopped
+* @return	The id of the source
+******************************************************************************/
+unsigned TSoftMixer::CreateTheSource()
+{
+	TMixerSource Source = { 0, 0, 1.0f, 1.0f, false, false };
+	m_Sources.push_back(Source);
+
+	return m_Sources.size() - 1;
+}
+
+/*!****************************************************************************
+* @brief	Deletes a source
+* @param	nSource The id of the source
+* @note		The ids are not reused: the source is only stopped
+******************************************************************************/
+void TSoftMixer::DeleteTheSource(unsigned nSource)
+{
+	Stop(nSource);
+}
+
+/*!****************************************************************************
+* @brief	Plays a buffer on a source, from its start
+* @param	nSource The id of the source
+* @param	nBuffer The id of the buffer
+* @param	bLoop True for playing the buffer repeatedly
+* @param	Gain The gain, between 0..1
+* @param	Pan The position, -1 left .. 1 right
+******************************************************************************/
+void TSoftMixer::Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+	double Gain, double Pan)
+{
+	assert(nSource < m_Sources.size());
+	assert(nBuffer < m_Buffers.size());
+
+	TMixerSource& Source = m_Sources[nSource];
+
+	Pan = std::min(std::max(Pan, -1.0), 1.0);
+
+	Source.nBuffer = nBuffer;
+	Source.nFrame = 0;
+	Source.GainL = float(Gain * std::min(1.0, 1.0 - Pan));
+	Source.GainR = float(Gain * std::min(1.0, 1.0 + Pan));
+	Source.bPlaying = m_Buffers[nBuffer].nFrames > 0;
+	Source.bLoop = bLoop;
+}
+
+/*!****************************************************************************
+* @brief	Stops a source
+* @param	nSource The id of the source
+******************************************************************************/
+void TSoftMixer::Stop(unsigned nSource)
+{
+	assert(nSource < m_Sources.size());
+
+	m_Sources[nSource].bPlaying = false;
+}
+
+/*!****************************************************************************
+* @brief	Checks if a source is playing
+* @param	nSource The id of the source
+* @return	True until the end of the buffer, always if looping
+******************************************************************************/
+bool TSoftMixer::IsPlaying(unsigned nSource)
+{
+	assert(nSource < m_Sources.size());
+
+	return m_Sources[nSource].bPlaying;
+}
+
+/*!****************************************************************************
+* @brief	Adds a source to the bus, and moves it forward
+* @param	Source The source, playing
+* @param	pBus The stereo bus
+* @param	nFrames Number of frames
+******************************************************************************/
+void TSoftMixer::MixTheSource(TMixerSource& Source, float* pBus, unsigned nFrames)
+{
+	TMixerBuffer& Buffer = m_Buffers[Source.nBuffer];
+
+	while( nFrames > 0 && Source.bPlaying )
+	{
+		unsigned nCount = std::min(nFrames, Buffer.nFrames - Source.nFrame);
+		const float* pSrc = &Buffer.Samples[Source.nFrame * Buffer.nChannels];
+
+		if( Buffer.nChannels == 1 )
+		{
+			MixTheMono(pBus, pSrc, nCount, Source.GainL, Source.GainR);
+		}
+		else
+		{
+			MixTheStereo(pBus, pSrc, nCount, Source.GainL, Source.GainR);
+		}
+
+		pBus += 2 * nCount;
+		nFrames -= nCount;
+		Source.nFrame += nCount;
+											// at the end: again, or stopped
+		if( Source.nFrame >= Buffer.nFrames )
+		{
+			Source.nFrame = 0;
+			Source.bPlaying = Source.bLoop;
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Writes a tag of a RIFF header
+* @param	p The position in the header, moved past the tag
+* @param	pTag The four characters of the tag
+******************************************************************************/
+static void PutTheTag(unsigned char*& p, const char* pTag)
+{
+	memcpy(p, pTag, 4);
+	p += 4;
+}
+
+/*!****************************************************************************
+* @brief	Writes an integer of a RIFF header, little endian
+* @param	p The position in the header, moved past the integer
+* @param	nValue The value
+* @param	nBytes The size of the integer, 2 or 4 bytes
+******************************************************************************/
+static void PutTheInt(unsigned char*& p, unsigned nValue, int nBytes)
+{
+	for(int i=0; i<nBytes; i++) *p++ = (unsigned char) ((nValue >> (8*i)) & 0xFF);
+}
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TWavSink::TWavSink()
+{
+	m_pFile = NULL;
+	m_nSampleRate = MIXER_RATE;
+	m_nFrames = 0;
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TWavSink::~TWavSink()
+{
+	Close();
+}
+
+/*!****************************************************************************
+* @brief	Creates a WAV file
+* @param	pFileName The name of the file
+* @param	nSampleRate The frames per second
+* @return	True for success, false otherwise
+******************************************************************************/
+bool TWavSink::Open(const char* pFileName, unsigned nSampleRate)
+{
+	assert(pFileName);
+
+	Close();
+
+	m_pFile = fopen(pFileName, "wb");
+
+	if( !m_pFile ) return false;
+
+	m_nSampleRate = nSampleRate;
+	m_nFrames = 0;
+											// the sizes are written by Close()
+	WriteTheHeader();
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Appends the frames to the file
+* @param	pFrames The stereo frames, 2 * nFrames samples
+* @param	nFrames Number of frames
+******************************************************************************/
+void TWavSink::Write(const short* pFrames, unsigned nFrames)
+{
+	if( !m_pFile ) return;
+
+	unsigned char Bytes[4 * MIXER_BLOCK];
+
+	while( nFrames > 0 )
+	{
+		unsigned nCount = std::min(nFrames, unsigned(MIXER_BLOCK));
+											// little endian, on any host
+		for(unsigned i=0; i<2 * nCount; i++)
+		{
+			Bytes[2*i] = (unsigned char) (pFrames[i] & 0xFF);
+			Bytes[2*i + 1] = (unsigned char) ((pFrames[i] >> 8) & 0xFF);
+		}
+
+		fwrite(Bytes, 4, nCount, m_pFile);
+
+		pFrames += 2 * nCount;
+		nFrames -= nCount;
+		m_nFrames += nCount;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Writes the sizes in the header, and closes the file
+******************************************************************************/
+void TWavSink::Close()
+{
+	if( !m_pFile ) return;
+
+	fseek(m_pFile, 0, SEEK_SET);
+	WriteTheHeader();
+
+	fclose(m_pFile);
+	m_pFile = NULL;
+}
+
+/*!****************************************************************************
+* @brief	Writes the RIFF header, for the frames written so far
+******************************************************************************/
+void TWavSink::WriteTheHeader()
+{
+	unsigned nData = 4 * m_nFrames;
+
+	unsigned char Header[44];
+	unsigned char* p = Header;
+
+	PutTheTag(p, "RIFF");
+	PutTheInt(p, 36 + nData, 4);
+	PutTheTag(p, "WAVE");
+	PutTheTag(p, "fmt ");
+	PutTheInt(p, 16, 4);
+	PutTheInt(p, 1, 2);						// PCM
+	PutTheInt(p, 2, 2);						// channels
+	PutTheInt(p, m_nSampleRate, 4);
+	PutTheInt(p, 4 * m_nSampleRate, 4);		// bytes per second
+	PutTheInt(p, 4, 2);						// bytes per frame
+	PutTheInt(p, 16, 2);					// bits per sample
+	PutTheTag(p, "data");
+	PutTheInt(p, nData, 4);
+
+	fwrite(Header, 1, sizeof(Header), m_pFile);
+}
+
@@ -0,0 +1,108 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _MIXER_H_
+#define _MIXER_H_
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "voices.h"
+
+#define MIXER_RATE			44100		// frames per second of the bus
+#define MIXER_VOICES		64
+#define MIXER_BLOCK			1024		// frames mixed at once
+
+
+										// a mixer in the game, without audio
+                                        // library: the buffers are converted
+                                        // to float at load, the voices are
+                                        // summed on a stereo float bus, then
+                                        // scaled by the master volume and
+                                        // saturated to 16 bit
+class TSoftMixer : public TAudioBackend
+{
+	public:
+		TSoftMixer(unsigned nSampleRate = MIXER_RATE);
+
+	public:
+		unsigned AddTheBuffer(const char* pData, int nChannels, int nSampleRate,
+			int nBps, int nSize);
+		void FreeTheBuffers();
+
+		void SetMasterVolume(double Volume);
+		double GetMasterVolume() { return m_Volume; }
+
+		unsigned GetSampleRate() { return m_nSampleRate; }
+		unsigned GetPlayingCount();
+		unsigned GetMemory();
+
+		void Mix(float* pBus, unsigned nFrames);
+		void Render(short* pFrames, unsigned nFrames);
+
+		static const char* GetKernelsName();
+
+		unsigned CreateTheSource();
+		void DeleteTheSource(unsigned nSource);
+
+		void Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+			double Gain, double Pan);
+		void Stop(unsigned nSource);
+		bool IsPlaying(unsigned nSource);
+
+	protected:
+		struct TMixerBuffer
+		{
+			std::vector<float> Samples;	// interleaved, -1..1
+			unsigned nChannels, nFrames;
+		};
+
+		struct TMixerSource
+		{
+			unsigned nBuffer;
+			unsigned nFrame;				// the next one to be mixed
+			float GainL, GainR;
+			bool bPlaying, bLoop;
+		};
+
+		std::vector<TMixerBuffer> m_Buffers;
+		std::vector<TMixerSource> m_Sources;
+		std::vector<float> m_Bus;			// of Render()
+		unsigned m_nSampleRate;
+		double m_Volume;
+
+	protected:
+		void MixTheSource(TMixerSource& Source, float* pBus, unsigned nFrames);
+};
+
+										// a WAV file, 16 bit stereo, written
+                                        // a block at a time
+class TWavSink
+{
+	public:
+		TWavSink();
+		~TWavSink();
+
+	public:
+		bool Open(const char* pFileName, unsigned nSampleRate);
+		void Write(const short* pFrames, unsigned nFrames);
+		void Close();
+
+		bool IsOpen() { return m_pFile != NULL; }
+		unsigned GetFramesCount() { return m_nFrames; }
+
+	protected:
+		FILE* m_pFile;
+		unsigned m_nSampleRate;
+		unsigned m_nFrames;
+
+	protected:
+		void WriteTheHeader();
+};
+
+#endif
+
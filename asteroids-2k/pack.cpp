@@ -0,0 +1,441 @@
+/*!****************************************************************************
+
+	@file	pack.h
+	@file	pack.cpp
+
+	@brief	Asset pack
+
+	@par	The data files of the game (the sounds, the font, the help) are
+			put in one file, PACKFILE in the data folder, by the packer
+			tool: at startup there is one file to open and map instead of
+			a dozen, and an asset is found by a binary search of the hash
+			of its name in the table of the entries.
+
+	@par	Each entry starts at a multiple of PACK_ALIGN bytes, so a stored
+			entry is used in place, in the mapping of the pack; an entry
+			may also be compressed, as an LZ4 block, when it pays.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "pack.h"
+#include "lz4.h"
+
+
+//-----------------------------------------------------------------------------
+
+/*!****************************************************************************
+* @brief	Rounds up to a multiple of PACK_ALIGN
+* @param	nValue The value
+* @return	The value rounded
+******************************************************************************/
+static inline unsigned AlignTheOffset(unsigned nValue)
+{
+	return (nValue + PACK_ALIGN - 1) & ~unsigned(PACK_ALIGN - 1);
+}
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TAssetPack::TAssetPack()
+{
+	m_pTable = NULL;
+	m_nEntries = 0;
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TAssetPack::~TAssetPack()
+{
+	Close();
+}
+
+/*!****************************************************************************
+* @brief	Hashes the name of an asset
+* @param	pName The name, as given to the packer, without the path
+* @return	The FNV-1a hash of the name
+******************************************************************************/
+unsigned TAssetPack::GetTheHash(const char* pName)
+{
+	assert(pName);
+
+	unsigned nHash = 2166136261u;
+
+	for( ; *pName; pName++)
+	{
+		nHash ^= (unsigned char) *pName;
+		nHash *= 16777619u;
+	}
+
+	return nHash;
+}
+
+/*!****************************************************************************
+* @brief	Maps a pack, and checks its header and its table
+* @param	pFileName The name of the file
+* @return	True for success, false if the file cannot be mapped or is not a
+*			valid pack
+******************************************************************************/
+bool TAssetPack::Open(const char* pFileName)
+{
+	assert(pFileName);
+
+	Close();
+
+	if( !m_File.Open(pFileName) ) return false;
+
+	const char* pBytes = m_File.GetData();
+	unsigned nSize = m_File.GetSize();
+
+	TPackHeader Header;
+
+	if( nSize < sizeof(Header) ) { Close(); return false; }
+
+	memcpy(&Header, pBytes, sizeof(Header));
+
+	if( memcmp(Header.Magic, PACK_MAGIC, 4) != 0 || Header.nVersion != PACK_VERSION ||
+		Header.nTableOffset % PACK_ALIGN || Header.nTableOffset > nSize ||
+		Header.nEntries > (nSize - Header.nTableOffset) / sizeof(TPackEntry) )
+	{
+		Close();
+		return false;
+	}
+											// the mapping starts on a page, the
+                                            // table on PACK_ALIGN: it is read
+                                            // in place
+	const TPackEntry* pTable = (const TPackEntry*) (pBytes + Header.nTableOffset);
+
+	for(unsigned i=0; i<Header.nEntries; i++)
+	{
+		const TPackEntry& Entry = pTable[i];
+
+		bool bValid = Entry.nNameOffset < nSize &&
+			memchr(pBytes + Entry.nNameOffset, 0, nSize - Entry.nNameOffset) != NULL &&
+			Entry.nOffset <= nSize && Entry.nSize <= nSize - Entry.nOffset &&
+			(Entry.nFlags & ~unsigned(PACK_LZ4)) == 0 &&
+			((Entry.nFlags & PACK_LZ4) || Entry.nRawSize == Entry.nSize) &&
+			(i == 0 || pTable[i-1].nHash <= Entry.nHash);
+
+		if( !bValid || GetTheHash(pBytes + Entry.nNameOffset) != Entry.nHash )
+		{
+			Close();
+			return false;
+		}
+	}
+
+	m_pTable = pTable;
+	m_nEntries = Header.nEntries;
+	m_Copies.resize(m_nEntries);
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Frees the copies, and unmaps the pack
+******************************************************************************/
+void TAssetPack::Close()
+{
+	m_Copies.clear();
+	m_pTable = NULL;
+	m_nEntries = 0;
+
+	m_File.Close();
+}
+
+/*!****************************************************************************
+* @brief	Gets the name of an entry
+* @param	nEntry The entry
+* @return	Pointer to the name, in the mapping
+******************************************************************************/
+const char* TAssetPack::GetName(int nEntry)
+{
+	assert(nEntry >= 0 && unsigned(nEntry) < m_nEntries);
+
+	return m_File.GetData() + m_pTable[nEntry].nNameOffset;
+}
+
+/*!****************************************************************************
+* @brief	Finds an asset
+* @param	pName The name of the asset
+* @return	The entry of the asset, or PACK_NONE
+******************************************************************************/
+int TAssetPack::Find(const char* pName)
+{
+	assert(pName);
+
+	unsigned nHash = GetTheHash(pName);
+	unsigned nLow = 0, nHigh = m_nEntries;
+											// the first entry of the hash
+	while( nLow < nHigh )
+	{
+		unsigned nMiddle = (nLow + nHigh) / 2;
+
+		if( m_pTable[nMiddle].nHash < nHash ) nLow = nMiddle + 1;
+		else nHigh = nMiddle;
+	}
+											// then the names of the same hash
+	for( ; nLow < m_nEntries && m_pTable[nLow].nHash == nHash; nLow++)
+	{
+		if( strcmp(GetName(nLow), pName) == 0 ) return int(nLow);
+	}
+
+	return PACK_NONE;
+}
+
+/*!****************************************************************************
+* @brief	Reads an asset
+* @param	nEntry The entry of the asset
+* @param[out]	pData Pointer to the data, valid until Close() or FreeTheCopies()
+* @param[out]	nSize The size of the data
+* @return	True for success, false if a compressed entry is broken
+******************************************************************************/
+bool TAssetPack::Read(int nEntry, const char*& pData, unsigned& nSize)
+{
+	assert(nEntry >= 0 && unsigned(nEntry) < m_nEntries);
+
+	const TPackEntry& Entry = m_pTable[nEntry];
+
+	pData = m_File.GetData() + Entry.nOffset;
+	nSize = Entry.nSize;
+
+	if( Entry.nFlags & PACK_LZ4 )
+	{
+		std::vector<char>& Copy = m_Copies[nEntry];
+
+		if( !Entry.nRawSize )
+		{
+			nSize = 0;
+			return true;
+		}
+
+		if( Copy.empty() )
+		{
+			Copy.resize(Entry.nRawSize);
+
+			if( !LZ4Decompress(pData, Entry.nSize, &Copy[0], Entry.nRawSize) )
+			{
+				Copy.clear();
+				return false;
+			}
+		}
+
+		pData = &Copy[0];
+		nSize = Entry.nRawSize;
+	}
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Reads an asset
+* @param	pName The name of the asset
+* @param[out]	pData Pointer to the data, valid until Close() or FreeTheCopies()
+* @param[out]	nSize The size of the data
+* @return	True for success, false if not found, or broken
+******************************************************************************/
+bool TAssetPack::Read(const char* pName, const char*& pData, unsigned& nSize)
+{
+	int nEntry = Find(pName);
+
+	return nEntry != PACK_NONE && Read(nEntry, pData, nSize);
+}
+
+/*!****************************************************************************
+* @brief	Frees the decompressed copies, once used; the stored entries are
+*			still there, in the mapping
+******************************************************************************/
+void TAssetPack::FreeTheCopies()
+{
+	for(unsigned i=0; i<m_Copies.size(); i++)
+	{
+		std::vector<char>().swap(m_Copies[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!****************************************************************************
+* @brief	Adds an asset
+* @param	pName The name of the asset
+* @param	pData Pointer to the data
+* @param	nSize The size of the data
+* @param	bCompress True for compressing it, if it saves 1/PACK_MINSAVING
+*			of its size at least
+* @return	True for success, false if the name is already there
+******************************************************************************/
+bool TAssetPackBuilder::Add(const char* pName, const char* pData, unsigned nSize,
+	bool bCompress)
+{
+	assert(pName);
+	assert(pData || !nSize);
+
+	for(unsigned i=0; i<m_Assets.size(); i++)
+	{
+		if( m_Assets[i].strName == pName ) return false;
+	}
+
+	m_Assets.push_back(TAsset());
+
+	TAsset& Asset = m_Assets.back();
+
+	Asset.strName = pName;
+	Asset.nRawSize = nSize;
+	Asset.nFlags = 0;
+
+	if( bCompress && nSize )
+	{
+		Asset.Data.resize(LZ4GetBound(nSize));
+		Asset.Data.resize(LZ4Compress(pData, nSize, &Asset.Data[0]));
+
+		if( Asset.Data.size() <= nSize - nSize / PACK_MINSAVING )
+		{
+			Asset.nFlags = PACK_LZ4;
+			return true;
+		}
+	}
+
+	Asset.Data.assign(pData, pData + nSize);
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Adds a file, named without its path
+* @param	pFileName The name of the file
+* @param	bCompress True for compressing it, if it pays
+* @return	True for success, false if the file cannot be read or the name is
+*			already there
+******************************************************************************/
+bool TAssetPackBuilder::AddTheFile(const char* pFileName, bool bCompress)
+{
+	assert(pFileName);
+
+	TMappedFile File;
+
+	if( !File.Open(pFileName) ) return false;
+
+	const char* pName = pFileName;
+
+	for(const char* p = pFileName; *p; p++)
+	{
+		if( *p == '/' || *p == '\\' ) pName = p + 1;
+	}
+
+	return Add(pName, File.GetData(), File.GetSize(), bCompress);
+}
+
+										// the order of the table
+struct TPackOrder
+{
+	const std::vector<unsigned>* pHashes;
+
+	bool operator()(unsigned nA, unsigned nB) const
+	{
+		return (*pHashes)[nA] < (*pHashes)[nB];
+	}
+};
+
+/*!****************************************************************************
+* @brief	Builds the pack
+* @param[out]	Bytes The bytes of the pack file
+******************************************************************************/
+void TAssetPackBuilder::Build(std::vector<char>& Bytes)
+{
+	unsigned nCount = m_Assets.size();
+
+	std::vector<unsigned> Hashes(nCount), Order(nCount);
+
+	for(unsigned i=0; i<nCount; i++)
+	{
+		Hashes[i] = TAssetPack::GetTheHash(m_Assets[i].strName.c_str());
+		Order[i] = i;
+	}
+
+	TPackOrder ByHash;
+	ByHash.pHashes = &Hashes;
+											// the same hash: in the order added
+	std::stable_sort(Order.begin(), Order.end(), ByHash);
+
+	TPackHeader Header;
+	memcpy(Header.Magic, PACK_MAGIC, 4);
+	Header.nVersion = PACK_VERSION;
+	Header.nEntries = nCount;
+	Header.nTableOffset = AlignTheOffset(sizeof(Header));
+
+	std::vector<TPackEntry> Table(nCount);
+											// the names after the table, then
+                                            // the data
+	unsigned nOffset = Header.nTableOffset + nCount * sizeof(TPackEntry);
+
+	for(unsigned i=0; i<nCount; i++)
+	{
+		Table[i].nNameOffset = nOffset;
+		nOffset += m_Assets[Order[i]].strName.size() + 1;
+	}
+
+	for(unsigned i=0; i<nCount; i++)
+	{
+		const TAsset& Asset = m_Assets[Order[i]];
+
+		nOffset = AlignTheOffset(nOffset);
+
+		Table[i].nHash = Hashes[Order[i]];
+		Table[i].nOffset = nOffset;
+		Table[i].nSize = Asset.Data.size();
+		Table[i].nRawSize = Asset.nRawSize;
+		Table[i].nFlags = Asset.nFlags;
+		Table[i].nReserved[0] = Table[i].nReserved[1] = 0;
+
+		nOffset += Asset.Data.size();
+	}
+
+	Bytes.assign(nOffset, 0);
+
+	memcpy(&Bytes[0], &Header, sizeof(Header));
+
+	if( nCount ) memcpy(&Bytes[Header.nTableOffset], &Table[0], nCount * sizeof(TPackEntry));
+
+	for(unsigned i=0; i<nCount; i++)
+	{
+		const TAsset& Asset = m_Assets[Order[i]];
+
+		memcpy(&Bytes[Table[i].nNameOffset], Asset.strName.c_str(), Asset.strName.size() + 1);
+
+		if( Asset.Data.size() )
+		{
+			memcpy(&Bytes[Table[i].nOffset], &Asset.Data[0], Asset.Data.size());
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Saves the pack
+* @param	pFileName The name of the file
+* @return	True for success, false if the file cannot be written
+******************************************************************************/
+bool TAssetPackBuilder::Save(const char* pFileName)
+{
+	assert(pFileName);
+
+	std::vector<char> Bytes;
+	Build(Bytes);
+
+	FILE* fp = fopen(pFileName, "wb");
+
+	if( !fp ) return false;
+
+	bool bResult = fwrite(&Bytes[0], 1, Bytes.size(), fp) == Bytes.size();
+
+	return fclose(fp) == 0 && bResult;
+}
+
@@ -0,0 +1,117 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _PACK_H_
+#define _PACK_H_
+
+#include <string>
+#include <vector>
+
+#include "mapfile.h"
+
+#define PACK_MAGIC			"A2KP"
+#define PACK_VERSION		1
+#define PACK_ALIGN			16			// of the table and of each entry
+#define PACK_LZ4			0x0001		// the entry is an LZ4 block
+#define PACK_NONE			-1
+#define PACK_MINSAVING		8			// compressed if it saves 1/8 at least
+
+#define PACKFILE			"assets.a2kp"
+
+
+										// the file starts with the header,
+                                        // then the table of the entries,
+                                        // sorted by the hash of their name,
+                                        // the names, and the data; integers
+                                        // are little endian, as on x86
+struct TPackHeader
+{
+	char Magic[4];
+	unsigned nVersion;
+	unsigned nEntries;
+	unsigned nTableOffset;
+};
+
+struct TPackEntry
+{
+	unsigned nHash;						// FNV-1a of the name
+	unsigned nNameOffset;				// of the name, NUL terminated
+	unsigned nOffset;					// of the data, PACK_ALIGN aligned
+	unsigned nSize;						// in the pack
+	unsigned nRawSize;					// once decompressed
+	unsigned nFlags;
+	unsigned nReserved[2];
+};
+
+										// a pack of the data files, mapped:
+                                        // a stored entry is read in place,
+                                        // a compressed one is decompressed
+                                        // on its first read into a copy, that
+                                        // lives until Close()
+class TAssetPack
+{
+	public:
+		TAssetPack();
+		~TAssetPack();
+
+	public:
+		bool Open(const char* pFileName);
+		void Close();
+
+		bool IsOpen() { return m_File.IsOpen(); }
+
+		unsigned GetEntriesCount() { return m_nEntries; }
+		const TPackEntry& GetEntry(int nEntry) { return m_pTable[nEntry]; }
+		const char* GetName(int nEntry);
+
+		int Find(const char* pName);
+		bool Read(int nEntry, const char*& pData, unsigned& nSize);
+		bool Read(const char* pName, const char*& pData, unsigned& nSize);
+
+		void FreeTheCopies();
+
+		static unsigned GetTheHash(const char* pName);
+
+	protected:
+		TMappedFile m_File;
+		const TPackEntry* m_pTable;
+		unsigned m_nEntries;
+		std::vector< std::vector<char> > m_Copies;
+
+	private:
+		TAssetPack(const TAssetPack&);
+		TAssetPack& operator=(const TAssetPack&);
+};
+
+										// builds a pack, in memory, then saves
+                                        // it in one write
+class TAssetPackBuilder
+{
+	public:
+		bool Add(const char* pName, const char* pData, unsigned nSize,
+			bool bCompress = false);
+		bool AddTheFile(const char* pFileName, bool bCompress = false);
+		void Clear() { m_Assets.clear(); }
+
+		bool Save(const char* pFileName);
+		void Build(std::vector<char>& Bytes);
+
+		unsigned GetAssetsCount() { return m_Assets.size(); }
+
+	protected:
+		struct TAsset
+		{
+			std::string strName;
+			std::vector<char> Data;			// as stored
+			unsigned nRawSize;
+			unsigned nFlags;
+		};
+
+		std::vector<TAsset> m_Assets;
+};
+
+#endif
+
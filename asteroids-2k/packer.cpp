@@ -0,0 +1,116 @@
+/*!****************************************************************************
+
+	@file	packer.cpp
+
+	@brief	Builds the asset pack of the game
+
+	@par	Puts the data files given in a pack, each named by its file name
+			without the path; "-c" compresses the files that follow, when
+			it pays, "-s" stores them as they are. "-l" lists a pack.
+
+	@par	Build (Linux):
+			g++ -O2 -o packer packer.cpp pack.cpp lz4.cpp mapfile.cpp
+
+	@par	Usage:
+			packer assets.a2kp [-c | -s] file ...
+			packer -l assets.a2kp
+
+	@par	The pack of the game, in its data folder:
+			packer assets.a2kp -s *.wav -c technolcd.ttf help.txt hiscores.txt
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pack.h"
+
+
+/*!****************************************************************************
+* @brief	Lists the entries of a pack
+* @param	pFileName The name of the pack
+* @return	0 for success, -1 if the pack cannot be opened or is broken
+******************************************************************************/
+int ListThePack(const char* pFileName)
+{
+	TAssetPack Pack;
+
+	if( !Pack.Open(pFileName) )
+	{
+		printf("%s: not a valid pack\n", pFileName);
+		return -1;
+	}
+
+	int nResult = 0;
+	unsigned nSize = 0, nRawSize = 0;
+
+	printf("%-24s %10s %10s %10s %s\n", "name", "offset", "size", "raw", "");
+
+	for(unsigned i=0; i<Pack.GetEntriesCount(); i++)
+	{
+		const TPackEntry& Entry = Pack.GetEntry(i);
+		const char* pData;
+		unsigned nData;
+											// decompressed, to check it
+		bool bValid = Pack.Read(i, pData, nData);
+
+		printf("%-24s %10u %10u %10u %s%s\n", Pack.GetName(i), Entry.nOffset,
+			Entry.nSize, Entry.nRawSize, Entry.nFlags & PACK_LZ4 ? "lz4" : "",
+			bValid ? "" : " BROKEN");
+
+		nSize += Entry.nSize;
+		nRawSize += Entry.nRawSize;
+
+		if( !bValid ) nResult = -1;
+	}
+
+	printf("\n%u entries, %u bytes of %u\n", Pack.GetEntriesCount(), nSize, nRawSize);
+
+	return nResult;
+}
+
+/*!****************************************************************************
+* @brief	Program entry point
+******************************************************************************/
+int main(int argc, char* argv[])
+{
+	if( argc == 3 && strcmp(argv[1], "-l") == 0 )
+	{
+		return ListThePack(argv[2]);
+	}
+
+	if( argc < 3 )
+	{
+		printf("usage: %s pack [-c | -s] file ...\n", argv[0]);
+		printf("       %s -l pack\n", argv[0]);
+		return -1;
+	}
+
+	TAssetPackBuilder Builder;
+	bool bCompress = false;
+
+	for(int i=2; i<argc; i++)
+	{
+		if( strcmp(argv[i], "-c") == 0 ) { bCompress = true; continue; }
+		if( strcmp(argv[i], "-s") == 0 ) { bCompress = false; continue; }
+
+		if( !Builder.AddTheFile(argv[i], bCompress) )
+		{
+			printf("%s: cannot be read, or already in the pack\n", argv[i]);
+			return -1;
+		}
+	}
+
+	if( !Builder.Save(argv[1]) )
+	{
+		printf("%s: cannot be written\n", argv[1]);
+		return -1;
+	}
+
+	return ListThePack(argv[1]);
+}
+
@@ -0,0 +1,148 @@
+/*!****************************************************************************
+
+	@file	pens.h
+	@file	pens.cpp
+
+	@brief	Cache of pens and brushes
+
+	@par	Creating and deleting a GDI pen for each polyline costs a kernel
+			call each time; the cache keeps the most recently used pens
+			and brushes, and deletes the least recently used one when full.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+
+#include "pens.h"
+
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	pFactory Pointer to the object that creates the pens
+* @param	nCapacity Maximum number of pens and brushes kept
+******************************************************************************/
+TPenCache::TPenCache(TGdiFactory* pFactory, unsigned nCapacity)
+{
+	assert(pFactory);
+	assert(nCapacity > 0);
+
+	m_pFactory = pFactory;
+	m_nCapacity = nCapacity;
+
+	ResetStats();
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TPenCache::~TPenCache()
+{
+	Clear();
+}
+
+/*!****************************************************************************
+* @brief	Gets a pen
+* @param	nWidth Width of the pen
+* @param	Color Color of the pen
+* @return	The pen, owned by the cache
+******************************************************************************/
+TGdiHandle TPenCache::GetPen(int nWidth, COLORREF Color)
+{
+	assert(nWidth >= 0);
+
+	return Get(nWidth, Color);
+}
+
+/*!****************************************************************************
+* @brief	Gets a solid brush
+* @param	Color Color of the brush
+* @return	The brush, owned by the cache
+******************************************************************************/
+TGdiHandle TPenCache::GetBrush(COLORREF Color)
+{
+	return Get(-1, Color);
+}
+
+/*!****************************************************************************
+* @brief	Looks for an object in the cache, creates it if missing
+* @param	nWidth Width of the pen, -1 for brushes
+* @param	Color Color of the object
+* @return	The object
+******************************************************************************/
+TGdiHandle TPenCache::Get(int nWidth, COLORREF Color)
+{
+	TPenKey Key(nWidth, Color);
+	TPenIndex::iterator It = m_Index.find(Key);
+
+	if( It != m_Index.end() )
+	{
+		m_Stats.nHits++;
+											// move to front (most recent)
+		m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+
+		return It->second->hObject;
+	}
+
+	m_Stats.nMisses++;
+											// evict the least recently used
+	if( m_Entries.size() >= m_nCapacity )
+	{
+		TPenEntry& Last = m_Entries.back();
+
+		m_pFactory->DeleteObject(Last.hObject);
+		m_Index.erase(Last.Key);
+		m_Entries.pop_back();
+
+		m_Stats.nEvictions++;
+	}
+
+	TPenEntry Entry;
+
+	Entry.Key = Key;
+	Entry.hObject = nWidth < 0 ? m_pFactory->CreateBrush(Color)
+		: m_pFactory->CreatePen(nWidth, Color);
+	assert(Entry.hObject);
+
+	m_Entries.push_front(Entry);
+	m_Index[Key] = m_Entries.begin();
+
+	return Entry.hObject;
+}
+
+/*!****************************************************************************
+* @brief	Deletes all the pens and brushes
+******************************************************************************/
+void TPenCache::Clear()
+{
+	for(TPenEntries::iterator It = m_Entries.begin(); It != m_Entries.end(); ++It)
+	{
+		m_pFactory->DeleteObject(It->hObject);
+	}
+
+	m_Entries.clear();
+	m_Index.clear();
+}
+
+/*!****************************************************************************
+* @brief	Gets the ratio between hits and lookups
+* @return	The hit rate, in [0,1]
+******************************************************************************/
+double TPenCache::GetHitRate()
+{
+	unsigned nLookups = m_Stats.nHits + m_Stats.nMisses;
+
+	return nLookups ? double(m_Stats.nHits) / nLookups : 0;
+}
+
+/*!****************************************************************************
+* @brief	Resets the statistics
+******************************************************************************/
+void TPenCache::ResetStats()
+{
+	m_Stats.nHits = m_Stats.nMisses = m_Stats.nEvictions = 0;
+}
+
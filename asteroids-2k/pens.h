@@ -0,0 +1,87 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _PENS_H_
+#define _PENS_H_
+
+#include <map>
+#include <list>
+#include <utility>
+
+#include "commdefs.h"
+
+#define PENCACHE_SIZE		32
+
+
+typedef void* TGdiHandle;
+
+										// creates and deletes the drawing objects,
+										// implemented by GDI on Windows, and by
+                                        // fake objects where GDI is not available
+class TGdiFactory
+{
+	public:
+		virtual ~TGdiFactory() {}
+
+		virtual TGdiHandle CreatePen(int nWidth, COLORREF Color) = 0;
+		virtual TGdiHandle CreateBrush(COLORREF Color) = 0;
+		virtual void DeleteObject(TGdiHandle hObject) = 0;
+};
+
+struct TPenCacheStats
+{
+	unsigned nHits, nMisses, nEvictions;
+};
+
+										// least recently used pens and brushes,
+                                        // keyed on (width, color)
+class TPenCache
+{
+	public:
+		TPenCache(TGdiFactory* pFactory, unsigned nCapacity = PENCACHE_SIZE);
+		~TPenCache();
+
+	public:
+		TGdiHandle GetPen(int nWidth, COLORREF Color);
+		TGdiHandle GetBrush(COLORREF Color);
+
+		void Clear();
+
+		unsigned GetCount() { return m_Entries.size(); }
+		unsigned GetCapacity() { return m_nCapacity; }
+
+		TPenCacheStats GetStats() { return m_Stats; }
+		double GetHitRate();
+		void ResetStats();
+
+	protected:
+											// brushes have width -1
+		typedef std::pair<int, COLORREF> TPenKey;
+
+		struct TPenEntry
+		{
+			TPenKey Key;
+			TGdiHandle hObject;
+		};
+
+		typedef std::list<TPenEntry> TPenEntries;
+		typedef std::map<TPenKey, TPenEntries::iterator> TPenIndex;
+
+	protected:
+		TGdiFactory* m_pFactory;
+		unsigned m_nCapacity;
+											// most recently used first
+		TPenEntries m_Entries;
+		TPenIndex m_Index;
+
+		TPenCacheStats m_Stats;
+
+	protected:
+		TGdiHandle Get(int nWidth, COLORREF Color);
+};
+
+#endif
+
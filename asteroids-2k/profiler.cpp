@@ -0,0 +1,296 @@
+/*!****************************************************************************
+
+	@file	profiler.h
+	@file	profiler.cpp
+
+	@brief	Per phase profiler of the frames
+
+	@par	The code of a phase is wrapped in PROFILE(phase, statement): when
+			the profiler is enabled the begin and the end of the phase are
+			recorded as an event in a ring of PROF_CAPACITY events, else the
+			statement is run as is, after a test of the Profiler pointer.
+
+	@par	The ring is lock-free: a writer claims a slot with an atomic
+			increment of the head, fills it and then publishes it writing
+			its sequence number, so the events can come from any thread.
+			A reader takes an event only if the sequence number is the same
+			before and after the copy.
+
+	@par	EndFrame() sums the time of each phase over the events of the
+			frame, the last PROF_WINDOW sums give the rolling p50 and p99
+			shown by DrawOverlay(). ExportTheTrace() writes the events in
+			the ring in the Chrome trace event format (JSON), to be opened
+			with chrome://tracing or Perfetto.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "profiler.h"
+#include "commdefs.h"
+
+
+TProfiler* Profiler = NULL;
+
+//-----------------------------------------------------------------------------
+
+static const char* PhaseNames[ppCount] =
+{
+	"ships", "missiles", "asteroids", "limits", "broadphase", "handlers",
+	"collisions", "showinfo", "clear", "render", "paint", "wait", "frame"
+};
+
+static long AtomicIncrement(volatile long* pVal)
+{
+#ifdef _WIN32
+	return InterlockedIncrement(pVal);
+#else
+	return __sync_add_and_fetch(pVal, 1);
+#endif
+}
+
+static void MemoryFence()
+{
+#ifdef _WIN32
+	static volatile long nFence = 0;
+	InterlockedExchange(&nFence, 0);		// full barrier on x86/x64
+#else
+	__sync_synchronize();
+#endif
+}
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TProfiler::TProfiler()
+{
+	memset(m_Events, 0, sizeof(m_Events));
+    memset(m_History, 0, sizeof(m_History));
+
+	m_nHead = 0;
+    m_nFrameStart = 0;
+    m_nFrames = 0;
+    m_Origin = 0;
+}
+
+/*!****************************************************************************
+* @brief	Enables or disables the profiling
+* @param	bEnabled True to enable the profiling
+* @note		Enabling the profiling discards the events recorded so far
+******************************************************************************/
+void TProfiler::SetEnabled(bool bEnabled)
+{
+	if( bEnabled && !IsEnabled() )
+    {
+		for(int i=0; i<PROF_CAPACITY; i++) m_Events[i].nSeq = 0;
+
+		m_nHead = 0;
+        m_nFrameStart = 0;
+        m_nFrames = 0;
+        m_Origin = utils::GetTime();
+
+		Profiler = this;
+	}
+	else if( !bEnabled && IsEnabled() )
+    {
+		Profiler = NULL;
+    }
+}
+
+/*!****************************************************************************
+* @brief	Tells if the profiling is on
+******************************************************************************/
+bool TProfiler::IsEnabled()
+{
+	return Profiler == this;
+}
+
+/*!****************************************************************************
+* @brief	Records an event
+* @param	nPhase The phase, a enProfPhase value
+* @param	Start The time of begin of the phase, seconds
+* @param	End The time of end of the phase, seconds
+* @param	nThread The thread that has run the phase
+******************************************************************************/
+void TProfiler::Record(unsigned nPhase, double Start, double End, unsigned nThread)
+{
+	assert(nPhase < ppCount);
+
+	unsigned nIndex = AtomicIncrement(&m_nHead) - 1;
+	TProfEvent& Event = m_Events[nIndex & (PROF_CAPACITY - 1)];
+											// the slot is not valid while
+                                            // writing it
+	Event.nSeq = 0;
+    MemoryFence();
+
+	Event.nPhase = nPhase;
+    Event.nThread = nThread;
+    Event.Start = Start;
+    Event.End = End;
+
+	MemoryFence();
+    Event.nSeq = nIndex + 1;
+}
+
+/*!****************************************************************************
+* @brief	Copies an event from the ring
+* @param	nIndex The index of the event
+* @param	Event The copy of the event
+* @return	false if the event has been overwritten or is being written
+******************************************************************************/
+bool TProfiler::GetEvent(unsigned nIndex, TProfEvent& Event)
+{
+	TProfEvent& Slot = m_Events[nIndex & (PROF_CAPACITY - 1)];
+
+	if( Slot.nSeq != nIndex + 1 ) return false;
+
+	MemoryFence();
+
+	Event.nPhase = Slot.nPhase;
+    Event.nThread = Slot.nThread;
+    Event.Start = Slot.Start;
+    Event.End = Slot.End;
+
+	MemoryFence();
+
+	return Slot.nSeq == nIndex + 1 && Event.nPhase < ppCount;
+}
+
+/*!****************************************************************************
+* @brief	Closes the frame, updating the rolling statistics
+* @note		To be called by a single thread, once per frame
+******************************************************************************/
+void TProfiler::EndFrame()
+{
+	unsigned nHead = m_nHead;
+	unsigned nFirst = nHead - m_nFrameStart > PROF_CAPACITY ?
+		nHead - PROF_CAPACITY : m_nFrameStart;
+
+	double Sums[ppCount];
+    for(int i=0; i<ppCount; i++) Sums[i] = 0;
+
+	for(unsigned i=nFirst; i!=nHead; i++)
+    {
+    	TProfEvent Event;
+
+		if( GetEvent(i, Event) ) Sums[Event.nPhase] += Event.End - Event.Start;
+    }
+
+	for(int i=0; i<ppCount; i++) m_History[i][m_nFrames % PROF_WINDOW] = Sums[i];
+
+	m_nFrames++;
+    m_nFrameStart = nHead;
+}
+
+/*!****************************************************************************
+* @brief	Gets a percentile of the time per frame of a phase
+* @param	nPhase The phase, a enProfPhase value
+* @param	P The percentile, from 0 to 1
+* @return	The time, in seconds, over the last PROF_WINDOW frames
+******************************************************************************/
+double TProfiler::GetPercentile(unsigned nPhase, double P)
+{
+	assert(nPhase < ppCount);
+
+	unsigned nCount = std::min(m_nFrames, (unsigned) PROF_WINDOW);
+
+	if( nCount == 0 ) return 0;
+
+	double Values[PROF_WINDOW];
+    memcpy(Values, m_History[nPhase], nCount * sizeof(double));
+
+	unsigned nIndex = (unsigned) (P * (nCount - 1) + 0.5);
+    std::nth_element(Values, Values + nIndex, Values + nCount);
+
+	return Values[nIndex];
+}
+
+/*!****************************************************************************
+* @brief	Draws the rolling p50 and p99 of each phase
+* @param	pDevice The device to draw on
+* @param	nX Left side of the table
+* @param	nY Top side of the table
+******************************************************************************/
+void TProfiler::DrawOverlay(TVideoDevice* pDevice, int nX, int nY)
+{
+	assert(pDevice);
+
+	COLORREF Color = RGB(255,255,0);
+	char Buffer[64];
+
+	sprintf(Buffer, "phase: p50 p99 (us)");
+	pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+
+	for(int i=0; i<ppCount; i++)
+	{
+    	nY += FONTSIZE;
+
+		sprintf(Buffer, "%s: %.0f %.0f", PhaseNames[i],
+        	GetPercentile(i, 0.5) * 1.0e6, GetPercentile(i, 0.99) * 1.0e6);
+
+		pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Writes the events in the ring in the Chrome trace event format
+* @param	pFileName Name of the file
+* @return	true for success
+******************************************************************************/
+bool TProfiler::ExportTheTrace(const char* pFileName)
+{
+	assert(pFileName);
+
+	FILE* fp = fopen(pFileName, "wt");
+
+	if( !fp ) return false;
+
+	unsigned nHead = m_nHead;
+	unsigned nFirst = nHead > PROF_CAPACITY ? nHead - PROF_CAPACITY : 0;
+    bool bFirst = true;
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+
+	for(unsigned i=nFirst; i!=nHead; i++)
+	{
+    	TProfEvent Event;
+
+		if( !GetEvent(i, Event) ) continue;
+											// complete events, microseconds
+		fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+			"\"pid\":1,\"tid\":%u}", bFirst ? "" : ",\n", PhaseNames[Event.nPhase],
+			(Event.Start - m_Origin) * 1.0e6, (Event.End - Event.Start) * 1.0e6,
+			Event.nThread);
+
+		bFirst = false;
+	}
+
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	bool bResult = !ferror(fp);
+
+	return fclose(fp) == 0 && bResult;
+}
+
+/*!****************************************************************************
+* @brief	Gets the name of a phase
+******************************************************************************/
+const char* TProfiler::GetPhaseName(unsigned nPhase)
+{
+	assert(nPhase < ppCount);
+
+	return PhaseNames[nPhase];
+}
+
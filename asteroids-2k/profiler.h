@@ -0,0 +1,103 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <vector>
+
+#include "devices.h"
+#include "timer.h"
+
+#define PROF_CAPACITY		8192	// events in the ring, a power of 2
+#define PROF_WINDOW			120		// frames of the rolling statistics
+
+
+										// the phases of a frame; the first
+                                        // ones are the same as enSimPhase
+enum enProfPhase { ppShips, ppMissiles, ppAsteroids, ppLimits,
+	ppBroadphase, ppHandlers, ppCollisions,
+	ppShowInfo, ppClear, ppRender, ppPaint, ppWait, ppFrame, ppCount };
+
+struct TProfEvent
+{
+	volatile unsigned nSeq;				// index of the event + 1, once written
+	unsigned nPhase;
+    unsigned nThread;
+	double Start, End;					// seconds, utils::GetTime()
+};
+
+										// timing of the phases of the frames:
+                                        // the events go in a lock-free ring,
+                                        // any thread can write them
+class TProfiler
+{
+	public:
+		TProfiler();
+
+	public:
+		void SetEnabled(bool bEnabled);
+        bool IsEnabled();
+
+		void Record(unsigned nPhase, double Start, double End, unsigned nThread = 0);
+        void EndFrame();
+											// rolling statistics, in seconds,
+                                            // of the time per frame of a phase
+		double GetPercentile(unsigned nPhase, double P);
+        unsigned GetFramesCount() { return m_nFrames; }
+
+		void DrawOverlay(TVideoDevice* pDevice, int nX, int nY);
+		bool ExportTheTrace(const char* pFileName);
+
+		static const char* GetPhaseName(unsigned nPhase);
+
+	protected:
+		TProfEvent m_Events[PROF_CAPACITY];
+		volatile long m_nHead;
+        unsigned m_nFrameStart;
+        double m_Origin;
+
+		double m_History[ppCount][PROF_WINDOW];
+        unsigned m_nFrames;
+
+	protected:
+		bool GetEvent(unsigned nIndex, TProfEvent& Event);
+};
+
+										// the enabled profiler, NULL when
+                                        // the profiling is off
+extern TProfiler* Profiler;
+
+										// times a phase
+class TProfScope
+{
+	public:
+		TProfScope(TProfiler* pProfiler, unsigned nPhase)
+        {
+        	m_pProfiler = pProfiler;
+            m_nPhase = nPhase;
+            m_Start = utils::GetTime();
+        }
+
+		~TProfScope() { m_pProfiler->Record(m_nPhase, m_Start, utils::GetTime()); }
+
+	protected:
+		TProfiler* m_pProfiler;
+        unsigned m_nPhase;
+        double m_Start;
+};
+
+										// runs a statement timing it as a phase;
+                                        // when the profiling is off the cost
+                                        // is a single branch
+#define PROFILE(nPhase, Statement)							\
+	do {													\
+		if( !Profiler ) { Statement; }						\
+		else { TProfScope _Scope(Profiler, nPhase); Statement; }	\
+	} while(0)
+
+#endif
+
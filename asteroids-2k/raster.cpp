@@ -0,0 +1,550 @@
+/*!****************************************************************************
+
+	@file	raster.h
+	@file	raster.cpp
+
+	@brief	Software rasterizer
+
+	@par	TRasterDevice is a video device that draws on a framebuffer in
+			memory instead of a window, so the game can be rendered where
+			GDI is not available (headless runs, benchmarks, golden-image
+			checks). Lines use Bresenham, or Wu when antialiasing is on;
+			texts use an embedded 8x8 bitmap font; the spans are filled
+			with SSE2/AVX2 stores when the compiler provides them.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "raster.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define RASTER_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define RASTER_SSE2
+#endif
+
+//-----------------------------------------------------------------------------
+
+										// public domain 8x8 font (font8x8_basic
+                                        // by D. Hepper), ASCII 32..127, one
+                                        // byte per row, bit 0 = leftmost pixel
+static const unsigned char Font8x8[96][8] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// ' '
+	{ 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },	// '!'
+	{ 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// '"'
+	{ 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },	// '#'
+	{ 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },	// '$'
+	{ 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },	// '%'
+	{ 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },	// '&'
+	{ 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },	// '''
+	{ 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },	// '('
+	{ 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },	// ')'
+	{ 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },	// '*'
+	{ 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },	// '+'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },	// ','
+	{ 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },	// '-'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },	// '.'
+	{ 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },	// '/'
+	{ 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },	// '0'
+	{ 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },	// '1'
+	{ 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },	// '2'
+	{ 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },	// '3'
+	{ 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },	// '4'
+	{ 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },	// '5'
+	{ 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },	// '6'
+	{ 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },	// '7'
+	{ 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },	// '8'
+	{ 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },	// '9'
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },	// ':'
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },	// ';'
+	{ 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },	// '<'
+	{ 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },	// '='
+	{ 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },	// '>'
+	{ 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },	// '?'
+	{ 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },	// '@'
+	{ 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },	// 'A'
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },	// 'B'
+	{ 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },	// 'C'
+	{ 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },	// 'D'
+	{ 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },	// 'E'
+	{ 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },	// 'F'
+	{ 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },	// 'G'
+	{ 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },	// 'H'
+	{ 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },	// 'I'
+	{ 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },	// 'J'
+	{ 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },	// 'K'
+	{ 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },	// 'L'
+	{ 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },	// 'M'
+	{ 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },	// 'N'
+	{ 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },	// 'O'
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },	// 'P'
+	{ 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },	// 'Q'
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },	// 'R'
+	{ 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },	// 'S'
+	{ 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },	// 'T'
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },	// 'U'
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },	// 'V'
+	{ 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },	// 'W'
+	{ 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },	// 'X'
+	{ 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },	// 'Y'
+	{ 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },	// 'Z'
+	{ 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },	// '['
+	{ 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },	// backslash
+	{ 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },	// ']'
+	{ 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },	// '^'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },	// '_'
+	{ 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },	// '`'
+	{ 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },	// 'a'
+	{ 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },	// 'b'
+	{ 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },	// 'c'
+	{ 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 },	// 'd'
+	{ 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 },	// 'e'
+	{ 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 },	// 'f'
+	{ 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },	// 'g'
+	{ 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },	// 'h'
+	{ 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },	// 'i'
+	{ 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },	// 'j'
+	{ 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },	// 'k'
+	{ 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },	// 'l'
+	{ 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },	// 'm'
+	{ 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },	// 'n'
+	{ 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },	// 'o'
+	{ 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },	// 'p'
+	{ 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },	// 'q'
+	{ 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },	// 'r'
+	{ 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },	// 's'
+	{ 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },	// 't'
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },	// 'u'
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },	// 'v'
+	{ 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },	// 'w'
+	{ 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },	// 'x'
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },	// 'y'
+	{ 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },	// 'z'
+	{ 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },	// '{'
+	{ 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },	// '|'
+	{ 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },	// '}'
+	{ 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// '~'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }	// DEL
+};
+
+/*!****************************************************************************
+* @brief	Fills a span of pixels with the same value
+* @param	pDst Pointer to the first pixel
+* @param	nCount Number of pixels
+* @param	nValue Value of the pixels
+******************************************************************************/
+static void FillSpan(unsigned* pDst, int nCount, unsigned nValue)
+{
+#if defined(RASTER_AVX2)
+	__m256i V8 = _mm256_set1_epi32(nValue);
+
+	for(; nCount >= 8; nCount -= 8, pDst += 8)
+	{
+		_mm256_storeu_si256((__m256i*) pDst, V8);
+	}
+#endif
+
+#if defined(RASTER_SSE2)
+	__m128i V4 = _mm_set1_epi32(nValue);
+
+	for(; nCount >= 4; nCount -= 4, pDst += 4)
+	{
+		_mm_storeu_si128((__m128i*) pDst, V4);
+	}
+#endif
+
+	for(; nCount > 0; nCount--) *pDst++ = nValue;
+}
+
+/*!****************************************************************************
+* @brief	Gets the kernels selected at compile time
+* @return	"avx2", "sse2" or "scalar"
+******************************************************************************/
+const char* TRasterDevice::GetKernelsName()
+{
+#if defined(RASTER_AVX2)
+	return "avx2";
+#elif defined(RASTER_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nWidth Width of the framebuffer
+* @param	nHeight Height of the framebuffer
+******************************************************************************/
+TRasterDevice::TRasterDevice(unsigned nWidth, unsigned nHeight)
+{
+	assert(nWidth > 0 && nHeight > 0);
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+
+	m_Pixels.resize(nWidth * nHeight, RGBA(RGB(0,0,0)));
+
+	m_bAntialias = false;
+
+	SetFontSize(FONTSIZE);
+}
+
+/*!****************************************************************************
+* @brief	Sets the height of the texts, rounded to a multiple of 8 pixels
+* @param	nSize Height of the texts, in pixels
+******************************************************************************/
+void TRasterDevice::SetFontSize(int nSize)
+{
+	m_nFontScale = nSize / 8 > 1 ? nSize / 8 : 1;
+}
+
+/*!****************************************************************************
+* @brief	Fills the whole framebuffer
+* @param	Color The color of the background
+******************************************************************************/
+void TRasterDevice::ClearScreen(COLORREF Color)
+{
+	FillSpan(&m_Pixels[0], m_Pixels.size(), RGBA(Color));
+}
+
+/*!****************************************************************************
+* @brief	Draws a point
+* @param	Pt Coordinates of point to be drawn
+* @param	Color Specifies the color of the point
+******************************************************************************/
+void TRasterDevice::DrawPoint(TVector2& Pt, COLORREF Color)
+{
+	int nX = (int) floor(Pt.X), nY = (int) floor(Pt.Y);
+
+	if( nX >= 0 && nX < (int) m_nWidth && nY >= 0 && nY < (int) m_nHeight )
+	{
+		m_Pixels[nY * m_nWidth + nX] = RGBA(Color);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Draws a series of points with the same color
+* @param	Pts Reference to a vector of points
+* @param	Color Specifies the color of the points
+******************************************************************************/
+void TRasterDevice::DrawPoints(TVecPoints& Pts, COLORREF Color)
+{
+	for(unsigned i=0; i<Pts.size(); i++) DrawPoint(Pts[i], Color);
+}
+
+/*!****************************************************************************
+* @brief	Draws a polyline
+* @param	Pts Reference to a vector of points
+* @param	nLineWidth Specifies the width of the polyline
+* @param	Color Specifies the color of the polyline
+* @param	bClosed If true draw a closed polyline
+******************************************************************************/
+void TRasterDevice::DrawLines(TVecPoints& Pts, int nLineWidth,
+	COLORREF Color, bool bClosed)
+{
+	unsigned nCount = Pts.size();
+
+	if( nCount < 2 ) return;
+
+	unsigned nColor = RGBA(Color);
+	unsigned nSegments = bClosed ? nCount : nCount - 1;
+										// as GDI, width 0 means one pixel;
+                                        // thicker lines are drawn as
+                                        // parallel lines, one pixel apart
+	int nWidth = nLineWidth > 1 ? nLineWidth : 1;
+
+	for(unsigned i=0; i<nSegments; i++)
+	{
+		TVector2& P0 = Pts[i];
+		TVector2& P1 = Pts[(i + 1) % nCount];
+
+		bool bSteep = fabs(P1.Y - P0.Y) > fabs(P1.X - P0.X);
+
+		for(int w=0; w<nWidth; w++)
+		{
+			double Offset = w - (nWidth - 1) / 2.0;
+			double OX = bSteep ? Offset : 0, OY = bSteep ? 0 : Offset;
+
+			if( m_bAntialias )
+				DrawLineWu(P0.X + OX, P0.Y + OY, P1.X + OX, P1.Y + OY, nColor);
+			else
+				DrawLine(P0.X + OX, P0.Y + OY, P1.X + OX, P1.Y + OY, nColor);
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Draws a series of polylines
+* @param	Pts Reference to a vector of polylines
+* @param	nLineWidth Specifies the width of the polyline
+* @param	Color Specifies the color of the polyline
+* @param	bClosed If true draw a closed polyline
+******************************************************************************/
+void TRasterDevice::DrawLines(TVecVecPoints& Pts, int nLineWidth,
+	COLORREF Color, bool bClosed)
+{
+	for(unsigned i=0; i<Pts.size(); i++)
+	{
+		DrawLines(Pts[i], nLineWidth, Color, bClosed);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Draws a text with the embedded 8x8 font
+* @param	pText Pointer to a text string
+* @param	nX X position for text
+* @param	nY Y position for text (top of the text, as GDI does)
+* @param	nColor Color for text
+* @param	nAlign Alignment for text (TA_LEFT, TA_CENTER or TA_RIGHT)
+******************************************************************************/
+void TRasterDevice::DrawText(char* pText, int nX, int nY,
+	COLORREF nColor, UINT nAlign)
+{
+	assert(pText);
+
+	int nScale = m_nFontScale;
+	int nLength = strlen(pText);
+	int nTextW = nLength * 8 * nScale;
+
+	if( (nAlign & TA_CENTER) == TA_CENTER ) nX -= nTextW / 2;
+	else if( nAlign & TA_RIGHT ) nX -= nTextW;
+
+	unsigned nPixel = RGBA(nColor);
+
+	for(int i=0; i<nLength; i++, nX += 8 * nScale)
+	{
+		unsigned char c = pText[i];
+
+		if( c < 32 || c > 127 ) c = '?';
+
+		const unsigned char* pGlyph = Font8x8[c - 32];
+
+		for(int nRow=0; nRow<8; nRow++)
+		{
+			unsigned char nBits = pGlyph[nRow];
+
+			for(int nCol=0; nBits; nCol++, nBits >>= 1)
+			{
+				if( nBits & 1 )
+				{
+					FillRect(nX + nCol * nScale, nY + nRow * nScale,
+						nScale, nScale, nPixel);
+				}
+			}
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Fills a rectangle, clipped to the framebuffer
+******************************************************************************/
+void TRasterDevice::FillRect(int nX, int nY, int nW, int nH, unsigned nColor)
+{
+	int nX0 = nX > 0 ? nX : 0, nY0 = nY > 0 ? nY : 0;
+	int nX1 = nX + nW < (int) m_nWidth ? nX + nW : m_nWidth;
+	int nY1 = nY + nH < (int) m_nHeight ? nY + nH : m_nHeight;
+
+	for(int y=nY0; y<nY1; y++)
+	{
+		FillSpan(&m_Pixels[y * m_nWidth + nX0], nX1 - nX0, nColor);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Clips a segment to the framebuffer (Cohen-Sutherland)
+* @return	false if the segment lies entirely outside
+******************************************************************************/
+bool TRasterDevice::ClipLine(double& X0, double& Y0, double& X1, double& Y1)
+{
+	enum { cLeft = 1, cRight = 2, cTop = 4, cBottom = 8 };
+
+	double XMin = 0, YMin = 0;
+	double XMax = m_nWidth - 1, YMax = m_nHeight - 1;
+
+	for(;;)
+	{
+		int nCode0 = (X0 < XMin ? cLeft : X0 > XMax ? cRight : 0)
+			| (Y0 < YMin ? cTop : Y0 > YMax ? cBottom : 0);
+		int nCode1 = (X1 < XMin ? cLeft : X1 > XMax ? cRight : 0)
+			| (Y1 < YMin ? cTop : Y1 > YMax ? cBottom : 0);
+
+		if( !(nCode0 | nCode1) ) return true;
+		if( nCode0 & nCode1 ) return false;
+
+		int nCode = nCode0 ? nCode0 : nCode1;
+		double X, Y;
+
+		if( nCode & cTop ) { X = X0 + (X1 - X0) * (YMin - Y0) / (Y1 - Y0); Y = YMin; }
+		else if( nCode & cBottom ) { X = X0 + (X1 - X0) * (YMax - Y0) / (Y1 - Y0); Y = YMax; }
+		else if( nCode & cLeft ) { Y = Y0 + (Y1 - Y0) * (XMin - X0) / (X1 - X0); X = XMin; }
+		else { Y = Y0 + (Y1 - Y0) * (XMax - X0) / (X1 - X0); X = XMax; }
+
+		if( nCode == nCode0 ) { X0 = X; Y0 = Y; }
+		else { X1 = X; Y1 = Y; }
+	}
+}
+
+/*!****************************************************************************
+* @brief	Draws a one pixel segment (Bresenham)
+******************************************************************************/
+void TRasterDevice::DrawLine(double X0, double Y0, double X1, double Y1, unsigned nColor)
+{
+	if( !ClipLine(X0, Y0, X1, Y1) ) return;
+
+	int nX0 = (int) floor(X0 + 0.5), nY0 = (int) floor(Y0 + 0.5);
+	int nX1 = (int) floor(X1 + 0.5), nY1 = (int) floor(Y1 + 0.5);
+										// the clipped end points are inside
+                                        // the framebuffer, no tests below
+	if( nY0 == nY1 )
+	{
+		if( nX0 > nX1 ) { int t = nX0; nX0 = nX1; nX1 = t; }
+
+		FillSpan(&m_Pixels[nY0 * m_nWidth + nX0], nX1 - nX0 + 1, nColor);
+		return;
+	}
+
+	int nDX = nX1 > nX0 ? nX1 - nX0 : nX0 - nX1;
+	int nDY = nY1 > nY0 ? nY0 - nY1 : nY1 - nY0;
+	int nSX = nX0 < nX1 ? 1 : -1;
+	int nSY = nY0 < nY1 ? (int) m_nWidth : -(int) m_nWidth;
+	int nErr = nDX + nDY;
+
+	unsigned* pDst = &m_Pixels[nY0 * m_nWidth + nX0];
+	unsigned* pEnd = &m_Pixels[nY1 * m_nWidth + nX1];
+
+	for(;;)
+	{
+		*pDst = nColor;
+
+		if( pDst == pEnd ) break;
+
+		int nErr2 = 2 * nErr;
+
+		if( nErr2 >= nDY ) { nErr += nDY; pDst += nSX; }
+		if( nErr2 <= nDX ) { nErr += nDX; pDst += nSY; }
+	}
+}
+
+/*!****************************************************************************
+* @brief	Blends a color on a pixel
+* @param	Coverage Fraction of the pixel covered, in [0,1]
+******************************************************************************/
+void TRasterDevice::BlendPixel(int nX, int nY, unsigned nColor, double Coverage)
+{
+	if( nX < 0 || nX >= (int) m_nWidth || nY < 0 || nY >= (int) m_nHeight ) return;
+
+	unsigned& nDst = m_Pixels[nY * m_nWidth + nX];
+	unsigned nA = (unsigned) (Coverage * 256);
+	unsigned nResult = 0xFF000000u;
+
+	for(int nShift=0; nShift<24; nShift+=8)
+	{
+		unsigned nS = (nColor >> nShift) & 0xFF, nD = (nDst >> nShift) & 0xFF;
+
+		nResult |= ((nD * (256 - nA) + nS * nA) >> 8) << nShift;
+	}
+
+	nDst = nResult;
+}
+
+/*!****************************************************************************
+* @brief	Draws an antialiased segment (Wu)
+******************************************************************************/
+void TRasterDevice::DrawLineWu(double X0, double Y0, double X1, double Y1, unsigned nColor)
+{
+	if( !ClipLine(X0, Y0, X1, Y1) ) return;
+
+	bool bSteep = fabs(Y1 - Y0) > fabs(X1 - X0);
+	double t;
+
+	if( bSteep ) { t = X0; X0 = Y0; Y0 = t; t = X1; X1 = Y1; Y1 = t; }
+	if( X0 > X1 ) { t = X0; X0 = X1; X1 = t; t = Y0; Y0 = Y1; Y1 = t; }
+
+	double DX = X1 - X0;
+	double Gradient = DX > 0 ? (Y1 - Y0) / DX : 1;
+
+	int nX0 = (int) floor(X0 + 0.5), nX1 = (int) floor(X1 + 0.5);
+	double Y = Y0 + Gradient * (nX0 - X0);
+
+	for(int x=nX0; x<=nX1; x++, Y += Gradient)
+	{
+		int nY = (int) floor(Y);
+		double Frac = Y - nY;
+
+		if( bSteep )
+		{
+			BlendPixel(nY, x, nColor, 1 - Frac);
+			BlendPixel(nY + 1, x, nColor, Frac);
+		}
+		else
+		{
+			BlendPixel(x, nY, nColor, 1 - Frac);
+			BlendPixel(x, nY + 1, nColor, Frac);
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets a checksum of the framebuffer (FNV-1a), to compare frames
+*			against reference images
+* @return	The checksum
+******************************************************************************/
+unsigned TRasterDevice::GetChecksum()
+{
+	unsigned nHash = 2166136261u;
+
+	for(unsigned i=0; i<m_Pixels.size(); i++)
+	{
+		nHash = (nHash ^ m_Pixels[i]) * 16777619u;
+	}
+
+	return nHash;
+}
+
+/*!****************************************************************************
+* @brief	Saves the framebuffer as a binary PPM image
+* @param	pFileName Name of the file
+* @return	true if the file has been written
+******************************************************************************/
+bool TRasterDevice::SaveTheFrame(char* pFileName)
+{
+	assert(pFileName);
+
+	FILE* pFile = fopen(pFileName, "wb");
+
+	if( !pFile ) return false;
+
+	fprintf(pFile, "P6\n%u %u\n255\n", m_nWidth, m_nHeight);
+
+	std::vector<unsigned char> Row(m_nWidth * 3);
+
+	for(unsigned y=0; y<m_nHeight; y++)
+	{
+		for(unsigned x=0; x<m_nWidth; x++)
+		{
+			unsigned nPixel = m_Pixels[y * m_nWidth + x];
+
+			Row[3*x + 0] = nPixel & 0xFF;
+			Row[3*x + 1] = (nPixel >> 8) & 0xFF;
+			Row[3*x + 2] = (nPixel >> 16) & 0xFF;
+		}
+
+		fwrite(&Row[0], 1, Row.size(), pFile);
+	}
+
+	return fclose(pFile) == 0;
+}
+
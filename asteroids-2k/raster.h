@@ -0,0 +1,75 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _RASTER_H_
+#define _RASTER_H_
+
+#include <vector>
+
+#include "commdefs.h"
+#include "devices.h"
+#include "vectors.h"
+
+using namespace maths;
+
+										// pixels are stored as R,G,B,A bytes,
+                                        // that is COLORREF with alpha = 255
+#define RGBA(C)		((unsigned)(C) | 0xFF000000u)
+
+typedef std::vector<unsigned> TVecPixels;
+
+										// software rasterizer, draws on an RGBA
+                                        // framebuffer in memory
+class TRasterDevice : public TVideoDevice
+{
+	public:
+		TRasterDevice(unsigned nWidth = FRAMEW, unsigned nHeight = FRAMEH);
+
+	public:
+        void DrawPoint(TVector2& Pt, COLORREF Color);
+        void DrawPoints(TVecPoints& Pts, COLORREF Color);
+
+        void DrawLines(TVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false);
+        void DrawLines(TVecVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false);
+
+        void DrawText(char* pText, int nX, int nY,
+        	COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER);
+
+        void ClearScreen(COLORREF Color);
+
+	public:
+		void SetAntialias(bool bAntialias) { m_bAntialias = bAntialias; }
+		void SetFontSize(int nSize);
+
+		unsigned GetWidth() { return m_nWidth; }
+		unsigned GetHeight() { return m_nHeight; }
+		unsigned* GetPixels() { return &m_Pixels[0]; }
+
+		unsigned GetChecksum();
+		bool SaveTheFrame(char* pFileName);
+
+		static const char* GetKernelsName();
+
+	protected:
+		unsigned m_nWidth, m_nHeight;
+		TVecPixels m_Pixels;
+
+		bool m_bAntialias;
+		int m_nFontScale;
+
+	protected:
+		void DrawLine(double X0, double Y0, double X1, double Y1, unsigned nColor);
+		void DrawLineWu(double X0, double Y0, double X1, double Y1, unsigned nColor);
+		bool ClipLine(double& X0, double& Y0, double& X1, double& Y1);
+
+		void BlendPixel(int nX, int nY, unsigned nColor, double Coverage);
+		void FillRect(int nX, int nY, int nW, int nH, unsigned nColor);
+};
+
+#endif
+
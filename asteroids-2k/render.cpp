@@ -0,0 +1,325 @@
+/*!****************************************************************************
+
+	@file	render.h
+	@file	render.cpp
+
+	@brief	Render command buffer
+
+	@par	The actors draw on a TRenderBuffer, that only records the
+			commands; at the end of the frame Flush() replays them on the
+			video device, sorted by kind and color so that polylines with
+			the same pen are sent to the device in a single call.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "render.h"
+
+//-----------------------------------------------------------------------------
+
+										// sorting of the commands: polylines,
+                                        // then points, then texts; polylines
+                                        // and points by pen, texts as recorded
+struct TRenderCommandLess
+{
+	TVecRenderCommands* pCommands;
+
+	TRenderCommandLess(TVecRenderCommands* pCmds) { pCommands = pCmds; }
+
+	bool operator () (unsigned nA, unsigned nB) const
+	{
+		TRenderCommand& A = (*pCommands)[nA];
+		TRenderCommand& B = (*pCommands)[nB];
+
+		if( A.nType != B.nType ) return A.nType < B.nType;
+											// the order of recording breaks
+                                            // the ties, as a stable sort
+                                            // without its temporary buffer
+		if( A.nType != rcText )
+		{
+			if( A.Color != B.Color ) return A.Color < B.Color;
+			if( A.nLineWidth != B.nLineWidth ) return A.nLineWidth < B.nLineWidth;
+			if( A.bClosed != B.bClosed ) return A.bClosed < B.bClosed;
+		}
+
+		return nA < nB;
+	}
+};
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TRenderBuffer::TRenderBuffer()
+{
+	m_nBatches = 0;
+}
+
+/*!****************************************************************************
+* @brief	Records a point
+* @param	Pt Coordinates of point to be drawn
+* @param	Color Specifies the color of the point
+******************************************************************************/
+void TRenderBuffer::DrawPoint(TVector2& Pt, COLORREF Color)
+{
+	TRenderCommand Cmd;
+
+	Cmd.nType = rcPoint;
+	Cmd.Color = Color;
+	Cmd.nLineWidth = 0;
+	Cmd.bClosed = false;
+	Cmd.nFirst = m_Points.size();
+	Cmd.nCount = 1;
+
+	m_Points.push_back(Pt);
+	m_Commands.push_back(Cmd);
+}
+
+/*!****************************************************************************
+* @brief	Records a polyline
+* @param	Pts Reference to a vector of points
+* @param	nLineWidth Specifies the width of the polyline
+* @param	Color Specifies the color of the polyline
+* @param	bClosed If true draw a closed polyline
+******************************************************************************/
+void TRenderBuffer::DrawLines(TVecPoints& Pts, int nLineWidth,
+	COLORREF Color, bool bClosed)
+{
+	AddLines(Pts, nLineWidth, Color, bClosed);
+}
+
+/*!****************************************************************************
+* @brief	Records a series of polylines
+* @param	Pts Reference to a vector of polylines
+* @param	nLineWidth Specifies the width of the polyline
+* @param	Color Specifies the color of the polyline
+* @param	bClosed If true draw a closed polyline
+******************************************************************************/
+void TRenderBuffer::DrawLines(TVecVecPoints& Pts, int nLineWidth,
+	COLORREF Color, bool bClosed)
+{
+	for(int i=0; i<Pts.size(); i++)
+	{
+		AddLines(Pts[i], nLineWidth, Color, bClosed);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Records a text
+* @param	pText Pointer to a text string
+* @param	nX X position for text
+* @param	nY Y position for text
+* @param	nColor Color for text
+* @param	nAlign Alignment for text
+******************************************************************************/
+void TRenderBuffer::DrawText(char* pText, int nX, int nY,
+	COLORREF nColor, UINT nAlign)
+{
+	assert(pText);
+
+	TRenderCommand Cmd;
+
+	Cmd.nType = rcText;
+	Cmd.Color = nColor;
+	Cmd.nLineWidth = 0;
+	Cmd.bClosed = false;
+	Cmd.nFirst = m_strText.size();
+	Cmd.nCount = strlen(pText);
+	Cmd.nX = nX;
+	Cmd.nY = nY;
+	Cmd.nAlign = nAlign;
+											// the terminator is kept, so
+                                            // c_str() + nFirst is the text
+	m_strText.append(pText, Cmd.nCount + 1);
+	m_Commands.push_back(Cmd);
+}
+
+/*!****************************************************************************
+* @brief	Records mulitple texts
+* @param	StringList A series of text strings
+* @param	nX X position for text
+* @param	nY Y position for text
+* @param	nLineHeight	Height of text line
+* @param	nColor Color for text
+* @param	nAlign Alignment for text
+******************************************************************************/
+void TRenderBuffer::DrawText(std::vector<std::string> StringList,
+	int nX, int nY, int nLineHeight, COLORREF nColor, UINT nAlign)
+{
+	for(int i=0; i<StringList.size(); i++)
+	{
+		DrawText((char*) StringList[i].c_str(), nX, nY, nColor, nAlign);
+
+		nY += 1.25 * nLineHeight;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Appends a polyline command
+******************************************************************************/
+void TRenderBuffer::AddLines(TVecPoints& Pts, int nLineWidth,
+	COLORREF Color, bool bClosed)
+{
+	if( Pts.empty() ) return;
+
+	TRenderCommand Cmd;
+
+	Cmd.nType = rcLines;
+	Cmd.Color = Color;
+	Cmd.nLineWidth = nLineWidth;
+	Cmd.bClosed = bClosed;
+	Cmd.nFirst = m_Points.size();
+	Cmd.nCount = Pts.size();
+
+	m_Points.insert(m_Points.end(), Pts.begin(), Pts.end());
+	m_Commands.push_back(Cmd);
+}
+
+/*!****************************************************************************
+* @brief	Checks if two commands can be sent to the device in a single call
+******************************************************************************/
+bool TRenderBuffer::IsSameBatch(TRenderCommand& Cmd1, TRenderCommand& Cmd2)
+{
+	return Cmd1.nType == Cmd2.nType && Cmd1.nType != rcText
+		&& Cmd1.Color == Cmd2.Color
+		&& Cmd1.nLineWidth == Cmd2.nLineWidth
+		&& Cmd1.bClosed == Cmd2.bClosed;
+}
+
+/*!****************************************************************************
+* @brief	Sets the number of polylines of the batch
+* @param	nSize The number of polylines
+* @note		The polylines in excess are parked in m_Spare, not destroyed,
+*			so their memory is reused by the next batches
+******************************************************************************/
+void TRenderBuffer::ResizeTheBatch(unsigned nSize)
+{
+	while( m_Batch.size() > nSize )
+	{
+		m_Spare.push_back(TVecPoints());
+		m_Spare.back().swap(m_Batch.back());
+		m_Batch.pop_back();
+	}
+
+	while( m_Batch.size() < nSize )
+	{
+		m_Batch.push_back(TVecPoints());
+
+		if( !m_Spare.empty() )
+		{
+			m_Batch.back().swap(m_Spare.back());
+			m_Spare.pop_back();
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Replays the recorded commands, then clears the buffer
+* @param	pDevice The video device, if NULL the commands are discarded
+* @param	bSort If true the commands are sorted by pen before replaying
+******************************************************************************/
+void TRenderBuffer::Flush(TVideoDevice* pDevice, bool bSort)
+{
+	m_nBatches = 0;
+
+	if( pDevice )
+	{
+		unsigned nCount = m_Commands.size();
+
+		m_Order.resize(nCount);
+		for(unsigned i=0; i<nCount; i++) m_Order[i] = i;
+
+		if( bSort )
+		{
+			std::sort(m_Order.begin(), m_Order.end(),
+				TRenderCommandLess(&m_Commands));
+		}
+
+		for(unsigned i=0; i<nCount; )
+		{
+			TRenderCommand& Cmd = m_Commands[m_Order[i]];
+
+			if( Cmd.nType == rcText )
+			{
+				pDevice->DrawText((char*) m_strText.c_str() + Cmd.nFirst,
+					Cmd.nX, Cmd.nY, Cmd.Color, Cmd.nAlign);
+
+				m_nBatches++;
+				i++;
+				continue;
+			}
+											// the run of commands with
+                                            // the same pen
+			unsigned nEnd = i + 1;
+
+			while( nEnd < nCount
+				&& IsSameBatch(Cmd, m_Commands[m_Order[nEnd]]) )
+			{
+				nEnd++;
+			}
+
+			if( Cmd.nType == rcLines )
+			{
+				ResizeTheBatch(nEnd - i);
+
+				for(unsigned j=i; j<nEnd; j++)
+				{
+					TRenderCommand& Run = m_Commands[m_Order[j]];
+
+					m_Batch[j-i].assign(m_Points.begin() + Run.nFirst,
+						m_Points.begin() + Run.nFirst + Run.nCount);
+				}
+
+				pDevice->DrawLines(m_Batch, Cmd.nLineWidth, Cmd.Color, Cmd.bClosed);
+			}
+			else
+			{
+				ResizeTheBatch(1);
+				m_Batch[0].clear();
+
+				for(unsigned j=i; j<nEnd; j++)
+				{
+					m_Batch[0].push_back( m_Points[m_Commands[m_Order[j]].nFirst] );
+				}
+
+				pDevice->DrawPoints(m_Batch[0], Cmd.Color);
+			}
+
+			m_nBatches++;
+			i = nEnd;
+		}
+	}
+
+	Clear();
+}
+
+/*!****************************************************************************
+* @brief	Discards the recorded commands, the memory is kept for reuse
+******************************************************************************/
+void TRenderBuffer::Clear()
+{
+	m_Commands.clear();
+	m_Points.clear();
+	m_strText.clear();
+}
+
+/*!****************************************************************************
+* @brief	Exchanges the recorded commands with another buffer, e.g. to
+*			hand a complete frame to the thread that renders it
+* @param	Buffer The other buffer
+******************************************************************************/
+void TRenderBuffer::Swap(TRenderBuffer& Buffer)
+{
+	m_Commands.swap(Buffer.m_Commands);
+	m_Points.swap(Buffer.m_Points);
+	m_strText.swap(Buffer.m_strText);
+}
+
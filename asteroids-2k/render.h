@@ -0,0 +1,83 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _RENDER_H_
+#define _RENDER_H_
+
+#include <string>
+#include <vector>
+
+#include "commdefs.h"
+#include "devices.h"
+#include "vectors.h"
+
+using namespace maths;
+
+enum enRenderCommand { rcLines, rcPoint, rcText };
+
+struct TRenderCommand
+{
+	enRenderCommand nType;
+	COLORREF Color;
+	int nLineWidth;
+	bool bClosed;
+											// polylines: points m_Points[nFirst]
+											// ... m_Points[nFirst+nCount-1];
+                                            // text: m_strText.c_str() + nFirst
+	unsigned nFirst, nCount;
+											// text only
+	int nX, nY;
+	UINT nAlign;
+};
+
+typedef std::vector<TRenderCommand> TVecRenderCommands;
+
+										// records the drawing of a frame, then
+										// replays it on a real video device
+class TRenderBuffer : public TVideoDevice
+{
+	public:
+		TRenderBuffer();
+
+	public:
+        void DrawPoint(TVector2& Pt, COLORREF Color);
+
+        void DrawLines(TVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false);
+        void DrawLines(TVecVecPoints& Pts, int nLineWidth,
+        	COLORREF Color, bool bClosed=false);
+
+        void DrawText(char* pText, int nX, int nY,
+        	COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER);
+        void DrawText(std::vector<std::string> StringList, int nX, int nY,
+            int nTextH, COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER);
+
+	public:
+		void Flush(TVideoDevice* pDevice, bool bSort = true);
+		void Clear();
+		void Swap(TRenderBuffer& Buffer);
+
+		unsigned GetCommandsCount() { return m_Commands.size(); }
+		unsigned GetPointsCount() { return m_Points.size(); }
+		unsigned GetBatchesCount() { return m_nBatches; }
+
+	protected:
+		TVecRenderCommands m_Commands;
+		TVecPoints m_Points;
+		std::string m_strText;
+											// reused by Flush()
+		std::vector<unsigned> m_Order;
+		TVecVecPoints m_Batch, m_Spare;
+		unsigned m_nBatches;
+
+	protected:
+		void AddLines(TVecPoints& Pts, int nLineWidth, COLORREF Color, bool bClosed);
+		bool IsSameBatch(TRenderCommand& Cmd1, TRenderCommand& Cmd2);
+		void ResizeTheBatch(unsigned nSize);
+};
+
+#endif
+
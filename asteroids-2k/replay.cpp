@@ -0,0 +1,264 @@
+/*!****************************************************************************
+
+	@file	replay.h
+	@file	replay.cpp
+
+	@brief	Recording and playback of a game session
+
+	@par	The simulation is deterministic: the same seed and the same
+			inputs give the same game. A replay stores the seed, the inputs
+			of each tick (a combination of enInput values) and the hash of
+			the world after each tick, chained; playing back the inputs on
+			a simulation restarted with the seed must give the same chain.
+
+	@par	File format (little endian): magic, version, seed, ticks count,
+			the inputs as (input, run length) pairs, the run length coded
+			in 7-bit groups, then the count of checks, the checks and the
+			final chain.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "replay.h"
+
+//-----------------------------------------------------------------------------
+
+static void WriteU32(FILE* fp, unsigned nVal)
+{
+	for(int i=0; i<4; i++) fputc( (nVal >> (8*i)) & 0xFF, fp );
+}
+
+static bool ReadU32(FILE* fp, unsigned& nVal)
+{
+	nVal = 0;
+
+	for(int i=0; i<4; i++)
+	{
+		int c = fgetc(fp);
+		if( c == EOF ) return false;
+
+		nVal |= unsigned(c) << (8*i);
+	}
+
+	return true;
+}
+
+static void WriteVarU32(FILE* fp, unsigned nVal)
+{
+	while( nVal >= 0x80 )
+	{
+		fputc( (nVal & 0x7F) | 0x80, fp );
+		nVal >>= 7;
+	}
+
+	fputc( nVal, fp );
+}
+
+static bool ReadVarU32(FILE* fp, unsigned& nVal)
+{
+	nVal = 0;
+
+	for(int nShift=0; nShift<35; nShift+=7)
+	{
+		int c = fgetc(fp);
+		if( c == EOF ) return false;
+
+		nVal |= unsigned(c & 0x7F) << nShift;
+
+		if( !(c & 0x80) ) return true;
+	}
+
+	return false;
+}
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TReplay::TReplay()
+{
+	m_bRecording = false;
+	m_nSeed = 0;
+	m_nChain = m_nFinalChain = 0;
+}
+
+/*!****************************************************************************
+* @brief	Combines the chain with the hash of a tick
+******************************************************************************/
+unsigned TReplay::Chain(unsigned nChain, unsigned nHash)
+{
+	return (nChain ^ nHash) * 16777619u + 0x9E3779B9u;
+}
+
+/*!****************************************************************************
+* @brief	Starts a new recording, discarding the previous one
+* @param	nSeed The seed the simulation has been restarted with
+******************************************************************************/
+void TReplay::Begin(unsigned nSeed)
+{
+	m_bRecording = true;
+	m_nSeed = nSeed;
+
+	m_Inputs.clear();
+	m_Checks.clear();
+	m_nChain = m_nFinalChain = 0;
+}
+
+/*!****************************************************************************
+* @brief	Records a tick
+* @param	nInput The inputs applied before the step
+* @param	nHash The hash of the world after the step
+******************************************************************************/
+void TReplay::Record(unsigned nInput, unsigned nHash)
+{
+	assert(m_bRecording);
+	assert(nInput < 256);
+
+	m_Inputs.push_back(nInput);
+
+	m_nChain = m_nFinalChain = Chain(m_nChain, nHash);
+
+	if( m_Inputs.size() % REPLAY_CHECKTICKS == 0 )
+	{
+		m_Checks.push_back(m_nChain);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the inputs of a tick
+* @param	nTick The tick, from 0
+* @return	The inputs, 0 after the end of the replay
+******************************************************************************/
+unsigned TReplay::GetInput(unsigned nTick)
+{
+	return nTick < m_Inputs.size() ? m_Inputs[nTick] : 0;
+}
+
+/*!****************************************************************************
+* @brief	Checks the hash of the world after a tick of the playback
+* @param	nTick The tick, must be called for each tick from 0
+* @param	nHash The hash of the world after the step
+* @return	false if the playback diverged from the recording
+******************************************************************************/
+bool TReplay::Check(unsigned nTick, unsigned nHash)
+{
+	if( nTick == 0 ) m_nChain = 0;
+
+	m_nChain = Chain(m_nChain, nHash);
+
+	unsigned nCount = nTick + 1;
+
+	if( nCount % REPLAY_CHECKTICKS == 0 && nCount / REPLAY_CHECKTICKS <= m_Checks.size() )
+	{
+		if( m_Checks[nCount / REPLAY_CHECKTICKS - 1] != m_nChain ) return false;
+	}
+
+	if( nCount == m_Inputs.size() && m_nFinalChain != m_nChain ) return false;
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Saves the recording
+* @param	pFileName Name of the file
+* @return	true for success
+******************************************************************************/
+bool TReplay::Save(const char* pFileName)
+{
+	assert(pFileName);
+
+	FILE* fp = fopen(pFileName, "wb");
+
+	if( !fp ) return false;
+
+	WriteU32(fp, REPLAY_MAGIC);
+	WriteU32(fp, REPLAY_VERSION);
+	WriteU32(fp, m_nSeed);
+	WriteU32(fp, m_Inputs.size());
+											// run length coding, the inputs
+                                            // change seldom
+	for(unsigned i=0; i<m_Inputs.size(); )
+	{
+		unsigned nEnd = i + 1;
+
+		while( nEnd < m_Inputs.size() && m_Inputs[nEnd] == m_Inputs[i] ) nEnd++;
+
+		fputc(m_Inputs[i], fp);
+		WriteVarU32(fp, nEnd - i);
+
+		i = nEnd;
+	}
+
+	WriteU32(fp, m_Checks.size());
+
+	for(unsigned i=0; i<m_Checks.size(); i++) WriteU32(fp, m_Checks[i]);
+
+	WriteU32(fp, m_nFinalChain);
+
+	bool bResult = !ferror(fp);
+
+	return fclose(fp) == 0 && bResult;
+}
+
+/*!****************************************************************************
+* @brief	Loads a recording
+* @param	pFileName Name of the file
+* @return	true for success
+******************************************************************************/
+bool TReplay::Load(const char* pFileName)
+{
+	assert(pFileName);
+
+	FILE* fp = fopen(pFileName, "rb");
+
+	if( !fp ) return false;
+
+	unsigned nMagic, nVersion, nTicks, nChecks;
+	bool bResult = ReadU32(fp, nMagic) && nMagic == REPLAY_MAGIC
+		&& ReadU32(fp, nVersion) && nVersion == REPLAY_VERSION
+		&& ReadU32(fp, m_nSeed) && ReadU32(fp, nTicks);
+
+	m_bRecording = false;
+	m_Inputs.clear();
+	m_Checks.clear();
+
+	while( bResult && m_Inputs.size() < nTicks )
+	{
+		int nInput = fgetc(fp);
+		unsigned nRun;
+
+		bResult = nInput != EOF && ReadVarU32(fp, nRun)
+			&& nRun > 0 && nRun <= nTicks - m_Inputs.size();
+
+		if( bResult ) m_Inputs.insert(m_Inputs.end(), nRun, (unsigned char) nInput);
+	}
+
+	bResult = bResult && ReadU32(fp, nChecks) && nChecks == nTicks / REPLAY_CHECKTICKS;
+
+	for(unsigned i=0; bResult && i<nChecks; i++)
+	{
+		unsigned nCheck;
+
+		bResult = ReadU32(fp, nCheck);
+		m_Checks.push_back(nCheck);
+	}
+
+	bResult = bResult && ReadU32(fp, m_nFinalChain);
+
+	fclose(fp);
+
+	if( !bResult )
+	{
+		m_Inputs.clear();
+		m_Checks.clear();
+	}
+
+	return bResult;
+}
+
@@ -0,0 +1,55 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include <vector>
+
+#define REPLAY_MAGIC		0x524B3241	// "A2KR"
+#define REPLAY_VERSION		5
+#define REPLAY_CHECKTICKS	60			// ticks between two stored hashes
+
+
+										// the inputs of a game, one byte per
+                                        // tick, and the hash of the world
+                                        // chained over the ticks
+class TReplay
+{
+	public:
+		TReplay();
+
+	public:
+										// recording
+		void Begin(unsigned nSeed);
+		void Record(unsigned nInput, unsigned nHash);
+		bool IsRecording() { return m_bRecording; }
+
+		bool Save(const char* pFileName);
+		bool Load(const char* pFileName);
+										// playback, from tick 0 onwards
+		unsigned GetInput(unsigned nTick);
+		bool Check(unsigned nTick, unsigned nHash);
+
+		unsigned GetSeed() { return m_nSeed; }
+		unsigned GetTicksCount() { return m_Inputs.size(); }
+
+	protected:
+		bool m_bRecording;
+		unsigned m_nSeed;
+
+		std::vector<unsigned char> m_Inputs;
+										// chained hash every REPLAY_CHECKTICKS
+                                        // ticks, and after the last tick
+		std::vector<unsigned> m_Checks;
+		unsigned m_nChain, m_nFinalChain;
+
+	protected:
+		static unsigned Chain(unsigned nChain, unsigned nHash);
+};
+
+#endif
+
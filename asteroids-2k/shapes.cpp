@@ -0,0 +1,390 @@
+/*!****************************************************************************
+
+	@file	shapes.h
+	@file	shapes.cpp
+
+	@brief	Cache of the rotated outlines of ships and asteroids
+
+	@par	The angle of a shape is rounded to the nearest of nSteps angles
+			per turn. The copies of each shape rotated by every step are
+			built when the shape is added, as long as the memory of all the
+			copies is within the budget; the shapes over the budget are
+			rotated with the sin/cos of the step from a table. Either way
+			drawing a shape is a lookup and a translation.
+
+	@par	Rounding the angle moves a vertex at distance R from the origin
+			by at most 2 R sin(Step / 4), Step = 360 / nSteps degrees;
+			GetMaxError() gives this bound for a shape. The ships rotate by
+			SHIP_ROTSTEP degrees, so with a multiple of 36 steps they are
+			drawn exactly.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "shapes.h"
+#include "maths.h"
+
+using namespace maths;
+
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	nSteps Number of rotations per turn
+* @param	nBudget Bytes for the pre-rotated copies
+******************************************************************************/
+TShapeCache::TShapeCache(unsigned nSteps, unsigned nBudget)
+{
+	m_nSteps = 0;
+	m_nBudget = nBudget;
+	m_nMemory = 0;
+
+	SetSteps(nSteps);
+}
+
+/*!****************************************************************************
+* @brief	Sets the angular resolution, rebuilding the copies
+* @param	nSteps Number of rotations per turn
+******************************************************************************/
+void TShapeCache::SetSteps(unsigned nSteps)
+{
+	assert(nSteps > 0);
+
+	m_nSteps = nSteps;
+	m_StepsPerDeg = nSteps / 360.0;
+
+	m_Sin.resize(nSteps);
+	m_Cos.resize(nSteps);
+
+	for(unsigned i=0; i<nSteps; i++)
+	{
+		m_Sin[i] = sin(DEG2RAD(i * 360.0 / nSteps));
+		m_Cos[i] = cos(DEG2RAD(i * 360.0 / nSteps));
+	}
+
+	m_nMemory = 0;
+
+	for(unsigned i=0; i<m_Shapes.size(); i++)
+	{
+		if( m_Shapes[i].bUsed ) BuildTheCopies(m_Shapes[i]);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Sets the memory for the pre-rotated copies, rebuilding them
+* @param	nBudget Bytes for the pre-rotated copies
+******************************************************************************/
+void TShapeCache::SetBudget(unsigned nBudget)
+{
+	m_nBudget = nBudget;
+
+	SetSteps(m_nSteps);
+}
+
+/*!****************************************************************************
+* @brief	Gets a free shape
+* @return	The index of the shape
+******************************************************************************/
+int TShapeCache::NewShape()
+{
+	int nShape;
+
+	if( m_FreeShapes.size() )
+	{
+		nShape = m_FreeShapes.back();
+		m_FreeShapes.pop_back();
+	}
+	else
+	{
+		nShape = m_Shapes.size();
+		m_Shapes.push_back(TCachedShape());
+	}
+
+	m_Shapes[nShape].bUsed = true;
+
+	return nShape;
+}
+
+/*!****************************************************************************
+* @brief	Builds the rotated copies of a shape, if in the budget
+* @param	Shape The shape
+******************************************************************************/
+void TShapeCache::BuildTheCopies(TCachedShape& Shape)
+{
+	unsigned nPoints = Shape.Points.size();
+	unsigned nBytes = m_nSteps * nPoints * sizeof(TVector2);
+
+	Shape.Radius = 0;
+
+	for(unsigned i=0; i<nPoints; i++)
+	{
+		Shape.Radius = std::max(Shape.Radius, Shape.Points[i].Length());
+	}
+
+	if( nPoints == 0 || m_nMemory + nBytes > m_nBudget )
+	{
+											// over the budget: the memory
+                                            // is kept for the next shapes
+		Shape.Rotated.clear();
+		return;
+	}
+
+	Shape.Rotated.resize(m_nSteps * nPoints);
+
+	for(unsigned i=0; i<m_nSteps; i++)
+	{
+		maths::Transform(GetMatrix(i, 1.0, TVector2(0, 0)), &Shape.Points[0],
+			&Shape.Rotated[i * nPoints], nPoints);
+	}
+
+	m_nMemory += nBytes;
+}
+
+/*!****************************************************************************
+* @brief	Adds a shape
+* @param	Shape The outline, a polyline
+* @return	The index of the shape
+******************************************************************************/
+int TShapeCache::Add(TVecPoints& Shape)
+{
+	int nShape = NewShape();
+	TCachedShape& Cached = m_Shapes[nShape];
+
+	Cached.Points.assign(Shape.begin(), Shape.end());
+	Cached.Lengths.assign(1, Shape.size());
+
+	BuildTheCopies(Cached);
+
+	return nShape;
+}
+
+/*!****************************************************************************
+* @brief	Adds a shape
+* @param	Shape The outline, a series of polylines
+* @return	The index of the shape
+******************************************************************************/
+int TShapeCache::Add(TVecVecPoints& Shape)
+{
+	int nShape = NewShape();
+	TCachedShape& Cached = m_Shapes[nShape];
+
+	Cached.Points.clear();
+	Cached.Lengths.clear();
+
+	for(unsigned i=0; i<Shape.size(); i++)
+	{
+		Cached.Points.insert(Cached.Points.end(), Shape[i].begin(), Shape[i].end());
+		Cached.Lengths.push_back(Shape[i].size());
+	}
+
+	BuildTheCopies(Cached);
+
+	return nShape;
+}
+
+/*!****************************************************************************
+* @brief	Removes a shape
+* @param	nShape The index of the shape
+******************************************************************************/
+void TShapeCache::Remove(int nShape)
+{
+	assert(nShape >= 0 && nShape < (int) m_Shapes.size());
+	assert(m_Shapes[nShape].bUsed);
+
+	TCachedShape& Shape = m_Shapes[nShape];
+
+	m_nMemory -= Shape.Rotated.size() * sizeof(TVector2);
+
+	Shape.bUsed = false;
+	Shape.Rotated.clear();
+
+	m_FreeShapes.push_back(nShape);
+}
+
+/*!****************************************************************************
+* @brief	Removes all the shapes
+******************************************************************************/
+void TShapeCache::Clear()
+{
+	m_Shapes.clear();
+	m_FreeShapes.clear();
+	m_nMemory = 0;
+}
+
+/*!****************************************************************************
+* @brief	Gets the step nearest to an angle
+* @param	ThetaDeg The angle, in degrees
+******************************************************************************/
+unsigned TShapeCache::GetStep(double ThetaDeg)
+{
+	double Step = ThetaDeg * m_StepsPerDeg + 0.5;
+											// fmod() only for the angles out
+                                            // of the range of an int
+	if( fabs(Step) > 1.0e9 ) Step = fmod(Step, (double) m_nSteps);
+											// floor(), without the call
+	int nStep = int(Step);
+	if( Step < nStep ) nStep--;
+
+	if( unsigned(nStep) >= m_nSteps ) nStep %= int(m_nSteps);
+
+	return unsigned(nStep < 0 ? nStep + int(m_nSteps) : nStep);
+}
+
+/*!****************************************************************************
+* @brief	Gets the rotation of a step, a scale then a translation, as TAffine2
+* @param	nStep The step
+* @param	Scale The scale factor
+* @param	Translation The value for translation
+******************************************************************************/
+TAffine2 TShapeCache::GetMatrix(unsigned nStep, double Scale, TVector2 Translation)
+{
+	TAffine2 M;
+
+	M.A = m_Cos[nStep] * Scale;		M.B = m_Sin[nStep] * Scale;
+	M.C = -m_Sin[nStep] * Scale;	M.D = m_Cos[nStep] * Scale;
+
+	M.TX = Translation.X;
+	M.TY = Translation.Y;
+
+	return M;
+}
+
+/*!****************************************************************************
+* @brief		Rotates a shape by the nearest step, then translates it
+* @param		nShape The index of the shape
+* @param		ThetaDeg The angle of rotation, in degrees
+* @param		Translation The value for translation
+* @param[out]	Dst The polyline, its memory is reused
+******************************************************************************/
+void TShapeCache::Transform(int nShape, double ThetaDeg, TVector2 Translation,
+	TVecPoints& Dst)
+{
+	Transform(nShape, ThetaDeg, 1.0, Translation, Dst);
+}
+
+/*!****************************************************************************
+* @brief		Rotates a shape by the nearest step, scales it, then
+*				translates it
+* @param		nShape The index of the shape
+* @param		ThetaDeg The angle of rotation, in degrees
+* @param		Scale The scale factor
+* @param		Translation The value for translation
+* @param[out]	Dst The polyline, its memory is reused
+******************************************************************************/
+void TShapeCache::Transform(int nShape, double ThetaDeg, double Scale,
+	TVector2 Translation, TVecPoints& Dst)
+{
+	assert(nShape >= 0 && nShape < (int) m_Shapes.size());
+
+	TCachedShape& Shape = m_Shapes[nShape];
+	unsigned nPoints = Shape.Points.size();
+
+	Dst.resize(nPoints);
+
+	if( nPoints == 0 ) return;
+
+	unsigned nStep = GetStep(ThetaDeg);
+
+	if( Shape.Rotated.size() )
+	{
+		TAffine2 M(Translation);
+
+		M.A = M.D = Scale;
+
+		maths::Transform(M, &Shape.Rotated[nStep * nPoints], &Dst[0], nPoints);
+	}
+	else
+	{
+		maths::Transform(GetMatrix(nStep, Scale, Translation), &Shape.Points[0],
+			&Dst[0], nPoints);
+	}
+}
+
+/*!****************************************************************************
+* @brief		Rotates a shape by the nearest step, then translates it
+* @param		nShape The index of the shape
+* @param		ThetaDeg The angle of rotation, in degrees
+* @param		Translation The value for translation
+* @param[out]	Dst The polylines, their memory is reused
+******************************************************************************/
+void TShapeCache::Transform(int nShape, double ThetaDeg, TVector2 Translation,
+	TVecVecPoints& Dst)
+{
+	assert(nShape >= 0 && nShape < (int) m_Shapes.size());
+
+	TCachedShape& Shape = m_Shapes[nShape];
+	unsigned nPoints = Shape.Points.size();
+
+	Dst.resize(Shape.Lengths.size());
+
+	if( nPoints == 0 ) return;
+
+	unsigned nStep = GetStep(ThetaDeg);
+	TAffine2 M = Shape.Rotated.size() ? TAffine2(Translation)
+		: GetMatrix(nStep, 1.0, Translation);
+	TVector2* pSrc = Shape.Rotated.size() ? &Shape.Rotated[nStep * nPoints]
+		: &Shape.Points[0];
+
+	for(unsigned i=0; i<Shape.Lengths.size(); i++)
+	{
+		Dst[i].resize(Shape.Lengths[i]);
+
+		if( Shape.Lengths[i] ) maths::Transform(M, pSrc, &Dst[i][0], Shape.Lengths[i]);
+
+		pSrc += Shape.Lengths[i];
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of shapes with the pre-rotated copies
+******************************************************************************/
+unsigned TShapeCache::GetCachedCount()
+{
+	unsigned nCount = 0;
+
+	for(unsigned i=0; i<m_Shapes.size(); i++)
+	{
+		if( m_Shapes[i].bUsed && m_Shapes[i].Rotated.size() ) nCount++;
+	}
+
+	return nCount;
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of shapes in the cache
+******************************************************************************/
+unsigned TShapeCache::GetShapesCount()
+{
+	return m_Shapes.size() - m_FreeShapes.size();
+}
+
+/*!****************************************************************************
+* @brief	Gets the bound of the error due to the rounding of the angle
+* @param	nShape The index of the shape
+* @return	The largest distance of a vertex from its exact position
+******************************************************************************/
+double TShapeCache::GetMaxError(int nShape)
+{
+	assert(nShape >= 0 && nShape < (int) m_Shapes.size());
+
+	return 2.0 * m_Shapes[nShape].Radius * sin(DEG2RAD(360.0 / m_nSteps) / 4.0);
+}
+
+/*!****************************************************************************
+* @brief	Gets the distance of the farthest vertex of a shape from its origin
+* @param	nShape The index of the shape
+******************************************************************************/
+double TShapeCache::GetRadius(int nShape)
+{
+	assert(nShape >= 0 && nShape < (int) m_Shapes.size());
+
+	return m_Shapes[nShape].Radius;
+}
+
@@ -0,0 +1,85 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _SHAPES_H_
+#define _SHAPES_H_
+
+#include <vector>
+
+#include "vectors.h"
+
+#define SHAPES_STEPS		360					// rotations per turn
+#define SHAPES_BUDGET		(4 * 1024 * 1024)	// bytes of pre-rotated copies
+#define SHAPES_NONE			-1
+
+
+										// a shape of the cache: the outline,
+                                        // as polylines, and its copies rotated
+                                        // by each step, if in the budget
+struct TCachedShape
+{
+	bool bUsed;
+	maths::TVecPoints Points;
+	std::vector<unsigned> Lengths;		// points of each polyline
+	maths::TVecPoints Rotated;			// nSteps * Points.size()
+	double Radius;						// of the farthest vertex
+};
+
+										// outlines rotated by the nearest of
+                                        // nSteps angles: from the pre-rotated
+                                        // copies, or from a table of sin/cos
+                                        // for the shapes over the budget;
+                                        // no trigonometry at drawing time
+class TShapeCache
+{
+	public:
+		TShapeCache(unsigned nSteps = SHAPES_STEPS, unsigned nBudget = SHAPES_BUDGET);
+
+	public:
+		int Add(maths::TVecPoints& Shape);
+		int Add(maths::TVecVecPoints& Shape);
+		void Remove(int nShape);
+        void Clear();
+
+		void Transform(int nShape, double ThetaDeg, maths::TVector2 Translation,
+			maths::TVecPoints& Dst);
+		void Transform(int nShape, double ThetaDeg, double Scale,
+			maths::TVector2 Translation, maths::TVecPoints& Dst);
+		void Transform(int nShape, double ThetaDeg, maths::TVector2 Translation,
+			maths::TVecVecPoints& Dst);
+
+		void SetSteps(unsigned nSteps);
+		unsigned GetSteps() { return m_nSteps; }
+		void SetBudget(unsigned nBudget);
+		unsigned GetBudget() { return m_nBudget; }
+											// bytes of pre-rotated copies, and
+                                            // shapes that have them
+		unsigned GetMemory() { return m_nMemory; }
+		unsigned GetCachedCount();
+		unsigned GetShapesCount();
+											// largest distance of a served
+                                            // vertex from the exact rotation
+		double GetMaxError(int nShape);
+												// of the farthest vertex
+		double GetRadius(int nShape);
+
+	protected:
+		unsigned m_nSteps, m_nBudget, m_nMemory;
+		double m_StepsPerDeg;
+		std::vector<double> m_Sin, m_Cos;
+
+		std::vector<TCachedShape> m_Shapes;
+        std::vector<int> m_FreeShapes;
+
+	protected:
+		int NewShape();
+		void BuildTheCopies(TCachedShape& Shape);
+		unsigned GetStep(double ThetaDeg);
+		maths::TAffine2 GetMatrix(unsigned nStep, double Scale, maths::TVector2 Translation);
+};
+
+#endif
+
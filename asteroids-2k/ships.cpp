@@ -11,14 +11,13 @@
 
 ******************************************************************************/
 
-#include <windows.h>
-#include <mmsystem.h>
 #include <assert.h>
 #include <math.h>
 
 #include "maths.h"
 #include "ships.h"
-#include "game.h"
+#include "sounds.h"
+#include "timer.h"
 #include "vectors.h"
 #include "commdefs.h"
 
@@ -30,37 +29,82 @@
 * @brief	Constructor
 * @param	pVM Pointer to the VideoManager
 * @param	pSM Pointer to the SoundManager
+* @param	pRandom Pointer to the random generator of the game
+* @param	pShapes Pointer to the cache of the rotated outlines
+* @param	pEntities Pointer to the entity store, the ship is one of its
+*			ekShip entities
 * @param	nClass Ship class (small, medium, big)
 * @param	Size Size of the ship
 * @param	Pos Initial position of the ship
 * @param	Vel Initial velocity of the ship
 ******************************************************************************/
-TShip::TShip(TVideoManager *pVM, TSoundManager* pSM,
-	enShipClass nClass, TVector2 Size, TVector2 Pos, TVector2 Vel)
+TShip::TShip(TVideoDevice *pVM, TSoundDevice* pSM, maths::TRandom* pRandom,
+	TShapeCache* pShapes, TEntityStore* pEntities, enShipClass nClass,
+	TVector2 Size, TVector2 Pos, TVector2 Vel)
 {
 	assert(pVM);
 	assert(pSM);
+	assert(pRandom);
+	assert(pShapes);
+	assert(pEntities);
 
 	m_pVideo = pVM;
 	m_pAudio = pSM;
+	m_pRandom = pRandom;
+	m_pShapes = pShapes;
+	m_pEntities = pEntities;
+	m_nEntity = pEntities->Create(ekShip);
+
+	GetTransform().X = Pos.X;
+	GetTransform().Y = Pos.Y;
+	GetMotion().VX = Vel.X;
+	GetMotion().VY = Vel.Y;
+	GetLifetime().bAlive = true;
+	GetRenderable().Color = RGB(255, 255, 255);
 
-	m_Pos = Pos;
-	m_Vel = Vel;
 	m_Size = Size;
-	m_bAlive = true;
-	m_bVisible = false;
-	m_Rot = m_Impulse = 0;
-	m_Color = RGB(255, 255, 255);
-	m_nImpulseTicks = m_nExplosionTicks = 0;
+	m_bOutline = false;
+	m_Impulse = 0;
+	m_nImpulseTicks = 0;
 
 	m_bShield = false;
 	m_nShieldTick = 0;
+	m_nShieldBlink = 0;
+
+	m_nCourseTicks = 0;
+	m_nThrustSoundTime = 0;
 
 	m_nClass = nClass;
 
 	BuildTheShip();
 }
 
+/*!****************************************************************************
+* @brief	Sets the sound of the ship, by class
+******************************************************************************/
+void TShip::SetTheEmitter()
+{
+	TSoundId nSound = snShipThrust;
+
+	if( GetClass() == scAlienBig ) nSound = snSaucerBig;
+	else if( GetClass() == scAlienSmall ) nSound = snSaucerSmall;
+
+	m_pEntities->GetEmitter(m_nEntity).nSound = nSound;
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TShip::~TShip()
+{
+	m_pShapes->Remove(m_nShapeId);
+	m_pShapes->Remove(m_nEngineId);
+	m_pShapes->Remove(m_nShieldId);
+
+	int nIndex = m_pEntities->Find(m_nEntity);
+	if( nIndex >= 0 ) m_pEntities->Remove(ekShip, nIndex);
+}
+
 /*!****************************************************************************
 * @brief	Builds the ship
 ******************************************************************************/
@@ -167,6 +211,17 @@ void TShip::BuildTheShip()
 			m_Shape.push_back(WShield);
 		}
 	}
+											// the outlines are rotated by the
+                                            // cache, the aliens have no shield
+	m_nShapeId = m_pShapes->Add(m_Shape);
+	m_nEngineId = m_pShapes->Add(m_Engine);
+	m_nShieldId = m_pShapes->Add(m_Shield);
+
+	m_pEntities->GetCollider(m_nEntity).Radius = m_pShapes->GetRadius(m_nShapeId);
+	m_pEntities->GetRenderable(m_nEntity).nShape = m_nShapeId;
+	m_pEntities->GetRenderable(m_nEntity).nClass = GetClass();
+
+	SetTheEmitter();
 }
 
 /*!****************************************************************************
@@ -176,6 +231,9 @@ void TShip::BuildTheShip()
 void TShip::SetClass(enShipClass nClass)
 {
 	m_nClass = nClass;
+
+	GetRenderable().nClass = nClass;
+	SetTheEmitter();
 }
 
 /*!****************************************************************************
@@ -192,14 +250,17 @@ enShipClass TShip::GetClass()
 ******************************************************************************/
 void TShip::Reset()
 {
-	m_Pos = TVector2(0, 0);
-	m_Vel = TVector2(0, 0);
-	m_Rot = 0;
-	m_nExplosionTicks = -1;
+	TTransform& Transform = GetTransform();
+
+	Transform.X = Transform.Y = Transform.Rot = 0;
+	SetVel(TVector2(0, 0));
+	GetLifetime().nTicks = -1;
 	m_nImpulseTicks = 0;
 
 	m_bShield = false;
 	m_nShieldTick = 0;
+	m_nShieldBlink = 0;
+	m_nCourseTicks = 0;
 
 	SetAlive(true);
 	SetVisible(false);
@@ -211,7 +272,7 @@ void TShip::Reset()
 ******************************************************************************/
 bool TShip::IsExploding()
 {
-	return bool(m_nExplosionTicks > 0);
+	return bool(GetLifetime().nTicks > 0);
 }
 
 /*!****************************************************************************
@@ -220,7 +281,14 @@ bool TShip::IsExploding()
 ******************************************************************************/
 void TShip::SetPos(TVector2 Pos)
 {
-	m_Pos = Pos;
+											// the outline follows, for the
+                                            // collisions
+	TTransform& Transform = GetTransform();
+
+	Translate(m_WorldShape, TVector2(Pos.X - Transform.X, Pos.Y - Transform.Y));
+
+	Transform.X = Pos.X;
+	Transform.Y = Pos.Y;
 }
 
 /*!****************************************************************************
@@ -229,7 +297,7 @@ void TShip::SetPos(TVector2 Pos)
 ******************************************************************************/
 TVector2 TShip::GetPos()
 {
-	return m_Pos;
+	return TVector2(GetTransform().X, GetTransform().Y);
 }
 
 /*!****************************************************************************
@@ -238,7 +306,7 @@ TVector2 TShip::GetPos()
 ******************************************************************************/
 void TShip::SetRot(double Rot)
 {
-	m_Rot = Rot;
+	GetTransform().Rot = Rot;
 }
 
 /*!****************************************************************************
@@ -247,7 +315,7 @@ void TShip::SetRot(double Rot)
 ******************************************************************************/
 double TShip::GetRot()
 {
-	return m_Rot;
+	return GetTransform().Rot;
 }
 
 /*!****************************************************************************
@@ -256,7 +324,8 @@ double TShip::GetRot()
 ******************************************************************************/
 void TShip::SetVel(TVector2 Vel)
 {
-	m_Vel = Vel;
+	GetMotion().VX = Vel.X;
+	GetMotion().VY = Vel.Y;
 }
 
 /*!****************************************************************************
@@ -265,7 +334,7 @@ void TShip::SetVel(TVector2 Vel)
 ******************************************************************************/
 TVector2 TShip::GetVel()
 {
-	return m_Vel;
+	return TVector2(GetMotion().VX, GetMotion().VY);
 }
 
 /*!****************************************************************************
@@ -274,7 +343,7 @@ TVector2 TShip::GetVel()
 ******************************************************************************/
 void TShip::SetColor(COLORREF Color)
 {
-	m_Color = Color;
+	GetRenderable().Color = Color;
 }
 
 /*!****************************************************************************
@@ -283,7 +352,7 @@ void TShip::SetColor(COLORREF Color)
 ******************************************************************************/
 void TShip::RotateLeft(double DAngleDeg)
 {
-	m_Rot += DAngleDeg;
+	GetTransform().Rot += DAngleDeg;
 }
 
 /*!****************************************************************************
@@ -292,7 +361,7 @@ void TShip::RotateLeft(double DAngleDeg)
 ******************************************************************************/
 void TShip::RotateRight(double DAngleDeg)
 {
-	m_Rot -= DAngleDeg;
+	GetTransform().Rot -= DAngleDeg;
 }
 
 /*!****************************************************************************
@@ -301,7 +370,7 @@ void TShip::RotateRight(double DAngleDeg)
 ******************************************************************************/
 bool TShip::IsVisible()
 {
-	return m_bVisible;
+	return GetLifetime().bVisible != 0;
 }
 
 /*!****************************************************************************
@@ -310,7 +379,7 @@ bool TShip::IsVisible()
 ******************************************************************************/
 bool TShip::IsAlive()
 {
-	return m_bAlive;
+	return GetLifetime().bAlive != 0;
 }
 
 /*!****************************************************************************
@@ -319,30 +388,15 @@ bool TShip::IsAlive()
 ******************************************************************************/
 void TShip::SetVisible(bool bVisible)
 {
-	m_bVisible = bVisible;
-
-
-	if( bVisible )
+	GetLifetime().bVisible = bVisible;
+											// the aliens: their saucer sound,
+                                            // looped while visible
+	if( GetClass() != scHuman )
 	{
-		if( GetClass() == scAlienBig )
-		{
-			m_pAudio->PlayTheSound("saucer_big", true);
-		}
-		else if( GetClass() == scAlienSmall )
-		{
-			m_pAudio->PlayTheSound("saucer_small", true);
-		}
-	}
-	else
-	{
-		if( GetClass() == scAlienBig )
-		{
-			m_pAudio->StopTheSound("saucer_big");
-		}
-		else if( GetClass() == scAlienSmall )
-		{
-			m_pAudio->StopTheSound("saucer_small");
-		}
+		TSoundId nSound = m_pEntities->GetEmitter(m_nEntity).nSound;
+
+		if( bVisible ) m_pAudio->PlayTheSound(nSound, true, GetThePan(GetPos().X));
+		else m_pAudio->StopTheSound(nSound);
 	}
 }
 
@@ -352,7 +406,11 @@ void TShip::SetVisible(bool bVisible)
 ******************************************************************************/
 void TShip::SetAlive(bool bAlive)
 {
-	m_bAlive = bAlive;
+											// a new life: no outline until
+                                            // it is drawn
+	if( bAlive && !IsAlive() ) m_bOutline = false;
+
+	GetLifetime().bAlive = bAlive;
 }
 
 /*!****************************************************************************
@@ -367,22 +425,25 @@ void TShip::Impulse(double Impulse)
 
 											// gives the impulse in the same
 											// direction of the ship heading
-	m_Vel.X += cos( DEG2RAD(m_Rot - 90.0) ) * Impulse;
-	m_Vel.Y += sin( DEG2RAD(m_Rot + 90.0) ) * Impulse;
+	TMotion& Motion = GetMotion();
+	double Rot = GetRot();
+
+	Motion.VX += cos( DEG2RAD(Rot - 90.0) ) * Impulse;
+	Motion.VY += sin( DEG2RAD(Rot + 90.0) ) * Impulse;
 
 											// limit the speed
-	if (m_Vel.X > SHIP_MAXVEL) m_Vel.X = SHIP_MAXVEL;
-	if (m_Vel.Y > SHIP_MAXVEL) m_Vel.Y = SHIP_MAXVEL;
+	if (Motion.VX > SHIP_MAXVEL) Motion.VX = SHIP_MAXVEL;
+	if (Motion.VY > SHIP_MAXVEL) Motion.VY = SHIP_MAXVEL;
 
 											// plays the thrust sound
 	unsigned nDelay = 250;
-	static unsigned nCurTick = nDelay;
 
-	if( (::GetTickCount() - nCurTick ) >= nDelay )
+	if( (utils::GetTicks() - m_nThrustSoundTime ) >= nDelay )
 	{
-		nCurTick = GetTickCount();
+		m_nThrustSoundTime = utils::GetTicks();
 
-		m_pAudio->PlayTheSound("ship_thrust");
+		m_pAudio->PlayTheSound(m_pEntities->GetEmitter(m_nEntity).nSound,
+			false, GetThePan(GetPos().X));
 	}
 }
 
@@ -396,8 +457,8 @@ void TShip::Explode()
 	SetAlive(false);
 	SetVisible(false);
 
-	m_pAudio->PlayTheSound("ship_explosion");
-	m_nExplosionTicks = SHIP_EXPLOSIONTICKS;
+	m_pAudio->PlayTheSound(snShipExplosion, false, GetThePan(GetPos().X));
+	GetLifetime().nTicks = SHIP_EXPLOSIONTICKS;
 
 									// debris initial conditions
     Split(m_Shape, m_Debris);
@@ -411,9 +472,9 @@ void TShip::Explode()
 
     for(int i=0;i<m_Debris.size();i++)
     {
-		m_DebrisRotations.push_back( maths::Rand(RotVal) );
+		m_DebrisRotations.push_back( m_pRandom->Rand(RotVal) );
 		m_DebrisTranslations.push_back(
-        	MidPoint(m_Debris[i][0], m_Debris[i][1]) * maths::AbsRand(ShiftVal));
+        	MidPoint(m_Debris[i][0], m_Debris[i][1]) * m_pRandom->AbsRand(ShiftVal));
     }
 }
 
@@ -424,13 +485,11 @@ void TShip::DoExplosion()
 {
 	assert(m_pVideo);
 
-	m_nExplosionTicks--;
-
-	int nCurTick = SHIP_EXPLOSIONTICKS - m_nExplosionTicks;
+	int nTicks = --GetLifetime().nTicks;
 
-	if( m_nExplosionTicks > 0 )
+	if( nTicks > 0 )
     {
-		BYTE Brightness = 255.0/ double(SHIP_EXPLOSIONTICKS) * m_nExplosionTicks;
+		BYTE Brightness = 255.0/ double(SHIP_EXPLOSIONTICKS) * nTicks;
 
 		for(int i=0; i<m_Debris.size(); i++)
         {
@@ -439,10 +498,7 @@ void TShip::DoExplosion()
             Translate(m_Debris[i], m_DebrisTranslations[i]);
         }
 
-		TVecVecPoints Shape = m_Debris;
-
-											// global transformations
-        Rotate(Shape, m_Rot);
+											// global transformations:
 											// no!: appare "innaturale"
         //Translate(Shape, m_Pos);
 											// si!: tien conto della quantita'
@@ -451,23 +507,102 @@ void TShip::DoExplosion()
                                             // ( moltiplica per un fattore
                                             // limitativo, ad esempio 0.5 )
 		double LimitingFactor = 0.5;
-        m_DebrisStartPos.X += m_Vel.X * DT * LimitingFactor;
-        m_DebrisStartPos.Y += m_Vel.Y * DT * LimitingFactor;
-        Translate(Shape, m_Pos + m_DebrisStartPos);
+        m_DebrisStartPos.X += GetMotion().VX * DT * LimitingFactor;
+        m_DebrisStartPos.Y += GetMotion().VY * DT * LimitingFactor;
+        Transform(m_Debris, GetRot(), GetPos() + m_DebrisStartPos, m_WorldDebris);
 
 											// draw the ship debris
-		m_pVideo->DrawLines(Shape, 0, RGB(Brightness, Brightness, Brightness));
+		m_pVideo->DrawLines(m_WorldDebris, 0, RGB(Brightness, Brightness, Brightness));
     }
 }
 
+/*!****************************************************************************
+* @brief	Gets the radius of the circle around the outline of the ship
+******************************************************************************/
+double TShip::GetRadius()
+{
+	return m_pEntities->GetCollider(m_nEntity).Radius;
+}
+
+/*!****************************************************************************
+* @brief	Checks if the ship has been drawn in its current life
+* @return	True if GetOutline() is its outline, where it is now
+******************************************************************************/
+bool TShip::HasOutline()
+{
+	return m_bOutline;
+}
+
+/*!****************************************************************************
+* @brief	Gets the outline of the ship, as drawn in the last update
+* @return	The polylines of the frame, polygons of the collisions
+******************************************************************************/
+TVecVecPoints& TShip::GetOutline()
+{
+	return m_WorldShape;
+}
+
 /*!****************************************************************************
 * @brief	Collision detection
 * @param	Pos Position to check for collision
+* @note		The circle around the ship first, then its outline
 ******************************************************************************/
 bool TShip::IsColliding(TVector2 Pos)
 {
-	return bool( Distance(GetPos(), Pos) <= m_Size.X);
-	//return bool( GetPos(pShip).Distance(Pos) <= m_Size.X);
+	if( Distance(GetPos(), Pos) > GetRadius() ) return false;
+
+	if( !HasOutline() ) return true;
+
+	for(unsigned i=0; i<m_WorldShape.size(); i++)
+	{
+		if( PointInPolygon(Pos, m_WorldShape[i]) ) return true;
+	}
+
+	return false;
+}
+
+/*!****************************************************************************
+* @brief	Collision detection of a point moving along a segment
+* @param	From The position of the point at the start of the step
+* @param	To The position of the point at the end of the step
+* @param	Dt The value for the delta time of the step
+* @note		The test is made relative to the ship, that has moved by its
+*			velocity in the same step
+******************************************************************************/
+bool TShip::IsColliding(TVector2 From, TVector2 To, double Dt)
+{
+	TVector2 Vel = GetVel();
+
+	From.X += Vel.X * Dt;
+	From.Y += Vel.Y * Dt;
+
+	if( !SegmentCircle(From, To, GetPos(), GetRadius()) ) return false;
+
+	if( !HasOutline() ) return true;
+
+	for(unsigned i=0; i<m_WorldShape.size(); i++)
+	{
+		if( SegmentPolygon(From, To, m_WorldShape[i]) ) return true;
+	}
+
+	return false;
+}
+
+/*!****************************************************************************
+* @brief	Collision detection with a polygon
+* @param	Polygon The polygon, an asteroid outline
+* @note		The caller has already checked the bounding circles
+******************************************************************************/
+bool TShip::IsColliding(TVecPoints& Polygon)
+{
+	if( !HasOutline() ) return true;
+
+	for(unsigned i=0; i<m_WorldShape.size(); i++)
+	{
+		if( PolygonPolygon(m_WorldShape[i], Polygon) ) return true;
+	}
+
+	return false;
 }
 
 /*!****************************************************************************
@@ -481,7 +616,7 @@ void TShip::ActivateTheShield()
 		m_nShieldTick = 0;
 		m_bShield = true;
 
-		m_pAudio->PlayTheSound("shield");
+		m_pAudio->PlayTheSound(snShield);
 	}
 }
 
@@ -501,17 +636,24 @@ bool TShip::IsShieldActive()
 ******************************************************************************/
 void TShip::Split(TVecVecPoints& Pts, TVecVecPoints& Splits)
 {
- 	Splits.clear();
+	unsigned nSplits = 0;
+
+    for(int i=0; i<Pts.size(); i++) nSplits += Pts[i].size() - 1;
+											// same shape, same count: the
+                                            // segments of the last explosion
+                                            // are reused
+	Splits.resize(nSplits);
+    nSplits = 0;
 
     for(int i=0; i<Pts.size(); i++)
     {
         for(int j=0; j<Pts[i].size()-1; j++)
         {
-            TVecPoints Temp;
-            Temp.push_back(Pts[i][j]);
-            Temp.push_back(Pts[i][j+1]);
+            TVecPoints& Segment = Splits[nSplits++];
 
-            Splits.push_back(Temp);
+            Segment.resize(2);
+            Segment[0] = Pts[i][j];
+            Segment[1] = Pts[i][j+1];
         }
     }
 }
@@ -525,6 +667,9 @@ void TShip::Update(double Dt)
 	assert(m_pVideo);
 	assert(m_Shape.size() > 0);
 
+	TTransform& Transform = GetTransform();
+	COLORREF Color = GetRenderable().Color;
+
 	if ( IsAlive() )
 	{
 		if( GetClass() == scHuman )
@@ -535,97 +680,85 @@ void TShip::Update(double Dt)
 				m_bShield = false;
 			}
 
-			TVecVecPoints Shape = m_Shape;
-
-			Rotate(Shape, m_Rot);
 			TVector2 Vel = GetVel();
-			m_Pos.X += Vel.X * Dt;
-			m_Pos.Y += Vel.Y * Dt;
-			Translate(Shape, m_Pos);
+			Transform.X += Vel.X * Dt;
+			Transform.Y += Vel.Y * Dt;
+			m_pShapes->Transform(m_nShapeId, Transform.Rot, GetPos(), m_WorldShape);
+			m_bOutline = true;
 
-			m_pVideo->DrawLines(Shape, 0, m_Color);
+			m_pVideo->DrawLines(m_WorldShape, 0, Color);
 
 												// draw the engine
 			m_nImpulseTicks--;
 
 			if (m_nImpulseTicks > 0)
 			{
-				TVecVecPoints Engine = m_Engine;
-
-				Rotate(Engine, m_Rot);
-				Translate(Engine, m_Pos);
+				m_pShapes->Transform(m_nEngineId, Transform.Rot, GetPos(), m_WorldEngine);
 
-				m_pVideo->DrawLines(Engine, 0, m_Color);
+				m_pVideo->DrawLines(m_WorldEngine, 0, Color);
 			}
 
 											// draw the shield
 			if( IsShieldActive() )
 			{
-				TVecVecPoints Shield = m_Shield;
-
-				Translate(Shield, m_Pos);
+				m_pShapes->Transform(m_nShieldId, 0, GetPos(), m_WorldShield);
 
 											// some special effects ...
 				{
-					static int nCounter = 0, nMaxCount = 4;
-					if( nCounter++ > nMaxCount ) nCounter = 0;
-					double ShadeLevel = double(nCounter) / double(nMaxCount);
+					int nMaxCount = 4;
+					if( m_nShieldBlink++ > nMaxCount ) m_nShieldBlink = 0;
+					double ShadeLevel = double(m_nShieldBlink) / double(nMaxCount);
 
 											// ... blink the shield when time is running out
 					if( m_nShieldTick > SHIELDTICKS*3.0/4.0)
 					{
-						COLORREF nColor = RGB(m_Color * ShadeLevel,
-                        	m_Color * ShadeLevel, m_Color * ShadeLevel);
+						COLORREF nColor = RGB(Color * ShadeLevel,
+                        	Color * ShadeLevel, Color * ShadeLevel);
 
 						//m_pVideo->DrawLines(Shield, 0, m_Color * ShadeLevel);
-						m_pVideo->DrawLines(Shield, 0, nColor);
+						m_pVideo->DrawLines(m_WorldShield, 0, nColor);
 					}
 					else
 					{
 						//m_pVideo->DrawLines(Shield, 0, m_Color);
-						m_pVideo->DrawLines(Shield, 0, RGB(m_Color, m_Color, m_Color));
+						m_pVideo->DrawLines(m_WorldShield, 0, RGB(Color, Color, Color));
 					}
 				}
 			}
 		}
 		else
 		{
-			static int nCounter = 0;
-			nCounter++;
-
-			TVecVecPoints Shape = m_Shape;
+			m_nCourseTicks++;
 
 			TVector2 Vel = GetVel();
 
 			double Module = 5.0;
 
-			if( nCounter > 25 )
+			if( m_nCourseTicks > 25 )
 			{
-				nCounter = 0;
+				m_nCourseTicks = 0;
 
-				Vel.Y += maths::Rand(2.0*Module);
-				Vel.X += maths::AbsRand(Module);
+				Vel.Y += m_pRandom->Rand(2.0*Module);
+				Vel.X += m_pRandom->AbsRand(Module);
 			}
 
 			SetVel(Vel);
 
-			m_Pos.X += Vel.X * Dt;
-			m_Pos.Y += Vel.Y * Dt;
-			Translate(Shape, m_Pos);
+			Transform.X += Vel.X * Dt;
+			Transform.Y += Vel.Y * Dt;
+			m_pShapes->Transform(m_nShapeId, 0, GetPos(), m_WorldShape);
+			m_bOutline = true;
 
-			m_pVideo->DrawLines(Shape, 0, m_Color);
+			m_pVideo->DrawLines(m_WorldShape, 0, Color);
 
 												// draw the engine
 			m_nImpulseTicks--;
 
 			if (m_nImpulseTicks > 0)
 			{
-				TVecVecPoints Engine = m_Engine;
-
-				Rotate(Engine, m_Rot);
-				Translate(Engine, m_Pos);
+				m_pShapes->Transform(m_nEngineId, Transform.Rot, GetPos(), m_WorldEngine);
 
-				m_pVideo->DrawLines(Engine, 0, m_Color);
+				m_pVideo->DrawLines(m_WorldEngine, 0, Color);
 			}
 		}
 	}
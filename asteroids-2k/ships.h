@@ -7,13 +7,14 @@
 #ifndef _SHIPS_H_
 #define _SHIPS_H_
 
-#include <windows.h>
 #include <vector>
-#pragma hdrstop
 
+#include "commdefs.h"
 #include "vectors.h"
-#include "audio.h"
-#include "video.h"
+#include "devices.h"
+#include "maths.h"
+#include "shapes.h"
+#include "entities.h"
 
 
 #define SHIP_SIZE				16
@@ -36,8 +37,10 @@ typedef std::vector<TShip*> TVecPtrShips;
 class TShip
 {
     public:
-        TShip(TVideoManager *pVM, TSoundManager* pSM,
-            enShipClass nClass, TVector2 Size, TVector2 Pos, TVector2 Vel);
+        TShip(TVideoDevice *pVM, TSoundDevice* pSM, maths::TRandom* pRandom,
+            TShapeCache* pShapes, TEntityStore* pEntities, enShipClass nClass,
+            TVector2 Size, TVector2 Pos, TVector2 Vel);
+        ~TShip();
 
     public:
         void Reset();
@@ -74,31 +77,58 @@ class TShip
         bool IsAlive();
         bool IsVisible();
         bool IsColliding(TVector2 Pos);
+        bool IsColliding(TVector2 From, TVector2 To, double Dt);
+        bool IsColliding(TVecPoints& Polygon);
+										// the frame as drawn in the last
+                                        // update, and the circle around it
+        bool HasOutline();
+        TVecVecPoints& GetOutline();
+        double GetRadius();
+                                        // its components, in the store
+        TEntity GetEntity() { return m_nEntity; }
 
     protected:
         enShipClass m_nClass;
-        TSoundManager *m_pAudio;
-        TVideoManager *m_pVideo;
-
-        COLORREF m_Color;
+        TSoundDevice *m_pAudio;
+        TVideoDevice *m_pVideo;
+        maths::TRandom *m_pRandom;
+        TShapeCache *m_pShapes;
+        TEntityStore *m_pEntities;
+        TEntity m_nEntity;					// position, velocity, rotation,
+        									// life and color of the ship
         int m_nImpulseTicks;
-        double m_Rot, m_Impulse;
-        bool m_bAlive, m_bVisible;
-        TVector2 m_Size, m_Pos, m_Vel;
+        double m_Impulse;
+        TVector2 m_Size;
         TVecVecPoints m_Shape, m_Engine, m_Shield;
+        									// the outlines in the cache
+        int m_nShapeId, m_nEngineId, m_nShieldId;
 
         bool m_bShield;
         unsigned m_nShieldTick;
+        int m_nShieldBlink;
+											// alien ships: ticks to next
+                                            // change of course
+        int m_nCourseTicks;
+        unsigned m_nThrustSoundTime;
 
-        int m_nExplosionTicks;
                                       		// debris
         TVecVecPoints m_Debris;
 		TVector2 m_DebrisStartPos;
         TVecPoints m_DebrisTranslations;
         std::vector<double> m_DebrisRotations;
+											// the outlines being drawn, the
+                                            // memory is reused every tick
+		TVecVecPoints m_WorldShape, m_WorldEngine, m_WorldShield, m_WorldDebris;
+        bool m_bOutline;					// m_WorldShape drawn in this life
 
     protected:
 		void BuildTheShip();
+		void SetTheEmitter();
+
+        TTransform& GetTransform() { return m_pEntities->GetTransform(m_nEntity); }
+        TMotion& GetMotion() { return m_pEntities->GetMotion(m_nEntity); }
+        TLifetime& GetLifetime() { return m_pEntities->GetLifetime(m_nEntity); }
+        TRenderable& GetRenderable() { return m_pEntities->GetRenderable(m_nEntity); }
         void Split(TVecVecPoints& Pts, TVecVecPoints& Splits);
 
 };
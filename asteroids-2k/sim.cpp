@@ -0,0 +1,1298 @@
+/*!****************************************************************************
+
+	@file	sim.h
+	@file	sim.cpp
+
+	@brief	Game simulation, independent from the platform
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "sim.h"
+#include "sounds.h"
+#include "maths.h"
+#include "timer.h"
+#include "profiler.h"
+#include "vectors.h"
+#include "commdefs.h"
+
+//-----------------------------------------------------------------------------
+
+#define MAXLIVES		3
+#define STARTLEVEL		1
+#define STARTSCORE		0
+#define BONUSCOUNTER	1
+#define BONUSPOINTS		1000
+
+#define MAXASTEROIDS	5
+
+#define ASTEROIDVEL			10
+#define ASTEROIDVELRATIO	2
+#define ASTEROIDBIGSIZE		30
+#define ASTEROIDMIDSIZE 	20
+#define ASTEROIDSMALLSIZE	10
+
+#define BIGASTEROIDSCORE	5
+#define MIDASTEROIDSCORE    10
+#define SMALLASTEROIDSCORE	20
+
+#define BIGALIENSHIPSCORE	100
+#define SMALLALIENSHIPSCORE	500
+
+#define SAFETYDISTANCE		(2.0*ASTEROIDBIGSIZE)
+
+#define GRIDCELLSIZE		(2.0*ASTEROIDBIGSIZE)
+
+#define ALIENSHOTDELAY		20
+#define HUMANSHOTDELAY		100
+
+#define MISSILESPEED		100.0
+
+#define ALIENSHIPTICK		500
+
+#define ALIENBIGINACCURACY		(M_PI/16.0)
+#define ALIENSMALLINACCURACY	(M_PI/64.0)
+
+
+//#define _DEVEL
+
+
+/*!****************************************************************************
+* @brief	Constructor
+* @param	pVD Pointer to the video device
+* @param	pSD Pointer to the sound device
+* @param	nWidth Width of the game area
+* @param	nHeight Height of the game area
+******************************************************************************/
+TSimulation::TSimulation(TVideoDevice* pVD, TSoundDevice* pSD,
+	unsigned nWidth, unsigned nHeight)
+	: m_Missiles(pVD, &m_Jobs, &m_Entities),
+	m_Asteroids(pVD, pSD, &m_Random, &m_ShapeCache, &m_Jobs, &m_Entities)
+{
+	assert(pVD);
+	assert(pSD);
+
+	m_pVideo = pVD;
+	m_pAudio = pSD;
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+
+	m_nTick = 0;
+	ResetTheCounters();
+
+	m_bGameOver = false;
+	m_nLives = MAXLIVES;
+	m_nScore = STARTSCORE;
+	m_nLevel = STARTLEVEL;
+	m_nBonusCount = BONUSCOUNTER;
+
+	m_nGridAsteroids = 0;
+	m_MaxAsteroidSpeed = 0;
+	m_Dt = DT;
+	m_AsteroidsGrid.Resize(m_nWidth, m_nHeight, GRIDCELLSIZE);
+
+	ResetPhaseTimes();
+
+	BuildTheShips();
+
+#ifdef _DEVEL
+	BuildTheAsteroids(1);
+#else
+	BuildTheAsteroids(m_nLevel * MAXASTEROIDS );
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Destructor
+******************************************************************************/
+TSimulation::~TSimulation()
+{
+    Clear(m_pShips);
+    m_Missiles.Clear();
+    m_Asteroids.Clear();
+}
+
+/*!****************************************************************************
+* @brief	Restarts the game with a new seed, drawn from the current sequence
+******************************************************************************/
+void TSimulation::Restart()
+{
+	Restart( m_Random.Next() );
+}
+
+/*!****************************************************************************
+* @brief	Set all parameters to their default values and restart the game
+* @param	nSeed The seed of the random generator: the same seed and the
+*			same inputs give the same game
+******************************************************************************/
+void TSimulation::Restart(unsigned nSeed)
+{
+	assert(m_pAudio);
+	assert(m_pShips.size());
+
+    m_Missiles.Clear();
+	m_Asteroids.Clear();
+
+	m_pAudio->StopAllSounds();
+
+	unsigned nWidth, nHeight;
+	GetClientArea(nWidth, nHeight);
+
+	for(int i=0; i<m_pShips.size(); ++i)
+	{
+		m_pShips[i]->Reset();
+
+		if( m_pShips[i]->GetClass() == scHuman )
+		{
+			m_pShips[i]->SetVel(TVector2(0,0));
+			m_pShips[i]->SetRot(180.0);
+			m_pShips[i]->SetPos(TVector2(nWidth/2.0, nHeight/2.0) );
+
+			m_pShips[i]->SetAlive(true);
+			m_pShips[i]->SetVisible(true);
+		}
+		else
+		{
+			m_pShips[i]->SetVel(TVector2(0,0) );
+			m_pShips[i]->SetRot(0);
+			m_pShips[i]->SetPos(TVector2( -100, -100 ) );
+
+			m_pShips[i]->SetAlive(false);
+			m_pShips[i]->SetVisible(false);
+		}
+	}
+
+	m_nLives = MAXLIVES;
+	m_nLevel = STARTLEVEL;
+	m_nScore = STARTSCORE;
+	m_nBonusCount = BONUSCOUNTER;
+	m_bGameOver = false;
+
+	m_Random.Seed(nSeed);
+
+	m_nTick = 0;
+	ResetTheCounters();
+
+#ifdef _DEVEL
+	BuildTheAsteroids(1);
+#else
+	BuildTheAsteroids(m_nLevel * MAXASTEROIDS);
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Terminates the game
+******************************************************************************/
+void TSimulation::GameOver()
+{
+	m_bGameOver = true;
+
+	for(int i=0; i<m_pShips.size(); ++i)
+	{
+		m_pShips[i]->SetVisible(false);
+		m_pShips[i]->SetAlive(false);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Checks for "game-over" status
+* @return	If the game is in "game-over" status return true, false otherwise
+******************************************************************************/
+bool TSimulation::IsGameOver()
+{
+	return m_bGameOver;
+}
+
+/*!****************************************************************************
+* @brief	Advances the game to next level
+******************************************************************************/
+void TSimulation::NextLevel()
+{
+	m_Missiles.Clear();
+    m_Asteroids.Clear();
+
+	m_nLevel++;
+
+#ifdef _DEVEL
+	unsigned nCount = m_nLevel;
+#else
+	unsigned nCount = m_nLevel * MAXASTEROIDS;
+#endif
+
+	BuildTheAsteroids(nCount);
+}
+
+/*!****************************************************************************
+* @brief	Resets the counters of the game events (shots, alien ships)
+******************************************************************************/
+void TSimulation::ResetTheCounters()
+{
+	unsigned nTickDelay = HUMANSHOTDELAY * FPS / 1000;
+
+	m_nShotTick = m_nTick - nTickDelay;
+	m_nAlienShotTick = 0;
+	m_nAlienShipTick = ALIENSHIPTICK + m_Random.Rand(ALIENSHIPTICK/2);
+}
+
+/*!****************************************************************************
+* @brief	Deletes a bunch of ships referenced by a vector of pointers
+* @param	Ships Referernce to a list of pointers to ships
+******************************************************************************/
+void TSimulation::Clear(TVecPtrShips& Ships)
+{
+	for(int i=0; i<Ships.size(); i++)
+    {
+    	if( Ships[i] ) delete Ships[i];
+    }
+
+    Ships.clear();
+}
+
+/*!****************************************************************************
+* @brief	Builds the ships
+* @return	Returns true for success, false otherwise
+******************************************************************************/
+bool TSimulation::BuildTheShips()
+{
+	bool bResult = true;
+											// build the human ship
+	{
+		TShip *pShip = new TShip(
+			m_pVideo,
+			m_pAudio,
+			&m_Random,
+			&m_ShapeCache,
+			&m_Entities,
+			scHuman,
+			TVector2 ( SHIP_SIZE, SHIP_SIZE ),
+			TVector2 ( m_nWidth/2, m_nHeight/2 ),
+			TVector2 ( 0, 0 ) );
+
+		assert(pShip);
+
+		pShip->SetRot(180.0);
+		pShip->SetAlive(true);
+		pShip->SetVisible(true);
+		pShip->SetColor(RGB(255,255,255));
+
+		m_pShips.push_back(pShip);
+	}
+											// build the small alien ship
+	{
+		TShip *pShip = new TShip(
+			m_pVideo,
+			m_pAudio,
+			&m_Random,
+			&m_ShapeCache,
+			&m_Entities,
+			scAlienSmall,
+			TVector2 ( SHIP_SIZE, SHIP_SIZE ),
+			TVector2 ( -100, -100 ),
+			TVector2 ( 0, 0 ) );
+
+		assert(pShip);
+
+		pShip->SetAlive(true);
+		pShip->SetVisible(false);
+		pShip->SetColor(RGB(255,255,255));
+
+		m_pShips.push_back(pShip);
+	}
+											// build the big alien ship
+	{
+		TShip *pShip = new TShip(
+			m_pVideo,
+			m_pAudio,
+			&m_Random,
+			&m_ShapeCache,
+			&m_Entities,
+			scAlienBig,
+			TVector2 (1.5*SHIP_SIZE, 1.5*SHIP_SIZE),
+			TVector2 ( -100, -100 ),
+			TVector2 ( 0, 0 ) );
+
+		assert(pShip);
+
+		pShip->SetAlive(true);
+		pShip->SetVisible(false);
+		pShip->SetColor(RGB(255,255,255));
+
+		m_pShips.push_back(pShip);
+	}
+
+	return bResult;
+}
+
+/*!****************************************************************************
+* @brief	Shots the missile
+* @param	pShip Pointer to the ship object
+******************************************************************************/
+void TSimulation::ShotTheMissile(TShip* pShip)
+{
+	assert(pShip);
+											// delay, in ticks, between sequential
+											// shots (HUMANSHOTDELAY is in ms)
+	unsigned nTickDelay = HUMANSHOTDELAY * FPS / 1000;
+
+	if( (m_nTick - m_nShotTick ) >= nTickDelay)
+	{
+		m_nShotTick = m_nTick;
+
+		m_pAudio->PlayTheSound(snShipFire, false, GetThePan(pShip->GetPos().X));
+
+		int nMissile = m_Missiles.Spawn();
+											// the pool is exhausted
+		if( nMissile < 0 ) return;
+
+		m_Missiles.SetOwner(nMissile, pShip->GetEntity());
+													// nel caso dell'astronave "umana" spara
+													// il missile lungo la direzione della prua
+		if( pShip->GetClass() == scHuman )
+		{
+			double Rot = pShip->GetRot();
+			double Mod = MISSILESPEED;
+
+			TVector2 Vel( Mod*cos(DEG2RAD(Rot-90.0)), Mod*sin(DEG2RAD(Rot+90.0)) );
+
+			TVector2 Pos = pShip->GetPos();
+			TVector2 ShipVel = pShip->GetVel();
+
+			m_Missiles.Arm(nMissile, Pos, Add( Vel, ShipVel) );
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Builds the asteroids
+* @param	nCount Number of asteroids to be created
+******************************************************************************/
+void TSimulation::BuildTheAsteroids(unsigned nCount)
+{
+	assert(m_pAudio);
+	assert(m_pVideo);
+												// rebuild the asteroid's list
+	for(int i=0; i<nCount; i++)
+	{
+												// one draw per statement, the
+                                                // order of the arguments is
+                                                // unspecified
+		TVector2 Pos, Vel;
+
+		Pos.X = m_Random.AbsRand(m_nWidth);
+		Pos.Y = m_Random.AbsRand(m_nHeight);
+		Vel.X = m_Random.Rand(ASTEROIDVEL) + ASTEROIDVEL/5.0;
+		Vel.Y = m_Random.Rand(ASTEROIDVEL) + ASTEROIDVEL/5.0;
+
+		m_Asteroids.Add(acBig, Pos, Vel,
+            ASTEROIDBIGSIZE + m_Random.AbsRand(ASTEROIDBIGSIZE/10.0) );
+	}
+}
+
+/*!****************************************************************************
+* @brief	Checks if given position are out of the scenario boundaries
+* @param	Pos Position to be tested to for coordinates
+* @return	Returns true if Pos is inside limits, false otherwise
+******************************************************************************/
+bool TSimulation::IsInsideGameArea(TVector2 Pos)
+{
+	unsigned nWidth, nHeight;
+	GetClientArea(nWidth, nHeight);
+
+	return bool( (Pos.X>=0) && (Pos.X <= nWidth) && (Pos.Y >=0 ) && (Pos.Y <= nHeight) );
+}
+
+/*!****************************************************************************
+* @brief	Force all actors inside of the scenario boundaries
+******************************************************************************/
+void TSimulation::ForceInsideLimits()
+{
+											// force ships inside the scenery limits
+	unsigned nWidth, nHeight;
+	GetClientArea(nWidth, nHeight);
+
+	for(int i=0; i<m_pShips.size(); ++i)
+	{
+		TVector2 Pos = m_pShips[i]->GetPos();
+
+		if( !IsInsideGameArea(Pos) )
+		{
+			if( m_pShips[i]->GetClass() == scHuman )
+			{
+
+				if( Pos.X < 0 ) Pos.X = nWidth;
+				if( Pos.X > nWidth ) Pos.X = 0;
+				if( Pos.Y < 0 ) Pos.Y = nHeight;
+				if( Pos.Y > nHeight ) Pos.Y = 0;
+
+				m_pShips[i]->SetPos(Pos);
+			}
+			else
+			{
+				if( Pos.X >=0 && Pos.X <= nWidth )
+				{
+					if( Pos.Y < 0 ) Pos.Y = nHeight;
+					if( Pos.Y > nHeight ) Pos.Y = 0;
+
+					m_pShips[i]->SetPos(Pos);
+				}
+				else
+				{
+					m_pShips[i]->SetVisible(false);
+					m_pShips[i]->SetPos(TVector2 ( -100, -100 ) );
+				}
+			}
+		}
+	}
+											// force asteroids inside the scenery limits
+	m_Asteroids.Wrap(nWidth, nHeight);
+}
+
+/*!****************************************************************************
+* @brief	Puts the alive asteroids in the broadphase grid
+* @note		Must be called once the asteroids have been moved, the splits
+*			created later in the same tick are not in the grid
+******************************************************************************/
+void TSimulation::BuildTheGrid()
+{
+	m_AsteroidsGrid.Clear();
+	m_MaxAsteroidSpeed = 0;
+
+	for(int i=0; i<m_Asteroids.GetCount(); i++)
+	{
+		if( m_Asteroids.IsAlive(i) )
+		{
+			m_AsteroidsGrid.Insert(i, m_Asteroids.GetPos(i), m_Asteroids.GetSize(i));
+
+			m_MaxAsteroidSpeed = std::max(m_MaxAsteroidSpeed,
+				m_Asteroids.GetVel(i).Length());
+		}
+	}
+
+	m_AsteroidsGrid.Commit();
+
+	m_nGridAsteroids = m_Asteroids.GetCount();
+}
+
+/*!****************************************************************************
+* @brief	Handles the transition to next game level
+******************************************************************************/
+void TSimulation::LevelHandler()
+{
+											// se non ci sono piu` asteroidi ...
+	if( m_Asteroids.GetAliveCount() == 0 )
+	{
+		NextLevel();
+	}
+}
+
+/*!****************************************************************************
+* @brief	Handles the "bonus" event
+******************************************************************************/
+void TSimulation::BonusHandler()
+{
+	if( m_nScore >= (BONUSPOINTS * m_nBonusCount) )
+	{
+		m_nLives++;
+		m_nBonusCount++;
+
+		m_pAudio->PlayTheSound(snBonus);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Checks for collision between two ships
+* @note		The bounding circles first, then the outlines
+******************************************************************************/
+bool TSimulation::Collide(TShip* pShip1, TShip* pShip2)
+{
+	assert(pShip1);
+    assert(pShip2);
+
+	if( Distance(pShip1->GetPos(), pShip2->GetPos())
+		> pShip1->GetRadius() + pShip2->GetRadius() ) return false;
+											// the circles overlap: the outlines
+	if( !pShip1->HasOutline() ) return true;
+
+	TVecVecPoints& Outline = pShip1->GetOutline();
+
+	for(unsigned i=0; i<Outline.size(); i++)
+	{
+		if( pShip2->IsColliding(Outline[i]) ) return true;
+	}
+
+	return false;
+}
+
+/*!****************************************************************************
+* @brief	Collision detection between ships and asteroids
+* @param	nAsteroid Index of the asteroid
+* @param	pShip Pointer to the ship object
+* @return	Returns true if objects collides, false otherwise
+* @note		The bounding circles first, then the outlines
+******************************************************************************/
+bool TSimulation::Collide(unsigned nAsteroid, TShip* pShip)
+{
+	if( Distance(pShip->GetPos(), m_Asteroids.GetPos(nAsteroid))
+    	> m_Asteroids.GetSize(nAsteroid) + pShip->GetRadius() ) return false;
+											// the circles overlap: the outlines,
+                                            // as drawn in this tick
+	if( !m_Asteroids.HasOutline(nAsteroid) ) return true;
+
+	return pShip->IsColliding(m_Asteroids.GetOutline(nAsteroid));
+}
+
+/*!****************************************************************************
+* @brief	Previene di piazzare "a tradimento" l'astronave
+*			ossia nel bel mezzo di una pioggia di meteoriti!
+* @param	Pos Position to want to check
+* @return	Returns true if area around specified position is
+			free from meteorites, false otherwise
+******************************************************************************/
+bool TSimulation::IsSafetyPos(TVector2 Pos)
+{
+	bool bResult = true;
+
+	m_AsteroidsGrid.Query(Pos, SAFETYDISTANCE, m_Candidates);
+
+	for(int i=0; i<m_Candidates.size(); ++i)
+	{
+		unsigned nRoid = m_Candidates[i];
+
+		if( nRoid >= m_Asteroids.GetCount() ) break;
+
+		if( m_Asteroids.IsAlive(nRoid) )
+		{
+			if( Distance( m_Asteroids.GetPos(nRoid), Pos) <= SAFETYDISTANCE)
+			{
+				bResult = false;
+				break;
+			}
+		}
+	}
+
+	return bResult;
+}
+
+/*!****************************************************************************
+* @brief	Gets the coordinates of the center of the game area
+* @return	Returns the center of the game area
+******************************************************************************/
+TVector2 TSimulation::GetScreenCenter()
+{
+	return TVector2(m_nWidth/2.0, m_nHeight/2.0);
+}
+
+/*!****************************************************************************
+* @brief	Handles the human ships
+******************************************************************************/
+void TSimulation::HumanShipsHandler()
+{
+    TVector2 ScreenCenter = GetScreenCenter();
+
+    if ( IsSafetyPos(ScreenCenter)
+        && !m_pShips[scHuman]->IsAlive()
+        && !m_pShips[scHuman]->IsExploding() )
+    {
+        m_pShips[scHuman]->Reset();
+        m_pShips[scHuman]->SetPos(ScreenCenter );
+        m_pShips[scHuman]->SetRot(180.0);
+        m_pShips[scHuman]->SetVel(TVector2(0,0) );
+        m_pShips[scHuman]->SetAlive(true);
+        m_pShips[scHuman]->SetVisible(true);
+    }
+}
+
+/*!****************************************************************************
+* @brief	Handles the aliens ships
+******************************************************************************/
+void TSimulation::AlienShipsHandler()
+{
+	m_nAlienShipTick--;
+
+	TShip* pShip = m_Random.RandSign() >= 0 ? m_pShips[scAlienBig] : m_pShips[scAlienSmall];
+	assert(pShip);
+
+	if( m_nAlienShipTick == 0 )
+	{
+		m_nAlienShipTick = ALIENSHIPTICK + m_Random.Rand(ALIENSHIPTICK/2);
+
+		if( !pShip->IsVisible() )
+		{
+			TVector2 ScreenCenter = GetScreenCenter();
+
+			pShip->SetPos(TVector2( 0, ScreenCenter.Y + m_Random.Rand(double(ScreenCenter.Y - 50)) ) );
+
+			pShip->SetVel(TVector2( 25 + m_Random.AbsRand(25), 0 ) );
+			pShip->SetAlive(true);
+			pShip->SetVisible(true);
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	If alien ships are active (visibles) then make shoots
+*			against human ships
+******************************************************************************/
+void TSimulation::AlienShotsHandler()
+{
+	m_nAlienShotTick++;
+
+	if( m_nAlienShotTick >= ALIENSHOTDELAY)
+	{
+		m_nAlienShotTick = 0;
+
+		if( m_pShips[scAlienBig]->IsVisible() && m_pShips[scAlienBig]->IsAlive() )
+		{
+			int nMissile = m_Missiles.Spawn();
+
+			if( nMissile >= 0 )
+			{
+				m_Missiles.SetOwner(nMissile, m_pShips[scAlienBig]->GetEntity());
+
+				TVector2 AlienPos = m_pShips[scAlienBig]->GetPos();
+				TVector2 HumanPos = m_pShips[scHuman]->GetPos();
+
+				double Mod = MISSILESPEED;
+
+				double DX = HumanPos.X - AlienPos.X;
+				double DY = HumanPos.Y - AlienPos.Y;
+
+				//double Rot = atan2(DY, DX);	// NO! troppo preciso!
+				double Rot = atan2(DY, DX) + ALIENBIGINACCURACY + m_Random.Rand(ALIENBIGINACCURACY);
+
+				TVector2 Vel( Mod*cos(Rot), Mod*sin(Rot) );
+
+				TVector2 ShipVel = m_pShips[scAlienBig]->GetVel();
+
+				m_Missiles.Arm(nMissile, AlienPos, Vel);
+			}
+		}
+
+		if( m_pShips[scAlienSmall]->IsVisible()&& m_pShips[scAlienSmall]->IsAlive() )
+		{
+			int nMissile = m_Missiles.Spawn();
+
+			if( nMissile >= 0 )
+			{
+				m_Missiles.SetOwner(nMissile, m_pShips[scAlienSmall]->GetEntity());
+
+				TVector2 AlienPos = m_pShips[scAlienSmall]->GetPos();
+				TVector2 HumanPos = m_pShips[scHuman]->GetPos();
+
+				double Mod = MISSILESPEED;
+
+				double DX = HumanPos.X - AlienPos.X;
+				double DY = HumanPos.Y - AlienPos.Y;
+
+				//double Rot = atan2(DY, DX);	// NO! troppo preciso!
+				double Rot = atan2(DY, DX) + ALIENSMALLINACCURACY + m_Random.Rand(ALIENSMALLINACCURACY);
+
+				TVector2 Vel( Mod*cos(Rot), Mod*sin(Rot) );
+
+				TVector2 ShipVel = m_pShips[scAlienSmall]->GetVel();
+
+				m_Missiles.Arm(nMissile, AlienPos, Vel);
+			}
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Increments the total game score
+* @param	nScore	The value for score increment
+******************************************************************************/
+void TSimulation::AddScore(int nScore)
+{
+	m_nScore += nScore;
+}
+
+/*!****************************************************************************
+* @brief	Increments the total game score based on the asteroid size
+* @param	nClass	The class of the asteroid
+******************************************************************************/
+void TSimulation::AddScore(enAsteroidClass nClass)
+{
+    if( nClass == acBig )
+    {
+        AddScore((int)BIGASTEROIDSCORE);
+    }
+    else if( nClass == acMedium )
+    {
+        AddScore((int) MIDASTEROIDSCORE);
+    }
+    else
+    {
+        AddScore((int)SMALLASTEROIDSCORE);
+    }
+}
+
+/*!****************************************************************************
+* @brief	Splits an asteroid in two smaller ones
+* @param	nRoid	Index of the asteroid
+* @note		The splits are added at the end of the asteroid field
+******************************************************************************/
+void TSimulation::Split(unsigned nRoid)
+{
+	assert(nRoid < m_Asteroids.GetCount());
+
+	enAsteroidClass nClass = m_Asteroids.GetClass(nRoid);
+    enAsteroidClass nNewClass = acSmall;
+    double nSize = ASTEROIDSMALLSIZE, NewSize = ASTEROIDSMALLSIZE;
+
+    if( nClass == acBig )
+    {
+    	nNewClass = acMedium;
+		nSize = ASTEROIDMIDSIZE;
+        NewSize = ASTEROIDMIDSIZE/4.0;
+    }
+    else if( nClass == acMedium )
+    {
+    	nNewClass = acSmall;
+		nSize = ASTEROIDSMALLSIZE;
+        NewSize = ASTEROIDSMALLSIZE/2.0;
+    }
+
+	for(int i=0; i<2; i++)
+    {
+        TVector2 Pos, Vel;
+        Pos = m_Asteroids.GetPos(nRoid);
+        Vel = m_Asteroids.GetVel(nRoid);
+
+        TVector2 RndVel1;
+
+        RndVel1.X = m_Random.Rand(Vel.X)/ASTEROIDVELRATIO;
+        RndVel1.Y = m_Random.Rand(Vel.Y)/ASTEROIDVELRATIO;
+
+        TVector2 Vel1 = Add(Vel, RndVel1);
+
+        m_Asteroids.Add(nNewClass, Pos, Add(Vel, Vel1),
+        	nSize + m_Random.AbsRand(NewSize));
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the size of the game area
+* @param[in,out] nW Width of game area
+* @param[in,out] nH Height of game area
+******************************************************************************/
+void TSimulation::GetClientArea(unsigned& nW, unsigned& nH)
+{
+	nW = m_nWidth;
+	nH = m_nHeight;
+}
+
+/*!****************************************************************************
+* @brief	Applies the commands of the player for the next step
+* @param	nInput The commands, a combination of enInput values
+******************************************************************************/
+void TSimulation::Input(unsigned nInput)
+{
+	TShip* pShip = m_pShips[scHuman];
+	assert(pShip);
+
+	if( !pShip->IsAlive() ) return;
+
+	if( nInput & inShield ) pShip->ActivateTheShield();
+	if( nInput & inFire ) ShotTheMissile(pShip);
+	if( nInput & inLeft ) pShip->RotateLeft(SHIP_ROTSTEP);
+	if( nInput & inRight ) pShip->RotateRight(SHIP_ROTSTEP);
+	if( nInput & inThrust ) pShip->Impulse(SHIP_IMPULSE);
+}
+
+/*!****************************************************************************
+* @brief	Adds a block of bytes to an hash value (FNV-1a)
+******************************************************************************/
+static unsigned Hash(unsigned nHash, const void* pData, unsigned nSize)
+{
+	const unsigned char* pBytes = (const unsigned char*) pData;
+
+	for(unsigned i=0; i<nSize; i++)
+	{
+		nHash = (nHash ^ pBytes[i]) * 16777619u;
+	}
+
+	return nHash;
+}
+
+static unsigned Hash(unsigned nHash, double Val)
+{
+	return Hash(nHash, &Val, sizeof(Val));
+}
+
+static unsigned Hash(unsigned nHash, int nVal)
+{
+	return Hash(nHash, &nVal, sizeof(nVal));
+}
+
+static unsigned Hash(unsigned nHash, TVector2 V)
+{
+	return Hash(Hash(nHash, V.X), V.Y);
+}
+
+/*!****************************************************************************
+* @brief	Gets a digest of the state of the world, bit exact: two runs
+*			with the same seed and the same inputs have the same hash at
+*			every tick
+* @return	The hash value
+******************************************************************************/
+unsigned TSimulation::GetHash()
+{
+	unsigned nHash = 2166136261u;
+
+	nHash = Hash(nHash, (int) m_nTick);
+	nHash = Hash(nHash, m_nScore);
+	nHash = Hash(nHash, m_nLevel);
+	nHash = Hash(nHash, m_nLives);
+	nHash = Hash(nHash, m_nBonusCount);
+	nHash = Hash(nHash, (int) m_bGameOver);
+	nHash = Hash(nHash, (int) m_Random.GetHash());
+
+	for(int i=0; i<m_pShips.size(); i++)
+	{
+		TShip* pShip = m_pShips[i];
+
+		nHash = Hash(nHash, pShip->GetPos());
+		nHash = Hash(nHash, pShip->GetVel());
+		nHash = Hash(nHash, pShip->GetRot());
+		nHash = Hash(nHash, (int) pShip->IsAlive());
+		nHash = Hash(nHash, (int) pShip->IsVisible());
+		nHash = Hash(nHash, (int) pShip->IsShieldActive());
+		nHash = Hash(nHash, (int) pShip->IsExploding());
+	}
+
+	nHash = Hash(nHash, (int) m_Missiles.GetCount());
+
+	for(unsigned i=0; i<m_Missiles.GetCount(); i++)
+	{
+		nHash = Hash(nHash, m_Missiles.GetPos(i));
+		nHash = Hash(nHash, m_Missiles.GetVel(i));
+	}
+
+	nHash = Hash(nHash, (int) m_Asteroids.GetCount());
+
+	for(unsigned i=0; i<m_Asteroids.GetCount(); i++)
+	{
+		nHash = Hash(nHash, m_Asteroids.GetPos(i));
+		nHash = Hash(nHash, m_Asteroids.GetVel(i));
+		nHash = Hash(nHash, m_Asteroids.GetSize(i));
+		nHash = Hash(nHash, (int) m_Asteroids.GetClass(i));
+		nHash = Hash(nHash, (int) m_Asteroids.IsAlive(i));
+	}
+
+	return nHash;
+}
+
+/*!****************************************************************************
+* @brief	Gets the counts of the entities, live and total
+* @return	The counts, as of the last step
+******************************************************************************/
+TSimStats TSimulation::GetStats()
+{
+	TSimStats Stats;
+
+	Stats.nEntities = m_Entities.GetCount();
+
+	Stats.nShips = m_pShips.size();
+	Stats.nShipsAlive = 0;
+
+	for(unsigned i=0; i<m_pShips.size(); i++)
+	{
+		if( m_pShips[i]->IsAlive() ) Stats.nShipsAlive++;
+	}
+
+	Stats.nMissiles = m_Missiles.GetCount();
+	Stats.nMissilesArmed = m_Missiles.GetArmedCount();
+
+	Stats.nAsteroids = m_Asteroids.GetCount();
+	Stats.nAsteroidsAlive = m_Asteroids.GetAliveCount();
+	Stats.nAsteroidsExploding = m_Asteroids.GetExplodingCount();
+	Stats.nExplosions = m_Asteroids.GetExplosionsCount();
+
+	return Stats;
+}
+
+/*!****************************************************************************
+* @brief	Draws the counts of the entities, live / total
+* @param	pDevice The device to draw on
+* @param	nX Left of the text
+* @param	nY Top of the text
+******************************************************************************/
+void TSimulation::DrawTheStats(TVideoDevice* pDevice, int nX, int nY)
+{
+	assert(pDevice);
+
+	COLORREF Color = RGB(255,255,0);
+	TSimStats Stats = GetStats();
+	char Buffer[64];
+
+	sprintf(Buffer, "entities: %u", Stats.nEntities);
+	pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+
+	nY += FONTSIZE;
+	sprintf(Buffer, "ships: %u / %u", Stats.nShipsAlive, Stats.nShips);
+	pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+
+	nY += FONTSIZE;
+	sprintf(Buffer, "missiles: %u / %u", Stats.nMissilesArmed, Stats.nMissiles);
+	pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+
+	nY += FONTSIZE;
+	sprintf(Buffer, "asteroids: %u / %u (%u exploding)", Stats.nAsteroidsAlive,
+		Stats.nAsteroids, Stats.nAsteroidsExploding);
+	pDevice->DrawText(Buffer, nX, nY, Color, TA_LEFT);
+}
+
+/*!****************************************************************************
+* @brief	Gets the time spent in a phase of the simulation
+* @param	nPhase The phase of the simulation step
+* @return	The time, in seconds, accumulated since the last reset
+******************************************************************************/
+double TSimulation::GetPhaseTime(enSimPhase nPhase)
+{
+	assert(nPhase < spCount);
+
+	return m_PhaseTimes[nPhase];
+}
+
+/*!****************************************************************************
+* @brief	Resets the time accumulated by the phases of the simulation
+******************************************************************************/
+void TSimulation::ResetPhaseTimes()
+{
+	for(int i=0; i<spCount; i++)
+	{
+		m_PhaseTimes[i] = 0;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Advances the simulation by a step
+* @param	Dt The value for the delta time
+******************************************************************************/
+void TSimulation::Step(double Dt)
+{
+	assert(m_pShips[scHuman]);
+	assert(m_pShips[scAlienBig]);
+	assert(m_pShips[scAlienSmall]);
+
+	m_nTick++;
+	m_Dt = Dt;
+
+	double Time = utils::GetTime();
+											// update the ships
+	for(int i=0; i<m_pShips.size(); ++i)
+	{
+		m_pShips[i]->Update(Dt);
+	}
+
+	AlienShotsHandler();
+
+	EndPhase(spShips, Time);
+											// update the missiles
+	m_Missiles.Update(Dt);
+
+	EndPhase(spMissiles, Time);
+											// update the asteroids
+	m_Asteroids.Update(Dt);
+
+	EndPhase(spAsteroids, Time);
+											// forces actors inside of scenery limits
+	ForceInsideLimits();
+
+	EndPhase(spLimits, Time);
+
+	BuildTheGrid();
+
+	EndPhase(spBroadphase, Time);
+
+	if( !IsGameOver() )
+	{
+		HumanShipsHandler();
+		AlienShipsHandler();
+
+		EndPhase(spHandlers, Time);
+
+		CollisionHandler();
+
+		EndPhase(spCollisions, Time);
+
+		BonusHandler();
+		LevelHandler();
+
+		EndPhase(spHandlers, Time);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Accounts the time of a phase of the step, to the phase times and
+*			to the profiler, if enabled
+* @param	nPhase The phase just ended
+* @param	Time The time of begin of the phase, set to the current time
+******************************************************************************/
+void TSimulation::EndPhase(enSimPhase nPhase, double& Time)
+{
+	double Now = utils::GetTime();
+
+	m_PhaseTimes[nPhase] += Now - Time;
+
+	if( Profiler ) Profiler->Record(nPhase, Time, Now);
+
+	Time = Now;
+}
+
+/*!****************************************************************************
+* @brief	Handles collisions between all objects of the scenario
+* @note		The contacts are found first, in parallel, without changing the
+*			state of the game; then they are resolved in a fixed order, the
+*			same for any number of threads
+******************************************************************************/
+void TSimulation::CollisionHandler()
+{
+	DetectTheContacts();
+	ResolveTheContacts();
+
+											// deletes the missiles that have
+                                            // gone out of range (screen area)
+	for(int i=0; i<m_Missiles.GetCount(); i++)
+	{
+		if( !IsInsideGameArea( m_Missiles.GetPos(i) ) )
+		{
+			m_Missiles.Disarm(i);
+		}
+	}
+											// gives back the disarmed missiles
+                                            // to the pool
+	m_Missiles.Compact();
+											// checks for game-over
+    if( m_nLives == 0 )
+    {
+        GameOver();
+
+        BestScoreHandler();
+    }
+}
+
+/*!****************************************************************************
+* @brief	Finds all the contacts, sorted in the order of resolution
+******************************************************************************/
+void TSimulation::DetectTheContacts()
+{
+	for(unsigned i=0; i<m_Jobs.GetThreadsCount(); i++) m_ThreadContacts[i].clear();
+
+	TVecContacts& Contacts = m_ThreadContacts[0];
+											// ... human ship and alien ships
+	{
+		TShip *pHuman = m_pShips[scHuman],
+        	*pAlienBig = m_pShips[scAlienBig],
+            *pAlienSmall = m_pShips[scAlienSmall];
+
+		TContact Contact = { ctShipShip, scHuman, 0 };
+
+		if( pAlienBig->IsAlive() && pAlienBig->IsVisible() )
+        {
+			Contact.nB = scAlienBig;
+			if( Collide(pHuman, pAlienBig) ) Contacts.push_back(Contact);
+        }
+		else if( pAlienSmall->IsAlive() && pAlienSmall->IsVisible() )
+        {
+			Contact.nB = scAlienSmall;
+			if( Collide(pHuman, pAlienSmall) ) Contacts.push_back(Contact);
+        }
+    }
+											// ... ships and asteroids
+	for(unsigned j=0; j<m_pShips.size(); ++j)
+	{
+		TShip* pShip = m_pShips[j];
+
+		if( !pShip->IsAlive() ) continue;
+
+		m_AsteroidsGrid.Query(pShip->GetPos(), pShip->GetRadius(), m_Candidates);
+
+		for(int k=0; k<m_Candidates.size(); ++k)
+		{
+			unsigned nRoid = m_Candidates[k];
+
+			if( m_Asteroids.IsAlive(nRoid) && Collide(nRoid, pShip) )
+			{
+				TContact Contact = { ctShipAsteroid, j, nRoid };
+				Contacts.push_back(Contact);
+			}
+		}
+	}
+											// ... missiles and ships, and
+                                            // missiles and asteroids
+											// no asteroid has been added since
+                                            // the grid was built: the splits
+                                            // come with the resolution
+	assert(m_nGridAsteroids == m_Asteroids.GetCount());
+
+	TMethodJob<TSimulation> Job(this, &TSimulation::DetectTheContacts);
+	m_Jobs.ParallelFor(m_Missiles.GetCount(), MISSILES_CONTACTSGRAIN, Job);
+											// all together, in order
+	m_Contacts.clear();
+
+	for(unsigned i=0; i<m_Jobs.GetThreadsCount(); i++)
+	{
+		m_Contacts.insert(m_Contacts.end(), m_ThreadContacts[i].begin(),
+			m_ThreadContacts[i].end());
+	}
+
+	std::sort(m_Contacts.begin(), m_Contacts.end());
+}
+
+/*!****************************************************************************
+* @brief	Finds the contacts of the missiles of a range
+* @param	nBegin First missile
+* @param	nEnd One past the last missile
+* @param	nThread The thread running the range, owner of the buffers
+******************************************************************************/
+void TSimulation::DetectTheContacts(unsigned nBegin, unsigned nEnd, unsigned nThread)
+{
+	TVecContacts& Contacts = m_ThreadContacts[nThread];
+	TVecIndices& Candidates = m_ThreadCandidates[nThread];
+
+	for(unsigned i=nBegin; i<nEnd; i++)
+	{
+		if( !m_Missiles.IsArmed(i) ) continue;
+											// the segment run by the missile in
+                                            // this step: a fast missile does
+                                            // not pass through a small target
+		TVector2 From = m_Missiles.GetPrevPos(i), To = m_Missiles.GetPos(i);
+
+		for(unsigned j=0; j<m_pShips.size(); ++j)
+		{
+			TShip* pShip = m_pShips[j];
+											// avoids that the missile destroy
+											// the ship itself that has shooted it
+			if( pShip->IsAlive() && m_Missiles.GetOwner(i) != pShip->GetEntity()
+				&& pShip->IsColliding(From, To, m_Dt) )
+			{
+				TContact Contact = { ctMissileShip, i, j };
+				Contacts.push_back(Contact);
+			}
+		}
+											// all the asteroids that may have
+                                            // crossed the segment
+		m_AsteroidsGrid.Query(MidPoint(From, To), Distance(From, To) / 2.0
+			+ m_MaxAsteroidSpeed * m_Dt, Candidates);
+
+		for(int k=0; k<Candidates.size(); ++k)
+		{
+			unsigned nRoid = Candidates[k];
+
+			if( m_Asteroids.IsAlive(nRoid)
+				&& m_Asteroids.Collide(nRoid, From, To, m_Dt) )
+			{
+				TContact Contact = { ctMissileAsteroid, i, nRoid };
+				Contacts.push_back(Contact);
+			}
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Applies the contacts: explosions, splits and scores
+* @note		A contact is skipped if one of its objects has been destroyed by
+*			a contact resolved before
+******************************************************************************/
+void TSimulation::ResolveTheContacts()
+{
+	for(unsigned i=0; i<m_Contacts.size(); i++)
+	{
+		TContact& Contact = m_Contacts[i];
+
+		switch( Contact.nKind )
+		{
+			case ctShipShip:
+			{
+				TShip *pHuman = m_pShips[Contact.nA], *pAlien = m_pShips[Contact.nB];
+
+				pHuman->Explode();
+				pAlien->Explode();
+
+				m_nLives--;
+			}
+			break;
+
+			case ctShipAsteroid:
+			{
+				TShip* pShip = m_pShips[Contact.nA];
+											// the first (oldest) asteroid hit
+				if( !pShip->IsAlive() || !m_Asteroids.IsAlive(Contact.nB) ) break;
+
+				pShip->Explode();
+				m_Asteroids.Explode(Contact.nB);
+
+				if( pShip->GetClass() == scHuman )
+				{
+					m_nLives--;
+				}
+			}
+			break;
+
+			case ctMissileShip:
+			{
+				unsigned nMissile = Contact.nA;
+				TShip* pShip = m_pShips[Contact.nB];
+
+				if( !m_Missiles.IsArmed(nMissile) || !pShip->IsAlive()
+					|| pShip->IsShieldActive() ) break;
+
+				pShip->Explode();
+
+				m_Missiles.Disarm(nMissile);
+
+				if( pShip->GetClass() == scHuman )
+				{
+					m_nLives--;
+
+					if( m_nLives == 0 )
+					{
+						GameOver();
+					}
+				}
+				else if( pShip->GetClass() == scAlienBig )
+				{
+					AddScore(BIGALIENSHIPSCORE);
+				}
+				else if( pShip->GetClass() == scAlienSmall )
+				{
+					AddScore(SMALLALIENSHIPSCORE);
+				}
+			}
+			break;
+
+			case ctMissileAsteroid:
+			{
+				unsigned nMissile = Contact.nA;
+				unsigned nRoid = Contact.nB;
+
+				if( !m_Missiles.IsArmed(nMissile) || !m_Asteroids.IsAlive(nRoid) ) break;
+
+				m_Asteroids.Explode(nRoid);
+				AddScore(m_Asteroids.GetClass(nRoid));
+
+				if( m_Asteroids.GetClass(nRoid) != acSmall )
+				{
+											// split an asteroid (big,medium)
+                                            // in two smaller ones asteorids
+					Split(nRoid);
+				}
+
+				m_Missiles.Disarm(nMissile);
+			}
+			break;
+		}
+	}
+}
+
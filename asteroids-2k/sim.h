@@ -0,0 +1,190 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <vector>
+
+#include "commdefs.h"
+#include "devices.h"
+#include "maths.h"
+
+#include "ships.h"
+#include "weapons.h"
+#include "asteroids.h"
+#include "spatial.h"
+#include "shapes.h"
+#include "jobs.h"
+#include "entities.h"
+
+										// the phases of a simulation step
+enum enSimPhase { spShips, spMissiles, spAsteroids, spLimits,
+	spBroadphase, spHandlers, spCollisions, spCount };
+
+										// the entities of the scenery in a
+                                        // step: the live ones, and all the
+                                        // ones in the arrays
+struct TSimStats
+{
+	unsigned nEntities;
+	unsigned nShips, nShipsAlive;
+	unsigned nMissiles, nMissilesArmed;
+	unsigned nAsteroids, nAsteroidsAlive, nAsteroidsExploding;
+	unsigned nExplosions;
+};
+
+										// the kinds of contact, in the order
+                                        // they are resolved
+enum enContact { ctShipShip, ctShipAsteroid, ctMissileShip, ctMissileAsteroid };
+
+										// a contact found by the detection:
+                                        // the indices of the two objects
+struct TContact
+{
+	unsigned nKind, nA, nB;
+
+	bool operator < (const TContact& C) const
+	{
+		if( nKind != C.nKind ) return nKind < C.nKind;
+		if( nA != C.nA ) return nA < C.nA;
+		return nB < C.nB;
+	}
+};
+
+typedef std::vector<TContact> TVecContacts;
+
+										// the commands of the player in a tick,
+                                        // or-ed together
+enum enInput { inLeft = 1, inRight = 2, inThrust = 4, inShield = 8, inFire = 16 };
+
+class TSimulation
+{
+	public:
+    	TSimulation(TVideoDevice* pVD, TSoundDevice* pSD,
+        	unsigned nWidth = FRAMEW, unsigned nHeight = FRAMEH);
+        virtual ~TSimulation();
+
+	public:
+        void Step(double Dt);
+
+        void Restart();
+        void Restart(unsigned nSeed);
+        unsigned GetSeed() { return m_Random.GetSeed(); }
+
+        void Input(unsigned nInput);
+        unsigned GetHash();
+
+        virtual void GameOver();
+        bool IsGameOver();
+
+        void ShotTheMissile(TShip* pShip);
+
+        void GetClientArea(unsigned& nW, unsigned& nH);
+
+		TShip* GetShip(enShipClass nShipClass) { return m_pShips[nShipClass]; }
+
+        int GetScore() { return m_nScore; }
+        int GetLevel() { return m_nLevel; }
+        int GetLives() { return m_nLives; }
+        unsigned GetTick() { return m_nTick; }
+
+        unsigned GetAsteroidsCount() { return m_Asteroids.GetCount(); }
+        unsigned GetMissilesCount() { return m_Missiles.GetCount(); }
+        unsigned GetMissilesPeak() { return m_Missiles.GetPeak(); }
+        unsigned GetMissilesCapacity() { return m_Missiles.GetCapacity(); }
+
+        TSimStats GetStats();
+        void DrawTheStats(TVideoDevice* pDevice, int nX, int nY);
+
+        void SetThreadsCount(unsigned nThreads) { m_Jobs.SetThreadsCount(nThreads); }
+        unsigned GetThreadsCount() { return m_Jobs.GetThreadsCount(); }
+
+        double GetPhaseTime(enSimPhase nPhase);
+        void ResetPhaseTimes();
+
+    protected:
+        TVideoDevice* m_pVideo;
+        TSoundDevice* m_pAudio;
+										// all the randomness of the game
+        maths::TRandom m_Random;
+										// the rotated outlines of the ships
+                                        // and of the asteroids
+        TShapeCache m_ShapeCache;
+										// the parallel loops of the step,
+                                        // a single thread by default
+        TJobSystem m_Jobs;
+										// the components of the ships, of the
+                                        // missiles and of the asteroids
+        TEntityStore m_Entities;
+
+        TVecPtrShips m_pShips;
+        TMissilePool m_Missiles;
+        TAsteroidField m_Asteroids;
+        bool m_bGameOver;
+        int m_nScore, m_nLevel,
+        	m_nDifficulty, m_nLives, m_nBonusCount;
+
+        unsigned m_nWidth, m_nHeight;
+        unsigned m_nTick;
+        unsigned m_nShotTick;
+        int m_nAlienShipTick, m_nAlienShotTick;
+
+        double m_PhaseTimes[spCount];
+										// broadphase of the asteroids collisions
+        TSpatialGrid m_AsteroidsGrid;
+        TVecIndices m_Candidates;
+        unsigned m_nGridAsteroids;
+        double m_MaxAsteroidSpeed;		// of the asteroids in the grid
+        double m_Dt;					// of the current step
+										// contacts found by each thread, and
+                                        // all of them, sorted
+        TVecContacts m_ThreadContacts[JOBS_MAXTHREADS];
+        TVecIndices m_ThreadCandidates[JOBS_MAXTHREADS];
+        TVecContacts m_Contacts;
+
+	protected:
+        virtual void NextLevel();
+
+		void Split(unsigned nAsteroid);
+
+        bool IsSafetyPos(TVector2 Pos);
+        TVector2 GetScreenCenter();
+
+        void AddScore(int nScore);
+        void AddScore(enAsteroidClass nClass);
+
+        void BuildTheAsteroids(unsigned nCount);
+
+        bool BuildTheShips();
+
+        void BuildTheGrid();
+        void EndPhase(enSimPhase nPhase, double& Time);
+        void ForceInsideLimits();
+        bool IsInsideGameArea(TVector2 Pos);
+
+        void LevelHandler();
+        void BonusHandler();
+        void CollisionHandler();
+        void DetectTheContacts();
+        void DetectTheContacts(unsigned nBegin, unsigned nEnd, unsigned nThread);
+        void ResolveTheContacts();
+        void AlienShotsHandler();
+
+        virtual void BestScoreHandler() {}
+
+		bool Collide(TShip* pShip1, TShip* pShip2);
+        bool Collide(unsigned nAsteroid, TShip* pShip);
+
+		void HumanShipsHandler();
+        void AlienShipsHandler();
+
+		void Clear(TVecPtrShips& Ships);
+        void ResetTheCounters();
+};
+
+#endif
+
@@ -0,0 +1,40 @@
+/*!****************************************************************************
+
+	@file	sounds.h
+	@file	sounds.cpp
+
+	@brief	The sounds of the game
+
+	@par	The names of the sounds are resolved once, when they are loaded:
+			the sounds are loaded in the order of enSound, so the value of
+			the enum is the id of the sound in the voice pool, and the game
+			plays them by id, with no lookup by name.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include "sounds.h"
+
+										// the bursts of bangs and shots
+                                        // overlap, up to a few voices; the
+                                        // loops and the events of the ship
+                                        // have one voice, never stolen
+                                        // by the bangs
+const TSoundSetup SoundSetups[snCount] =
+{
+	{ "bonus", 2, 1 },
+	{ "shield", 2, 1 },
+	{ "ship_fire", 0, 4 },
+	{ "bang_large", 1, 4 },
+	{ "bang_medium", 1, 4 },
+	{ "bang_small", 1, 6 },
+	{ "saucer_big", 2, 1 },
+	{ "saucer_small", 2, 1 },
+	{ "ship_thrust", 0, 1 },
+	{ "ship_explosion", 3, 1 },
+	{ "starwars-trails", 3, 1 }
+};
+
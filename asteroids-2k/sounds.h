@@ -0,0 +1,44 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _SOUNDS_H_
+#define _SOUNDS_H_
+
+#include "devices.h"
+#include "commdefs.h"
+
+										// the sounds of the game: loaded in
+                                        // this order, each value is also the
+                                        // TSoundId of the sound
+enum enSound
+{
+	snBonus, snShield, snShipFire,
+	snBangLarge, snBangMedium, snBangSmall,
+	snSaucerBig, snSaucerSmall, snShipThrust,
+	snShipExplosion, snStarwarsTrails,
+	snCount
+};
+
+										// a sound of the game, and how it
+                                        // shares the voices of the pool
+struct TSoundSetup
+{
+	const char* pName;					// file name, without extension
+	int nPriority;
+	unsigned nMaxVoices;
+};
+
+extern const TSoundSetup SoundSetups[snCount];
+
+										// the pan of a sound played at X, on
+                                        // the game area
+inline double GetThePan(double X)
+{
+	return 2.0 * X / FRAMEW - 1.0;
+}
+
+#endif
+
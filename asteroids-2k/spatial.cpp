@@ -0,0 +1,177 @@
+/*!****************************************************************************
+
+	@file	spatial.h
+	@file	spatial.cpp
+
+	@brief	Uniform grid for the collisions broadphase
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <math.h>
+#include <assert.h>
+
+#include <algorithm>
+
+#include "spatial.h"
+
+//-----------------------------------------------------------------------------
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TSpatialGrid::TSpatialGrid()
+{
+	m_nCols = m_nRows = 1;
+	m_CellSize = 1;
+	m_MaxRadius = 0;
+
+	m_Starts.assign(2, 0);
+}
+
+/*!****************************************************************************
+* @brief	Sets the size of the grid
+* @param	nWidth Width of the game area
+* @param	nHeight Height of the game area
+* @param	CellSize Size of the cells, should be about the diameter
+*			of the biggest object inserted
+******************************************************************************/
+void TSpatialGrid::Resize(unsigned nWidth, unsigned nHeight, double CellSize)
+{
+	assert(CellSize > 0);
+
+	m_CellSize = CellSize;
+
+	m_nCols = std::max(1, int( ceil(nWidth / CellSize) ));
+	m_nRows = std::max(1, int( ceil(nHeight / CellSize) ));
+
+	Clear();
+	Commit();
+}
+
+/*!****************************************************************************
+* @brief	Removes all the items, the grid memory is kept for reuse
+******************************************************************************/
+void TSpatialGrid::Clear()
+{
+	m_MaxRadius = 0;
+
+	m_Cells.clear();
+	m_Pending.clear();
+}
+
+/*!****************************************************************************
+* @brief	Inserts an item in the grid, the item is not visible
+*			to queries until Commit() is called
+* @param	nIndex The index of the item (e.g. in the asteroids list)
+* @param	Pos Position of the item
+* @param	Radius Radius of the item
+******************************************************************************/
+void TSpatialGrid::Insert(unsigned nIndex, TVector2 Pos, double Radius)
+{
+	unsigned nCell = Wrap(GetRow(Pos.Y), m_nRows) * m_nCols
+		+ Wrap(GetCol(Pos.X), m_nCols);
+
+	m_Cells.push_back(nCell);
+	m_Pending.push_back(nIndex);
+
+	if( Radius > m_MaxRadius ) m_MaxRadius = Radius;
+}
+
+/*!****************************************************************************
+* @brief	Sorts the inserted items by cell (counting sort)
+******************************************************************************/
+void TSpatialGrid::Commit()
+{
+	unsigned nCells = m_nCols * m_nRows;
+
+	m_Starts.assign(nCells + 1, 0);
+	m_Items.resize(m_Pending.size());
+											// count the items of each cell
+	for(unsigned i=0; i<m_Cells.size(); i++)
+	{
+		m_Starts[m_Cells[i]]++;
+	}
+											// m_Starts[i] = end of cell i
+	for(unsigned i=1; i<nCells; i++)
+	{
+		m_Starts[i] += m_Starts[i-1];
+	}
+
+	m_Starts[nCells] = m_Pending.size();
+											// backwards, so the items of a cell
+											// keep the insertion order and
+											// m_Starts[i] becomes the start
+	for(unsigned i=m_Pending.size(); i-- > 0; )
+	{
+		m_Items[ --m_Starts[m_Cells[i]] ] = m_Pending[i];
+	}
+}
+
+/*!****************************************************************************
+* @brief	Finds the items that may overlap a circle
+* @param	Pos Center of the circle
+* @param	Radius Radius of the circle
+* @param[out] Indices The candidates, in ascending order; the caller must
+*			check for the actual overlap
+******************************************************************************/
+void TSpatialGrid::Query(TVector2 Pos, double Radius, TVecIndices& Indices)
+{
+	Indices.clear();
+
+	double Reach = Radius + m_MaxRadius;
+
+	int nCol0 = GetCol(Pos.X - Reach), nCol1 = GetCol(Pos.X + Reach);
+	int nRow0 = GetRow(Pos.Y - Reach), nRow1 = GetRow(Pos.Y + Reach);
+											// don't visit a cell twice when the
+											// circle wraps around the whole grid
+	if( nCol1 - nCol0 + 1 >= int(m_nCols) ) { nCol0 = 0; nCol1 = m_nCols - 1; }
+	if( nRow1 - nRow0 + 1 >= int(m_nRows) ) { nRow0 = 0; nRow1 = m_nRows - 1; }
+
+	for(int nRow = nRow0; nRow <= nRow1; nRow++)
+	{
+		unsigned nBase = Wrap(nRow, m_nRows) * m_nCols;
+
+		for(int nCol = nCol0; nCol <= nCol1; nCol++)
+		{
+			unsigned nCell = nBase + Wrap(nCol, m_nCols);
+
+			Indices.insert(Indices.end(),
+				m_Items.begin() + m_Starts[nCell],
+				m_Items.begin() + m_Starts[nCell + 1]);
+		}
+	}
+
+	std::sort(Indices.begin(), Indices.end());
+}
+
+/*!****************************************************************************
+* @brief	Gets the (unwrapped) column of a X coordinate
+******************************************************************************/
+int TSpatialGrid::GetCol(double X)
+{
+	return int( floor(X / m_CellSize) );
+}
+
+/*!****************************************************************************
+* @brief	Gets the (unwrapped) row of a Y coordinate
+******************************************************************************/
+int TSpatialGrid::GetRow(double Y)
+{
+	return int( floor(Y / m_CellSize) );
+}
+
+/*!****************************************************************************
+* @brief	Wraps a column or a row index inside of the grid
+******************************************************************************/
+unsigned TSpatialGrid::Wrap(int nVal, unsigned nCount)
+{
+	int nResult = nVal % int(nCount);
+
+	return nResult < 0 ? nResult + nCount : nResult;
+}
+
@@ -0,0 +1,55 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _SPATIAL_H_
+#define _SPATIAL_H_
+
+#include <vector>
+
+#include "vectors.h"
+
+using namespace maths;
+
+typedef std::vector<unsigned> TVecIndices;
+
+										// uniform grid over the game area,
+										// wrapped around the edges (toroidal)
+class TSpatialGrid
+{
+	public:
+		TSpatialGrid();
+
+	public:
+		void Resize(unsigned nWidth, unsigned nHeight, double CellSize);
+
+		void Clear();
+		void Insert(unsigned nIndex, TVector2 Pos, double Radius);
+		void Commit();
+
+		void Query(TVector2 Pos, double Radius, TVecIndices& Indices);
+
+		unsigned GetCount() { return m_Items.size(); }
+		unsigned GetCellsCount() { return m_nCols * m_nRows; }
+		double GetMaxRadius() { return m_MaxRadius; }
+
+	protected:
+		unsigned m_nCols, m_nRows;
+		double m_CellSize, m_MaxRadius;
+										// cells in compressed form: the items
+										// of cell i are m_Items[m_Starts[i]]
+										// ... m_Items[m_Starts[i+1]-1]
+		TVecIndices m_Starts, m_Items;
+										// items inserted, waiting for Commit()
+		TVecIndices m_Cells, m_Pending;
+
+	protected:
+		int GetCol(double X);
+		int GetRow(double Y);
+		unsigned Wrap(int nVal, unsigned nCount);
+};
+
+#endif
+
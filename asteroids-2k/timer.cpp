@@ -0,0 +1,82 @@
+/*!****************************************************************************
+
+	@file	timer.h
+	@file	timer.cpp
+
+	@brief	Portable timing routines
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
+#include "timer.h"
+
+namespace utils
+{
+
+/*!****************************************************************************
+* @brief	Gets the elapsed time, in milliseconds, from an arbitrary origin
+* @return	The number of milliseconds elapsed
+* @note		Portable replacement for the Win32 GetTickCount()
+******************************************************************************/
+unsigned GetTicks()
+{
+	return unsigned( GetTime() * 1000.0 );
+}
+
+/*!****************************************************************************
+* @brief	Gets the value of the high resolution clock
+* @return	The time, in seconds, elapsed from an arbitrary origin
+******************************************************************************/
+double GetTime()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER Frequency = { 0 };
+
+	if( Frequency.QuadPart == 0 )
+	{
+		::QueryPerformanceFrequency(&Frequency);
+	}
+
+	LARGE_INTEGER Counter;
+	::QueryPerformanceCounter(&Counter);
+
+	return double(Counter.QuadPart) / double(Frequency.QuadPart);
+#else
+	struct timespec TS;
+	clock_gettime(CLOCK_MONOTONIC, &TS);
+
+	return double(TS.tv_sec) + double(TS.tv_nsec) * 1.0e-9;
+#endif
+}
+
+/*!****************************************************************************
+* @brief	Suspends the calling thread
+* @param	Seconds The time to sleep, 0 gives up the rest of the time slice
+* @note		On Windows the resolution is the one of the system timer, see
+*			timeBeginPeriod()
+******************************************************************************/
+void Sleep(double Seconds)
+{
+#ifdef _WIN32
+	::Sleep( DWORD(Seconds * 1000.0) );
+#else
+	struct timespec TS;
+
+	TS.tv_sec = time_t(Seconds);
+	TS.tv_nsec = long( (Seconds - TS.tv_sec) * 1.0e9 );
+
+	nanosleep(&TS, NULL);
+#endif
+}
+
+}	// namespace utils
+
@@ -0,0 +1,18 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+namespace utils
+{
+    unsigned GetTicks();
+    double GetTime();
+    void Sleep(double Seconds);
+}
+
+#endif
+
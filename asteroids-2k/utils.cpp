@@ -91,14 +91,51 @@ std::string GetExePath()
 /*!****************************************************************************
 * @brief	Gets the application data folder
 * @return	Returns the path to data folder
+* @note		The path is found on the first call, then kept: the exe does not
+*			move while running
 ******************************************************************************/
 std::string GetDataPath()
 {
-	std::string strDataPath = GetExePath() + std::string(DATAFOLDER);
+	static std::string strDataPath;
+
+	if( strDataPath.empty() )
+	{
+		strDataPath = GetExePath() + std::string(DATAFOLDER);
+	}
 
 	return strDataPath;
 }
 
+/*!****************************************************************************
+* @brief	Splits a text in lines, as read by fgets() from a file opened in
+*			text mode
+* @param	pText Pointer to the text, not NUL terminated
+* @param	nSize The size of the text
+* @return	The lines, each with its newline but the last one
+******************************************************************************/
+TVecStrings SplitTheLines(const char* pText, unsigned nSize)
+{
+	TVecStrings strLines;
+
+	unsigned nStart = 0;
+
+	for(unsigned i=0; i<nSize; i++)
+	{
+		if( pText[i] == '\n' )
+		{
+											// a CR LF as the text mode reads it
+			unsigned nEnd = i > nStart && pText[i-1] == '\r' ? i - 1 : i;
+
+			strLines.push_back(std::string(pText + nStart, pText + nEnd) + "\n");
+			nStart = i + 1;
+		}
+	}
+
+	if( nStart < nSize ) strLines.push_back(std::string(pText + nStart, pText + nSize));
+
+	return strLines;
+}
+
 /*!****************************************************************************
 * @brief	Gets the file size
 * @param	fp Pointer to a FILE struct
@@ -21,6 +21,8 @@ typedef std::vector<std::string> TVecStrings;
 std::string GetExePath();
 std::string GetDataPath();
 
+TVecStrings SplitTheLines(const char* pText, unsigned nSize);
+
 unsigned GetFileSize(FILE *fp);
 bool IsWavFile(std::string strFileName);
 
@@ -5,6 +5,13 @@
 
 	@brief	Vectors routines
 
+	@par	The batched Transform() kernels apply a TAffine2 to arrays of
+			points, AoS (TVector2, TVector2f) or SoA (separate X and Y
+			arrays), in double or float. They use AVX2 or SSE2 when the
+			compiler provides them, with a scalar tail; the products and
+			the sums are done in the same order as the scalar code, without
+			fused multiply-add, so all the paths give the same results.
+
 	@noop	author:	Francesco Settembrini
 	@noop	last update: 23/6/2021
 	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
@@ -14,9 +21,21 @@
 #include <assert.h>
 #include <math.h>
 
+#include <algorithm>
+
 #include "maths.h"
 #include "vectors.h"
 
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define VECTORS_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define VECTORS_SSE2
+#endif
+
 namespace maths
 {
 
@@ -157,6 +176,155 @@ TVector2 MidPoint(TVector2 Pt1, TVector2 Pt2)
 	return TVector2( (Pt1.X + Pt2.X)/2.0, (Pt1.Y + Pt2.Y)/2.0 );
 }
 
+/*!****************************************************************************
+* @brief	Checks if a segment touches a circle
+* @param	Pt1 First end of the segment
+* @param	Pt2 Second end of the segment
+* @param	Center The center of the circle
+* @param	Radius The radius of the circle
+* @return	True if a point of the segment is inside the circle
+******************************************************************************/
+bool SegmentCircle(TVector2 Pt1, TVector2 Pt2, TVector2 Center, double Radius)
+{
+	double DX = Pt2.X - Pt1.X, DY = Pt2.Y - Pt1.Y;
+	double CX = Center.X - Pt1.X, CY = Center.Y - Pt1.Y;
+	double Dot = CX*DX + CY*DY, Length2 = DX*DX + DY*DY;
+											// the center beyond an end: the
+                                            // distance from that end
+	if( Dot >= Length2 ) { CX -= DX; CY -= DY; }
+	else if( Dot > 0 )
+	{
+											// else from the line, no division
+		double Cross = CX*DY - CY*DX;
+
+		return bool( Cross * Cross <= Radius * Radius * Length2 );
+	}
+
+	return bool( CX*CX + CY*CY <= Radius * Radius );
+}
+
+/*!****************************************************************************
+* @brief	Checks if two segments cross each other
+* @param	A1 First end of the first segment
+* @param	A2 Second end of the first segment
+* @param	B1 First end of the second segment
+* @param	B2 Second end of the second segment
+* @return	True if the segments have a point in common
+******************************************************************************/
+static bool SegmentsCross(const TVector2& A1, const TVector2& A2,
+	const TVector2& B1, const TVector2& B2)
+{
+											// the boxes first, cheaper
+	if( std::max(A1.X, A2.X) < std::min(B1.X, B2.X)
+		|| std::max(B1.X, B2.X) < std::min(A1.X, A2.X)
+		|| std::max(A1.Y, A2.Y) < std::min(B1.Y, B2.Y)
+		|| std::max(B1.Y, B2.Y) < std::min(A1.Y, A2.Y) ) return false;
+
+	double DAX = A2.X - A1.X, DAY = A2.Y - A1.Y;
+	double DBX = B2.X - B1.X, DBY = B2.Y - B1.Y;
+											// the sides of the ends of a
+                                            // segment w.r.t. the other one
+	double S1 = DAX * (B1.Y - A1.Y) - DAY * (B1.X - A1.X);
+	double S2 = DAX * (B2.Y - A1.Y) - DAY * (B2.X - A1.X);
+	double S3 = DBX * (A1.Y - B1.Y) - DBY * (A1.X - B1.X);
+	double S4 = DBX * (A2.Y - B1.Y) - DBY * (A2.X - B1.X);
+
+	return bool( ((S1 <= 0 && S2 >= 0) || (S1 >= 0 && S2 <= 0))
+		&& ((S3 <= 0 && S4 >= 0) || (S3 >= 0 && S4 <= 0)) );
+}
+
+/*!****************************************************************************
+* @brief	Checks if a point is inside a polygon, by the crossing number
+* @param	Pt The point
+* @param	Polygon The vertices of the polygon
+* @return	True if the point is inside the polygon
+******************************************************************************/
+bool PointInPolygon(TVector2 Pt, TVecPoints& Polygon)
+{
+	unsigned nCount = Polygon.size();
+	bool bInside = false;
+
+	for(unsigned i=0, j=nCount-1; i<nCount; j=i++)
+	{
+		TVector2& A = Polygon[i];
+		TVector2& B = Polygon[j];
+											// the edges crossed by a ray from
+                                            // Pt towards +X
+		if( (A.Y > Pt.Y) != (B.Y > Pt.Y) )
+		{
+											// Pt left of the edge, without the
+                                            // division by B.Y - A.Y
+			double Side = (Pt.X - A.X) * (B.Y - A.Y) - (B.X - A.X) * (Pt.Y - A.Y);
+
+			if( (Side < 0) == (B.Y > A.Y) ) bInside = !bInside;
+		}
+	}
+
+	return bInside;
+}
+
+/*!****************************************************************************
+* @brief	Checks if a segment touches a polygon
+* @param	Pt1 First end of the segment
+* @param	Pt2 Second end of the segment
+* @param	Polygon The vertices of the polygon
+* @return	True if the segment crosses an edge or is inside the polygon
+******************************************************************************/
+bool SegmentPolygon(TVector2 Pt1, TVector2 Pt2, TVecPoints& Polygon)
+{
+	unsigned nCount = Polygon.size();
+
+	for(unsigned i=0, j=nCount-1; i<nCount; j=i++)
+	{
+		if( SegmentsCross(Pt1, Pt2, Polygon[j], Polygon[i]) ) return true;
+	}
+											// no crossing: all inside, or
+                                            // all outside
+	return nCount > 0 && PointInPolygon(Pt1, Polygon);
+}
+
+/*!****************************************************************************
+* @brief	Checks if two polygons overlap
+* @param	Polygon1 The vertices of the first polygon
+* @param	Polygon2 The vertices of the second polygon
+* @return	True if two edges cross or a polygon is inside the other
+******************************************************************************/
+bool PolygonPolygon(TVecPoints& Polygon1, TVecPoints& Polygon2)
+{
+	unsigned nCount1 = Polygon1.size(), nCount2 = Polygon2.size();
+
+	if( nCount1 == 0 || nCount2 == 0 ) return false;
+											// the box of the second polygon
+	double MinX = Polygon2[0].X, MaxX = MinX, MinY = Polygon2[0].Y, MaxY = MinY;
+
+	for(unsigned k=1; k<nCount2; k++)
+	{
+		MinX = std::min(MinX, Polygon2[k].X);	MaxX = std::max(MaxX, Polygon2[k].X);
+		MinY = std::min(MinY, Polygon2[k].Y);	MaxY = std::max(MaxY, Polygon2[k].Y);
+	}
+
+	for(unsigned i=0, j=nCount1-1; i<nCount1; j=i++)
+	{
+		TVector2& A1 = Polygon1[j];
+		TVector2& A2 = Polygon1[i];
+											// the edges out of the box cannot
+                                            // cross the other polygon
+		if( std::max(A1.X, A2.X) < MinX || std::min(A1.X, A2.X) > MaxX
+			|| std::max(A1.Y, A2.Y) < MinY || std::min(A1.Y, A2.Y) > MaxY ) continue;
+
+		for(unsigned k=0, l=nCount2-1; k<nCount2; l=k++)
+		{
+			if( SegmentsCross(A1, A2, Polygon2[l], Polygon2[k]) )
+			{
+				return true;
+			}
+		}
+	}
+											// no crossing: one inside the
+                                            // other, or apart
+	return PointInPolygon(Polygon1[0], Polygon2) || PointInPolygon(Polygon2[0], Polygon1);
+}
+
 /*!****************************************************************************
 * @brief	Rotates the vector around the axis origin
 * @param	ThetaDeg The angle of rotation, in degrees
@@ -241,4 +409,336 @@ void Translate(TVecVecPoints& VecPts, TVector2 Translation)
 	}
 }
 
+/*!****************************************************************************
+* @brief		Rotates around the axis origin and then translates a list of
+*				points, the same as Rotate() and Translate() on a copy
+* @param[in]	Src Reference to the list of points
+* @param		ThetaDeg The angle of rotation, in degrees
+* @param		Translation The value for translation
+* @param[out]	Dst Reference to the transformed points, its memory is reused
+******************************************************************************/
+void Transform(TVecPoints& Src, double ThetaDeg, TVector2 Translation, TVecPoints& Dst)
+{
+	Dst.resize(Src.size());
+
+	if( Src.size() )
+	{
+		Transform(TAffine2(ThetaDeg, Translation), &Src[0], &Dst[0], Src.size());
+	}
+}
+
+/*!****************************************************************************
+* @brief		Rotates around the axis origin and then translates a list of
+*				a list of points
+* @param[in]	Src Reference to the list of list of points
+* @param		ThetaDeg The angle of rotation, in degrees
+* @param		Translation The value for translation
+* @param[out]	Dst Reference to the transformed points, its memory is reused
+******************************************************************************/
+void Transform(TVecVecPoints& Src, double ThetaDeg, TVector2 Translation, TVecVecPoints& Dst)
+{
+	Dst.resize(Src.size());
+
+	for(int i=0; i<Src.size(); ++i)
+	{
+		Transform(Src[i], ThetaDeg, Translation, Dst[i]);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Default constructor, the identity
+******************************************************************************/
+TAffine2::TAffine2()
+{
+	A = D = 1;
+	B = C = TX = TY = 0;
+}
+
+/*!****************************************************************************
+* @brief	Constructor, a translation
+* @param	Translation The value for translation
+******************************************************************************/
+TAffine2::TAffine2(TVector2 Translation)
+{
+	A = D = 1;
+	B = C = 0;
+
+	TX = Translation.X;
+	TY = Translation.Y;
+}
+
+/*!****************************************************************************
+* @brief	Constructor, a rotation around the axis origin then a translation,
+*			the same as TVector2::Rotate() then TVector2::Translate()
+* @param	ThetaDeg The angle of rotation, in degrees
+* @param	Translation The value for translation
+******************************************************************************/
+TAffine2::TAffine2(double ThetaDeg, TVector2 Translation)
+{
+	double SinTheta = sin(DEG2RAD(ThetaDeg));
+	double CosTheta = cos(DEG2RAD(ThetaDeg));
+
+	A = CosTheta;	B = SinTheta;
+	C = -SinTheta;	D = CosTheta;
+
+	TX = Translation.X;
+	TY = Translation.Y;
+}
+
+/*!****************************************************************************
+* @brief	Transforms an array of points, double precision
+* @param	M The affine matrix
+* @param	pSrc Pointer to the points
+* @param	pDst Pointer to the transformed points
+* @param	nCount Number of points
+******************************************************************************/
+void Transform(const TAffine2& M, const TVector2* pSrc, TVector2* pDst, unsigned nCount)
+{
+	unsigned i = 0;
+	const double* pS = (const double*) pSrc;
+	double* pD = (double*) pDst;
+
+#if defined(VECTORS_AVX2)
+	__m256d AC = _mm256_setr_pd(M.A, M.C, M.A, M.C);
+	__m256d BD = _mm256_setr_pd(M.B, M.D, M.B, M.D);
+	__m256d T4 = _mm256_setr_pd(M.TX, M.TY, M.TX, M.TY);
+											// two points per step
+	for(; i + 2 <= nCount; i += 2)
+	{
+		__m256d P = _mm256_loadu_pd(pS + 2*i);
+		__m256d XX = _mm256_unpacklo_pd(P, P);
+		__m256d YY = _mm256_unpackhi_pd(P, P);
+
+		__m256d R = _mm256_add_pd(_mm256_mul_pd(XX, AC), _mm256_mul_pd(YY, BD));
+		_mm256_storeu_pd(pD + 2*i, _mm256_add_pd(R, T4));
+	}
+#endif
+
+#if defined(VECTORS_SSE2)
+	__m128d AC2 = _mm_setr_pd(M.A, M.C);
+	__m128d BD2 = _mm_setr_pd(M.B, M.D);
+	__m128d T2 = _mm_setr_pd(M.TX, M.TY);
+
+	for(; i < nCount; i++)
+	{
+		__m128d P = _mm_loadu_pd(pS + 2*i);
+		__m128d XX = _mm_unpacklo_pd(P, P);
+		__m128d YY = _mm_unpackhi_pd(P, P);
+
+		__m128d R = _mm_add_pd(_mm_mul_pd(XX, AC2), _mm_mul_pd(YY, BD2));
+		_mm_storeu_pd(pD + 2*i, _mm_add_pd(R, T2));
+	}
+#endif
+
+	for(; i < nCount; i++)
+	{
+		double X = pS[2*i], Y = pS[2*i+1];
+		double RX = X * M.A + Y * M.B;
+		double RY = X * M.C + Y * M.D;
+
+		pD[2*i] = RX + M.TX;
+		pD[2*i+1] = RY + M.TY;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Transforms an array of points, single precision
+* @param	M The affine matrix
+* @param	pSrc Pointer to the points
+* @param	pDst Pointer to the transformed points
+* @param	nCount Number of points
+******************************************************************************/
+void Transform(const TAffine2& M, const TVector2f* pSrc, TVector2f* pDst, unsigned nCount)
+{
+	unsigned i = 0;
+	const float* pS = (const float*) pSrc;
+	float* pD = (float*) pDst;
+
+	float A = M.A, B = M.B, C = M.C, D = M.D, TX = M.TX, TY = M.TY;
+
+#if defined(VECTORS_AVX2)
+	__m256 AC = _mm256_setr_ps(A, C, A, C, A, C, A, C);
+	__m256 BD = _mm256_setr_ps(B, D, B, D, B, D, B, D);
+	__m256 T8 = _mm256_setr_ps(TX, TY, TX, TY, TX, TY, TX, TY);
+											// four points per step
+	for(; i + 4 <= nCount; i += 4)
+	{
+		__m256 P = _mm256_loadu_ps(pS + 2*i);
+		__m256 XX = _mm256_moveldup_ps(P);
+		__m256 YY = _mm256_movehdup_ps(P);
+
+		__m256 R = _mm256_add_ps(_mm256_mul_ps(XX, AC), _mm256_mul_ps(YY, BD));
+		_mm256_storeu_ps(pD + 2*i, _mm256_add_ps(R, T8));
+	}
+#endif
+
+#if defined(VECTORS_SSE2)
+	__m128 AC4 = _mm_setr_ps(A, C, A, C);
+	__m128 BD4 = _mm_setr_ps(B, D, B, D);
+	__m128 T4 = _mm_setr_ps(TX, TY, TX, TY);
+											// two points per step
+	for(; i + 2 <= nCount; i += 2)
+	{
+		__m128 P = _mm_loadu_ps(pS + 2*i);
+		__m128 XX = _mm_shuffle_ps(P, P, _MM_SHUFFLE(2,2,0,0));
+		__m128 YY = _mm_shuffle_ps(P, P, _MM_SHUFFLE(3,3,1,1));
+
+		__m128 R = _mm_add_ps(_mm_mul_ps(XX, AC4), _mm_mul_ps(YY, BD4));
+		_mm_storeu_ps(pD + 2*i, _mm_add_ps(R, T4));
+	}
+#endif
+
+	for(; i < nCount; i++)
+	{
+		float X = pS[2*i], Y = pS[2*i+1];
+		float RX = X * A + Y * B;
+		float RY = X * C + Y * D;
+
+		pD[2*i] = RX + TX;
+		pD[2*i+1] = RY + TY;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Transforms an array of points, double precision, X and Y in
+*			separate arrays
+* @param	M The affine matrix
+* @param	pSrcX Pointer to the X of the points
+* @param	pSrcY Pointer to the Y of the points
+* @param	pDstX Pointer to the X of the transformed points
+* @param	pDstY Pointer to the Y of the transformed points
+* @param	nCount Number of points
+******************************************************************************/
+void Transform(const TAffine2& M, const double* pSrcX, const double* pSrcY,
+	double* pDstX, double* pDstY, unsigned nCount)
+{
+	unsigned i = 0;
+
+#if defined(VECTORS_AVX2)
+	__m256d A4 = _mm256_set1_pd(M.A), B4 = _mm256_set1_pd(M.B);
+	__m256d C4 = _mm256_set1_pd(M.C), D4 = _mm256_set1_pd(M.D);
+	__m256d TX4 = _mm256_set1_pd(M.TX), TY4 = _mm256_set1_pd(M.TY);
+
+	for(; i + 4 <= nCount; i += 4)
+	{
+		__m256d X = _mm256_loadu_pd(pSrcX + i);
+		__m256d Y = _mm256_loadu_pd(pSrcY + i);
+
+		__m256d RX = _mm256_add_pd(_mm256_mul_pd(X, A4), _mm256_mul_pd(Y, B4));
+		__m256d RY = _mm256_add_pd(_mm256_mul_pd(X, C4), _mm256_mul_pd(Y, D4));
+
+		_mm256_storeu_pd(pDstX + i, _mm256_add_pd(RX, TX4));
+		_mm256_storeu_pd(pDstY + i, _mm256_add_pd(RY, TY4));
+	}
+#endif
+
+#if defined(VECTORS_SSE2)
+	__m128d A2 = _mm_set1_pd(M.A), B2 = _mm_set1_pd(M.B);
+	__m128d C2 = _mm_set1_pd(M.C), D2 = _mm_set1_pd(M.D);
+	__m128d TX2 = _mm_set1_pd(M.TX), TY2 = _mm_set1_pd(M.TY);
+
+	for(; i + 2 <= nCount; i += 2)
+	{
+		__m128d X = _mm_loadu_pd(pSrcX + i);
+		__m128d Y = _mm_loadu_pd(pSrcY + i);
+
+		__m128d RX = _mm_add_pd(_mm_mul_pd(X, A2), _mm_mul_pd(Y, B2));
+		__m128d RY = _mm_add_pd(_mm_mul_pd(X, C2), _mm_mul_pd(Y, D2));
+
+		_mm_storeu_pd(pDstX + i, _mm_add_pd(RX, TX2));
+		_mm_storeu_pd(pDstY + i, _mm_add_pd(RY, TY2));
+	}
+#endif
+
+	for(; i < nCount; i++)
+	{
+		double X = pSrcX[i], Y = pSrcY[i];
+		double RX = X * M.A + Y * M.B;
+		double RY = X * M.C + Y * M.D;
+
+		pDstX[i] = RX + M.TX;
+		pDstY[i] = RY + M.TY;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Transforms an array of points, single precision, X and Y in
+*			separate arrays
+* @param	M The affine matrix
+* @param	pSrcX Pointer to the X of the points
+* @param	pSrcY Pointer to the Y of the points
+* @param	pDstX Pointer to the X of the transformed points
+* @param	pDstY Pointer to the Y of the transformed points
+* @param	nCount Number of points
+******************************************************************************/
+void Transform(const TAffine2& M, const float* pSrcX, const float* pSrcY,
+	float* pDstX, float* pDstY, unsigned nCount)
+{
+	unsigned i = 0;
+
+	float A = M.A, B = M.B, C = M.C, D = M.D, TX = M.TX, TY = M.TY;
+
+#if defined(VECTORS_AVX2)
+	__m256 A8 = _mm256_set1_ps(A), B8 = _mm256_set1_ps(B);
+	__m256 C8 = _mm256_set1_ps(C), D8 = _mm256_set1_ps(D);
+	__m256 TX8 = _mm256_set1_ps(TX), TY8 = _mm256_set1_ps(TY);
+
+	for(; i + 8 <= nCount; i += 8)
+	{
+		__m256 X = _mm256_loadu_ps(pSrcX + i);
+		__m256 Y = _mm256_loadu_ps(pSrcY + i);
+
+		__m256 RX = _mm256_add_ps(_mm256_mul_ps(X, A8), _mm256_mul_ps(Y, B8));
+		__m256 RY = _mm256_add_ps(_mm256_mul_ps(X, C8), _mm256_mul_ps(Y, D8));
+
+		_mm256_storeu_ps(pDstX + i, _mm256_add_ps(RX, TX8));
+		_mm256_storeu_ps(pDstY + i, _mm256_add_ps(RY, TY8));
+	}
+#endif
+
+#if defined(VECTORS_SSE2)
+	__m128 A4 = _mm_set1_ps(A), B4 = _mm_set1_ps(B);
+	__m128 C4 = _mm_set1_ps(C), D4 = _mm_set1_ps(D);
+	__m128 TX4 = _mm_set1_ps(TX), TY4 = _mm_set1_ps(TY);
+
+	for(; i + 4 <= nCount; i += 4)
+	{
+		__m128 X = _mm_loadu_ps(pSrcX + i);
+		__m128 Y = _mm_loadu_ps(pSrcY + i);
+
+		__m128 RX = _mm_add_ps(_mm_mul_ps(X, A4), _mm_mul_ps(Y, B4));
+		__m128 RY = _mm_add_ps(_mm_mul_ps(X, C4), _mm_mul_ps(Y, D4));
+
+		_mm_storeu_ps(pDstX + i, _mm_add_ps(RX, TX4));
+		_mm_storeu_ps(pDstY + i, _mm_add_ps(RY, TY4));
+	}
+#endif
+
+	for(; i < nCount; i++)
+	{
+		float X = pSrcX[i], Y = pSrcY[i];
+		float RX = X * A + Y * B;
+		float RY = X * C + Y * D;
+
+		pDstX[i] = RX + TX;
+		pDstY[i] = RY + TY;
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the kernels of the batched transforms selected at compile
+*			time
+* @return	"avx2", "sse2" or "scalar"
+******************************************************************************/
+const char* GetTransformKernels()
+{
+#if defined(VECTORS_AVX2)
+	return "avx2";
+#elif defined(VECTORS_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
 } // namespace maths;
@@ -46,15 +46,57 @@ class TVector2
 		double X, Y;
 };
 
+										// single precision point, for the
+                                        // float kernels
+struct TVector2f
+{
+	float X, Y;
+};
+
+										// 2x3 affine matrix:
+                                        // X' = A * X + B * Y + TX
+                                        // Y' = C * X + D * Y + TY
+struct TAffine2
+{
+	TAffine2();
+	TAffine2(TVector2 Translation);
+	TAffine2(double ThetaDeg, TVector2 Translation);
+
+	double A, B, C, D, TX, TY;
+};
+
 TVector2 Add(TVector2& A, TVector2& B);
 double Distance(TVector2 Pt1, TVector2 Pt2);
 TVector2 MidPoint(TVector2 Pt1, TVector2 Pt2);
+bool SegmentCircle(TVector2 Pt1, TVector2 Pt2, TVector2 Center, double Radius);
+										// polygons as closed polylines, the
+                                        // last point joined to the first;
+                                        // convex or not
+bool PointInPolygon(TVector2 Pt, TVecPoints& Polygon);
+bool SegmentPolygon(TVector2 Pt1, TVector2 Pt2, TVecPoints& Polygon);
+bool PolygonPolygon(TVecPoints& Polygon1, TVecPoints& Polygon2);
 
 void Rotate(TVecPoints& VecPts, double ThetaDeg);
 void Translate(TVecPoints& Src, TVector2 Translation);
 
 void Rotate(TVecVecPoints& VecPts, double ThetaDeg);
 void Translate(TVecVecPoints& VecPts, TVector2 Translation);
+										// rotation then translation, written
+                                        // on Dst: no allocation once Dst has
+                                        // grown to the size of Src
+void Transform(TVecPoints& Src, double ThetaDeg, TVector2 Translation, TVecPoints& Dst);
+void Transform(TVecVecPoints& Src, double ThetaDeg, TVector2 Translation, TVecVecPoints& Dst);
+										// batched affine transforms, AoS and
+                                        // SoA, SSE2/AVX2 when available;
+                                        // pDst may be the same as pSrc
+void Transform(const TAffine2& M, const TVector2* pSrc, TVector2* pDst, unsigned nCount);
+void Transform(const TAffine2& M, const TVector2f* pSrc, TVector2f* pDst, unsigned nCount);
+void Transform(const TAffine2& M, const double* pSrcX, const double* pSrcY,
+	double* pDstX, double* pDstY, unsigned nCount);
+void Transform(const TAffine2& M, const float* pSrcX, const float* pSrcY,
+	float* pDstX, float* pDstY, unsigned nCount);
+
+const char* GetTransformKernels();
 
 }	// namespace maths
 
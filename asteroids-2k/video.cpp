@@ -20,6 +20,37 @@
 #include "video.h"
 
 
+/*!****************************************************************************
+* @brief	Creates a GDI pen
+* @param	nWidth Width of the pen
+* @param	Color Color of the pen
+* @return	The handle of the pen
+******************************************************************************/
+TGdiHandle TWinGdiFactory::CreatePen(int nWidth, COLORREF Color)
+{
+	return (TGdiHandle) ::CreatePen(PS_SOLID, nWidth, Color);
+}
+
+/*!****************************************************************************
+* @brief	Creates a GDI solid brush
+* @param	Color Color of the brush
+* @return	The handle of the brush
+******************************************************************************/
+TGdiHandle TWinGdiFactory::CreateBrush(COLORREF Color)
+{
+	return (TGdiHandle) ::CreateSolidBrush(Color);
+}
+
+/*!****************************************************************************
+* @brief	Deletes a GDI pen or brush
+* @param	hObject The handle of the object
+******************************************************************************/
+void TWinGdiFactory::DeleteObject(TGdiHandle hObject)
+{
+	::DeleteObject( (HGDIOBJ) hObject );
+}
+
+
 /*!****************************************************************************
 * @brief	Initialize the video system
 * @param	hWnd Handle to the game main window
@@ -27,6 +58,7 @@
 * @return	Returns true for success, false otherwise
 ******************************************************************************/
 TVideoManager::TVideoManager(HWND hWnd, RECT Rect)
+	: m_PenCache(&m_GdiFactory)
 {
 	assert(hWnd);
 	assert(Rect.right > 0);
@@ -58,6 +90,9 @@ TVideoManager::~TVideoManager()
 {
 	assert(m_hDC);
 	assert(m_hBmp);
+											// no pen or brush is selected
+                                            // in the DC, they can be deleted
+	m_PenCache.Clear();
 
 	::DeleteDC(m_hDC);
 	::DeleteObject(m_hBmp);
@@ -89,26 +124,51 @@ void TVideoManager::DrawLines(TVecPoints& Pts, int nLineWidth,
 	HDC hDC = m_hDC;
 	assert(hDC);
 
-	HPEN hPen = ::CreatePen(PS_SOLID, nLineWidth, Color);
+	m_Points.clear();
+	m_Counts.clear();
+
+	AddPolyline(Pts, bClosed);
+
+	if( m_Counts.empty() ) return;
+
+	HPEN hPen = (HPEN) m_PenCache.GetPen(nLineWidth, Color);
 	assert(hPen);
 
 	HPEN hOldPen = (HPEN) ::SelectObject(hDC, hPen);
 	assert(hOldPen);
 
-	for(int i=1; i<Pts.size(); i++)
+	::Polyline(hDC, &m_Points[0], m_Points.size());
+
+	::SelectObject(hDC, hOldPen);
+}
+
+/*!****************************************************************************
+* @brief	Appends a polyline to the batch drawn by PolyPolyline()
+* @param	Pts Reference to a vector of points
+* @param	bClosed If true the first point is repeated at the end
+******************************************************************************/
+void TVideoManager::AddPolyline(TVecPoints& Pts, bool bClosed)
+{
+											// GDI wants at least two points
+	if( Pts.size() < 2 ) return;
+
+	for(int i=0; i<Pts.size(); i++)
 	{
-		::MoveToEx(hDC, Pts[i-1].X, Pts[i-1].Y, (LPPOINT) NULL);
-		::LineTo(hDC, Pts[i].X, Pts[i].Y);
+		POINT Pt = { LONG(Pts[i].X), LONG(Pts[i].Y) };
+		m_Points.push_back(Pt);
 	}
 
+	DWORD nCount = Pts.size();
+
 	if( bClosed && (Pts.size() > 2) )
 	{
-		::MoveToEx(hDC, Pts[Pts.size()-1].X, Pts[Pts.size()-1].Y, (LPPOINT) NULL);
-		::LineTo(hDC, Pts[0].X, Pts[0].Y);
+		POINT Pt = { LONG(Pts[0].X), LONG(Pts[0].Y) };
+		m_Points.push_back(Pt);
+
+		nCount++;
 	}
 
-	::SelectObject(hDC, hOldPen);
-	::DeleteObject(hPen);
+	m_Counts.push_back(nCount);
 }
 
 /*!****************************************************************************
@@ -121,10 +181,27 @@ void TVideoManager::DrawLines(TVecPoints& Pts, int nLineWidth,
 void TVideoManager::DrawLines(TVecVecPoints& Pts, int nLineWidth,
 	COLORREF Color, bool bClosed)
 {
+	assert(m_hDC);
+
+	m_Points.clear();
+	m_Counts.clear();
+
 	for (int i = 0; i < Pts.size(); ++i)
 	{
-		DrawLines(Pts[i], nLineWidth, Color, bClosed);
+		AddPolyline(Pts[i], bClosed);
 	}
+
+	if( m_Counts.empty() ) return;
+
+	HPEN hPen = (HPEN) m_PenCache.GetPen(nLineWidth, Color);
+	assert(hPen);
+
+	HPEN hOldPen = (HPEN) ::SelectObject(m_hDC, hPen);
+	assert(hOldPen);
+
+	::PolyPolyline(m_hDC, &m_Points[0], &m_Counts[0], m_Counts.size());
+
+	::SelectObject(m_hDC, hOldPen);
 }
 
 /*!****************************************************************************
@@ -147,15 +224,10 @@ void TVideoManager::ClearScreen(COLORREF Color)
 {
 	assert(m_hDC);
 
-	HBRUSH hBrush = ::CreateSolidBrush(Color);
+	HBRUSH hBrush = (HBRUSH) m_PenCache.GetBrush(Color);
 	assert(hBrush);
 
-	HBRUSH hOldBrush = (HBRUSH) ::SelectObject(m_hDC, hBrush);
-
 	::FillRect(m_hDC, &m_ClientArea, hBrush);
-
-	::SelectObject(m_hDC, hOldBrush);
-	::DeleteObject(hBrush);
 }
 
 /*!****************************************************************************
@@ -174,24 +246,63 @@ bool TVideoManager::LoadFont(std::string strFontPath, std::wstring strName, int
 
 	if( nResults )
 	{
-		LOGFONT LF;
-		memset(&LF, 0, sizeof(LF));
+		bResult = SelectTheFont(strName, nSize);
+	}
 
-		LF.lfHeight = nSize;
-		LF.lfWeight = FW_NORMAL;
-		LF.lfOutPrecision = OUT_TT_ONLY_PRECIS;
-		wcscpy(LF.lfFaceName, strName.c_str());
+	return bResult;
+}
 
-		HFONT hFont = ::CreateFontIndirect(&LF);
+/*!****************************************************************************
+* @brief	Loads a font from memory
+* @param	pData Pointer to the bytes of the font file
+* @param	nBytes The size of the font file
+* @param	strName The name of the font
+* @param	nSize The size of the font
+* @return	Returns true for success, false otherwise
+* @note		The font is copied by the system, the bytes can go
+******************************************************************************/
+bool TVideoManager::LoadFont(const char* pData, unsigned nBytes, std::wstring strName, int nSize)
+{
+	assert(m_hDC);
+	assert(pData);
 
-		::SelectObject(m_hDC, hFont);
+	bool bResult = false;
+	DWORD nFonts = 0;
+											// private to the process, as with
+                                            // FR_PRIVATE
+	HANDLE hFonts = ::AddFontMemResourceEx((void*) pData, nBytes, NULL, &nFonts);
 
-		bResult = true;
+	if( hFonts && nFonts )
+	{
+		bResult = SelectTheFont(strName, nSize);
 	}
 
 	return bResult;
 }
 
+/*!****************************************************************************
+* @brief	Selects a font, loaded, in the DC
+* @param	strName The name of the font
+* @param	nSize The size of the font
+* @return	Returns true for success, false otherwise
+******************************************************************************/
+bool TVideoManager::SelectTheFont(std::wstring strName, int nSize)
+{
+	LOGFONT LF;
+	memset(&LF, 0, sizeof(LF));
+
+	LF.lfHeight = nSize;
+	LF.lfWeight = FW_NORMAL;
+	LF.lfOutPrecision = OUT_TT_ONLY_PRECIS;
+	wcscpy(LF.lfFaceName, strName.c_str());
+
+	HFONT hFont = ::CreateFontIndirect(&LF);
+
+	::SelectObject(m_hDC, hFont);
+
+	return true;
+}
+
 /*!****************************************************************************
 * @brief	Draws text
 * @param	pText Pointer to a text string
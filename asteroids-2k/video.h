@@ -9,12 +9,24 @@
 
 #include <windows.h>
 #include <string>
+#include <vector>
 
+#include "pens.h"
 #include "vectors.h"
+#include "devices.h"
 
 using namespace maths;
 
-class TVideoManager
+										// pens and brushes created by GDI
+class TWinGdiFactory : public TGdiFactory
+{
+	public:
+		TGdiHandle CreatePen(int nWidth, COLORREF Color);
+		TGdiHandle CreateBrush(COLORREF Color);
+		void DeleteObject(TGdiHandle hObject);
+};
+
+class TVideoManager : public TVideoDevice
 {
 	public:
         TVideoManager(HWND hWnd, RECT Rect);
@@ -28,6 +40,7 @@ class TVideoManager
         void DrawPoint(TVector2& Pt, COLORREF Color);
         void ClearScreen(COLORREF Color);
         bool LoadFont(std::string strFontPath, std::wstring strName, int nSize);
+        bool LoadFont(const char* pData, unsigned nBytes, std::wstring strName, int nSize);
 
         void DrawLines(TVecPoints& Pts, int nLineWidth,
         	COLORREF Color, bool bClosed=false);
@@ -39,11 +52,23 @@ class TVideoManager
         void DrawText(std::vector<std::string> StringList, int nX, int nY,
             int nTextH, COLORREF nColor = RGB(255,255,255), UINT nAlign = TA_CENTER);
 
+        TPenCache* GetPenCache() { return &m_PenCache; }
+
 	protected:
         HWND m_hWnd;
         RECT m_ClientArea;
         HDC m_hDC;
         HBITMAP m_hBmp;
+
+        TWinGdiFactory m_GdiFactory;
+        TPenCache m_PenCache;
+											// reused by DrawLines()
+        std::vector<POINT> m_Points;
+        std::vector<DWORD> m_Counts;
+
+	protected:
+		void AddPolyline(TVecPoints& Pts, bool bClosed);
+		bool SelectTheFont(std::wstring strName, int nSize);
 };
 
 #endif
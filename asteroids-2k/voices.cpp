@@ -0,0 +1,451 @@
+/*!****************************************************************************
+
+	@file	voices.h
+	@file	voices.cpp
+
+	@brief	Pool of voices: the sources shared by the sounds of the game
+
+	@par	The sources are allocated once, by the constructor. Play() takes
+			a free voice, so the same sound can be heard more times at once
+			(ten asteroids exploding in a burst), up to the limit of the
+			sound: at the limit, the oldest voice of the sound is restarted.
+
+	@par	With all the voices busy, a voice is stolen: the one of lowest
+			priority and, among them, the oldest one; if the sound has a
+			lower priority than all of them, it is dropped. The ended voices
+			are found lazily, by asking the backend, only when a voice is
+			needed.
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "voices.h"
+
+
+/*!****************************************************************************
+* @brief	Constructor
+******************************************************************************/
+TStubAudioBackend::TStubAudioBackend()
+{
+	m_nTime = 0;
+}
+
+/*!****************************************************************************
+* @brief	Adds a buffer
+* @param	nTicks The length of the buffer
+* @return	The id of the buffer
+******************************************************************************/
+unsigned TStubAudioBackend::AddTheBuffer(unsigned nTicks)
+{
+	m_Buffers.push_back(nTicks);
+
+	return m_Buffers.size() - 1;
+}
+
+/*!****************************************************************************
+* @brief	Creates a source, stopped
+* @return	The id of the source
+******************************************************************************/
+unsigned TStubAudioBackend::CreateTheSource()
+{
+	TStubSource Source = { 0, false, false };
+	m_Sources.push_back(Source);
+
+	return m_Sources.size() - 1;
+}
+
+/*!****************************************************************************
+* @brief	Deletes a source
+* @param	nSource The id of the source
+******************************************************************************/
+void TStubAudioBackend::DeleteTheSource(unsigned nSource)
+{
+	assert(nSource < m_Sources.size());
+
+	m_Sources[nSource].bPlaying = false;
+}
+
+/*!****************************************************************************
+* @brief	Plays a buffer on a source, from its start
+* @param	nSource The id of the source
+* @param	nBuffer The id of the buffer
+* @param	bLoop True for playing the buffer repeatedly
+* @param	Gain Not used
+* @param	Pan Not used
+******************************************************************************/
+void TStubAudioBackend::Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+	double Gain, double Pan)
+{
+	assert(nSource < m_Sources.size());
+	assert(nBuffer < m_Buffers.size());
+
+	TStubSource& Source = m_Sources[nSource];
+
+	Source.nEnd = m_nTime + m_Buffers[nBuffer];
+	Source.bPlaying = true;
+	Source.bLoop = bLoop;
+}
+
+/*!****************************************************************************
+* @brief	Stops a source
+* @param	nSource The id of the source
+******************************************************************************/
+void TStubAudioBackend::Stop(unsigned nSource)
+{
+	assert(nSource < m_Sources.size());
+
+	m_Sources[nSource].bPlaying = false;
+}
+
+/*!****************************************************************************
+* @brief	Checks if a source is playing
+* @param	nSource The id of the source
+* @return	True until the end of the buffer, always if looping
+******************************************************************************/
+bool TStubAudioBackend::IsPlaying(unsigned nSource)
+{
+	assert(nSource < m_Sources.size());
+
+	TStubSource& Source = m_Sources[nSource];
+
+	return Source.bPlaying && (Source.bLoop || m_nTime < Source.nEnd);
+}
+
+/*!****************************************************************************
+* @brief	Constructor, creates the sources
+* @param	pBackend Pointer to the audio backend
+* @param	nVoices Number of voices
+******************************************************************************/
+TVoicePool::TVoicePool(TAudioBackend* pBackend, unsigned nVoices)
+{
+	assert(pBackend);
+	assert(nVoices > 0);
+
+	m_pBackend = pBackend;
+	m_nAge = 0;
+
+	m_Voices.resize(nVoices);
+	m_FreeVoices.reserve(nVoices);
+
+	for(unsigned i=0; i<nVoices; i++)
+	{
+		m_Voices[i].nSource = pBackend->CreateTheSource();
+		m_Voices[i].nSound = VOICES_NONE;
+		m_Voices[i].nPriority = 0;
+		m_Voices[i].nAge = 0;
+		m_Voices[i].bLoop = false;
+											// the first voices are taken
+                                            // first, from the back
+		m_FreeVoices.push_back(nVoices - 1 - i);
+	}
+
+	ResetStats();
+}
+
+/*!****************************************************************************
+* @brief	Destructor, deletes the sources
+******************************************************************************/
+TVoicePool::~TVoicePool()
+{
+	StopAll();
+
+	for(unsigned i=0; i<m_Voices.size(); i++)
+	{
+		m_pBackend->DeleteTheSource(m_Voices[i].nSource);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Adds a sound to the pool
+* @param	nBuffer The buffer of the sound, in the backend
+* @param	nPriority The priority of the sound, the higher the less stolen
+* @param	nMaxVoices The voices of the sound at once, VOICES_NOLIMIT for
+*			any number
+* @return	The id of the sound
+******************************************************************************/
+TSoundId TVoicePool::AddTheSound(unsigned nBuffer, int nPriority, unsigned nMaxVoices)
+{
+	TVoiceSound Sound = { nBuffer, nPriority, nMaxVoices, 0, 1.0 };
+	m_Sounds.push_back(Sound);
+
+	return m_Sounds.size() - 1;
+}
+
+/*!****************************************************************************
+* @brief	Sets how a sound shares the voices
+* @param	nSound The id of the sound
+* @param	nPriority The priority of the sound, the higher the less stolen
+* @param	nMaxVoices The voices of the sound at once, VOICES_NOLIMIT for
+*			any number
+******************************************************************************/
+void TVoicePool::SetTheLimits(TSoundId nSound, int nPriority, unsigned nMaxVoices)
+{
+	if( nSound < 0 || nSound >= (int) m_Sounds.size() ) return;
+
+	m_Sounds[nSound].nPriority = nPriority;
+	m_Sounds[nSound].nMaxVoices = nMaxVoices;
+}
+
+/*!****************************************************************************
+* @brief	Sets the gain of the voices of a sound
+* @param	nSound The id of the sound
+* @param	Gain The gain, between 0..1
+* @note		The voices playing it now keep their gain
+******************************************************************************/
+void TVoicePool::SetTheGain(TSoundId nSound, double Gain)
+{
+	if( nSound < 0 || nSound >= (int) m_Sounds.size() ) return;
+
+	m_Sounds[nSound].Gain = std::min(std::max(Gain, 0.0), 1.0);
+}
+
+/*!****************************************************************************
+* @brief	Stops all the voices and removes the sounds
+* @note		Every source is stopped, the ended ones too: none refers to the
+*			buffers of the sounds any more
+******************************************************************************/
+void TVoicePool::Clear()
+{
+	StopAll();
+
+	for(unsigned i=0; i<m_Voices.size(); i++) m_pBackend->Stop(m_Voices[i].nSource);
+
+	m_Sounds.clear();
+}
+
+/*!****************************************************************************
+* @brief	Plays a sound on a voice
+* @param	nSound The id of the sound
+* @param	bLoop True for playing the sound repeatedly
+* @param	Pan The position of the sound, -1 left .. 1 right
+* @return	The voice playing the sound, -1 if the sound has been dropped
+******************************************************************************/
+int TVoicePool::Play(TSoundId nSound, bool bLoop, double Pan)
+{
+	if( nSound < 0 || nSound >= (int) m_Sounds.size() ) return VOICES_NONE;
+
+	TVoiceSound& Sound = m_Sounds[nSound];
+
+	m_Stats.nPlays++;
+											// at its limit: the oldest voice
+                                            // of the sound starts again
+	if( Sound.nMaxVoices != VOICES_NOLIMIT && Sound.nVoices >= Sound.nMaxVoices )
+	{
+		Reap(nSound);
+
+		if( Sound.nVoices >= Sound.nMaxVoices )
+		{
+			int nVoice = FindTheOldest(nSound);
+			assert(nVoice >= 0);
+
+			Free(nVoice);
+			m_FreeVoices.pop_back();
+			Start(nVoice, nSound, bLoop, Pan);
+
+			m_Stats.nRestarts++;
+
+			return nVoice;
+		}
+	}
+											// a free voice, or one that has
+                                            // ended since the last look
+	if( m_FreeVoices.empty() ) Reap(VOICES_NONE);
+
+	if( m_FreeVoices.size() )
+	{
+		unsigned nVoice = m_FreeVoices.back();
+		m_FreeVoices.pop_back();
+
+		Start(nVoice, nSound, bLoop, Pan);
+
+		return nVoice;
+	}
+											// all busy: the least important
+	int nVoice = FindTheVictim(Sound.nPriority);
+
+	if( nVoice < 0 )
+	{
+		m_Stats.nDrops++;
+		return VOICES_NONE;
+	}
+
+	Free(nVoice);
+	m_FreeVoices.pop_back();
+	Start(nVoice, nSound, bLoop, Pan);
+
+	m_Stats.nSteals++;
+
+	return nVoice;
+}
+
+/*!****************************************************************************
+* @brief	Stops all the voices of a sound
+* @param	nSound The id of the sound
+******************************************************************************/
+void TVoicePool::Stop(TSoundId nSound)
+{
+	if( nSound < 0 || nSound >= (int) m_Sounds.size() ) return;
+
+	for(unsigned i=0; i<m_Voices.size() && m_Sounds[nSound].nVoices; i++)
+	{
+		if( m_Voices[i].nSound == nSound )
+		{
+			m_pBackend->Stop(m_Voices[i].nSource);
+			Free(i);
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Stops all the voices
+******************************************************************************/
+void TVoicePool::StopAll()
+{
+	for(unsigned i=0; i<m_Voices.size(); i++)
+	{
+		if( m_Voices[i].nSound != VOICES_NONE )
+		{
+			m_pBackend->Stop(m_Voices[i].nSource);
+			Free(i);
+		}
+	}
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of busy voices
+* @return	The voices not yet known to have ended
+******************************************************************************/
+unsigned TVoicePool::GetBusyCount()
+{
+	return m_Voices.size() - m_FreeVoices.size();
+}
+
+/*!****************************************************************************
+* @brief	Gets the number of voices of a sound
+* @param	nSound The id of the sound
+* @return	The voices not yet known to have ended
+******************************************************************************/
+unsigned TVoicePool::GetPlayingCount(TSoundId nSound)
+{
+	if( nSound < 0 || nSound >= (int) m_Sounds.size() ) return 0;
+
+	return m_Sounds[nSound].nVoices;
+}
+
+/*!****************************************************************************
+* @brief	Resets the counters of the pool
+******************************************************************************/
+void TVoicePool::ResetStats()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+/*!****************************************************************************
+* @brief	Starts a sound on a free voice
+* @param	nVoice The voice, not in the free list
+* @param	nSound The id of the sound
+* @param	bLoop True for playing the sound repeatedly
+* @param	Pan The position of the sound, -1 left .. 1 right
+******************************************************************************/
+void TVoicePool::Start(unsigned nVoice, TSoundId nSound, bool bLoop, double Pan)
+{
+	TVoice& Voice = m_Voices[nVoice];
+	TVoiceSound& Sound = m_Sounds[nSound];
+
+	Voice.nSound = nSound;
+	Voice.nPriority = Sound.nPriority;
+	Voice.nAge = m_nAge++;
+	Voice.bLoop = bLoop;
+
+	Sound.nVoices++;
+
+	m_pBackend->Play(Voice.nSource, Sound.nBuffer, bLoop, Sound.Gain, Pan);
+}
+
+/*!****************************************************************************
+* @brief	Gives back a voice to the free list
+* @param	nVoice The voice, playing a sound
+******************************************************************************/
+void TVoicePool::Free(unsigned nVoice)
+{
+	TVoice& Voice = m_Voices[nVoice];
+
+	assert(Voice.nSound != VOICES_NONE);
+
+	m_Sounds[Voice.nSound].nVoices--;
+	Voice.nSound = VOICES_NONE;
+
+	m_FreeVoices.push_back(nVoice);
+}
+
+/*!****************************************************************************
+* @brief	Frees the voices that have ended
+* @param	nSound The id of the sound, VOICES_NONE for all the sounds
+******************************************************************************/
+void TVoicePool::Reap(TSoundId nSound)
+{
+	for(unsigned i=0; i<m_Voices.size(); i++)
+	{
+		TVoice& Voice = m_Voices[i];
+
+		if( Voice.nSound == VOICES_NONE ) continue;
+		if( nSound != VOICES_NONE && Voice.nSound != nSound ) continue;
+
+		if( !Voice.bLoop && !m_pBackend->IsPlaying(Voice.nSource) ) Free(i);
+	}
+}
+
+/*!****************************************************************************
+* @brief	Finds the oldest voice of a sound
+* @param	nSound The id of the sound
+* @return	The voice, -1 if the sound is not playing
+******************************************************************************/
+int TVoicePool::FindTheOldest(TSoundId nSound)
+{
+	int nOldest = VOICES_NONE;
+
+	for(unsigned i=0; i<m_Voices.size(); i++)
+	{
+		if( m_Voices[i].nSound != nSound ) continue;
+
+		if( nOldest < 0 || m_Voices[i].nAge < m_Voices[nOldest].nAge ) nOldest = i;
+	}
+
+	return nOldest;
+}
+
+/*!****************************************************************************
+* @brief	Finds the voice to be stolen, all the voices being busy
+* @param	nPriority The priority of the sound to be played
+* @return	The voice of lowest priority and, among them, the oldest one;
+*			-1 if all the voices have a higher priority than nPriority
+******************************************************************************/
+int TVoicePool::FindTheVictim(int nPriority)
+{
+	int nVictim = VOICES_NONE;
+
+	for(unsigned i=0; i<m_Voices.size(); i++)
+	{
+		TVoice& Voice = m_Voices[i];
+
+		if( Voice.nPriority > nPriority ) continue;
+
+		if( nVictim < 0 || Voice.nPriority < m_Voices[nVictim].nPriority
+			|| (Voice.nPriority == m_Voices[nVictim].nPriority
+			&& Voice.nAge < m_Voices[nVictim].nAge) )
+		{
+			nVictim = i;
+		}
+	}
+
+	return nVictim;
+}
+
@@ -0,0 +1,154 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _VOICES_H_
+#define _VOICES_H_
+
+#include <vector>
+
+#include "devices.h"
+
+#define VOICES_COUNT		16			// sources of the pool
+#define VOICES_NOLIMIT		0			// voices of a sound: as many as free
+#define VOICES_NONE			-1
+
+
+										// the sources of the audio library: a
+                                        // source plays a buffer, once or in
+                                        // a loop, with a gain (0..1) and a
+                                        // pan (-1 left, 0 center, 1 right)
+class TAudioBackend
+{
+	public:
+		virtual ~TAudioBackend() {}
+
+		virtual unsigned CreateTheSource() = 0;
+		virtual void DeleteTheSource(unsigned nSource) = 0;
+
+		virtual void Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+			double Gain, double Pan) = 0;
+		virtual void Stop(unsigned nSource) = 0;	// and release the buffer
+		virtual bool IsPlaying(unsigned nSource) = 0;
+};
+
+										// a backend without audio: a buffer
+                                        // lasts a number of ticks, the time
+                                        // is advanced by the caller; to test
+                                        // and time the pool without a device
+class TStubAudioBackend : public TAudioBackend
+{
+	public:
+		TStubAudioBackend();
+
+	public:
+		unsigned AddTheBuffer(unsigned nTicks);
+
+		void Advance(unsigned nTicks = 1) { m_nTime += nTicks; }
+		unsigned GetTime() { return m_nTime; }
+
+		unsigned CreateTheSource();
+		void DeleteTheSource(unsigned nSource);
+
+		void Play(unsigned nSource, unsigned nBuffer, bool bLoop,
+			double Gain, double Pan);
+		void Stop(unsigned nSource);
+		bool IsPlaying(unsigned nSource);
+
+	protected:
+		struct TStubSource
+		{
+			unsigned nEnd;
+			bool bPlaying, bLoop;
+		};
+
+		std::vector<unsigned> m_Buffers;	// ticks of each buffer
+		std::vector<TStubSource> m_Sources;
+		unsigned m_nTime;
+};
+
+										// a source of the pool, playing a sound
+                                        // or free
+struct TVoice
+{
+	unsigned nSource;
+	TSoundId nSound;					// VOICES_NONE if free
+	int nPriority;
+	unsigned nAge;						// the play that started it
+	bool bLoop;
+};
+
+										// a sound of the pool: its buffer, and
+                                        // how it shares the voices
+struct TVoiceSound
+{
+	unsigned nBuffer;
+	int nPriority;						// the higher, the less stolen
+	unsigned nMaxVoices;				// VOICES_NOLIMIT or more
+	unsigned nVoices;					// playing it now
+	double Gain;
+};
+
+struct TVoicePoolStats
+{
+	unsigned nPlays;					// requests
+	unsigned nRestarts;					// of the oldest voice of a sound
+                                        // at its limit
+	unsigned nSteals;					// of the voice of another sound
+	unsigned nDrops;					// no voice of lower priority
+};
+
+typedef std::vector<TVoice> TVecVoices;
+typedef std::vector<TVoiceSound> TVecVoiceSounds;
+
+										// a fixed number of sources, shared by
+                                        // the sounds: a sound played while
+                                        // it is playing takes another voice,
+                                        // up to its limit; when all the voices
+                                        // are busy the one of lowest priority,
+                                        // and then the oldest, is stolen
+class TVoicePool
+{
+	public:
+		TVoicePool(TAudioBackend* pBackend, unsigned nVoices = VOICES_COUNT);
+		~TVoicePool();
+
+	public:
+		TSoundId AddTheSound(unsigned nBuffer, int nPriority = 0,
+			unsigned nMaxVoices = VOICES_NOLIMIT);
+		void SetTheLimits(TSoundId nSound, int nPriority, unsigned nMaxVoices);
+		void SetTheGain(TSoundId nSound, double Gain);
+		void Clear();
+
+		int Play(TSoundId nSound, bool bLoop = false, double Pan = 0);
+		void Stop(TSoundId nSound);
+		void StopAll();
+
+		unsigned GetVoicesCount() { return m_Voices.size(); }
+		unsigned GetSoundsCount() { return m_Sounds.size(); }
+		unsigned GetBusyCount();
+		unsigned GetPlayingCount(TSoundId nSound);
+
+		TVoicePoolStats GetStats() { return m_Stats; }
+		void ResetStats();
+
+	protected:
+		TAudioBackend* m_pBackend;
+		TVecVoices m_Voices;
+		TVecVoiceSounds m_Sounds;
+		std::vector<unsigned> m_FreeVoices;
+		unsigned m_nAge;
+		TVoicePoolStats m_Stats;
+
+	protected:
+		void Start(unsigned nVoice, TSoundId nSound, bool bLoop, double Pan);
+		void Free(unsigned nVoice);
+		void Reap(TSoundId nSound);
+		int FindTheOldest(TSoundId nSound);
+		int FindTheVictim(int nPriority);
+};
+
+#endif
+
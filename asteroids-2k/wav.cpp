@@ -0,0 +1,201 @@
+/*!****************************************************************************
+
+	@file	wav.h
+	@file	wav.cpp
+
+	@brief	RIFF/WAV parser
+
+	@par	A WAV file is a RIFF chunk of type WAVE, with a list of chunks:
+			"fmt " and "data" are needed, the others (LIST, fact, cue, ...)
+			are skipped. A chunk has an id, a size and its bytes, plus one
+			byte of padding when the size is odd. The "fmt " chunk can be
+			longer than 16 bytes: a cbSize follows, and for the extensible
+			format the subformat, that must be PCM.
+
+	@par	Every size is checked against the bytes left before anything is
+			read, so a truncated or corrupted file is rejected, never read
+			past its end. The samples are not copied: the data of TWavInfo
+			points in the bytes parsed, a mapped file (see mapfile.cpp).
+
+	@noop	author:	Francesco Settembrini
+	@noop	last update: 23/6/2021
+	@noop	e-mail:	mailto:francesco.settembrini@poliba.it
+
+******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "wav.h"
+
+
+/*!****************************************************************************
+* @brief	Reads a little endian integer
+* @param	pBytes The bytes
+* @param	nBytes The size of the integer, 2 or 4 bytes
+* @return	The value
+******************************************************************************/
+static unsigned GetTheInt(const char* pBytes, int nBytes)
+{
+	const unsigned char* p = (const unsigned char*) pBytes;
+	unsigned nValue = 0;
+
+	for(int i=nBytes-1; i>=0; i--) nValue = (nValue << 8) | p[i];
+
+	return nValue;
+}
+
+/*!****************************************************************************
+* @brief	Parses the "fmt " chunk
+* @param	pChunk The bytes of the chunk
+* @param	nSize The size of the chunk
+* @param	Info The format, on success
+* @return	True for a PCM format supported, false otherwise
+******************************************************************************/
+static bool ParseTheFormat(const char* pChunk, unsigned nSize, TWavInfo& Info)
+{
+	if( nSize < 16 )
+	{
+		Info.pError = "fmt chunk too short";
+		return false;
+	}
+
+	unsigned nFormat = GetTheInt(pChunk, 2);
+	unsigned nChannels = GetTheInt(pChunk + 2, 2);
+	unsigned nSampleRate = GetTheInt(pChunk + 4, 4);
+	unsigned nAlign = GetTheInt(pChunk + 12, 2);
+	unsigned nBps = GetTheInt(pChunk + 14, 2);
+											// the extensible format: cbSize,
+                                            // valid bits, channel mask, then
+                                            // the GUID of the subformat, that
+                                            // begins with the format tag
+	if( nFormat == WAV_FORMATEXT )
+	{
+		if( nSize < 40 || GetTheInt(pChunk + 16, 2) < 22 )
+		{
+			Info.pError = "extensible fmt chunk too short";
+			return false;
+		}
+
+		nFormat = GetTheInt(pChunk + 24, 2);
+	}
+
+	if( nFormat != WAV_FORMATPCM )
+	{
+		Info.pError = "not PCM";
+		return false;
+	}
+
+	if( nChannels < 1 || nChannels > 2 || (nBps != 8 && nBps != 16) )
+	{
+		Info.pError = "channels or bits per sample not supported";
+		return false;
+	}
+
+	if( nSampleRate == 0 || nSampleRate > WAV_MAXRATE )
+	{
+		Info.pError = "bad sample rate";
+		return false;
+	}
+
+	if( nAlign != nChannels * nBps / 8 )
+	{
+		Info.pError = "bad block align";
+		return false;
+	}
+
+	Info.nChannels = nChannels;
+	Info.nSampleRate = nSampleRate;
+	Info.nBps = nBps;
+
+	return true;
+}
+
+/*!****************************************************************************
+* @brief	Parses a WAV file
+* @param	pBytes The bytes of the file
+* @param	nSize The size of the file
+* @param[out] Info The format and the samples, or the error
+* @return	True for a PCM WAV file supported, false otherwise
+******************************************************************************/
+bool ParseTheWav(const char* pBytes, unsigned nSize, TWavInfo& Info)
+{
+	memset(&Info, 0, sizeof(Info));
+
+	if( !pBytes || nSize < 12 || memcmp(pBytes, "RIFF", 4) != 0 )
+	{
+		Info.pError = "not a RIFF file";
+		return false;
+	}
+
+	if( memcmp(pBytes + 8, "WAVE", 4) != 0 )
+	{
+		Info.pError = "not a WAVE file";
+		return false;
+	}
+											// the RIFF chunk, within the file:
+                                            // some writers round it up, or
+                                            // leave the bytes of a stream
+	unsigned nEnd = GetTheInt(pBytes + 4, 4);
+
+	if( nEnd < 4 )
+	{
+		Info.pError = "bad RIFF size";
+		return false;
+	}
+
+	nEnd = nEnd > nSize - 8 ? nSize : nEnd + 8;
+
+	bool bFormat = false;
+	const char* pData = NULL;
+	unsigned nData = 0, nPos = 12;
+
+	while( nEnd - nPos >= 8 )
+	{
+		const char* pChunk = pBytes + nPos;
+		unsigned nChunk = GetTheInt(pChunk + 4, 4);
+
+		if( nChunk > nEnd - nPos - 8 )
+		{
+			Info.pError = "chunk past the end of the file";
+			return false;
+		}
+
+		if( memcmp(pChunk, "fmt ", 4) == 0 )
+		{
+			if( !ParseTheFormat(pChunk + 8, nChunk, Info) ) return false;
+			bFormat = true;
+		}
+		else if( memcmp(pChunk, "data", 4) == 0 && !pData )
+		{
+			pData = pChunk + 8;
+			nData = nChunk;
+		}
+											// the padding of the odd sizes,
+                                            // missing after the last chunk
+                                            // of some files
+		nPos += 8 + nChunk;
+		nPos += (nChunk & 1) && nPos < nEnd;
+	}
+
+	if( !bFormat )
+	{
+		Info.pError = "no fmt chunk";
+		return false;
+	}
+
+	if( !pData )
+	{
+		Info.pError = "no data chunk";
+		return false;
+	}
+
+	unsigned nFrame = Info.nChannels * Info.nBps / 8;
+
+	Info.pData = pData;
+	Info.nSize = nData - nData % nFrame;
+
+	return true;
+}
+
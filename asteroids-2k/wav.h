@@ -0,0 +1,31 @@
+/******************************************************************************
+	author:	Francesco Settembrini
+	last update: 23/6/2021
+	e-mail:	mailto:francesco.settembrini@poliba.it
+******************************************************************************/
+
+#ifndef _WAV_H_
+#define _WAV_H_
+
+#define WAV_MAXRATE			192000
+#define WAV_FORMATPCM		0x0001
+#define WAV_FORMATEXT		0xFFFE		// WAVE_FORMAT_EXTENSIBLE
+
+
+										// the PCM samples of a WAV file: the
+                                        // data points in the bytes parsed,
+                                        // they are not copied
+struct TWavInfo
+{
+	int nChannels;						// 1 or 2
+	int nSampleRate;
+	int nBps;							// 8 or 16
+	const char* pData;
+	unsigned nSize;						// in bytes, whole frames
+	const char* pError;					// why the file is rejected
+};
+
+bool ParseTheWav(const char* pBytes, unsigned nSize, TWavInfo& Info);
+
+#endif
+
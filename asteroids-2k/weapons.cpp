@@ -11,123 +11,159 @@
 
 ******************************************************************************/
 
-#include <windows.h>
+#include <assert.h>
 
 #include "weapons.h"
 
 /*!****************************************************************************
-* @brief	Builds the missile
+* @brief	Builds the pool, all the missiles are allocated here
 * @param	pVM Pointer to the video manager data structure
+* @param	pJobs Pointer to the job system
+* @param	pEntities Pointer to the entity store, the missiles are its
+*			archetype ekMissile
+* @param	nCapacity Maximum number of live missiles
 ******************************************************************************/
-TWeapon::TWeapon(TVideoManager* pVM)
+TMissilePool::TMissilePool(TVideoDevice* pVM, TJobSystem* pJobs,
+	TEntityStore* pEntities, unsigned nCapacity)
 {
 	assert(pVM);
+	assert(pJobs);
+	assert(pEntities);
 
 	m_pVM = pVM;
-	m_bArmed = false;
-
-	m_Pos = TVector2(-10,-10);
-	m_Vel = TVector2(0,0);
+	m_pJobs = pJobs;
+	m_pEntities = pEntities;
+	m_pMissiles = &pEntities->GetArchetype(ekMissile);
+	m_nCapacity = nCapacity;
+	m_nPeak = m_nArmed = 0;
+	m_Dt = 0;
+
+	m_pMissiles->Reserve(nCapacity);
 }
 
 /*!****************************************************************************
-* @brief	Builds the missile
-* @param	pVM Pointer to the video manager data structure
-* @param	Pos Initial position of the missile
-* @param	Vel Initial velocity of the missile
+* @brief	Destructor, gives back the missiles to the store
 ******************************************************************************/
-TWeapon::TWeapon(TVideoManager* pVM, TVector2 Pos, TVector2 Vel)
+TMissilePool::~TMissilePool()
 {
-	assert(pVM);
-
-	m_Pos = Pos;
-	m_Vel = Vel;
-	m_pVM = pVM;
-	m_bArmed = false;
+	Clear();
 }
 
 /*!****************************************************************************
-* @brief	Gets the missile position
-* @return	The position of the missile
+* @brief	Updates the armed missiles: moves them, in parallel, then draws
+*			them, in order
+* @param	Dt The value for the delta time
 ******************************************************************************/
-TVector2 TWeapon::GetPos()
+void TMissilePool::Update(double Dt)
 {
-	return m_Pos;
+	m_Dt = Dt;
+
+	TMethodJob<TMissilePool> Job(this, &TMissilePool::Move);
+	m_pJobs->ParallelFor(GetCount(), MISSILES_GRAIN, Job);
+
+	for(unsigned i=0; i<GetCount(); i++)
+	{
+		if( IsArmed(i) )
+		{
+			TVector2 Pos = GetPos(i);
+			m_pVM->DrawPoint(Pos, m_pMissiles->Renderables[i].Color);
+		}
+	}
 }
 
 /*!****************************************************************************
-* @brief	Gets the status of missile
-* @return	Returns true if the missile is armed, false otherwise
+* @brief	Moves the armed missiles of a range
+* @param	nBegin First missile
+* @param	nEnd One past the last missile
 ******************************************************************************/
-bool TWeapon::IsArmed()
+void TMissilePool::Move(unsigned nBegin, unsigned nEnd)
 {
-	return m_bArmed;
+	IntegrateTheMotion(*m_pMissiles, m_Dt, nBegin, nEnd);
 }
 
 /*!****************************************************************************
-* @brief	Arms the missile
-* @param	Pos The position of the missile
-* @param	Vel The velocity of the missile
+* @brief	Takes a missile from the pool, not armed yet
+* @return	Index of the missile, -1 if the pool is exhausted
+* @note		The index is valid until the next Despawn() or Compact()
 ******************************************************************************/
-void TWeapon::Arm(TVector2 Pos, TVector2 Vel)
+int TMissilePool::Spawn()
 {
-	m_Pos = Pos;
-	m_Vel = Vel;
-	m_bArmed = true;
-	m_Color = RGB(255,255,255);
+	if( GetCount() == m_nCapacity ) return -1;
+
+	m_pEntities->Create(ekMissile);
+
+	unsigned nIndex = GetCount() - 1;
+											// out of the scenery, until armed
+	m_pMissiles->Transforms[nIndex].X = m_pMissiles->Transforms[nIndex].Y = -10;
+	m_pMissiles->Previous[nIndex].X = m_pMissiles->Previous[nIndex].Y = -10;
+
+	if( GetCount() > m_nPeak ) m_nPeak = GetCount();
+
+	return nIndex;
 }
 
 /*!****************************************************************************
-* @brief	Builds the missile
-* @param	pVM Pointer to the video manager data structure
+* @brief	Arms a missile
+* @param	nIndex Index of the missile
+* @param	Pos The position of the missile
+* @param	Vel The velocity of the missile
 ******************************************************************************/
-TMissile::TMissile(TVideoManager* pVM):TWeapon(pVM)
+void TMissilePool::Arm(unsigned nIndex, TVector2 Pos, TVector2 Vel)
 {
-	m_pShip = NULL;
+	TTransform& Transform = m_pMissiles->Transforms[nIndex];
+	TMotion& Motion = m_pMissiles->Motions[nIndex];
+
+	Transform.X = m_pMissiles->Previous[nIndex].X = Pos.X;
+	Transform.Y = m_pMissiles->Previous[nIndex].Y = Pos.Y;
+	Motion.VX = Vel.X;
+	Motion.VY = Vel.Y;
+
+	if( !IsArmed(nIndex) ) m_nArmed++;
+
+	m_pMissiles->Lifetimes[nIndex].bAlive = true;
+	m_pMissiles->Renderables[nIndex].Color = RGB(255,255,255);
 }
 
 /*!****************************************************************************
-* @brief	Builds the missile
-* @param	pVM Pointer to the video manager data structure
-* @param	Pos Initial position of the missile
-* @param	Vel Initial velocity of the missile
+* @brief	Disarms a missile, it is given back by the next Compact()
+* @param	nIndex Index of the missile
 ******************************************************************************/
-TMissile::TMissile(TVideoManager* pVM, TVector2 Pos, TVector2 Vel)
-: TWeapon(pVM, Pos, Vel)
+void TMissilePool::Disarm(unsigned nIndex)
 {
-	m_pShip = NULL;
+	if( IsArmed(nIndex) ) m_nArmed--;
+
+	m_pMissiles->Lifetimes[nIndex].bAlive = false;
 }
 
 /*!****************************************************************************
-* @brief	Set the pointer to the ship
-* @param	pShip The pointer to the TShip object
+* @brief	Gives back a missile to the pool, the last live missile
+*			takes its place
+* @param	nIndex Index of the missile
 ******************************************************************************/
-void TMissile::SetShip(TShip* pShip)
+void TMissilePool::Despawn(unsigned nIndex)
 {
-	m_pShip = pShip;
+	assert(nIndex < GetCount());
+
+	if( IsArmed(nIndex) ) m_nArmed--;
+
+	m_pEntities->Remove(ekMissile, nIndex);
 }
 
 /*!****************************************************************************
-* @brief	Gett the pointer to the ship
-* @return	Return the pointer to the TShip object
+* @brief	Gives back to the pool all the disarmed missiles
+* @note		Single pass that keeps the firing order of the live missiles,
+*			so the oldest missile is still the first one to be tested
 ******************************************************************************/
-TShip* TMissile::GetShip()
+void TMissilePool::Compact()
 {
-	return m_pShip;
+	m_pEntities->RemoveTheDead(ekMissile);
 }
 
 /*!****************************************************************************
-* @brief	Updates by time the missile status
-* @param	Dt The value for the delta time
+* @brief	Gives back to the pool all the missiles
 ******************************************************************************/
-void TMissile::Update(double Dt)
+void TMissilePool::Clear()
 {
-	assert(m_pVM);
-
-	m_Pos.X += m_Vel.X * Dt;
-	m_Pos.Y += m_Vel.Y * Dt;
-
-	m_pVM->DrawPoint(m_Pos, m_Color);
+	m_pEntities->Clear(ekMissile);
+	m_nArmed = 0;
 }
-
-
@@ -11,47 +11,66 @@
 #include <vector>
 
 #include "maths.h"
-#include "video.h"
+#include "devices.h"
 #include "vectors.h"
+#include "jobs.h"
+#include "entities.h"
 
+#define MISSILES_POOLSIZE	256
+#define MISSILES_GRAIN		1024	// missiles per chunk of a parallel loop
+#define MISSILES_CONTACTSGRAIN	32	// the same, for the collisions
 
-class TShip;
 
-class TWeapon;
-typedef std::vector<TWeapon*> TVecPtrWeapons;
-
-class TWeapon
+										// fixed number of missiles, the archetype
+										// ekMissile of the entity store: the live
+										// missiles, armed or not, are the first
+										// GetCount() entities, in firing order
+class TMissilePool
 {
 	public:
-    	TWeapon(TVideoManager* pVM);
-        TWeapon(TVideoManager* pVM, TVector2 Pos, TVector2 Vel);
-
-        TVector2 GetPos();
-        virtual void Update(double Dt) = 0;
-
-        bool IsArmed();
-        void Arm(TVector2 Pos, TVector2 Vel);
+		TMissilePool(TVideoDevice* pVM, TJobSystem* pJobs, TEntityStore* pEntities,
+			unsigned nCapacity = MISSILES_POOLSIZE);
+		~TMissilePool();
 
-	protected:
-		bool m_bArmed;
-        TVector2 m_Pos, m_Vel;
-        COLORREF m_Color;
-        TVideoManager *m_pVM;
-};
-
-class TMissile : public TWeapon
-{
 	public:
-        TMissile(TVideoManager* pVM);
-        TMissile(TVideoManager* pVM, TVector2 Pos, TVector2 Vel);
+		void Update(double Dt);
+
+		int Spawn();
+		void Despawn(unsigned nIndex);
+		void Compact();
+		void Clear();
+
+		void Arm(unsigned nIndex, TVector2 Pos, TVector2 Vel);
+		void Disarm(unsigned nIndex);
+		bool IsArmed(unsigned nIndex) { return m_pMissiles->Lifetimes[nIndex].bAlive != 0; }
+
+		TVector2 GetPos(unsigned nIndex)
+			{ return TVector2(m_pMissiles->Transforms[nIndex].X, m_pMissiles->Transforms[nIndex].Y); }
+		TVector2 GetPrevPos(unsigned nIndex)
+			{ return TVector2(m_pMissiles->Previous[nIndex].X, m_pMissiles->Previous[nIndex].Y); }
+		TVector2 GetVel(unsigned nIndex)
+			{ return TVector2(m_pMissiles->Motions[nIndex].VX, m_pMissiles->Motions[nIndex].VY); }
+											// the ship that has fired it
+		TEntity GetOwner(unsigned nIndex) { return m_pMissiles->Owners[nIndex].nOwner; }
+		void SetOwner(unsigned nIndex, TEntity nShip) { m_pMissiles->Owners[nIndex].nOwner = nShip; }
+
+		unsigned GetCount() { return m_pMissiles->GetCount(); }
+		unsigned GetArmedCount() { return m_nArmed; }
+		unsigned GetPeak() { return m_nPeak; }
+		unsigned GetCapacity() { return m_nCapacity; }
+		void ResetPeak() { m_nPeak = GetCount(); }
 
-		TShip* GetShip();
-		void SetShip(TShip* pShip);
-
-        void Update(double Dt);
+	protected:
+		TVideoDevice *m_pVM;
+		TJobSystem *m_pJobs;
+		TEntityStore *m_pEntities;
+		TArchetype *m_pMissiles;			// the components of the missiles
+		unsigned m_nCapacity, m_nPeak;
+		unsigned m_nArmed;					// kept by Arm() and Disarm()
+		double m_Dt;
 
 	protected:
-        TShip* m_pShip;
+		void Move(unsigned nBegin, unsigned nEnd);
 };
 
 #endif